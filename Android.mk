@@ -117,10 +117,16 @@ LOCAL_SRC_FILES := \
     session/src/ACDEngine.cpp \
     resource_manager/src/ResourceManager.cpp \
     resource_manager/src/SndCardMonitor.cpp \
+    resource_manager/src/StreamHandleTable.cpp \
     utils/src/SoundTriggerXmlParser.cpp \
     utils/src/SoundTriggerPlatformInfo.cpp \
     utils/src/ACDPlatformInfo.cpp \
     utils/src/PalRingBuffer.cpp \
+    utils/src/PalLatencyTrace.cpp \
+    utils/src/PalEventExecutor.cpp \
+    utils/src/PalDebugDump.cpp \
+    utils/src/PalIdPool.cpp \
+    utils/src/PalGraphLock.cpp \
     utils/src/SoundTriggerUtils.cpp \
     utils/src/SignalHandler.cpp
 ifeq ($(strip $(AUDIO_FEATURE_ENABLED_EC_REF_CAPTURE)),true)
@@ -30,6 +30,8 @@
 
 #define LOG_TAG "PAL: API"
 
+#include <atomic>
+#include <map>
 #include <set>
 #include <unistd.h>
 #include <stdlib.h>
@@ -38,6 +40,8 @@
 #include "Device.h"
 #include "ResourceManager.h"
 #include "PalCommon.h"
+#include "PalLatencyTrace.h"
+#include "PalEventExecutor.h"
 class Stream;
 
 /*
@@ -68,6 +72,134 @@ static void notify_concurrent_stream(pal_stream_type_t type,
     rm->ConcurrentStreamStatus(type, dir, active);
 }
 
+/* Only streams from pal_stream_open_async are recorded here. The *_async
+ * APIs run on a serial queue per stream, so a start queued behind the open
+ * only runs once the open is done. The open and start wait on the driver,
+ * so the queues sit on the blocking executor, in the RT lane since the
+ * client waits on them while deferred stops and other housekeeping can be
+ * late. Completions go to the callback given at open, which not every
+ * stream type keeps. pending is set until the open finishes and every
+ * other call on the handle gets -EBUSY meanwhile. opened stays false until
+ * the open succeeds; pal_stream_close then skips the inactive notification
+ * that was never matched by an active one.
+ */
+struct pal_async_stream {
+    std::shared_ptr<PalEventQueue> queue;
+    pal_stream_callback cb;
+    uint64_t cookie;
+    bool pending;
+    bool opened;
+};
+
+static std::mutex asyncStreamsMutex;
+static std::map<Stream *, pal_async_stream> asyncStreams;
+/* lets stream calls skip the lookup while no async open is pending */
+static std::atomic<uint32_t> asyncOpensPending(0);
+
+static void add_async_stream(Stream *s, pal_stream_callback cb, uint64_t cookie)
+{
+    std::lock_guard<std::mutex> lock(asyncStreamsMutex);
+
+    asyncStreams[s] = {nullptr, cb, cookie, true, false};
+    asyncOpensPending++;
+}
+
+/* returns nullptr for a stream that did not come from pal_stream_open_async */
+static std::shared_ptr<PalEventQueue> get_async_queue(Stream *s)
+{
+    std::lock_guard<std::mutex> lock(asyncStreamsMutex);
+    auto it = asyncStreams.find(s);
+
+    if (it == asyncStreams.end())
+        return nullptr;
+
+    if (!it->second.queue)
+        it->second.queue = PalEventExecutor::getBlockingInstance()->createQueue(
+            "pal_async_stream", PAL_EXEC_LANE_RT);
+    return it->second.queue;
+}
+
+static bool async_open_pending(pal_stream_handle_t *stream_handle)
+{
+    if (!asyncOpensPending.load())
+        return false;
+
+    std::lock_guard<std::mutex> lock(asyncStreamsMutex);
+    auto it = asyncStreams.find(reinterpret_cast<Stream *>(stream_handle));
+
+    return it != asyncStreams.end() && it->second.pending;
+}
+
+static void set_async_open_done(Stream *s, bool opened)
+{
+    std::lock_guard<std::mutex> lock(asyncStreamsMutex);
+    auto it = asyncStreams.find(s);
+
+    if (it != asyncStreams.end() && it->second.pending) {
+        it->second.pending = false;
+        it->second.opened = opened;
+        asyncOpensPending--;
+    }
+}
+
+static bool async_opened(Stream *s)
+{
+    std::lock_guard<std::mutex> lock(asyncStreamsMutex);
+    auto it = asyncStreams.find(s);
+
+    return it == asyncStreams.end() || it->second.opened;
+}
+
+/* drops queued async work and waits for a running open/start, returns
+ * false if the stream came from an async open that did not succeed
+ */
+static bool remove_async_stream(Stream *s)
+{
+    std::shared_ptr<PalEventQueue> queue = nullptr;
+    bool opened = true;
+
+    asyncStreamsMutex.lock();
+    auto it = asyncStreams.find(s);
+    if (it != asyncStreams.end())
+        queue = it->second.queue;
+    asyncStreamsMutex.unlock();
+
+    if (queue)
+        queue->close();
+
+    asyncStreamsMutex.lock();
+    it = asyncStreams.find(s);
+    if (it != asyncStreams.end()) {
+        opened = it->second.opened;
+        /* the open was dropped from the queue before it ran */
+        if (it->second.pending)
+            asyncOpensPending--;
+        asyncStreams.erase(it);
+    }
+    asyncStreamsMutex.unlock();
+
+    return opened;
+}
+
+static void notify_async_done(Stream *s, uint32_t event_id, int32_t status)
+{
+    pal_stream_callback cb = NULL;
+    uint64_t cookie = 0;
+
+    asyncStreamsMutex.lock();
+    auto it = asyncStreams.find(s);
+    if (it != asyncStreams.end()) {
+        cb = it->second.cb;
+        cookie = it->second.cookie;
+    }
+    asyncStreamsMutex.unlock();
+
+    /* the client may close the stream from the callback, s is not used after */
+    if (cb)
+        cb(reinterpret_cast<pal_stream_handle_t *>(s), event_id,
+           reinterpret_cast<uint32_t *>(&status), sizeof(status), cookie);
+}
+
 /*
  * pal_init - Initialize PAL
  *
@@ -138,6 +270,7 @@ int32_t pal_stream_open(struct pal_stream_attributes *attributes,
                         pal_stream_callback cb, uint64_t cookie,
                         pal_stream_handle_t **stream_handle)
 {
+    PalLatencyScope trace(PAL_TRACE_STREAM_OPEN);
     uint64_t *stream = NULL;
     Stream *s = NULL;
     int status;
@@ -186,10 +319,20 @@ int32_t pal_stream_open(struct pal_stream_attributes *attributes,
     s->getStreamAttributes(&sAttr);
     notify_concurrent_stream(sAttr.type, sAttr.direction, true);
 
+    status = rm->initStreamUserCounter(s);
+    if (0 != status) {
+        PAL_ERR(LOG_TAG, "no stream user counter slot, status %d", status);
+        notify_concurrent_stream(sAttr.type, sAttr.direction, false);
+        if (s->close() != 0) {
+            PAL_ERR(LOG_TAG, "stream closed failed.");
+        }
+        delete s;
+        goto exit;
+    }
+
     if (cb)
        s->registerCallBack(cb, cookie);
 
-    rm->initStreamUserCounter(s);
     stream = reinterpret_cast<uint64_t *>(s);
     *stream_handle = stream;
 exit:
@@ -197,10 +340,94 @@ exit:
     return status;
 }
 
+int32_t pal_stream_open_async(struct pal_stream_attributes *attributes,
+                              uint32_t no_of_devices, struct pal_device *devices,
+                              uint32_t no_of_modifiers, struct modifier_kv *modifiers,
+                              pal_stream_callback cb, uint64_t cookie,
+                              pal_stream_handle_t **stream_handle)
+{
+    uint64_t *stream = NULL;
+    Stream *s = NULL;
+    int status;
+    std::shared_ptr<PalEventQueue> queue = nullptr;
+    std::shared_ptr<ResourceManager> rm = NULL;
+
+    rm = ResourceManager::getInstance();
+    if (!rm) {
+        PAL_ERR(LOG_TAG, "Invalid resource manager");
+        status = -EINVAL;
+        return status;
+    }
+
+    if (!attributes || !cb || !stream_handle) {
+        status = -EINVAL;
+        PAL_ERR(LOG_TAG, "Invalid input parameters status %d", status);
+        return status;
+    }
+
+    PAL_INFO(LOG_TAG, "Enter, stream type:%d", attributes->type);
+
+    try {
+        s = Stream::create(attributes, devices, no_of_devices, modifiers,
+                           no_of_modifiers);
+    } catch (const std::exception& e) {
+        status = -EINVAL;
+        PAL_ERR(LOG_TAG, "Stream create failed: %s", e.what());
+        Stream::handleStreamException(attributes, cb, cookie);
+        goto exit;
+    }
+    if (!s) {
+        status = -EINVAL;
+        PAL_ERR(LOG_TAG, "stream creation failed status %d", status);
+        goto exit;
+    }
+
+    /* nothing is queued yet, so a stream without a counter slot just goes */
+    status = rm->initStreamUserCounter(s);
+    if (0 != status) {
+        PAL_ERR(LOG_TAG, "no stream user counter slot, status %d", status);
+        s->close();
+        delete s;
+        goto exit;
+    }
+
+    s->registerCallBack(cb, cookie);
+    add_async_stream(s, cb, cookie);
+    stream = reinterpret_cast<uint64_t *>(s);
+    *stream_handle = stream;
+
+    queue = get_async_queue(s);
+    status = queue->post([s]() {
+        PalLatencyScope trace(PAL_TRACE_STREAM_OPEN);
+        struct pal_stream_attributes sAttr;
+        int32_t ret = s->open();
+
+        if (0 != ret) {
+            PAL_ERR(LOG_TAG, "async open of %pK failed with status %d", s, ret);
+        } else {
+            s->getStreamAttributes(&sAttr);
+            notify_concurrent_stream(sAttr.type, sAttr.direction, true);
+        }
+        set_async_open_done(s, 0 == ret);
+        notify_async_done(s, PAL_STREAM_CBK_EVENT_OPEN_DONE, ret);
+    });
+    if (0 != status) {
+        PAL_ERR(LOG_TAG, "failed to queue the open, status %d", status);
+        pal_stream_close(stream);
+        stream = NULL;
+        *stream_handle = NULL;
+    }
+exit:
+    PAL_INFO(LOG_TAG, "Exit. Value of stream_handle %pK, status %d", stream, status);
+    return status;
+}
+
 int32_t pal_stream_close(pal_stream_handle_t *stream_handle)
 {
+    PalLatencyScope trace(PAL_TRACE_STREAM_CLOSE);
     Stream *s = NULL;
     int status;
+    bool opened = true;
     struct pal_stream_attributes sAttr;
     std::shared_ptr<ResourceManager> rm = NULL;
     if (!stream_handle) {
@@ -226,6 +453,7 @@ int32_t pal_stream_close(pal_stream_handle_t *stream_handle)
     rm->unlockValidStreamMutex();
 
     s = reinterpret_cast<Stream *>(stream_handle);
+    opened = remove_async_stream(s);
     s->setCachedState(STREAM_IDLE);
     status = s->close();
 
@@ -240,7 +468,8 @@ int32_t pal_stream_close(pal_stream_handle_t *stream_handle)
     }
 exit:
     s->getStreamAttributes(&sAttr);
-    notify_concurrent_stream(sAttr.type, sAttr.direction, false);
+    if (opened)
+        notify_concurrent_stream(sAttr.type, sAttr.direction, false);
     delete s;
     rm->eraseStreamUserCounter(s);
     PAL_INFO(LOG_TAG, "Exit. status %d", status);
@@ -249,6 +478,7 @@ exit:
 
 int32_t pal_stream_start(pal_stream_handle_t *stream_handle)
 {
+    PalLatencyScope trace(PAL_TRACE_STREAM_START);
     Stream *s = NULL;
     std::shared_ptr<ResourceManager> rm = NULL;
     int status;
@@ -259,6 +489,11 @@ int32_t pal_stream_start(pal_stream_handle_t *stream_handle)
     }
     PAL_INFO(LOG_TAG, "Enter. Stream handle %pK", stream_handle);
 
+    if (async_open_pending(stream_handle)) {
+        PAL_ERR(LOG_TAG, "async open of %pK not done yet", stream_handle);
+        return -EBUSY;
+    }
+
     rm = ResourceManager::getInstance();
     if (!rm) {
         PAL_ERR(LOG_TAG, "Invalid resource manager");
@@ -298,8 +533,63 @@ exit:
     return status;
 }
 
+int32_t pal_stream_start_async(pal_stream_handle_t *stream_handle)
+{
+    Stream *s = NULL;
+    std::shared_ptr<PalEventQueue> queue = nullptr;
+    std::shared_ptr<ResourceManager> rm = NULL;
+    int status;
+    if (!stream_handle) {
+        status = -EINVAL;
+        PAL_ERR(LOG_TAG, "Invalid stream handle status %d", status);
+        return status;
+    }
+    PAL_INFO(LOG_TAG, "Enter. Stream handle %pK", stream_handle);
+
+    rm = ResourceManager::getInstance();
+    if (!rm) {
+        PAL_ERR(LOG_TAG, "Invalid resource manager");
+        status = -EINVAL;
+        goto exit;
+    }
+
+    rm->lockValidStreamMutex();
+    if (!rm->isActiveStream(stream_handle)) {
+        rm->unlockValidStreamMutex();
+        status = -EINVAL;
+        goto exit;
+    }
+    rm->unlockValidStreamMutex();
+
+    s = reinterpret_cast<Stream *>(stream_handle);
+    queue = get_async_queue(s);
+    if (!queue) {
+        status = -EINVAL;
+        PAL_ERR(LOG_TAG, "stream not opened with pal_stream_open_async, status %d",
+                status);
+        goto exit;
+    }
+
+    status = queue->post([s]() {
+        int32_t ret = -EINVAL;
+
+        if (async_opened(s))
+            ret = pal_stream_start(reinterpret_cast<pal_stream_handle_t *>(s));
+        else
+            PAL_ERR(LOG_TAG, "async open of %pK failed, not starting", s);
+        notify_async_done(s, PAL_STREAM_CBK_EVENT_START_DONE, ret);
+    });
+    if (0 != status)
+        PAL_ERR(LOG_TAG, "failed to queue the start, status %d", status);
+
+exit:
+    PAL_INFO(LOG_TAG, "Exit. status %d", status);
+    return status;
+}
+
 int32_t pal_stream_stop(pal_stream_handle_t *stream_handle)
 {
+    PalLatencyScope trace(PAL_TRACE_STREAM_STOP);
     Stream *s = NULL;
     std::shared_ptr<ResourceManager> rm = NULL;
     int status;
@@ -310,6 +600,12 @@ int32_t pal_stream_stop(pal_stream_handle_t *stream_handle)
         return status;
     }
     PAL_INFO(LOG_TAG, "Enter. Stream handle :%pK", stream_handle);
+
+    if (async_open_pending(stream_handle)) {
+        PAL_ERR(LOG_TAG, "async open of %pK not done yet", stream_handle);
+        return -EBUSY;
+    }
+
     rm = ResourceManager::getInstance();
     if (!rm) {
         PAL_ERR(LOG_TAG, "Invalid resource manager");
@@ -355,38 +651,38 @@ ssize_t pal_stream_write(pal_stream_handle_t *stream_handle, struct pal_buffer *
     int status;
     std::shared_ptr<ResourceManager> rm = NULL;
 
+    if (async_open_pending(stream_handle)) {
+        PAL_ERR(LOG_TAG, "async open of %pK not done yet", stream_handle);
+        return -EBUSY;
+    }
+
     rm = ResourceManager::getInstance();
     if (!rm) {
         PAL_ERR(LOG_TAG, "Invalid resource manager");
         status = -EINVAL;
         return status;
     }
-    rm->lockValidStreamMutex();
-    if (!stream_handle || !rm->isActiveStream(stream_handle) || !buf) {
-        rm->unlockValidStreamMutex();
+    if (!stream_handle || !buf) {
         status = -EINVAL;
         PAL_ERR(LOG_TAG, "Invalid input parameters status %d", status);
         return status;
     }
 
     PAL_VERBOSE(LOG_TAG, "Enter. Stream handle :%pK", stream_handle);
+    /* handle is validated and pinned without taking mValidStreamMutex */
     s =  reinterpret_cast<Stream *>(stream_handle);
     status = rm->increaseStreamUserCounter(s);
     if (0 != status) {
-        rm->unlockValidStreamMutex();
         PAL_ERR(LOG_TAG, "failed to increase stream user count");
         return status;
     }
-    rm->unlockValidStreamMutex();
 
     status = s->write(buf);
     if (status < 0) {
         PAL_ERR(LOG_TAG, "stream write failed status %d", status);
     }
 
-    rm->lockValidStreamMutex();
     rm->decreaseStreamUserCounter(s);
-    rm->unlockValidStreamMutex();
 
     PAL_VERBOSE(LOG_TAG, "Exit. status %d", status);
     return status;
@@ -398,38 +694,38 @@ ssize_t pal_stream_read(pal_stream_handle_t *stream_handle, struct pal_buffer *b
     int status;
     std::shared_ptr<ResourceManager> rm = NULL;
 
+    if (async_open_pending(stream_handle)) {
+        PAL_ERR(LOG_TAG, "async open of %pK not done yet", stream_handle);
+        return -EBUSY;
+    }
+
     rm = ResourceManager::getInstance();
     if (!rm) {
         PAL_ERR(LOG_TAG, "Invalid resource manager");
         status = -EINVAL;
         return status;
     }
-    rm->lockValidStreamMutex();
-    if (!stream_handle || !rm->isActiveStream(stream_handle) || !buf) {
-        rm->unlockValidStreamMutex();
+    if (!stream_handle || !buf) {
         status = -EINVAL;
         PAL_ERR(LOG_TAG, "Invalid input parameters status %d", status);
         return status;
     }
 
     PAL_VERBOSE(LOG_TAG, "Enter. Stream handle :%pK", stream_handle);
+    /* handle is validated and pinned without taking mValidStreamMutex */
     s =  reinterpret_cast<Stream *>(stream_handle);
     status = rm->increaseStreamUserCounter(s);
     if (0 != status) {
-        rm->unlockValidStreamMutex();
         PAL_ERR(LOG_TAG, "failed to increase stream user count");
         return status;
     }
-    rm->unlockValidStreamMutex();
 
     status = s->read(buf);
     if (status < 0) {
         PAL_ERR(LOG_TAG, "stream read failed status %d", status);
     }
 
-    rm->lockValidStreamMutex();
     rm->decreaseStreamUserCounter(s);
-    rm->unlockValidStreamMutex();
     PAL_VERBOSE(LOG_TAG, "Exit. status %d", status);
     return status;
 }
@@ -441,6 +737,11 @@ int32_t pal_stream_get_param(pal_stream_handle_t *stream_handle,
     int status;
     std::shared_ptr<ResourceManager> rm = NULL;
 
+    if (async_open_pending(stream_handle)) {
+        PAL_ERR(LOG_TAG, "async open of %pK not done yet", stream_handle);
+        return -EBUSY;
+    }
+
     rm = ResourceManager::getInstance();
     if (!rm) {
         status = -EINVAL;
@@ -485,6 +786,11 @@ int32_t pal_stream_set_param(pal_stream_handle_t *stream_handle, uint32_t param_
     int status;
     std::shared_ptr<ResourceManager> rm = NULL;
 
+    if (async_open_pending(stream_handle)) {
+        PAL_ERR(LOG_TAG, "async open of %pK not done yet", stream_handle);
+        return -EBUSY;
+    }
+
     rm = ResourceManager::getInstance();
     if (!rm) {
         status = -EINVAL;
@@ -537,6 +843,12 @@ int32_t pal_stream_set_volume(pal_stream_handle_t *stream_handle,
     Stream *s = NULL;
     int status;
     std::shared_ptr<ResourceManager> rm = NULL;
+
+    if (async_open_pending(stream_handle)) {
+        PAL_ERR(LOG_TAG, "async open of %pK not done yet", stream_handle);
+        return -EBUSY;
+    }
+
     rm = ResourceManager::getInstance();
     if (!rm) {
         PAL_ERR(LOG_TAG, "Invalid resource manager");
@@ -593,6 +905,11 @@ int32_t pal_stream_set_mute(pal_stream_handle_t *stream_handle, bool state)
         return status;
     }
 
+    if (async_open_pending(stream_handle)) {
+        PAL_ERR(LOG_TAG, "async open of %pK not done yet", stream_handle);
+        return -EBUSY;
+    }
+
     rm = ResourceManager::getInstance();
     if (!rm) {
         status = -EINVAL;
@@ -639,6 +956,11 @@ int32_t pal_stream_pause(pal_stream_handle_t *stream_handle)
     int status;
     std::shared_ptr<ResourceManager> rm = NULL;
 
+    if (async_open_pending(stream_handle)) {
+        PAL_ERR(LOG_TAG, "async open of %pK not done yet", stream_handle);
+        return -EBUSY;
+    }
+
     rm = ResourceManager::getInstance();
     if (!rm) {
         PAL_ERR(LOG_TAG, "Invalid resource manager");
@@ -681,6 +1003,11 @@ int32_t pal_stream_resume(pal_stream_handle_t *stream_handle)
     int status;
     std::shared_ptr<ResourceManager> rm = NULL;
 
+    if (async_open_pending(stream_handle)) {
+        PAL_ERR(LOG_TAG, "async open of %pK not done yet", stream_handle);
+        return -EBUSY;
+    }
+
     rm = ResourceManager::getInstance();
     if (!rm) {
         PAL_ERR(LOG_TAG, "Invalid resource manager");
@@ -731,6 +1058,11 @@ int32_t pal_stream_drain(pal_stream_handle_t *stream_handle, pal_drain_type_t ty
 
     PAL_DBG(LOG_TAG, "Enter. Stream handle :%pK", stream_handle);
 
+    if (async_open_pending(stream_handle)) {
+        PAL_ERR(LOG_TAG, "async open of %pK not done yet", stream_handle);
+        return -EBUSY;
+    }
+
     rm = ResourceManager::getInstance();
     if (!rm) {
         PAL_ERR(LOG_TAG, "Invalid resource manager");
@@ -775,6 +1107,11 @@ int32_t pal_stream_flush(pal_stream_handle_t *stream_handle)
     int status;
     std::shared_ptr<ResourceManager> rm = NULL;
 
+    if (async_open_pending(stream_handle)) {
+        PAL_ERR(LOG_TAG, "async open of %pK not done yet", stream_handle);
+        return -EBUSY;
+    }
+
     rm = ResourceManager::getInstance();
     if (!rm) {
         PAL_ERR(LOG_TAG, "Invalid resource manager");
@@ -818,6 +1155,11 @@ int32_t pal_stream_suspend(pal_stream_handle_t *stream_handle)
     int status;
     std::shared_ptr<ResourceManager> rm = NULL;
 
+    if (async_open_pending(stream_handle)) {
+        PAL_ERR(LOG_TAG, "async open of %pK not done yet", stream_handle);
+        return -EBUSY;
+    }
+
     rm = ResourceManager::getInstance();
     if (!rm) {
         PAL_ERR(LOG_TAG, "Invalid resource manager");
@@ -863,6 +1205,11 @@ int32_t pal_stream_set_buffer_size (pal_stream_handle_t *stream_handle,
     int status;
     std::shared_ptr<ResourceManager> rm = NULL;
 
+    if (async_open_pending(stream_handle)) {
+        PAL_ERR(LOG_TAG, "async open of %pK not done yet", stream_handle);
+        return -EBUSY;
+    }
+
     rm = ResourceManager::getInstance();
     if (!rm) {
         PAL_ERR(LOG_TAG, "Invalid resource manager");
@@ -907,6 +1254,11 @@ int32_t pal_get_timestamp(pal_stream_handle_t *stream_handle,
     std::shared_ptr<ResourceManager> rm = NULL;
     PAL_DBG(LOG_TAG, "Enter. Stream handle :%pK\n", stream_handle);
 
+    if (async_open_pending(stream_handle)) {
+        PAL_ERR(LOG_TAG, "async open of %pK not done yet", stream_handle);
+        return -EBUSY;
+    }
+
     rm = ResourceManager::getInstance();
     if (!rm) {
         PAL_ERR(LOG_TAG, "Invalid resource manager");
@@ -954,6 +1306,11 @@ int32_t pal_add_remove_effect(pal_stream_handle_t *stream_handle,
     int status = 0;
     std::shared_ptr<ResourceManager> rm = NULL;
 
+    if (async_open_pending(stream_handle)) {
+        PAL_ERR(LOG_TAG, "async open of %pK not done yet", stream_handle);
+        return -EBUSY;
+    }
+
     rm = ResourceManager::getInstance();
     if (!rm) {
         PAL_ERR(LOG_TAG, "Invalid resource manager");
@@ -995,6 +1352,7 @@ int32_t pal_add_remove_effect(pal_stream_handle_t *stream_handle,
 int32_t pal_stream_set_device(pal_stream_handle_t *stream_handle,
                            uint32_t no_of_devices, struct pal_device *devices)
 {
+    PalLatencyScope trace(PAL_TRACE_STREAM_SET_DEVICE);
     int status = -EINVAL;
     Stream *s = NULL;
     std::shared_ptr<ResourceManager> rm = NULL;
@@ -1018,6 +1376,11 @@ int32_t pal_stream_set_device(pal_stream_handle_t *stream_handle,
         return status;
     }
 
+    if (async_open_pending(stream_handle)) {
+        PAL_ERR(LOG_TAG, "async open of %pK not done yet", stream_handle);
+        return -EBUSY;
+    }
+
     rm = ResourceManager::getInstance();
     if (!rm) {
         status = -EINVAL;
@@ -1158,6 +1521,11 @@ int32_t pal_stream_get_tags_with_module_info(pal_stream_handle_t *stream_handle,
     Stream *s = NULL;
     std::shared_ptr<ResourceManager> rm = NULL;
 
+    if (async_open_pending(stream_handle)) {
+        PAL_ERR(LOG_TAG, "async open of %pK not done yet", stream_handle);
+        return -EBUSY;
+    }
+
     rm = ResourceManager::getInstance();
     if (!rm) {
         status = -EINVAL;
@@ -1246,6 +1614,11 @@ int32_t pal_stream_get_mmap_position(pal_stream_handle_t *stream_handle,
     int status;
     std::shared_ptr<ResourceManager> rm = NULL;
 
+    if (async_open_pending(stream_handle)) {
+        PAL_ERR(LOG_TAG, "async open of %pK not done yet", stream_handle);
+        return -EBUSY;
+    }
+
     rm = ResourceManager::getInstance();
     if (!rm) {
         status = -EINVAL;
@@ -1291,6 +1664,11 @@ int32_t pal_stream_create_mmap_buffer(pal_stream_handle_t *stream_handle,
     int status;
     std::shared_ptr<ResourceManager> rm = NULL;
 
+    if (async_open_pending(stream_handle)) {
+        PAL_ERR(LOG_TAG, "async open of %pK not done yet", stream_handle);
+        return -EBUSY;
+    }
+
     rm = ResourceManager::getInstance();
     if (!rm) {
         status = -EINVAL;
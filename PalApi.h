@@ -102,6 +102,28 @@ int32_t pal_stream_open(struct pal_stream_attributes *attributes,
                         pal_stream_callback cb, uint64_t cookie,
                         pal_stream_handle_t **stream_handle);
 
+/**
+  * \brief Open the stream without waiting for the graph setup.
+  *        Takes the same arguments as pal_stream_open. The handle
+  *        is returned right away; PAL_STREAM_CBK_EVENT_OPEN_DONE
+  *        is raised through cb with the int32_t status of the open
+  *        once it completes. Until then only pal_stream_start_async
+  *        and pal_stream_close may be called on the handle, other
+  *        calls return -EBUSY. On a failed open the handle must
+  *        still be closed.
+  *
+  * \param[in] cb - callback function associated with stream,
+  *        mandatory for the async open.
+  *
+  * \return 0 if the open was queued, -ENOSYS through a PAL
+  *         service without the async calls, error code otherwise
+  */
+int32_t pal_stream_open_async(struct pal_stream_attributes *attributes,
+                              uint32_t no_of_devices, struct pal_device *devices,
+                              uint32_t no_of_modifiers, struct modifier_kv *modifiers,
+                              pal_stream_callback cb, uint64_t cookie,
+                              pal_stream_handle_t **stream_handle);
+
 /**
   * \brief Close the stream.
   *
@@ -137,6 +159,20 @@ int32_t pal_stream_close(pal_stream_handle_t *stream_handle);
   */
 int32_t pal_stream_start(pal_stream_handle_t *stream_handle);
 
+/**
+  * \brief Start the stream without waiting for it. Runs after a
+  *        pending pal_stream_open_async on the same handle and
+  *        raises PAL_STREAM_CBK_EVENT_START_DONE with the int32_t
+  *        status of the start.
+  *
+  * \param[in] stream_handle - Valid stream handle obtained
+  *       from pal_stream_open_async
+  *
+  * \return 0 if the start was queued, -ENOSYS through a PAL
+  *         service without the async calls, error code otherwise
+  */
+int32_t pal_stream_start_async(pal_stream_handle_t *stream_handle);
+
 /**
   * \brief Stop the stream. Stream must be in started/paused
   *        state before stoping.
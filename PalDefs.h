@@ -630,6 +630,8 @@ typedef enum {
     PAL_STREAM_CBK_EVENT_PARTIAL_DRAIN_READY, /* partial drain completed */
     PAL_STREAM_CBK_EVENT_READ_DONE, /* stream hit some error, let AF take action */
     PAL_STREAM_CBK_EVENT_ERROR, /* stream hit some error, let AF take action */
+    PAL_STREAM_CBK_EVENT_OPEN_DONE, /* pal_stream_open_async completed, payload is int32_t status */
+    PAL_STREAM_CBK_EVENT_START_DONE, /* pal_stream_start_async completed, payload is int32_t status */
 } pal_stream_callback_event_t;
 
 /* type of global callback events. */
@@ -920,6 +922,9 @@ typedef enum {
     PAL_PARAM_ID_TIMESTRETCH_PARAMS = 72,
     PAL_PARAM_ID_LATENCY_MODE = 73,
     PAL_PARAM_ID_PROXY_RECORD_SESSION = 74,
+    PAL_PARAM_ID_LATENCY_TRACE = 75,
+    PAL_PARAM_ID_FE_POOL_STATS = 76,
+    PAL_PARAM_ID_DEBUG_DUMP = 77,
 } pal_param_id_type_t;
 
 /** HDMI/DP */
@@ -964,6 +969,39 @@ struct pal_vol_ctrl_ramp_param {
     uint32_t ramp_period_ms;
 };
 
+/* Payload For ID: PAL_PARAM_ID_LATENCY_TRACE
+ * Description   : get returns a NUL terminated JSON string with per-phase
+ *                 latency histograms of stream open/start/stop/close and
+ *                 device switch and the parallel vs. summed RX/TX mixer
+ *                 setup and pcm open time of voice and loopback sessions,
+ *                 allocated by PAL and freed by the caller.
+ *                 set with any payload clears the histograms.
+*/
+
+/* Payload For ID: PAL_PARAM_ID_FE_POOL_STATS
+ * Description   : get only, returns a NUL terminated JSON array with size,
+ *                 usage, peak, failure and bad free counters and the busy
+ *                 ids of every front end id pool, allocated by PAL and freed
+ *                 by the caller.
+*/
+
+/* Payload For ID: PAL_PARAM_ID_DEBUG_DUMP
+ * Description   : set configures the asynchronous debug dump writer:
+ *                 max_bytes caps dump data queued for the writer thread
+ *                 (0 keeps the current cap). The queued data lives in an
+ *                 arena sized by the cap when the first dump is opened, a
+ *                 larger cap set later is bounded by it. Bit n of
+ *                 pcm_tap_mask dumps the pcm read/write buffers of
+ *                 pal_stream_type_t n to /data/vendor/audio. get
+ *                 returns a NUL terminated JSON string with queued,
+ *                 written and dropped byte counters, allocated by PAL
+ *                 and freed by the caller.
+*/
+typedef struct pal_param_debug_dump {
+    uint32_t max_bytes;
+    uint64_t pcm_tap_mask;
+} pal_param_debug_dump_t;
+
 /* Payload For ID: PAL_PARAM_ID_DEVICE_CONNECTION
  * Description   : Device Connection
 */
@@ -37,6 +37,7 @@
 #include <PalApi.h>
 #include "ACDPlatformInfo.h"
 #include <PalCommon.h>
+#include "PalEventExecutor.h"
 
 enum PCM_DATA_EFFECT {
     PCM_DATA_EFFECT_RAW = 1,
@@ -206,11 +207,7 @@ class ContextManager
 private:
     std::map<uint32_t, see_client *> see_clients;
     pal_stream_handle_t *proxy_stream;
-    bool exit_cmd_thread_;
-    std::condition_variable request_queue_cv;
-    std::mutex request_queue_mtx;
-    std::thread cmd_thread_;
-    std::queue<RequestCommand *> request_cmd_queue;
+    std::shared_ptr<PalEventQueue> request_cmd_queue;
 
     see_client* SEE_Client_CreateIf_And_Get(uint32_t see_id);
     see_client * SEE_Client_Get_Existing(uint32_t see_id);
@@ -219,7 +216,6 @@ private:
     int32_t CreateCommandProcessingThread();
     void DestroyCommandProcessingThread();
     void CloseAll();
-    static void CommandThreadRunner(ContextManager& cm);
     int32_t build_and_send_register_ack(Usecase *uc, uint32_t see_id, uint32_t uc_id);
 
 public:
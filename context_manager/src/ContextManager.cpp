@@ -319,22 +319,23 @@ int32_t ContextManager::Init()
     int32_t rc = 0;
     PAL_VERBOSE(LOG_TAG, "Enter");
 
-    rc = OpenAndStartProxyStream();
+    /* the proxy stream callback posts to the command queue */
+    rc = CreateCommandProcessingThread();
     if (rc) {
-        PAL_ERR(LOG_TAG, "Error:%d Failed to OpenAndStartProxyStream", rc);
+        PAL_ERR(LOG_TAG, "Error:%d Failed to CreateCommandProcessingThread", rc);
         goto exit;
     }
 
-    rc = CreateCommandProcessingThread();
+    rc = OpenAndStartProxyStream();
     if (rc) {
-        PAL_ERR(LOG_TAG, "Error:%d Failed to CreateCommandProcessingThread", rc);
-        goto stop_and_close_proxy_stream;
+        PAL_ERR(LOG_TAG, "Error:%d Failed to OpenAndStartProxyStream", rc);
+        goto destroy_cmd_thread;
     }
 
     goto exit;
 
-stop_and_close_proxy_stream:
-    StopAndCloseProxyStream();
+destroy_cmd_thread:
+    DestroyCommandProcessingThread();
 
 exit:
     PAL_VERBOSE(LOG_TAG, "Exit rc %d", rc);
@@ -355,17 +356,12 @@ void ContextManager::DeInit()
 int32_t ContextManager::ssrDownHandler()
 {
     int32_t rc = 0;
-    std::unique_lock<std::mutex> lck(request_queue_mtx, std::defer_lock);
     PAL_VERBOSE(LOG_TAG, "Enter");
 
     this->CloseAll();
 
-    lck.lock();
-    while (!request_cmd_queue.empty()) {
-        free(request_cmd_queue.front());
-        request_cmd_queue.pop();
-    }
-    lck.unlock();
+    if (request_cmd_queue)
+        request_cmd_queue->clear();
 
     PAL_VERBOSE(LOG_TAG, "Exit rc %d", rc);
     return rc;
@@ -385,15 +381,27 @@ int32_t ContextManager::StreamProxyCallback (pal_stream_handle_t *stream_handle,
 {
     RequestCommand *request_command;
     ContextManager* cm = ((ContextManager*)cookie);
+    int32_t rc = 0;
 
     PAL_VERBOSE(LOG_TAG, "Enter");
-    std::unique_lock<std::mutex> lck(cm->request_queue_mtx);
     request_command = RequestCommandFactory::RequestCommandCreate(event_id, event_data);
-    cm->request_cmd_queue.push(request_command);
-    cm->request_queue_cv.notify_one();
+    if (!request_command) {
+        PAL_ERR(LOG_TAG, "Error: unsupported event id 0x%x", event_id);
+        return -EINVAL;
+    }
+
+    rc = cm->request_cmd_queue->post([cm, request_command] {
+        int32_t status = request_command->Process(*cm);
+
+        if (status)
+            PAL_ERR(LOG_TAG, "Error:%d failed to process request", status);
+        delete request_command;
+    });
+    if (rc)
+        delete request_command;
 
     PAL_VERBOSE(LOG_TAG, "Exit");
-    return 0;
+    return rc;
 }
 
 void ContextManager::CloseAll()
@@ -472,45 +480,15 @@ int32_t ContextManager::StopAndCloseProxyStream()
     return rc;
 }
 
-void ContextManager::CommandThreadRunner(ContextManager& cm)
-{
-    RequestCommand *request_command;
-    int32_t rc = 0;
-
-    PAL_VERBOSE(LOG_TAG, "Entering CommandThreadRunner");
-
-    std::unique_lock<std::mutex> lck(cm.request_queue_mtx);
-    while (!cm.exit_cmd_thread_) {
-        // wait until we have a command to process.
-        if (cm.request_cmd_queue.empty()) {
-            cm.request_queue_cv.wait(lck);
-            if (cm.exit_cmd_thread_) {
-                PAL_DBG(LOG_TAG, "Received exit request");
-                continue;
-            }
-        }
-
-        request_command = cm.request_cmd_queue.front();
-        cm.request_cmd_queue.pop();
-
-        rc = request_command->Process(cm);
-        if (rc) {
-            PAL_ERR(LOG_TAG, "Error:%d failed to process request", rc);
-        }
-
-        free(request_command);
-    }
-    PAL_VERBOSE(LOG_TAG, "Exiting CommandThreadRunner");
-}
-
 int32_t ContextManager::CreateCommandProcessingThread()
 {
     int32_t rc = 0;
 
     PAL_VERBOSE(LOG_TAG, "Enter");
 
-    exit_cmd_thread_ = false;
-    cmd_thread_ = std::thread(CommandThreadRunner, std::ref(*this));
+    /* requests open and close streams, so they run on the blocking pool */
+    request_cmd_queue = PalEventExecutor::getBlockingInstance()->createQueue(
+        "context_manager_cmd", PAL_EXEC_LANE_NORMAL);
 
     PAL_VERBOSE(LOG_TAG, "Exit rc: %d", rc);
     return rc;
@@ -522,12 +500,9 @@ void ContextManager::DestroyCommandProcessingThread()
 
     PAL_VERBOSE(LOG_TAG, "Enter");
 
-    exit_cmd_thread_ = true;
-    request_queue_cv.notify_all();
-
-    if (cmd_thread_.joinable()) {
-        PAL_DBG(LOG_TAG, "Join cmd_thread_ thread");
-        cmd_thread_.join();
+    if (request_cmd_queue) {
+        request_cmd_queue->close();
+        request_cmd_queue = nullptr;
     }
 
     PAL_VERBOSE(LOG_TAG, "Exit rc:%d", rc);
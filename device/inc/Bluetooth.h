@@ -35,6 +35,7 @@
 #include <bt_intf.h>
 #include <bt_ble.h>
 #include <vector>
+#include <map>
 #include <mutex>
 #include <system/audio.h>
 
@@ -103,6 +104,10 @@ protected:
     std::mutex                 mAbrMutex;
     int                        totalActiveSessionRequests;
 
+    static std::mutex pluginLibMutex;
+    static std::map<std::string, std::pair<void *, open_fn_t>> pluginLibs;
+    static int loadPluginLib(const std::string &lib_path, void **handle,
+                             open_fn_t *open_fn);
     int getPluginPayload(void **handle, bt_codec_t **btCodec,
                          bt_enc_payload_t **out_buf,
                          codec_type codecType);
@@ -48,6 +48,9 @@
 #define MIXER_SET_FEEDBACK_CHANNEL        "BT set feedback channel"
 #define BT_SLIMBUS_CLK_STR                "BT SLIMBUS CLK SRC"
 
+std::mutex Bluetooth::pluginLibMutex;
+std::map<std::string, std::pair<void *, open_fn_t>> Bluetooth::pluginLibs;
+
 Bluetooth::Bluetooth(struct pal_device *device, std::shared_ptr<ResourceManager> Rm)
     : Device(device, Rm),
       codecFormat(CODEC_TYPE_INVALID),
@@ -132,6 +135,46 @@ bool Bluetooth::isPlaceholderEncoder()
     }
 }
 
+/*
+ * Codec plugin libraries are loaded once per library path and stay resident,
+ * A2DP/LE start, suspend/resume and reconfiguration only reopen the plugin.
+ */
+int Bluetooth::loadPluginLib(const std::string &lib_path, void **handle,
+              open_fn_t *open_fn)
+{
+    std::lock_guard<std::mutex> lock(pluginLibMutex);
+    void *lib = NULL;
+    open_fn_t fn = NULL;
+
+    auto it = pluginLibs.find(lib_path);
+    if (it != pluginLibs.end()) {
+        *handle = it->second.first;
+        *open_fn = it->second.second;
+        return 0;
+    }
+
+    lib = dlopen(lib_path.c_str(), RTLD_NOW);
+    if (lib == NULL) {
+        PAL_ERR(LOG_TAG, "failed to dlopen lib %s", lib_path.c_str());
+        return -EINVAL;
+    }
+
+    dlerror();
+    fn = (open_fn_t)dlsym(lib, "plugin_open");
+    if (!fn) {
+        PAL_ERR(LOG_TAG, "dlsym to open fn failed, err = '%s'", dlerror());
+        dlclose(lib);
+        return -EINVAL;
+    }
+
+    PAL_INFO(LOG_TAG, "loaded BT codec plugin %s", lib_path.c_str());
+    pluginLibs[lib_path] = std::make_pair(lib, fn);
+    *handle = lib;
+    *open_fn = fn;
+
+    return 0;
+}
+
 int Bluetooth::getPluginPayload(void **libHandle, bt_codec_t **btCodec,
               bt_enc_payload_t **out_buf, codec_type codecType)
 {
@@ -147,19 +190,9 @@ int Bluetooth::getPluginPayload(void **libHandle, bt_codec_t **btCodec,
         return -ENOSYS;
     }
 
-    handle = dlopen(lib_path.c_str(), RTLD_NOW);
-    if (handle == NULL) {
-        PAL_ERR(LOG_TAG, "failed to dlopen lib %s", lib_path.c_str());
-        return -EINVAL;
-    }
-
-    dlerror();
-    plugin_open_fn = (open_fn_t)dlsym(handle, "plugin_open");
-    if (!plugin_open_fn) {
-        PAL_ERR(LOG_TAG, "dlsym to open fn failed, err = '%s'", dlerror());
-        status = -EINVAL;
-        goto error;
-    }
+    status = loadPluginLib(lib_path, &handle, &plugin_open_fn);
+    if (status)
+        return status;
 
     status = plugin_open_fn(&codec, codecFormat, codecType);
     if (status) {
@@ -179,9 +212,6 @@ int Bluetooth::getPluginPayload(void **libHandle, bt_codec_t **btCodec,
 error:
     if (codec)
         codec->close_plugin(codec);
-
-    if (handle)
-        dlclose(handle);
 done:
     return status;
 }
@@ -821,7 +851,6 @@ void Bluetooth::startAbr()
                   (uint32_t *)blk->payload, blk->payload_sz, miid, blk->param_id);
 
         codec->close_plugin(codec);
-        dlclose(pluginLibHandle);
 
         if (!paramData) {
             PAL_ERR(LOG_TAG, "Failed to populateAPMHeader");
@@ -936,7 +965,6 @@ void Bluetooth::startAbr()
             }
 
             codec->close_plugin(codec);
-            dlclose(pluginLibHandle);
 
             if (fbDevice.id == PAL_DEVICE_IN_BLUETOOTH_SCO_HEADSET) {
                 /* COP v2 DEPACKETIZER Module Configuration */
@@ -1608,10 +1636,7 @@ int BtA2dp::stopPlayback()
             pluginCodec->close_plugin(pluginCodec);
             pluginCodec = NULL;
         }
-        if (pluginHandler) {
-            dlclose(pluginHandler);
-            pluginHandler = NULL;
-        }
+        pluginHandler = NULL;
     }
 
     PAL_DBG(LOG_TAG, "Stop A2DP playback, total active sessions :%d",
@@ -1773,10 +1798,7 @@ int BtA2dp::stopCapture()
             pluginCodec->close_plugin(pluginCodec);
             pluginCodec = NULL;
         }
-        if (pluginHandler) {
-            dlclose(pluginHandler);
-            pluginHandler = NULL;
-        }
+        pluginHandler = NULL;
     }
     PAL_DBG(LOG_TAG, "Stop A2DP capture, total active sessions :%d",
             totalActiveSessionRequests);
@@ -2297,10 +2319,7 @@ int BtSco::stop()
         pluginCodec->close_plugin(pluginCodec);
         pluginCodec = NULL;
     }
-    if (pluginHandler) {
-        dlclose(pluginHandler);
-        pluginHandler = NULL;
-    }
+    pluginHandler = NULL;
 
     Device::stop_l();
     if (isAbrEnabled == false)
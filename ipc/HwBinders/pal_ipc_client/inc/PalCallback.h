@@ -45,6 +45,7 @@ using PalAudioFmt = ::vendor::qti::hardware::pal::V1_0::PalAudioFmt;
 using PalDeviceId = ::vendor::qti::hardware::pal::V1_0::PalDeviceId;
 using PalDrainType = ::vendor::qti::hardware::pal::V1_0::PalDrainType;
 using PalBuffer = ::vendor::qti::hardware::pal::V1_0::PalBuffer;
+using TimeSpec = ::vendor::qti::hardware::pal::V1_0::TimeSpec;
 using PalBufferConfig = ::vendor::qti::hardware::pal::V1_0::PalBufferConfig;
 using PalStreamHandle = ::vendor::qti::hardware::pal::V1_0::PalStreamHandle;
 using PalChannelVolKv = ::vendor::qti::hardware::pal::V1_0::PalChannelVolKv;
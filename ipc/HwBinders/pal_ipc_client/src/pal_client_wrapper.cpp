@@ -29,25 +29,125 @@
 
 #define LOG_TAG "pal_client_wrapper"
 #include <vendor/qti/hardware/pal/1.0/IPAL.h>
+#include <vendor/qti/hardware/pal/1.1/IPAL.h>
 #include <hidl/MQDescriptor.h>
 #include <hidl/Status.h>
 #include <log/log.h>
+#include <sys/mman.h>
+#include <algorithm>
+#include <map>
+#include <vector>
 #include "PalApi.h"
 #include "inc/PalCallback.h"
 
+#define PAL_SHARED_DATA_BUF_COUNT 4
+
 using android::hardware::Return;
 using android::hardware::hidl_vec;
 using vendor::qti::hardware::pal::V1_0::IPAL;
+using IPAL_1_1 = vendor::qti::hardware::pal::V1_1::IPAL;
 
 using vendor::qti::hardware::pal::V1_0::implementation::PalCallback;
 using android::sp;
 
 bool pal_server_died = false;
 android::sp<IPAL> pal_client = NULL;
+/* set when the server also implements @1.1, which adds the shared buffers
+ * and the async open/start
+ */
+android::sp<IPAL_1_1> pal_client_1_1 = NULL;
 sp<server_death_notifier> Server_death_notifier = NULL;
 
 std::mutex gLock;
 
+/* buffers shared with the server, data is copied in place instead of sent in hidl_vec */
+struct pal_shared_data {
+    uint8_t *base;
+    size_t memSize;
+    uint32_t bufSize;
+    uint32_t bufCount;
+    uint32_t nextIdx;
+    bool unsupported;
+
+    pal_shared_data() : base(nullptr), memSize(0), bufSize(0), bufCount(0),
+                        nextIdx(0), unsupported(false) {}
+    ~pal_shared_data()
+    {
+        if (base)
+            munmap(base, memSize);
+    }
+};
+
+std::mutex gSharedDataLock;
+std::map<pal_stream_handle_t *, std::shared_ptr<pal_shared_data>> gSharedData;
+
+static bool pal_shared_data_eligible(struct pal_buffer *buf)
+{
+    /* metadata and extern alloc buffers still go through the hidl_vec path */
+    return buf->buffer && buf->size && !buf->metadata_size &&
+           !buf->alloc_info.alloc_size;
+}
+
+static std::shared_ptr<pal_shared_data> get_shared_data(android::sp<IPAL_1_1> client,
+                                                        pal_stream_handle_t *stream_handle,
+                                                        size_t size, uint32_t *idx)
+{
+    std::lock_guard<std::mutex> guard(gSharedDataLock);
+    std::shared_ptr<pal_shared_data> shData = nullptr;
+    auto it = gSharedData.find(stream_handle);
+    int32_t ret = -EINVAL;
+
+    if (it != gSharedData.end()) {
+        if (it->second->unsupported)
+            return nullptr;
+        if (size <= it->second->bufSize) {
+            shData = it->second;
+            *idx = shData->nextIdx++ % shData->bufCount;
+            return shData;
+        }
+    }
+
+    /* first use or a bigger period, (re)map the shared buffers */
+    shData = std::make_shared<pal_shared_data>();
+    client->ipc_pal_stream_map_shared_buffers((PalStreamHandle)stream_handle,
+               (uint32_t)size, PAL_SHARED_DATA_BUF_COUNT,
+               [&](int32_t ret_, const hidl_handle& memHandle, uint32_t memSize)
+                  {
+                      ret = ret_;
+                      if (ret || !memHandle.getNativeHandle() ||
+                          memHandle->numFds < 1)
+                          return;
+                      void *base = mmap(NULL, memSize, PROT_READ | PROT_WRITE,
+                                        MAP_SHARED, memHandle->data[0], 0);
+                      if (base == MAP_FAILED) {
+                          ALOGE("%s: mmap failed %d", __func__, errno);
+                          ret = -ENOMEM;
+                          return;
+                      }
+                      shData->base = (uint8_t *)base;
+                      shData->memSize = memSize;
+                  });
+    if (ret || !shData->base) {
+        ALOGI("%s: shared buffers unavailable for %pK, ret %d", __func__,
+              stream_handle, ret);
+        shData->unsupported = true;
+        gSharedData[stream_handle] = shData;
+        return nullptr;
+    }
+
+    shData->bufSize = (uint32_t)size;
+    shData->bufCount = PAL_SHARED_DATA_BUF_COUNT;
+    *idx = shData->nextIdx++;
+    gSharedData[stream_handle] = shData;
+    return shData;
+}
+
+static void put_shared_data(pal_stream_handle_t *stream_handle)
+{
+    std::lock_guard<std::mutex> guard(gSharedDataLock);
+    gSharedData.erase(stream_handle);
+}
+
 void server_death_notifier::serviceDied(uint64_t cookie,
                    const android::wp<::android::hidl::base::V1_0::IBase>& who)
 {
@@ -58,6 +158,13 @@ void server_death_notifier::serviceDied(uint64_t cookie,
     _exit(1);
 }
 
+/* only valid once get_pal_server() has returned a server */
+static android::sp<IPAL_1_1> get_pal_server_1_1()
+{
+    std::lock_guard<std::mutex> guard(gLock);
+    return pal_client_1_1;
+}
+
 android::sp<IPAL> get_pal_server() {
     std::lock_guard<std::mutex> guard(gLock);
     if (pal_client == NULL) {
@@ -71,6 +178,9 @@ android::sp<IPAL> get_pal_server() {
             pal_client->linkToDeath(Server_death_notifier, 0);
             ALOGE("palclient linked to death server death \n", __func__);
         }
+        pal_client_1_1 = IPAL_1_1::castFrom(pal_client);
+        if (pal_client_1_1 == nullptr)
+            ALOGI("PAL service has no @1.1, shared buffers disabled");
     }
 exit:
     return pal_client ;
@@ -113,63 +223,52 @@ exit:
     return int32_t {};
 }
 
+/*
+ * Backing store for rw_done payloads handed to the client callback. The
+ * callback runs on a hwbinder thread and only borrows the buffers, so they
+ * are kept per thread and only grow when a bigger period shows up.
+ */
+static uint8_t *get_rw_done_scratch(std::vector<uint8_t> &scratch, size_t size)
+{
+    if (scratch.size() < size)
+        scratch.resize(size);
+    return scratch.data();
+}
+
 Return<int32_t> PalCallback::event_callback_rw_done(uint64_t strm_handle,
                                  uint32_t event_id,
                                  uint32_t event_data_size,
                                  const hidl_vec<PalEventReadWriteDonePayload>& event_data,
                                  uint64_t cookie) {
-    struct pal_event_read_write_done_payload *rw_done_payload;
-    struct pal_buffer *buffer = nullptr;
-    uint32_t *ev_data = NULL;
+    static thread_local std::vector<uint8_t> dataScratch;
+    static thread_local std::vector<uint8_t> metadataScratch;
+    struct pal_event_read_write_done_payload rw_done_payload = {};
+    struct timespec ts;
+    struct pal_buffer *buffer = &rw_done_payload.buff;
     const native_handle *allochandle = nullptr;
     const PalEventReadWriteDonePayload *rwDonePayloadHidl = event_data.data();
-    PalBuffer *bufferHidl;
 
     ALOGV("%s called \n", __func__);
-    rw_done_payload = (struct pal_event_read_write_done_payload *)
-                          calloc(1, sizeof(pal_event_read_write_done_payload));
-    if (!rw_done_payload) {
-        ALOGE("%s:%d Failed to allocate memory to rw_done_payload", __func__, __LINE__);
-        goto exit;
-    }
-
-    ev_data = (uint32_t *)rw_done_payload;
-    rw_done_payload->tag = rwDonePayloadHidl->tag;
-    rw_done_payload->status = rwDonePayloadHidl->status;
-    rw_done_payload->md_status = rwDonePayloadHidl->md_status;
-
-    buffer = &rw_done_payload->buff;
+    rw_done_payload.tag = rwDonePayloadHidl->tag;
+    rw_done_payload.status = rwDonePayloadHidl->status;
+    rw_done_payload.md_status = rwDonePayloadHidl->md_status;
 
     buffer->size = rwDonePayloadHidl->buff.size;
     if (rwDonePayloadHidl->buff.buffer.size() == buffer->size) {
-        buffer->buffer = (uint8_t *)calloc(1, buffer->size);
-        if (!buffer->buffer) {
-            ALOGE("%s:%d Failed to allocate memory to buffer", __func__, __LINE__);
-            goto exit;
-        }
+        buffer->buffer = get_rw_done_scratch(dataScratch, buffer->size);
         memcpy(buffer->buffer, rwDonePayloadHidl->buff.buffer.data(),
                buffer->size);
     }
 
     buffer->offset = rwDonePayloadHidl->buff.offset;
-    buffer->ts = (struct timespec *) calloc(1, sizeof(struct timespec));
-    if (!buffer->ts) {
-        ALOGE("%s:%d Failed to allocate memory to buffer->ts", __func__, __LINE__);
-        goto exit;
-    }
-
+    buffer->ts = &ts;
     buffer->ts->tv_sec = rwDonePayloadHidl->buff.timeStamp.tvSec;
     buffer->ts->tv_nsec = rwDonePayloadHidl->buff.timeStamp.tvNSec;
     buffer->flags = rwDonePayloadHidl->buff.flags;
     if (rwDonePayloadHidl->buff.metadataSz) {
         buffer->metadata_size = rwDonePayloadHidl->buff.metadataSz;
-        buffer->metadata = (uint8_t *)calloc(1, buffer->metadata_size);
-        if (!buffer->metadata) {
-            ALOGE("%s:%d Failed to allocate memory to buffer->metadata",
-                __func__, __LINE__);
-            goto exit;
-        }
-
+        buffer->metadata = get_rw_done_scratch(metadataScratch,
+                                               buffer->metadata_size);
         ALOGV("metadatasize %d \n", buffer->metadata_size);
         memcpy(buffer->metadata, rwDonePayloadHidl->buff.metadata.data(),
                buffer->metadata_size);
@@ -183,36 +282,32 @@ Return<int32_t> PalCallback::event_callback_rw_done(uint64_t strm_handle,
     ALOGV("%s:%d Bufsize %d  ret bufSize %d", __func__, __LINE__, rwDonePayloadHidl->buff.size, buffer->size);
     ALOGV("event_payload_size %d alloc_handle %d", event_data_size, allochandle->data[1]);
     ALOGV("alloc size %d alloc_size ret %d", rwDonePayloadHidl->buff.alloc_info.alloc_size,buffer->alloc_info.alloc_size);
-    this->cb((pal_stream_handle_t *)strm_handle, event_id, ev_data, event_data_size,
-                                    cookie);
+    this->cb((pal_stream_handle_t *)strm_handle, event_id, (uint32_t *)&rw_done_payload,
+             event_data_size, cookie);
 
-exit:
-    if (buffer) {
-        if (buffer->metadata)
-            free(buffer->metadata);
-        if (buffer->buffer)
-            free(buffer->buffer);
-        if (buffer->ts)
-            free(buffer->ts);
-    }
-    if (rw_done_payload)
-        free(rw_done_payload);
     return int32_t {};
 }
 
-int32_t pal_stream_open(struct pal_stream_attributes *attr,
-                        uint32_t no_of_devices, struct pal_device *devices,
-                        uint32_t no_of_modifiers, struct modifier_kv *modifiers,
-                        pal_stream_callback cb, uint64_t cookie,
-                        pal_stream_handle_t **stream_handle)
+static int32_t stream_open(struct pal_stream_attributes *attr,
+                           uint32_t no_of_devices, struct pal_device *devices,
+                           uint32_t no_of_modifiers, struct modifier_kv *modifiers,
+                           pal_stream_callback cb, uint64_t cookie, bool async,
+                           pal_stream_handle_t **stream_handle)
 {
     int32_t ret = -EINVAL;
     if (!pal_server_died) {
-        sp<IPALCallback> ClbkBinder = new PalCallback(cb);
         android::sp<IPAL> pal_client = get_pal_server();
         if (pal_client == nullptr)
             return ret;
 
+        android::sp<IPAL_1_1> pal_client_1_1 = get_pal_server_1_1();
+        if (async && pal_client_1_1 == nullptr) {
+            ALOGE("%s: PAL service has no async open", __func__);
+            return -ENOSYS;
+        }
+
+        sp<IPALCallback> ClbkBinder = new PalCallback(cb);
+
         hidl_vec<PalStreamAttributes> attr_hidl;
         hidl_vec<PalDevice> devs_hidl;
         hidl_vec<ModifierKV> modskv_hidl;
@@ -277,18 +372,43 @@ int32_t pal_stream_open(struct pal_stream_attributes *attr,
             modskv_hidl.resize(sizeof(struct modifier_kv) * no_of_modifiers);
             memcpy(modskv_hidl.data(), modifiers, sizeof(struct modifier_kv) * no_of_modifiers);
         }
-        pal_client->ipc_pal_stream_open(attr_hidl, no_of_devices, devs_hidl, no_of_modifiers,
-                                        modskv_hidl, ClbkBinder, cookie,
-                                        [&](int32_t ret_, PalStreamHandle streamHandleRet)
-                                          {
-                                               ret = ret_;
-                                               *stream_handle = (uint64_t *)streamHandleRet;
-                                          }
-                                         );
+        auto open_cb = [&](int32_t ret_, PalStreamHandle streamHandleRet)
+                         {
+                              ret = ret_;
+                              *stream_handle = (uint64_t *)streamHandleRet;
+                         };
+        if (async)
+            pal_client_1_1->ipc_pal_stream_open_async(attr_hidl, no_of_devices, devs_hidl,
+                                                      no_of_modifiers, modskv_hidl, ClbkBinder,
+                                                      cookie, open_cb);
+        else
+            pal_client->ipc_pal_stream_open(attr_hidl, no_of_devices, devs_hidl,
+                                            no_of_modifiers, modskv_hidl, ClbkBinder,
+                                            cookie, open_cb);
     }
     return ret;
 }
 
+int32_t pal_stream_open(struct pal_stream_attributes *attr,
+                        uint32_t no_of_devices, struct pal_device *devices,
+                        uint32_t no_of_modifiers, struct modifier_kv *modifiers,
+                        pal_stream_callback cb, uint64_t cookie,
+                        pal_stream_handle_t **stream_handle)
+{
+    return stream_open(attr, no_of_devices, devices, no_of_modifiers, modifiers,
+                       cb, cookie, false, stream_handle);
+}
+
+int32_t pal_stream_open_async(struct pal_stream_attributes *attr,
+                              uint32_t no_of_devices, struct pal_device *devices,
+                              uint32_t no_of_modifiers, struct modifier_kv *modifiers,
+                              pal_stream_callback cb, uint64_t cookie,
+                              pal_stream_handle_t **stream_handle)
+{
+    return stream_open(attr, no_of_devices, devices, no_of_modifiers, modifiers,
+                       cb, cookie, true, stream_handle);
+}
+
 
 
 int32_t pal_stream_close(pal_stream_handle_t *stream_handle)
@@ -299,6 +419,7 @@ int32_t pal_stream_close(pal_stream_handle_t *stream_handle)
         if (pal_client == nullptr)
             return -EINVAL;
 
+        put_shared_data(stream_handle);
         return pal_client->ipc_pal_stream_close((PalStreamHandle)stream_handle);
     }
     return -EINVAL;
@@ -317,6 +438,23 @@ int32_t pal_stream_start(pal_stream_handle_t *stream_handle)
     return -EINVAL;
 }
 
+int32_t pal_stream_start_async(pal_stream_handle_t *stream_handle)
+{
+    if (!pal_server_died) {
+        ALOGD("%s %d handle %pK", __func__, __LINE__, stream_handle);
+        android::sp<IPAL> pal_client = get_pal_server();
+        if (pal_client == nullptr)
+            return -EINVAL;
+
+        android::sp<IPAL_1_1> pal_client_1_1 = get_pal_server_1_1();
+        if (pal_client_1_1 == nullptr)
+            return -ENOSYS;
+
+        return pal_client_1_1->ipc_pal_stream_start_async((PalStreamHandle)stream_handle);
+    }
+    return -EINVAL;
+}
+
 int32_t pal_stream_stop(pal_stream_handle_t *stream_handle)
 {
     if (!pal_server_died) {
@@ -459,9 +597,29 @@ ssize_t pal_stream_write(pal_stream_handle_t *stream_handle, struct pal_buffer *
         if (pal_client == nullptr)
             return ret;
 
+        android::sp<IPAL_1_1> pal_client_1_1 = get_pal_server_1_1();
+        if (pal_client_1_1 != nullptr && pal_shared_data_eligible(buf)) {
+            uint32_t idx = 0;
+            std::shared_ptr<pal_shared_data> shData =
+                    get_shared_data(pal_client_1_1, stream_handle, buf->size, &idx);
+            if (shData) {
+                TimeSpec ts = {};
+                if (buf->ts) {
+                    ts.tvSec = buf->ts->tv_sec;
+                    ts.tvNSec = buf->ts->tv_nsec;
+                }
+                memcpy(shData->base + (size_t)idx * shData->bufSize, buf->buffer,
+                       buf->size);
+                return pal_client_1_1->ipc_pal_stream_write_shared((PalStreamHandle)stream_handle,
+                                                  idx, buf->size, ts, buf->flags);
+            }
+        }
+
+        /* the caller's buffers are only read while the call is serialized */
+        PalBuffer palBuffData;
+        PalBuffer *palBuff = &palBuffData;
         hidl_vec<PalBuffer> buf_hidl;
-        buf_hidl.resize(sizeof(struct pal_buffer));
-        PalBuffer *palBuff = buf_hidl.data();
+        buf_hidl.setToExternal(palBuff, 1);
         native_handle_t *allocHidlHandle = nullptr;
         allocHidlHandle = native_handle_create(1, 1);
         if (!allocHidlHandle) {
@@ -473,19 +631,16 @@ ssize_t pal_stream_write(pal_stream_handle_t *stream_handle, struct pal_buffer *
 
         palBuff->size = buf->size;
         palBuff->offset = buf->offset;
-        palBuff->buffer.resize(buf->size);
         palBuff->flags = buf->flags;
         if (buf->ts) {
              palBuff->timeStamp.tvSec = buf->ts->tv_sec;
              palBuff->timeStamp.tvNSec = buf->ts->tv_nsec;
         }
         if (buf->size && buf->buffer)
-            memcpy(palBuff->buffer.data(), buf->buffer, buf->size);
+            palBuff->buffer.setToExternal(buf->buffer, buf->size);
         if ((buf->metadata_size > 0) && buf->metadata) {
             palBuff->metadataSz = buf->metadata_size;
-            palBuff->metadata.resize(buf->metadata_size);
-            memcpy(palBuff->metadata.data(),
-                   buf->metadata, buf->metadata_size);
+            palBuff->metadata.setToExternal(buf->metadata, buf->metadata_size);
          }
          palBuff->alloc_info.alloc_handle = hidl_memory("arpal_alloc_handle", hidl_handle(allocHidlHandle),
                                                          buf->alloc_info.alloc_size);
@@ -511,9 +666,36 @@ ssize_t pal_stream_read(pal_stream_handle_t *stream_handle, struct pal_buffer *b
         if (pal_client == nullptr)
             return ret;
 
+        android::sp<IPAL_1_1> pal_client_1_1 = get_pal_server_1_1();
+        if (pal_client_1_1 != nullptr && pal_shared_data_eligible(buf)) {
+            uint32_t idx = 0;
+            std::shared_ptr<pal_shared_data> shData =
+                    get_shared_data(pal_client_1_1, stream_handle, buf->size, &idx);
+            if (shData) {
+                pal_client_1_1->ipc_pal_stream_read_shared((PalStreamHandle)stream_handle,
+                       idx, buf->size,
+                       [&](int32_t ret_, const TimeSpec& ts, uint32_t flags)
+                          {
+                              if (ret_ > 0) {
+                                  memcpy(buf->buffer,
+                                         shData->base + (size_t)idx * shData->bufSize,
+                                         std::min((size_t)ret_, buf->size));
+                                  if (buf->ts) {
+                                      buf->ts->tv_sec = ts.tvSec;
+                                      buf->ts->tv_nsec = ts.tvNSec;
+                                  }
+                                  buf->flags = flags;
+                              }
+                              ret = ret_;
+                          });
+                return ret;
+            }
+        }
+
+        PalBuffer palBuffData;
+        PalBuffer *palBuff = &palBuffData;
         hidl_vec<PalBuffer> buf_hidl;
-        buf_hidl.resize(sizeof(struct pal_buffer));
-        PalBuffer *palBuff = buf_hidl.data();
+        buf_hidl.setToExternal(palBuff, 1);
         native_handle_t *allocHidlHandle = nullptr;
         allocHidlHandle = native_handle_create(1, 1);
         if (!allocHidlHandle) {
@@ -32,6 +32,7 @@ LOCAL_SHARED_LIBRARIES := \
     libhardware \
     libbase \
     vendor.qti.hardware.pal@1.0 \
+    vendor.qti.hardware.pal@1.1 \
     libar-pal
 
 include $(BUILD_SHARED_LIBRARY)
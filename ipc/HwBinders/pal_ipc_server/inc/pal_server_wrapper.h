@@ -37,10 +37,14 @@
 
 #include <vendor/qti/hardware/pal/1.0/IPALCallback.h>
 #include <vendor/qti/hardware/pal/1.0/IPAL.h>
+#include <vendor/qti/hardware/pal/1.1/IPAL.h>
 #include <hidl/MQDescriptor.h>
 #include <hidl/Status.h>
 #include <utils/RefBase.h>
+#include <condition_variable>
 #include <mutex>
+#include <sys/mman.h>
+#include <unistd.h>
 #include "PalApi.h"
 #include<log/log.h>
 
@@ -64,6 +68,27 @@ using ::android::sp;
 
 class PalClientDeathRecipient;
 
+/*
+ * Scratch memory for the hidl_vec read/write path of one session. Blocks
+ * are handed back after each call so steady state streaming does not
+ * touch the heap, and they are never zeroed since every call fills them.
+ */
+class ScratchPool {
+    public :
+    struct block {
+        uint8_t *data;
+        size_t size;
+    };
+    ScratchPool() {}
+    ~ScratchPool();
+    block acquire(size_t size);
+    void release(block blk);
+    void reserve(size_t size, uint32_t count);
+    private :
+    std::mutex mLock;
+    std::vector<block> mFree;
+};
+
 
 class SrvrClbk : public ::android::RefBase {
     public :
@@ -73,12 +98,18 @@ class SrvrClbk : public ::android::RefBase {
     int pid_;
     bool client_died;
     std::vector<std::pair<int, int>> sharedMemFdList;
+    ScratchPool scratch;
+    /* set once openStream has registered the session, OPEN_DONE waits on it */
+    std::mutex registeredLock;
+    std::condition_variable registeredCv;
+    bool registered;
 
     SrvrClbk()
     {
         clbk_binder = NULL;
         client_data_ = 0;
         pid_ = 0;
+        registered = false;
     }
     SrvrClbk(sp<IPALCallback> binder,
              uint64_t client_data, int pid)
@@ -87,20 +118,50 @@ class SrvrClbk : public ::android::RefBase {
         client_data_ = client_data;
         pid_ = pid;
         client_died = false;
+        registered = false;
     }
     void setSessionAttr(struct pal_stream_attributes *attr)
     {
         memcpy(&session_attr, attr, sizeof(session_attr));
     }
+    void setRegistered()
+    {
+        std::lock_guard<std::mutex> lock(registeredLock);
+        registered = true;
+        registeredCv.notify_all();
+    }
+    void waitRegistered()
+    {
+        std::unique_lock<std::mutex> lock(registeredLock);
+        registeredCv.wait(lock, [this] { return registered; });
+    }
     ~SrvrClbk()
     {
       ALOGV("%s:%d",__func__,__LINE__);
     }
 };
 
+/* buffers mapped in both client and server for the zero copy data path */
+struct shared_data_buffer {
+    int fd;
+    uint8_t *base;
+    uint32_t bufSize;
+    uint32_t bufCount;
+
+    shared_data_buffer() : fd(-1), base(nullptr), bufSize(0), bufCount(0) {}
+    ~shared_data_buffer()
+    {
+        if (base)
+            munmap(base, (size_t)bufSize * bufCount);
+        if (fd >= 0)
+            close(fd);
+    }
+};
+
 typedef struct session_info {
     uint64_t session_handle;
     sp<SrvrClbk> callback_binder;
+    std::shared_ptr<shared_data_buffer> shared_data;
 }session_info;
 
 struct client_info {
@@ -109,7 +170,7 @@ struct client_info {
     std::mutex mActiveSessionsLock;
 };
 
-struct PAL : public IPAL /*, public android::hardware::hidl_death_recipient*/{
+struct PAL : public ::vendor::qti::hardware::pal::V1_1::IPAL /*, public android::hardware::hidl_death_recipient*/{
     public:
     std::mutex mClientLock;
     PAL()
@@ -197,6 +258,24 @@ struct PAL : public IPAL /*, public android::hardware::hidl_death_recipient*/{
     Return<void>ipc_pal_stream_get_tags_with_module_info(const uint64_t streamHandle,
                                      uint32_t size,
                                      ipc_pal_stream_get_tags_with_module_info_cb _hidl_cb) override;
+    Return<void>ipc_pal_stream_map_shared_buffers(const uint64_t streamHandle,
+                                     uint32_t bufSize, uint32_t bufCount,
+                                     ipc_pal_stream_map_shared_buffers_cb _hidl_cb) override;
+    Return<int32_t>ipc_pal_stream_write_shared(const uint64_t streamHandle,
+                                     uint32_t bufIdx, uint32_t size,
+                                     const TimeSpec& timeStamp, uint32_t flags) override;
+    Return<void>ipc_pal_stream_read_shared(const uint64_t streamHandle,
+                                     uint32_t bufIdx, uint32_t size,
+                                     ipc_pal_stream_read_shared_cb _hidl_cb) override;
+    Return<void> ipc_pal_stream_open_async(const hidl_vec<PalStreamAttributes>& attributes,
+                                    uint32_t noOfDevices,
+                                    const hidl_vec<PalDevice>& devices,
+                                    uint32_t noOfModifiers,
+                                    const hidl_vec<ModifierKV>& modifiers,
+                                    const sp<IPALCallback>& cb,
+                                    uint64_t ipc_clt_data,
+                                    ipc_pal_stream_open_async_cb _hidl_cb) override;
+    Return<int32_t> ipc_pal_stream_start_async(const uint64_t streamHandle) override;
     sp<PalClientDeathRecipient> mDeathRecipient;
     std::vector<std::shared_ptr<client_info>> mPalClients;
 private:
@@ -204,6 +283,13 @@ private:
     int find_dup_fd_from_input_fd(const uint64_t streamHandle, int input_fd, int *dup_fd);
     void add_input_and_dup_fd(const uint64_t streamHandle, int input_fd, int dup_fd);
     bool isValidstreamHandle(const uint64_t streamHandle);
+    std::shared_ptr<shared_data_buffer> getSharedDataBuffer(const uint64_t streamHandle);
+    sp<SrvrClbk> getSessionCallback(const uint64_t streamHandle);
+    void openStream(const hidl_vec<PalStreamAttributes>& attributes,
+                    uint32_t noOfDevices, const hidl_vec<PalDevice>& devices,
+                    uint32_t noOfModifiers, const hidl_vec<ModifierKV>& modifiers,
+                    const sp<IPALCallback>& cb, uint64_t ipc_clt_data, bool async,
+                    ipc_pal_stream_open_cb _hidl_cb);
 };
 
 class PalClientDeathRecipient : public android::hardware::hidl_death_recipient
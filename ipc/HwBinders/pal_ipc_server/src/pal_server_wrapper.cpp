@@ -34,8 +34,13 @@
 #define LOG_TAG "pal_server_wrapper"
 #include "inc/pal_server_wrapper.h"
 #include <hwbinder/IPCThreadState.h>
+#include <cutils/ashmem.h>
+#include <algorithm>
+#include <new>
 
 #define MAX_CACHE_SIZE 64
+#define MAX_SHARED_DATA_SIZE (4 * 1024 * 1024)
+#define MAX_SCRATCH_BLOCKS 4
 
 using vendor::qti::hardware::pal::V1_0::IPAL;
 using android::hardware::hidl_handle;
@@ -51,6 +56,66 @@ namespace implementation {
 
 PAL* PAL::sInstance;
 
+ScratchPool::~ScratchPool()
+{
+    for (auto &blk : mFree)
+        delete[] blk.data;
+    mFree.clear();
+}
+
+ScratchPool::block ScratchPool::acquire(size_t size)
+{
+    block blk = {nullptr, 0};
+
+    size = std::max(size, (size_t)1);
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        for (auto it = mFree.begin(); it != mFree.end(); it++) {
+            if (it->size >= size) {
+                blk = *it;
+                mFree.erase(it);
+                return blk;
+            }
+        }
+        if (!mFree.empty()) {
+            /* too small for this period, regrow the oldest one */
+            delete[] mFree.front().data;
+            mFree.erase(mFree.begin());
+        }
+    }
+
+    blk.data = new (std::nothrow) uint8_t[size];
+    if (!blk.data) {
+        ALOGE("%s: failed to allocate %zu bytes", __func__, size);
+        return blk;
+    }
+    blk.size = size;
+    return blk;
+}
+
+void ScratchPool::release(block blk)
+{
+    if (!blk.data)
+        return;
+
+    std::lock_guard<std::mutex> lock(mLock);
+    if (mFree.size() < MAX_SCRATCH_BLOCKS) {
+        mFree.push_back(blk);
+        return;
+    }
+    delete[] blk.data;
+}
+
+void ScratchPool::reserve(size_t size, uint32_t count)
+{
+    std::vector<block> blocks;
+
+    for (uint32_t i = 0; i < count && i < MAX_SCRATCH_BLOCKS; i++)
+        blocks.push_back(acquire(size));
+    for (auto &blk : blocks)
+        release(blk);
+}
+
 void PalClientDeathRecipient::serviceDied(uint64_t cookie,
                    const android::wp<::android::hidl::base::V1_0::IBase>& who)
 {
@@ -145,6 +210,11 @@ static int32_t pal_callback(pal_stream_handle_t *stream_handle,
         return false;
     };
 
+    if (event_id == PAL_STREAM_CBK_EVENT_OPEN_DONE) {
+        /* wait for ipc_pal_stream_open_async to register this session */
+        ((SrvrClbk *)cookie)->waitRegistered();
+    }
+
     if (!isPalSessionActive((uint64_t)stream_handle)) {
         ALOGE("%s: PAL session %pK is no longer active", __func__, stream_handle);
         return -EINVAL;
@@ -157,7 +227,8 @@ static int32_t pal_callback(pal_stream_handle_t *stream_handle,
           ((event_id == PAL_STREAM_CBK_EVENT_READ_DONE) ||
            (event_id == PAL_STREAM_CBK_EVENT_WRITE_READY))) {
         hidl_vec<PalEventReadWriteDonePayload> rwDonePayloadHidl;
-        PalEventReadWriteDonePayload *rwDonePayload;
+        PalEventReadWriteDonePayload rwDonePayloadData;
+        PalEventReadWriteDonePayload *rwDonePayload = &rwDonePayloadData;
         struct pal_event_read_write_done_payload *rw_done_payload;
         int input_fd = -1;
         int fdToBeClosed = -1;
@@ -198,8 +269,8 @@ static int32_t pal_callback(pal_stream_handle_t *stream_handle,
         }
         PAL::getInstance()->mClientLock.unlock();
 
-        rwDonePayloadHidl.resize(sizeof(struct pal_event_read_write_done_payload));
-        rwDonePayload =(PalEventReadWriteDonePayload *)rwDonePayloadHidl.data();
+        /* payload and data stay valid until the synchronous callback returns */
+        rwDonePayloadHidl.setToExternal(rwDonePayload, 1);
         rwDonePayload->tag = rw_done_payload->tag;
         rwDonePayload->status = rw_done_payload->status;
         rwDonePayload->md_status = rw_done_payload->md_status;
@@ -213,16 +284,14 @@ static int32_t pal_callback(pal_stream_handle_t *stream_handle,
         }
         if ((rw_done_payload->buff.buffer != NULL) &&
              !(sr_clbk_dat->session_attr.flags & PAL_STREAM_FLAG_EXTERN_MEM)) {
-            rwDonePayload->buff.buffer.resize(rwDonePayload->buff.size);
-            memcpy(rwDonePayload->buff.buffer.data(), rw_done_payload->buff.buffer,
+            rwDonePayload->buff.buffer.setToExternal(rw_done_payload->buff.buffer,
                    rwDonePayload->buff.size);
         }
         if ((rw_done_payload->buff.metadata_size > 0) &&
              rw_done_payload->buff.metadata) {
             ALOGV("metadatasize %d ", rw_done_payload->buff.metadata_size);
             rwDonePayload->buff.metadataSz = rw_done_payload->buff.metadata_size;
-            rwDonePayload->buff.metadata.resize(rwDonePayload->buff.metadataSz);
-            memcpy(rwDonePayload->buff.metadata.data(), rw_done_payload->buff.metadata,
+            rwDonePayload->buff.metadata.setToExternal(rw_done_payload->buff.metadata,
                     rwDonePayload->buff.metadataSz);
         }
 
@@ -316,6 +385,40 @@ static void print_attr(struct pal_stream_attributes *attr)
    print_media_config(&attr->out_media_config);
 }
 
+std::shared_ptr<shared_data_buffer> PAL::getSharedDataBuffer(const uint64_t streamHandle) {
+    int pid = ::android::hardware::IPCThreadState::self()->getCallingPid();
+
+    std::lock_guard<std::mutex> guard(mClientLock);
+    for (auto& client: mPalClients) {
+        if (client->pid != pid)
+            continue;
+        std::lock_guard<std::mutex> lock(client->mActiveSessionsLock);
+        for (auto& session: client->mActiveSessions) {
+            if (session.session_handle == streamHandle)
+                return session.shared_data;
+        }
+        break;
+    }
+    return nullptr;
+}
+
+sp<SrvrClbk> PAL::getSessionCallback(const uint64_t streamHandle) {
+    int pid = ::android::hardware::IPCThreadState::self()->getCallingPid();
+
+    std::lock_guard<std::mutex> guard(mClientLock);
+    for (auto& client: mPalClients) {
+        if (client->pid != pid)
+            continue;
+        std::lock_guard<std::mutex> lock(client->mActiveSessionsLock);
+        for (auto& session: client->mActiveSessions) {
+            if (session.session_handle == streamHandle)
+                return session.callback_binder;
+        }
+        break;
+    }
+    return nullptr;
+}
+
 bool PAL::isValidstreamHandle(const uint64_t streamHandle) {
     int pid = ::android::hardware::IPCThreadState::self()->getCallingPid();
 
@@ -349,6 +452,32 @@ Return<void> PAL::ipc_pal_stream_open(const hidl_vec<PalStreamAttributes>& attr_
                             const hidl_vec<ModifierKV>& modskv_hidl,
                             const sp<IPALCallback>& cb, uint64_t ipc_clt_data,
                             ipc_pal_stream_open_cb _hidl_cb)
+{
+    openStream(attr_hidl, noOfDevices, devs_hidl, noOfModifiers, modskv_hidl,
+               cb, ipc_clt_data, false, _hidl_cb);
+    return Void();
+}
+
+Return<void> PAL::ipc_pal_stream_open_async(const hidl_vec<PalStreamAttributes>& attr_hidl,
+                            uint32_t noOfDevices,
+                            const hidl_vec<PalDevice>& devs_hidl,
+                            uint32_t noOfModifiers,
+                            const hidl_vec<ModifierKV>& modskv_hidl,
+                            const sp<IPALCallback>& cb, uint64_t ipc_clt_data,
+                            ipc_pal_stream_open_async_cb _hidl_cb)
+{
+    openStream(attr_hidl, noOfDevices, devs_hidl, noOfModifiers, modskv_hidl,
+               cb, ipc_clt_data, true, _hidl_cb);
+    return Void();
+}
+
+void PAL::openStream(const hidl_vec<PalStreamAttributes>& attr_hidl,
+                     uint32_t noOfDevices,
+                     const hidl_vec<PalDevice>& devs_hidl,
+                     uint32_t noOfModifiers,
+                     const hidl_vec<ModifierKV>& modskv_hidl,
+                     const sp<IPALCallback>& cb, uint64_t ipc_clt_data, bool async,
+                     ipc_pal_stream_open_cb _hidl_cb)
 {
     struct pal_stream_attributes *attr = NULL;
     struct pal_device *devices = NULL;
@@ -366,7 +495,7 @@ Return<void> PAL::ipc_pal_stream_open(const hidl_vec<PalStreamAttributes>& attr_
 
     if (attr_hidl == NULL) {
         ALOGE("Invalid hidl attributes ");
-        return Void();
+        return;
     }
     in_ch = attr_hidl.data()->in_media_config.ch_info.channels;
     out_ch = attr_hidl.data()->out_media_config.ch_info.channels;
@@ -441,8 +570,16 @@ Return<void> PAL::ipc_pal_stream_open(const hidl_vec<PalStreamAttributes>& attr_
 
     sr_clbk_data->setSessionAttr(attr);
 
-    ret = pal_stream_open(attr, noOfDevices, devices, noOfModifiers, modifiers,
-                          callback, (uint64_t)sr_clbk_data.get(), &stream_handle);
+    if (async) {
+        /* OPEN_DONE may fire before the session below is registered,
+         * pal_callback holds it back until setRegistered()
+         */
+        ret = pal_stream_open_async(attr, noOfDevices, devices, noOfModifiers, modifiers,
+                                    callback, (uint64_t)sr_clbk_data.get(), &stream_handle);
+    } else {
+        ret = pal_stream_open(attr, noOfDevices, devices, noOfModifiers, modifiers,
+                              callback, (uint64_t)sr_clbk_data.get(), &stream_handle);
+    }
 
     if (!ret) {
         std::lock_guard<std::mutex> guard(mClientLock);
@@ -483,6 +620,8 @@ Return<void> PAL::ipc_pal_stream_open(const hidl_vec<PalStreamAttributes>& attr_
                 cb->linkToDeath(this->mDeathRecipient, pid);
             }
         }
+        if (sr_clbk_data)
+            sr_clbk_data->setRegistered();
     } else {
         /*stream_open failed, free the callback binder object*/
         sr_clbk_data.clear();
@@ -495,7 +634,6 @@ exit:
         free(devices);
     if (attr)
         free(attr);
-    return Void();
 }
 
 Return<int32_t> PAL::ipc_pal_stream_close(const uint64_t streamHandle)
@@ -556,6 +694,15 @@ Return<int32_t> PAL::ipc_pal_stream_start(const uint64_t streamHandle) {
     return pal_stream_start((pal_stream_handle_t *)streamHandle);
 }
 
+Return<int32_t> PAL::ipc_pal_stream_start_async(const uint64_t streamHandle) {
+    if (!isValidstreamHandle(streamHandle)) {
+        ALOGE("%s: Invalid streamHandle: %pK", __func__, streamHandle);
+        return -EINVAL;
+    }
+
+    return pal_stream_start_async((pal_stream_handle_t *)streamHandle);
+}
+
 Return<int32_t> PAL::ipc_pal_stream_stop(const uint64_t streamHandle) {
     if (!isValidstreamHandle(streamHandle)) {
         ALOGE("%s: Invalid streamHandle: %pK", __func__, streamHandle);
@@ -638,6 +785,13 @@ Return<void> PAL::ipc_pal_stream_set_buffer_size(const uint64_t streamHandle,
 
     ret = pal_stream_set_buffer_size((pal_stream_handle_t *)streamHandle,
                                     &in_buf_cfg, &out_buf_cfg);
+    if (!ret) {
+        /* pal_stream_get_buffer_size is not implemented, size from the config */
+        sp<SrvrClbk> sr_clbk_dat = getSessionCallback(streamHandle);
+        if (sr_clbk_dat != nullptr)
+            sr_clbk_dat->scratch.reserve(std::max(in_buf_cfg.buf_size,
+                                                  out_buf_cfg.buf_size), 2);
+    }
 
     in_buff_config_ret.buf_count = in_buf_cfg.buf_count;
     in_buff_config_ret.buf_size = in_buf_cfg.buf_size;
@@ -672,30 +826,33 @@ Return<int32_t> PAL::ipc_pal_stream_write(const uint64_t streamHandle,
                                           const hidl_vec<PalBuffer>& buff_hidl) {
     int32_t ret = -ENOMEM;
     struct pal_buffer buf = {0};
+    struct timespec ts;
     uint32_t bufSize;
     const native_handle *allochandle = nullptr;
+    sp<SrvrClbk> sr_clbk_dat = getSessionCallback(streamHandle);
+    ScratchPool::block dataBlk = {nullptr, 0};
+    ScratchPool::block mdBlk = {nullptr, 0};
 
-    if (!isValidstreamHandle(streamHandle)) {
+    if (sr_clbk_dat == nullptr) {
         ALOGE("%s: Invalid streamHandle: %pK", __func__, streamHandle);
         return -EINVAL;
     }
 
     bufSize = buff_hidl.data()->size;
-    if (buff_hidl.data()->buffer.size() == bufSize)
-        buf.buffer = (uint8_t *)calloc(1, bufSize);
+    if (buff_hidl.data()->buffer.size() == bufSize) {
+        dataBlk = sr_clbk_dat->scratch.acquire(bufSize);
+        buf.buffer = dataBlk.data;
+    }
     buf.size = (size_t)bufSize;
     buf.offset = (size_t)buff_hidl.data()->offset;
-    buf.ts = (struct timespec *) calloc(1, sizeof(struct timespec));
-    if (!buf.ts) {
-        ALOGE("Not enough memory for buf.ts ");
-        goto exit;
-    }
+    buf.ts = &ts;
     buf.ts->tv_sec =  buff_hidl.data()->timeStamp.tvSec;
     buf.ts->tv_nsec = buff_hidl.data()->timeStamp.tvNSec;
     buf.flags = buff_hidl.data()->flags;
     if (buff_hidl.data()->metadataSz) {
         buf.metadata_size = buff_hidl.data()->metadataSz;
-        buf.metadata = (uint8_t *)calloc(1, buf.metadata_size);
+        mdBlk = sr_clbk_dat->scratch.acquire(buf.metadata_size);
+        buf.metadata = mdBlk.data;
         if (!buf.metadata) {
             ALOGE("Not enough memory for buf.metadata");
             goto exit;
@@ -718,39 +875,43 @@ Return<int32_t> PAL::ipc_pal_stream_write(const uint64_t streamHandle,
     ALOGV("%s:%d sz %d", __func__,__LINE__,bufSize);
     ret = pal_stream_write((pal_stream_handle_t *)streamHandle, &buf);
 exit:
-    if (buf.buffer)
-        free(buf.buffer);
-    if (buf.ts)
-        free(buf.ts);
-    if (buf.metadata)
-        free(buf.metadata);
+    sr_clbk_dat->scratch.release(dataBlk);
+    sr_clbk_dat->scratch.release(mdBlk);
     return ret;
 }
 
 Return<void> PAL::ipc_pal_stream_read(const uint64_t streamHandle,
                                       const hidl_vec<PalBuffer>& inBuff_hidl,
                                       ipc_pal_stream_read_cb _hidl_cb) {
-    struct pal_buffer buf;
+    struct pal_buffer buf = {0};
+    struct timespec ts = {0, 0};
     int32_t ret = 0;
+    PalBuffer outBuff;
     hidl_vec<PalBuffer> outBuff_hidl;
     uint32_t bufSize;
     const native_handle *allochandle = nullptr;
+    sp<SrvrClbk> sr_clbk_dat = getSessionCallback(streamHandle);
+    ScratchPool::block dataBlk = {nullptr, 0};
+    ScratchPool::block mdBlk = {nullptr, 0};
+
+    if (sr_clbk_dat == nullptr) {
+        ALOGE("%s: Invalid streamHandle: %pK", __func__, streamHandle);
+        return Void();
+    }
 
     bufSize = inBuff_hidl.data()->size;
-    buf.buffer = (uint8_t *)calloc(1, bufSize);
+    dataBlk = sr_clbk_dat->scratch.acquire(bufSize);
+    buf.buffer = dataBlk.data;
     buf.size = (size_t)bufSize;
+    buf.ts = &ts;
     buf.metadata_size = inBuff_hidl.data()->metadataSz;
-    buf.metadata = (uint8_t *)calloc(1, buf.metadata_size);
-    if (!buf.metadata) {
+    mdBlk = sr_clbk_dat->scratch.acquire(buf.metadata_size);
+    buf.metadata = mdBlk.data;
+    if (!buf.buffer || !buf.metadata) {
         ALOGE("Not enough memory for buf.metadata");
         goto exit;
     }
 
-    if (!isValidstreamHandle(streamHandle)) {
-        ALOGE("%s: Invalid streamHandle: %pK", __func__, streamHandle);
-        return Void();
-    }
-
     allochandle = inBuff_hidl.data()->alloc_info.alloc_handle.handle();
 
     buf.alloc_info.alloc_handle = dup(allochandle->data[0]);
@@ -762,28 +923,23 @@ Return<void> PAL::ipc_pal_stream_read(const uint64_t streamHandle,
 
     ret = pal_stream_read((pal_stream_handle_t *)streamHandle, &buf);
     if (ret > 0) {
-        outBuff_hidl.resize(sizeof(struct pal_buffer));
-        outBuff_hidl.data()->size = (uint32_t)buf.size;
-        outBuff_hidl.data()->offset = (uint32_t)buf.offset;
-        outBuff_hidl.data()->buffer.resize(buf.size);
-        memcpy(outBuff_hidl.data()->buffer.data(), buf.buffer,
-               buf.size);
-        if (buf.ts) {
-          outBuff_hidl.data()->timeStamp.tvSec = buf.ts->tv_sec;
-          outBuff_hidl.data()->timeStamp.tvNSec = buf.ts->tv_nsec;
-        }
+        /* scratch blocks outlive the synchronous _hidl_cb, no copy needed */
+        outBuff.size = (uint32_t)buf.size;
+        outBuff.offset = (uint32_t)buf.offset;
+        outBuff.buffer.setToExternal(buf.buffer, buf.size);
+        outBuff.timeStamp.tvSec = ts.tv_sec;
+        outBuff.timeStamp.tvNSec = ts.tv_nsec;
+        outBuff.flags = buf.flags;
         if (buf.metadata_size) {
-           outBuff_hidl.data()->metadata.resize(buf.metadata_size);
-           memcpy(outBuff_hidl.data()->metadata.data(),
-                  buf.metadata, buf.metadata_size);
+           outBuff.metadataSz = buf.metadata_size;
+           outBuff.metadata.setToExternal(buf.metadata, buf.metadata_size);
         }
+        outBuff_hidl.setToExternal(&outBuff, 1);
     }
     _hidl_cb(ret, outBuff_hidl);
 exit:
-    if (buf.buffer)
-        free(buf.buffer);
-    if (buf.metadata)
-        free(buf.metadata);
+    sr_clbk_dat->scratch.release(dataBlk);
+    sr_clbk_dat->scratch.release(mdBlk);
     return Void();
 }
 
@@ -1041,9 +1197,9 @@ Return<void> PAL::ipc_pal_get_param(uint32_t paramId,
                                     ipc_pal_get_param_cb _hidl_cb)
 {
     int32_t ret = 0;
-    void *payLoad;
+    void *payLoad = NULL;
     hidl_vec<uint8_t> payload_hidl;
-    size_t sz;
+    size_t sz = 0;
     ret = pal_get_param(paramId, &payLoad, &sz, NULL);
     if (!payLoad) {
         ALOGE("Not enough memory for payLoad");
@@ -1053,6 +1209,14 @@ Return<void> PAL::ipc_pal_get_param(uint32_t paramId,
     payload_hidl.resize(sz);
     memcpy(payload_hidl.data(), payLoad, sz);
     _hidl_cb(ret, payload_hidl, sz);
+    /*
+     * These payloads are allocated per call and owned by the caller, the
+     * others point at memory PAL keeps.
+     */
+    if (paramId == PAL_PARAM_ID_LATENCY_TRACE ||
+        paramId == PAL_PARAM_ID_FE_POOL_STATS ||
+        paramId == PAL_PARAM_ID_DEBUG_DUMP)
+        free(payLoad);
     return Void();
 }
 
@@ -1145,6 +1309,145 @@ Return<void>PAL::ipc_pal_stream_get_tags_with_module_info(PalStreamHandle stream
 }
 
 
+Return<void>PAL::ipc_pal_stream_map_shared_buffers(const uint64_t streamHandle,
+                               uint32_t bufSize, uint32_t bufCount,
+                               ipc_pal_stream_map_shared_buffers_cb _hidl_cb)
+{
+    int32_t ret = -EINVAL;
+    int pid = ::android::hardware::IPCThreadState::self()->getCallingPid();
+    std::shared_ptr<shared_data_buffer> shBuf = nullptr;
+    native_handle_t *memHandle = nullptr;
+    size_t memSize = (size_t)bufSize * bufCount;
+    bool found = false;
+
+    if (!isValidstreamHandle(streamHandle)) {
+        ALOGE("%s: Invalid streamHandle: %pK", __func__, streamHandle);
+        _hidl_cb(ret, hidl_handle(), 0);
+        return Void();
+    }
+
+    if (!bufSize || !bufCount || memSize > MAX_SHARED_DATA_SIZE) {
+        ALOGE("%s: Invalid shared buffer config size %u count %u", __func__,
+              bufSize, bufCount);
+        _hidl_cb(ret, hidl_handle(), 0);
+        return Void();
+    }
+
+    shBuf = std::make_shared<shared_data_buffer>();
+    shBuf->fd = ashmem_create_region("pal_shared_data", memSize);
+    if (shBuf->fd < 0) {
+        ALOGE("%s: ashmem_create_region failed %d", __func__, errno);
+        ret = -ENOMEM;
+        _hidl_cb(ret, hidl_handle(), 0);
+        return Void();
+    }
+    shBuf->base = (uint8_t *)mmap(NULL, memSize, PROT_READ | PROT_WRITE,
+                                  MAP_SHARED, shBuf->fd, 0);
+    if (shBuf->base == MAP_FAILED) {
+        ALOGE("%s: mmap failed %d", __func__, errno);
+        shBuf->base = nullptr;
+        ret = -ENOMEM;
+        _hidl_cb(ret, hidl_handle(), 0);
+        return Void();
+    }
+    shBuf->bufSize = bufSize;
+    shBuf->bufCount = bufCount;
+
+    {
+        std::lock_guard<std::mutex> guard(mClientLock);
+        for (auto& client: mPalClients) {
+            if (client->pid != pid)
+                continue;
+            std::lock_guard<std::mutex> lock(client->mActiveSessionsLock);
+            for (auto& session: client->mActiveSessions) {
+                if (session.session_handle == streamHandle) {
+                    /* a remap drops the old buffers once in-flight calls finish */
+                    session.shared_data = shBuf;
+                    found = true;
+                    break;
+                }
+            }
+            break;
+        }
+    }
+    if (!found) {
+        _hidl_cb(ret, hidl_handle(), 0);
+        return Void();
+    }
+
+    memHandle = native_handle_create(1, 0);
+    if (!memHandle) {
+        ALOGE("%s: Failed to create memHandle", __func__);
+        ret = -ENOMEM;
+        _hidl_cb(ret, hidl_handle(), 0);
+        return Void();
+    }
+    memHandle->data[0] = shBuf->fd;
+    ret = 0;
+    ALOGD("%s: handle %pK mapped %u x %u bytes", __func__, streamHandle,
+          bufCount, bufSize);
+    _hidl_cb(ret, hidl_handle(memHandle), (uint32_t)memSize);
+    native_handle_delete(memHandle);
+    return Void();
+}
+
+Return<int32_t>PAL::ipc_pal_stream_write_shared(const uint64_t streamHandle,
+                               uint32_t bufIdx, uint32_t size,
+                               const TimeSpec& timeStamp, uint32_t flags)
+{
+    struct pal_buffer buf = {0};
+    struct timespec ts;
+    std::shared_ptr<shared_data_buffer> shBuf = getSharedDataBuffer(streamHandle);
+
+    if (!shBuf) {
+        ALOGE("%s: no shared buffers for streamHandle: %pK", __func__, streamHandle);
+        return -EINVAL;
+    }
+    if (bufIdx >= shBuf->bufCount || size > shBuf->bufSize) {
+        ALOGE("%s: Invalid buffer index %u size %u", __func__, bufIdx, size);
+        return -EINVAL;
+    }
+
+    ts.tv_sec = timeStamp.tvSec;
+    ts.tv_nsec = timeStamp.tvNSec;
+    buf.buffer = shBuf->base + (size_t)bufIdx * shBuf->bufSize;
+    buf.size = (size_t)size;
+    buf.ts = &ts;
+    buf.flags = flags;
+    ALOGV("%s:%d idx %u sz %u", __func__, __LINE__, bufIdx, size);
+    return pal_stream_write((pal_stream_handle_t *)streamHandle, &buf);
+}
+
+Return<void>PAL::ipc_pal_stream_read_shared(const uint64_t streamHandle,
+                               uint32_t bufIdx, uint32_t size,
+                               ipc_pal_stream_read_shared_cb _hidl_cb)
+{
+    int32_t ret = -EINVAL;
+    struct pal_buffer buf = {0};
+    struct timespec ts = {0, 0};
+    TimeSpec timeStamp = {};
+    std::shared_ptr<shared_data_buffer> shBuf = getSharedDataBuffer(streamHandle);
+
+    if (!shBuf) {
+        ALOGE("%s: no shared buffers for streamHandle: %pK", __func__, streamHandle);
+        _hidl_cb(ret, timeStamp, 0);
+        return Void();
+    }
+    if (bufIdx >= shBuf->bufCount || size > shBuf->bufSize) {
+        ALOGE("%s: Invalid buffer index %u size %u", __func__, bufIdx, size);
+        _hidl_cb(ret, timeStamp, 0);
+        return Void();
+    }
+
+    buf.buffer = shBuf->base + (size_t)bufIdx * shBuf->bufSize;
+    buf.size = (size_t)size;
+    buf.ts = &ts;
+    ret = pal_stream_read((pal_stream_handle_t *)streamHandle, &buf);
+    timeStamp.tvSec = ts.tv_sec;
+    timeStamp.tvNSec = ts.tv_nsec;
+    _hidl_cb(ret, timeStamp, buf.flags);
+    return Void();
+}
 
 IPAL* HIDL_FETCH_IPAL(const char* /* name */) {
     ALOGV("%s");
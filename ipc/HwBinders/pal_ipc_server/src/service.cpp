@@ -28,11 +28,11 @@
  */
 
 #define LOG_TAG "vendor.qti.hardware.pal@1.0-service"
-#include <vendor/qti/hardware/pal/1.0/IPAL.h>
+#include <vendor/qti/hardware/pal/1.1/IPAL.h>
 #include <hidl/LegacySupport.h>
 #include "inc/pal_server_wrapper.h"
 
-using vendor::qti::hardware::pal::V1_0::IPAL;
+using vendor::qti::hardware::pal::V1_1::IPAL;
 using vendor::qti::hardware::pal::V1_0::implementation::PAL;
 using android::hardware::defaultPassthroughServiceImplementation;
 using android::hardware::configureRpcThreadpool;
@@ -87,6 +87,9 @@
 #include "ACDPlatformInfo.h"
 #include "ContextManager.h"
 #include "SignalHandler.h"
+#include "StreamHandleTable.h"
+#include "PalIdPool.h"
+#include "PalGraphLock.h"
 #include <fstream>
 
 typedef enum {
@@ -435,8 +438,9 @@ private:
     void getHigherPriorityActiveStreams(const int inComingStreamPriority,
                                         std::vector<Stream*> &activestreams,
                                         std::vector<T> sourcestreams);
-    const std::vector<int> allocateVoiceFrontEndIds(std::vector<int> listAllPcmVoiceFrontEnds,
-                                  const int howMany);
+    static PalIdPool *getFrontEndPool(const struct pal_stream_attributes &sAttr,
+                                      int lDirection);
+    static std::string dumpFrontEndPools();
     int getDeviceDefaultCapability(pal_param_device_capability_t capability);
 
     int handleScreenStatusChange(pal_param_screen_state_t screen_state);
@@ -458,8 +462,19 @@ private:
     void onChargingStateChange();
     void onVUIStreamRegistered();
     void onVUIStreamDeregistered();
+    void addToStreamIndex(Stream *s, pal_stream_type_t type);
+    void removeFromStreamIndex(Stream *s);
 protected:
     std::list <Stream*> mActiveStreams;
+    /*
+     * Flat views of the registered streams, maintained by register/deregister
+     * stream so the active/orphan and EC reference queries do not have to
+     * merge the typed lists below. mStreamIndex is ordered by the query rank
+     * of the stream type, the direction lists follow registration order.
+     */
+    std::vector <std::pair<int, Stream*>> mStreamIndex;
+    std::vector <Stream*> mRxStreamIndex;
+    std::vector <Stream*> mTxStreamIndex;
     std::list <StreamPCM*> active_streams_ll;
     std::list <StreamPCM*> active_streams_ulla;
     std::list <StreamPCM*> active_streams_ull;
@@ -481,7 +496,7 @@ protected:
     std::vector <std::pair<std::shared_ptr<Device>, Stream*>> active_devices;
     std::vector <std::shared_ptr<Device>> plugin_devices_;
     std::vector <pal_device_id_t> avail_devices_;
-    std::map<Stream*, std::pair<uint32_t, bool>> mActiveStreamUserCounter;
+    StreamHandleTable mActiveStreamUserCounter;
     bool bOverwriteFlag;
     bool screen_state_ = true;
     bool charging_state_;
@@ -490,14 +505,23 @@ protected:
     bool use_lpi_;
     pal_speaker_rotation_type rotation_type_;
     bool isDeviceSwitch = false;
+    /* Lock hierarchy, outermost first. Never acquire an outer lock while
+     * holding an inner one:
+     *   mResourceManagerMutex
+     *   mActiveStreamMutex
+     *   Stream::mStreamMutex
+     *   mGraphLock (exclusive via lockGraph(), per backend via lockGraph(devices))
+     *   Device::mDeviceMutex
+     *   the SessionAlsaUtils backend mixer write lock
+     */
     static std::mutex mResourceManagerMutex;
-    static std::mutex mGraphMutex;
+    static PalGraphLock mGraphLock;
     static std::mutex mActiveStreamMutex;
     static std::mutex mValidStreamMutex;
     static std::mutex mSleepMonitorMutex;
-    static std::mutex mListFrontEndsMutex;
     static int snd_virt_card;
     static int snd_hw_card;
+    static std::string snd_card_name_;
 
     static std::shared_ptr<ResourceManager> rm;
     static struct audio_route* audio_route;
@@ -511,22 +535,23 @@ protected:
     static std::vector<std::pair<int32_t, int32_t>> devicePcmId;
     static std::vector<std::pair<int32_t, std::string>> deviceLinkName;
     static std::vector<int> listAllFrontEndIds;
-    static std::vector<int> listAllPcmPlaybackFrontEnds;
-    static std::vector<int> listAllPcmRecordFrontEnds;
-    static std::vector<int> listAllPcmHostlessRxFrontEnds;
-    static std::vector<int> listAllNonTunnelSessionIds;
-    static std::vector<int> listAllPcmHostlessTxFrontEnds;
-    static std::vector<int> listAllCompressPlaybackFrontEnds;
-    static std::vector<int> listAllCompressRecordFrontEnds;
     static std::vector<int> listFreeFrontEndIds;
-    static std::vector<int> listAllPcmVoice1RxFrontEnds;
-    static std::vector<int> listAllPcmVoice1TxFrontEnds;
-    static std::vector<int> listAllPcmVoice2RxFrontEnds;
-    static std::vector<int> listAllPcmVoice2TxFrontEnds;
-    static std::vector<int> listAllPcmExtEcTxFrontEnds;
-    static std::vector<int> listAllPcmInCallRecordFrontEnds;
-    static std::vector<int> listAllPcmInCallMusicFrontEnds;
-    static std::vector<int> listAllPcmContextProxyFrontEnds;
+    static PalIdPool pcmPlaybackFrontEnds;
+    static PalIdPool pcmRecordFrontEnds;
+    static PalIdPool pcmHostlessRxFrontEnds;
+    static PalIdPool nonTunnelSessionIds;
+    static PalIdPool pcmHostlessTxFrontEnds;
+    static PalIdPool compressPlaybackFrontEnds;
+    static PalIdPool compressRecordFrontEnds;
+    static PalIdPool pcmVoice1RxFrontEnds;
+    static PalIdPool pcmVoice1TxFrontEnds;
+    static PalIdPool pcmVoice2RxFrontEnds;
+    static PalIdPool pcmVoice2TxFrontEnds;
+    static PalIdPool pcmExtEcTxFrontEnds;
+    static PalIdPool pcmInCallRecordFrontEnds;
+    static PalIdPool pcmInCallMusicFrontEnds;
+    static PalIdPool pcmContextProxyFrontEnds;
+    static PalIdPool *frontEndPools[];
     static std::vector<std::pair<int32_t, std::string>> listAllBackEndIds;
     static std::vector<std::pair<int32_t, std::string>> sndDeviceNameLUT;
     static std::vector<deviceCap> devInfo;
@@ -859,6 +884,7 @@ public:
     static int convertCharToHex(std::string num);
     static pal_stream_type_t getStreamType(std::string stream_name);
     static pal_device_id_t getDeviceId(std::string device_name);
+    static const std::string& getSndCardName();
     bool getScreenState();
     bool isDeviceAvailable(pal_device_id_t id);
     bool isDeviceAvailable(std::vector<std::shared_ptr<Device>> devices, pal_device_id_t id);
@@ -877,8 +903,16 @@ public:
     /* Separate device reference counts are maintained in PAL device and GSL device SGs.
      * lock graph is to sychronize these reference counts during device and session operations
      */
-    void lockGraph() { mGraphMutex.lock(); };
-    void unlockGraph() { mGraphMutex.unlock(); };
+    void lockGraph() { mGraphLock.lock(); };
+    void unlockGraph() { mGraphLock.unlock(); };
+    /* Backend scoped lockGraph for starting/stopping a single stream: streams
+     * whose devices sit on disjoint backends proceed in parallel, while
+     * lockGraph() callers still exclude all of them. heldBackEnds returns the
+     * locks taken and must be passed back unchanged to unlockGraph.
+     */
+    void lockGraph(const std::vector<std::shared_ptr<Device>> &devices,
+                   std::vector<std::mutex *> &heldBackEnds);
+    void unlockGraph(std::vector<std::mutex *> &heldBackEnds);
     void lockActiveStream() { mActiveStreamMutex.lock(); };
     void unlockActiveStream() { mActiveStreamMutex.unlock(); };
     void lockValidStreamMutex() { mValidStreamMutex.lock(); };
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef STREAM_HANDLE_TABLE_H
+#define STREAM_HANDLE_TABLE_H
+
+#include <atomic>
+#include <stdint.h>
+
+class Stream;
+
+#define STREAM_HANDLE_TABLE_SIZE 256
+/* erase() compacts the table once this many tombstones are left in chains */
+#define STREAM_HANDLE_TABLE_MAX_TOMBSTONES (STREAM_HANDLE_TABLE_SIZE / 8)
+
+/*
+ * StreamHandleTable - validates and pins stream handles on the data path
+ *
+ * Each live stream owns one open-addressed slot keyed by its Stream pointer.
+ * The slot state word packs a generation (bits 63..32), an active flag
+ * (bit 31) and the user count (bits 30..0), so a pin is a single CAS that
+ * fails if the slot was deactivated or recycled after it was looked up.
+ *
+ * Erased slots become tombstones. insert() reuses the first tombstone on
+ * the probe path, erase() turns tombstones that end a chain back into empty
+ * slots and compacts the table once too many are left inside chains, so a
+ * miss never degrades into a scan of the whole table under churn.
+ *
+ * acquire()/release() are lock free. insert()/erase() must be serialized
+ * by the caller (ResourceManager holds mValidStreamMutex). Compaction only
+ * moves unpinned streams and bumps epoch_ around the move, lookups that
+ * miss while it runs retry.
+ */
+class StreamHandleTable {
+public:
+    StreamHandleTable();
+    ~StreamHandleTable() {};
+
+    int insert(Stream *s);
+    int erase(Stream *s);
+    /* clears the active flag, returns users still holding the stream */
+    int deactivate(Stream *s, uint32_t *users);
+    int acquire(Stream *s);
+    /* returns 1 if the last user of a deactivated stream left */
+    int release(Stream *s);
+    int getUsers(Stream *s);
+
+private:
+    struct HandleSlot {
+        std::atomic<Stream *> stream;
+        std::atomic<uint64_t> state;
+        /* keep neighbouring slots off the same cache line */
+        char pad[64 - sizeof(std::atomic<Stream *>) - sizeof(std::atomic<uint64_t>)];
+    };
+
+    static const uint64_t kActive = 1ULL << 31;
+    /* set while compaction relocates an unpinned stream */
+    static const uint64_t kMoving = 1ULL << 30;
+    static const uint64_t kUserMask = kMoving - 1;
+    static const uint64_t kGenShift = 32;
+
+    HandleSlot *find(Stream *s);
+    HandleSlot *lookup(Stream *s);
+    bool retryLookup(uint32_t epoch);
+    void reclaim(uint32_t idx);
+    void compact();
+    static uint32_t hash(Stream *s);
+
+    HandleSlot slots_[STREAM_HANDLE_TABLE_SIZE];
+    /* odd while compact() is moving slots */
+    std::atomic<uint32_t> epoch_;
+    /* only touched under the caller's insert/erase serialization */
+    uint32_t tombstones_;
+    uint32_t compactAt_;
+};
+
+#endif
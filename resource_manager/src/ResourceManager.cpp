@@ -77,6 +77,7 @@
 #include "gsl_intf.h"
 #include "Headphone.h"
 #include "PayloadBuilder.h"
+#include "SessionAlsaUtils.h"
 #include "Bluetooth.h"
 #include "SpeakerMic.h"
 #include "Speaker.h"
@@ -88,6 +89,8 @@
 #include "Handset.h"
 #include "SndCardMonitor.h"
 #include "UltrasoundDevice.h"
+#include "PalLatencyTrace.h"
+#include "PalDebugDump.h"
 #include <agm/agm_api.h>
 #include <cutils/properties.h>
 #include <unistd.h>
@@ -410,33 +413,41 @@ std::vector <int> ResourceManager::mixerTag = {0};
 std::vector <int> ResourceManager::devicePpTag = {0};
 std::vector <int> ResourceManager::deviceTag = {0};
 std::mutex ResourceManager::mResourceManagerMutex;
-std::mutex ResourceManager::mGraphMutex;
+PalGraphLock ResourceManager::mGraphLock;
 std::mutex ResourceManager::mActiveStreamMutex;
 std::mutex ResourceManager::mValidStreamMutex;
 std::mutex ResourceManager::mSleepMonitorMutex;
-std::mutex ResourceManager::mListFrontEndsMutex;
 std::vector <int> ResourceManager::listAllFrontEndIds = {0};
 std::vector <int> ResourceManager::listFreeFrontEndIds = {0};
-std::vector <int> ResourceManager::listAllPcmPlaybackFrontEnds = {0};
-std::vector <int> ResourceManager::listAllPcmRecordFrontEnds = {0};
-std::vector <int> ResourceManager::listAllPcmHostlessRxFrontEnds = {0};
-std::vector <int> ResourceManager::listAllPcmHostlessTxFrontEnds = {0};
-std::vector <int> ResourceManager::listAllPcmExtEcTxFrontEnds = {0};
-std::vector <int> ResourceManager::listAllCompressPlaybackFrontEnds = {0};
-std::vector <int> ResourceManager::listAllCompressRecordFrontEnds = {0};
-std::vector <int> ResourceManager::listAllPcmVoice1RxFrontEnds = {0};
-std::vector <int> ResourceManager::listAllPcmVoice1TxFrontEnds = {0};
-std::vector <int> ResourceManager::listAllPcmVoice2RxFrontEnds = {0};
-std::vector <int> ResourceManager::listAllPcmVoice2TxFrontEnds = {0};
-std::vector <int> ResourceManager::listAllPcmInCallRecordFrontEnds = {0};
-std::vector <int> ResourceManager::listAllPcmInCallMusicFrontEnds = {0};
-std::vector <int> ResourceManager::listAllNonTunnelSessionIds = {0};
-std::vector <int> ResourceManager::listAllPcmContextProxyFrontEnds = {0};
+PalIdPool ResourceManager::pcmPlaybackFrontEnds("pcm_playback");
+PalIdPool ResourceManager::pcmRecordFrontEnds("pcm_record");
+PalIdPool ResourceManager::pcmHostlessRxFrontEnds("pcm_hostless_rx");
+PalIdPool ResourceManager::pcmHostlessTxFrontEnds("pcm_hostless_tx");
+PalIdPool ResourceManager::pcmExtEcTxFrontEnds("pcm_ext_ec_tx");
+PalIdPool ResourceManager::compressPlaybackFrontEnds("compress_playback");
+PalIdPool ResourceManager::compressRecordFrontEnds("compress_record");
+PalIdPool ResourceManager::pcmVoice1RxFrontEnds("pcm_voice1_rx", true);
+PalIdPool ResourceManager::pcmVoice1TxFrontEnds("pcm_voice1_tx", true);
+PalIdPool ResourceManager::pcmVoice2RxFrontEnds("pcm_voice2_rx", true);
+PalIdPool ResourceManager::pcmVoice2TxFrontEnds("pcm_voice2_tx", true);
+PalIdPool ResourceManager::pcmInCallRecordFrontEnds("pcm_incall_record");
+PalIdPool ResourceManager::pcmInCallMusicFrontEnds("pcm_incall_music");
+PalIdPool ResourceManager::nonTunnelSessionIds("non_tunnel");
+PalIdPool ResourceManager::pcmContextProxyFrontEnds("pcm_context_proxy");
+PalIdPool *ResourceManager::frontEndPools[] = {
+    &pcmPlaybackFrontEnds, &pcmRecordFrontEnds, &pcmHostlessRxFrontEnds,
+    &pcmHostlessTxFrontEnds, &pcmExtEcTxFrontEnds, &compressPlaybackFrontEnds,
+    &compressRecordFrontEnds, &pcmVoice1RxFrontEnds, &pcmVoice1TxFrontEnds,
+    &pcmVoice2RxFrontEnds, &pcmVoice2TxFrontEnds, &pcmInCallRecordFrontEnds,
+    &pcmInCallMusicFrontEnds, &nonTunnelSessionIds, &pcmContextProxyFrontEnds,
+    nullptr,
+};
 struct audio_mixer* ResourceManager::audio_virt_mixer = NULL;
 struct audio_mixer* ResourceManager::audio_hw_mixer = NULL;
 struct audio_route* ResourceManager::audio_route = NULL;
 int ResourceManager::snd_virt_card = SND_CARD_VIRTUAL;
 int ResourceManager::snd_hw_card = SND_CARD_HW;
+std::string ResourceManager::snd_card_name_;
 std::vector<deviceCap> ResourceManager::devInfo;
 static struct nativeAudioProp na_props;
 static bool isHifiFilterEnabled = false;
@@ -604,6 +615,11 @@ pal_stream_type_t ResourceManager::getStreamType(std::string stream_name)
     return type;
 }
 
+const std::string& ResourceManager::getSndCardName()
+{
+    return snd_card_name_;
+}
+
 uint32_t ResourceManager::getNTPathForStreamAttr(
                               const pal_stream_attributes attr)
 {
@@ -739,21 +755,8 @@ ResourceManager::ResourceManager()
 #endif
     listAllFrontEndIds.clear();
     listFreeFrontEndIds.clear();
-    listAllPcmPlaybackFrontEnds.clear();
-    listAllPcmRecordFrontEnds.clear();
-    listAllPcmHostlessRxFrontEnds.clear();
-    listAllNonTunnelSessionIds.clear();
-    listAllPcmHostlessTxFrontEnds.clear();
-    listAllCompressPlaybackFrontEnds.clear();
-    listAllCompressRecordFrontEnds.clear();
-    listAllPcmVoice1RxFrontEnds.clear();
-    listAllPcmVoice1TxFrontEnds.clear();
-    listAllPcmVoice2RxFrontEnds.clear();
-    listAllPcmVoice2TxFrontEnds.clear();
-    listAllPcmInCallRecordFrontEnds.clear();
-    listAllPcmInCallMusicFrontEnds.clear();
-    listAllPcmContextProxyFrontEnds.clear();
-    listAllPcmExtEcTxFrontEnds.clear();
+    for (int i = 0; frontEndPools[i]; i++)
+        frontEndPools[i]->clear();
     memset(stream_instances, 0, PAL_STREAM_MAX * sizeof(uint64_t));
     memset(in_stream_instances, 0, PAL_STREAM_MAX * sizeof(uint64_t));
 
@@ -761,43 +764,43 @@ ResourceManager::ResourceManager()
 
         if (devInfo[i].type == PCM) {
             if (devInfo[i].sess_mode == HOSTLESS && devInfo[i].playback == 1) {
-                listAllPcmHostlessRxFrontEnds.push_back(devInfo[i].deviceId);
+                pcmHostlessRxFrontEnds.add(devInfo[i].deviceId);
             } else if (devInfo[i].sess_mode == HOSTLESS && devInfo[i].record == 1) {
-                listAllPcmHostlessTxFrontEnds.push_back(devInfo[i].deviceId);
+                pcmHostlessTxFrontEnds.add(devInfo[i].deviceId);
             } else if (devInfo[i].playback == 1 && devInfo[i].sess_mode == DEFAULT) {
-                listAllPcmPlaybackFrontEnds.push_back(devInfo[i].deviceId);
+                pcmPlaybackFrontEnds.add(devInfo[i].deviceId);
             } else if (devInfo[i].record == 1 && devInfo[i].sess_mode == DEFAULT) {
-                listAllPcmRecordFrontEnds.push_back(devInfo[i].deviceId);
+                pcmRecordFrontEnds.add(devInfo[i].deviceId);
             } else if (devInfo[i].sess_mode == NON_TUNNEL && devInfo[i].record == 1) {
-                listAllPcmInCallRecordFrontEnds.push_back(devInfo[i].deviceId);
+                pcmInCallRecordFrontEnds.add(devInfo[i].deviceId);
             } else if (devInfo[i].sess_mode == NON_TUNNEL && devInfo[i].playback == 1) {
-                listAllPcmInCallMusicFrontEnds.push_back(devInfo[i].deviceId);
+                pcmInCallMusicFrontEnds.add(devInfo[i].deviceId);
             } else if (devInfo[i].sess_mode == NO_CONFIG && devInfo[i].record == 1) {
-                listAllPcmContextProxyFrontEnds.push_back(devInfo[i].deviceId);
+                pcmContextProxyFrontEnds.add(devInfo[i].deviceId);
             }
         } else if (devInfo[i].type == COMPRESS) {
             if (devInfo[i].playback == 1) {
-                listAllCompressPlaybackFrontEnds.push_back(devInfo[i].deviceId);
+                compressPlaybackFrontEnds.add(devInfo[i].deviceId);
             } else if (devInfo[i].record == 1) {
-                listAllCompressRecordFrontEnds.push_back(devInfo[i].deviceId);
+                compressRecordFrontEnds.add(devInfo[i].deviceId);
             }
         } else if (devInfo[i].type == VOICE1) {
             if (devInfo[i].sess_mode == HOSTLESS && devInfo[i].playback == 1) {
-                listAllPcmVoice1RxFrontEnds.push_back(devInfo[i].deviceId);
+                pcmVoice1RxFrontEnds.add(devInfo[i].deviceId);
             }
             if (devInfo[i].sess_mode == HOSTLESS && devInfo[i].record == 1) {
-                listAllPcmVoice1TxFrontEnds.push_back(devInfo[i].deviceId);
+                pcmVoice1TxFrontEnds.add(devInfo[i].deviceId);
             }
         } else if (devInfo[i].type == VOICE2) {
             if (devInfo[i].sess_mode == HOSTLESS && devInfo[i].playback == 1) {
-                listAllPcmVoice2RxFrontEnds.push_back(devInfo[i].deviceId);
+                pcmVoice2RxFrontEnds.add(devInfo[i].deviceId);
             }
             if (devInfo[i].sess_mode == HOSTLESS && devInfo[i].record == 1) {
-                listAllPcmVoice2TxFrontEnds.push_back(devInfo[i].deviceId);
+                pcmVoice2TxFrontEnds.add(devInfo[i].deviceId);
             }
         } else if (devInfo[i].type == ExtEC) {
             if (devInfo[i].sess_mode == HOSTLESS && devInfo[i].record == 1) {
-                listAllPcmExtEcTxFrontEnds.push_back(devInfo[i].deviceId);
+                pcmExtEcTxFrontEnds.add(devInfo[i].deviceId);
             }
         }
         /*We create a master list of all the frontends*/
@@ -812,7 +815,7 @@ ResourceManager::ResourceManager()
      sort(listAllFrontEndIds.rbegin(), listAllFrontEndIds.rend());
      int maxDeviceIdInUse = listAllFrontEndIds.at(0);
      for (int i = 0; i < max_nt_sessions; i++)
-          listAllNonTunnelSessionIds.push_back(maxDeviceIdInUse + i);
+          nonTunnelSessionIds.add(maxDeviceIdInUse + i);
 
     // Get AGM service handle
     ret = agm_register_service_crash_callback(&agmServiceCrashHandler,
@@ -857,19 +860,11 @@ ResourceManager::~ResourceManager()
     deviceTag.clear();
 
     listAllFrontEndIds.clear();
-    listAllPcmPlaybackFrontEnds.clear();
-    listAllPcmRecordFrontEnds.clear();
-    listAllPcmHostlessRxFrontEnds.clear();
-    listAllPcmHostlessTxFrontEnds.clear();
-    listAllCompressPlaybackFrontEnds.clear();
-    listAllCompressRecordFrontEnds.clear();
     listFreeFrontEndIds.clear();
-    listAllPcmVoice1RxFrontEnds.clear();
-    listAllPcmVoice1TxFrontEnds.clear();
-    listAllPcmVoice2RxFrontEnds.clear();
-    listAllPcmVoice2TxFrontEnds.clear();
-    listAllNonTunnelSessionIds.clear();
-    listAllPcmExtEcTxFrontEnds.clear();
+    for (int i = 0; frontEndPools[i]; i++) {
+        frontEndPools[i]->reportLeaks();
+        frontEndPools[i]->clear();
+    }
     devInfo.clear();
     deviceInfo.clear();
     txEcInfo.clear();
@@ -1037,6 +1032,11 @@ void ResourceManager::ssrHandlingLoop(std::shared_ptr<ResourceManager> rm)
 
             mActiveStreamMutex.lock();
             rm->cardState = state;
+            /* mixer controls and MIIDs are resolved again once the card is back */
+            if (state == CARD_STATUS_OFFLINE && state != prevState) {
+                SessionAlsaUtils::invalidateMixerControlCache(NULL);
+                SessionAlsaUtils::invalidateModuleInstanceIdCache();
+            }
             if (state != prevState) {
                 if (rm->globalCb) {
                     PAL_DBG(LOG_TAG, "Notifying client about sound card state %d global cb %pK",
@@ -1272,6 +1272,7 @@ int ResourceManager::init_audio()
         return -EIO;
     }
 
+    snd_card_name_ = snd_card_name;
     getFileNameExtn(snd_card_name, file_name_extn);
 
     getVendorConfigPath(vendor_config_path, sizeof(vendor_config_path));
@@ -2640,6 +2641,8 @@ int ResourceManager::registerStream(Stream *s)
             break;
     }
     mActiveStreams.push_back(s);
+    if (!ret)
+        addToStreamIndex(s, type);
 
 #if 0
     s->getStreamAttributes(&incomingStreamAttr);
@@ -2817,6 +2820,7 @@ int ResourceManager::deregisterStream(Stream *s)
     }
 
     deregisterstream(s, mActiveStreams);
+    removeFromStreamIndex(s);
     mValidStreamMutex.unlock();
     mActiveStreamMutex.unlock();
 exit:
@@ -2824,6 +2828,99 @@ exit:
     return ret;
 }
 
+/*
+ * Rank of each stream type in the active stream query. Keeps the order the
+ * typed lists used to be merged in, -1 for types that are never reported.
+ */
+static int getStreamIndexRank(pal_stream_type_t type)
+{
+    switch (type) {
+        case PAL_STREAM_LOW_LATENCY:
+        case PAL_STREAM_VOIP_RX:
+        case PAL_STREAM_VOIP_TX:
+        case PAL_STREAM_VOICE_CALL:
+            return 0;
+        case PAL_STREAM_ULTRA_LOW_LATENCY:
+            return 1;
+        case PAL_STREAM_GENERIC:
+            return 2;
+        case PAL_STREAM_DEEP_BUFFER:
+            return 3;
+        case PAL_STREAM_RAW:
+            return 4;
+        case PAL_STREAM_COMPRESSED:
+            return 5;
+        case PAL_STREAM_VOICE_UI:
+            return 6;
+        case PAL_STREAM_ACD:
+            return 7;
+        case PAL_STREAM_PCM_OFFLOAD:
+        case PAL_STREAM_LOOPBACK:
+            return 8;
+        case PAL_STREAM_PROXY:
+            return 9;
+        case PAL_STREAM_VOICE_CALL_RECORD:
+            return 10;
+        case PAL_STREAM_NON_TUNNEL:
+            return 11;
+        case PAL_STREAM_VOICE_CALL_MUSIC:
+            return 12;
+        case PAL_STREAM_HAPTICS:
+            return 13;
+        case PAL_STREAM_ULTRASOUND:
+            return 14;
+        case PAL_STREAM_SENSOR_PCM_DATA:
+            return 15;
+        case PAL_STREAM_VOICE_RECOGNITION:
+            return 16;
+        default:
+            return -1;
+    }
+}
+
+// raw, sensor pcm data and voice recognition streams are never restored
+static bool isOrphanStreamRank(int rank)
+{
+    return rank >= 0 && rank != 4 && rank != 15 && rank != 16;
+}
+
+void ResourceManager::addToStreamIndex(Stream *s, pal_stream_type_t type)
+{
+    pal_stream_direction_t dir = PAL_AUDIO_OUTPUT;
+    int rank = getStreamIndexRank(type);
+
+    if (rank >= 0) {
+        // insert after the last stream of the same rank to keep FIFO order
+        auto iter = std::upper_bound(mStreamIndex.begin(), mStreamIndex.end(),
+            rank, [](int r, const std::pair<int, Stream*> &e) {
+                return r < e.first;
+            });
+        mStreamIndex.insert(iter, std::make_pair(rank, s));
+    }
+
+    s->getStreamDirection(&dir);
+    if (dir == PAL_AUDIO_INPUT)
+        mTxStreamIndex.push_back(s);
+    else
+        mRxStreamIndex.push_back(s);
+}
+
+void ResourceManager::removeFromStreamIndex(Stream *s)
+{
+    auto iter = std::find_if(mStreamIndex.begin(), mStreamIndex.end(),
+        [s](const std::pair<int, Stream*> &e) { return e.second == s; });
+    if (iter != mStreamIndex.end())
+        mStreamIndex.erase(iter);
+
+    auto rxIter = std::find(mRxStreamIndex.begin(), mRxStreamIndex.end(), s);
+    if (rxIter != mRxStreamIndex.end())
+        mRxStreamIndex.erase(rxIter);
+
+    auto txIter = std::find(mTxStreamIndex.begin(), mTxStreamIndex.end(), s);
+    if (txIter != mTxStreamIndex.end())
+        mTxStreamIndex.erase(txIter);
+}
+
 template <class T>
 bool isStreamActive(T s, std::list<T> &streams)
 {
@@ -2851,118 +2948,92 @@ int ResourceManager::isActiveStream(pal_stream_handle_t *handle) {
 
 int ResourceManager::initStreamUserCounter(Stream *s)
 {
+    int ret = 0;
+
     lockValidStreamMutex();
-    mActiveStreamUserCounter.insert(std::make_pair(s, std::make_pair(0, true)));
     s->initStreamSmph();
+    ret = mActiveStreamUserCounter.insert(s);
     unlockValidStreamMutex();
-    return 0;
+    return ret;
 }
 
 int ResourceManager::deactivateStreamUserCounter(Stream *s)
 {
-    std::map<Stream*, std::pair<uint32_t, bool>>::iterator it;
+    uint32_t users = 0;
+
     lockValidStreamMutex();
-    printStreamUserCounter(s);
-    it = mActiveStreamUserCounter.find(s);
-    if (it != mActiveStreamUserCounter.end() && it->second.second == true) {
-        PAL_DBG(LOG_TAG, "stream %p is to be deactivated.", s);
-        it->second.second = false;
-        unlockValidStreamMutex();
-        s->waitStreamSmph();
-        PAL_DBG(LOG_TAG, "stream %p is inactive.", s);
-        s->deinitStreamSmph();
-        return 0;
-    } else {
+    if (mActiveStreamUserCounter.deactivate(s, &users)) {
         PAL_ERR(LOG_TAG, "stream %p is not found or inactive", s);
         unlockValidStreamMutex();
         return -EINVAL;
     }
+    unlockValidStreamMutex();
+
+    PAL_DBG(LOG_TAG, "stream %p is to be deactivated, users %u", s, users);
+    /* the last user posts the semaphore once the stream is inactive */
+    if (users)
+        s->waitStreamSmph();
+    PAL_DBG(LOG_TAG, "stream %p is inactive.", s);
+    s->deinitStreamSmph();
+    return 0;
 }
 
 int ResourceManager::eraseStreamUserCounter(Stream *s)
 {
-    std::map<Stream*, std::pair<uint32_t, bool>>::iterator it;
     lockValidStreamMutex();
-    it = mActiveStreamUserCounter.find(s);
-    if (it != mActiveStreamUserCounter.end()) {
-        mActiveStreamUserCounter.erase(it);
-        PAL_DBG(LOG_TAG, "stream counter for %p is erased.", s);
-        unlockValidStreamMutex();
-        return 0;
-    } else {
+    if (mActiveStreamUserCounter.erase(s)) {
         PAL_ERR(LOG_TAG, "stream counter for %p is not found.", s);
         unlockValidStreamMutex();
         return -EINVAL;
     }
+    PAL_DBG(LOG_TAG, "stream counter for %p is erased.", s);
+    unlockValidStreamMutex();
+    return 0;
 }
 
+/*
+ * increase/decreaseStreamUserCounter are lock free, callers on the data
+ * path need not hold mValidStreamMutex to pin a stream handle.
+ */
 int ResourceManager::increaseStreamUserCounter(Stream* s)
 {
-    std::map<Stream*, std::pair<uint32_t, bool>>::iterator it;
-    printStreamUserCounter(s);
-    it = mActiveStreamUserCounter.find(s);
-    if (it != mActiveStreamUserCounter.end() &&
-        it->second.second) {
-        if (0 == it->second.first) {
-            s->waitStreamSmph();
-            PAL_DBG(LOG_TAG, "stream %p in use", s);
-        }
-        PAL_DBG(LOG_TAG, "stream %p counter was %d", s, it->second.first);
-        it->second.first = it->second.first + 1;
-        PAL_DBG(LOG_TAG, "stream %p counter increased to %d", s, it->second.first);
-        return 0;
-    } else {
+    if (mActiveStreamUserCounter.acquire(s)) {
         PAL_ERR(LOG_TAG, "stream %p is not found or inactive.", s);
         return -EINVAL;
     }
+    PAL_VERBOSE(LOG_TAG, "stream %p counter increased", s);
+    return 0;
 }
 
 int ResourceManager::decreaseStreamUserCounter(Stream* s)
 {
-    std::map<Stream*, std::pair<uint32_t, bool>>::iterator it;
-    printStreamUserCounter(s);
-    it = mActiveStreamUserCounter.find(s);
-    if (it != mActiveStreamUserCounter.end()) {
-        PAL_DBG(LOG_TAG, "stream %p counter was %d", s, it->second.first);
-        if (0 == it->second.first) {
-            PAL_ERR(LOG_TAG, "counter of stream %p has already been 0.", s);
-            return -EINVAL;
-        }
+    int ret = mActiveStreamUserCounter.release(s);
 
-        it->second.first = it->second.first - 1;
-        if (0 == it->second.first) {
-            PAL_DBG(LOG_TAG, "stream %p not in use", s);
-            s->postStreamSmph();
-        }
-        PAL_DBG(LOG_TAG, "stream %p counter decreased to %d", s, it->second.first);
-        return 0;
-    } else {
-        PAL_ERR(LOG_TAG, "stream %p is not found.", s);
+    if (ret < 0) {
+        PAL_ERR(LOG_TAG, "stream %p is not found or counter is 0.", s);
         return -EINVAL;
     }
+    if (ret > 0) {
+        PAL_DBG(LOG_TAG, "stream %p not in use", s);
+        s->postStreamSmph();
+    }
+    PAL_VERBOSE(LOG_TAG, "stream %p counter decreased", s);
+    return 0;
 }
 
 int ResourceManager::getStreamUserCounter(Stream *s)
 {
-    std::map<Stream*, std::pair<uint32_t, bool>>::iterator it;
-    printStreamUserCounter(s);
-    it = mActiveStreamUserCounter.find(s);
-    if (it != mActiveStreamUserCounter.end()) {
-        return it->second.first;
-    } else {
+    int ret = mActiveStreamUserCounter.getUsers(s);
+
+    if (ret < 0)
         PAL_ERR(LOG_TAG, "stream %p is not found.", s);
-        return -EINVAL;
-    }
+    return ret;
 }
 
 int ResourceManager::printStreamUserCounter(Stream *s)
 {
-    std::map<Stream*, std::pair<uint32_t, bool>>::iterator it;
-    for (it = mActiveStreamUserCounter.begin();
-            it != mActiveStreamUserCounter.end(); it++) {
-        PAL_VERBOSE(LOG_TAG, "stream = %p count = %d active = %d",
-                    it->first, it->second.first, it->second.second);
-    }
+    PAL_VERBOSE(LOG_TAG, "stream = %p count = %d", s,
+                mActiveStreamUserCounter.getUsers(s));
 
     return 0;
 }
@@ -4689,7 +4760,7 @@ std::shared_ptr<Device> ResourceManager::getActiveEchoReferenceRxDevices_l(
         goto exit;
     }
 
-    for (auto& rx_str: mActiveStreams) {
+    for (auto& rx_str: mRxStreamIndex) {
         rx_str->getStreamAttributes(&rx_attr);
         rx_device_list.clear();
         if (rx_attr.direction != PAL_AUDIO_INPUT) {
@@ -4764,7 +4835,7 @@ std::vector<Stream*> ResourceManager::getConcurrentTxStream_l(
         goto exit;
     }
 
-    for (auto& tx_str: mActiveStreams) {
+    for (auto& tx_str: mTxStreamIndex) {
         tx_device_list.clear();
         tx_str->getStreamAttributes(&tx_attr);
         if (tx_attr.type == PAL_STREAM_PROXY ||
@@ -5019,26 +5090,6 @@ void ResourceManager::getHigherPriorityActiveStreams(const int inComingStreamPri
 #endif
 
 
-template <class T>
-void getActiveStreams(std::shared_ptr<Device> d, std::vector<Stream*> &activestreams,
-                      std::list<T> sourcestreams)
-{
-    for (typename std::list<T>::iterator iter = sourcestreams.begin();
-                 iter != sourcestreams.end(); iter++) {
-        std::vector <std::shared_ptr<Device>> devices;
-        (*iter)->getAssociatedDevices(devices);
-        if (d == NULL) {
-             if((*iter)->isAlive() && !devices.empty())
-                activestreams.push_back(*iter);
-        } else {
-            typename std::vector<std::shared_ptr<Device>>::iterator result =
-                     std::find(devices.begin(), devices.end(), d);
-            if ((result != devices.end()) && (*iter)->isAlive())
-                activestreams.push_back(*iter);
-        }
-    }
-}
-
 int ResourceManager::getActiveStream_l(std::vector<Stream*> &activestreams,
                                        std::shared_ptr<Device> d)
 {
@@ -5046,24 +5097,14 @@ int ResourceManager::getActiveStream_l(std::vector<Stream*> &activestreams,
 
     activestreams.clear();
 
-    // merge all types of active streams into activestreams
-    getActiveStreams(d, activestreams, active_streams_ll);
-    getActiveStreams(d, activestreams, active_streams_ull);
-    getActiveStreams(d, activestreams, active_streams_ulla);
-    getActiveStreams(d, activestreams, active_streams_db);
-    getActiveStreams(d, activestreams, active_streams_raw);
-    getActiveStreams(d, activestreams, active_streams_comp);
-    getActiveStreams(d, activestreams, active_streams_st);
-    getActiveStreams(d, activestreams, active_streams_acd);
-    getActiveStreams(d, activestreams, active_streams_po);
-    getActiveStreams(d, activestreams, active_streams_proxy);
-    getActiveStreams(d, activestreams, active_streams_incall_record);
-    getActiveStreams(d, activestreams, active_streams_non_tunnel);
-    getActiveStreams(d, activestreams, active_streams_incall_music);
-    getActiveStreams(d, activestreams, active_streams_haptics);
-    getActiveStreams(d, activestreams, active_streams_ultrasound);
-    getActiveStreams(d, activestreams, active_streams_sensor_pcm_data);
-    getActiveStreams(d, activestreams, active_streams_voice_rec);
+    for (auto &entry : mStreamIndex) {
+        Stream *str = entry.second;
+
+        if (!str->isAlive())
+            continue;
+        if (d ? str->isDeviceAssociated(d) : str->hasAssociatedDevices())
+            activestreams.push_back(str);
+    }
 
     if (activestreams.empty()) {
         ret = -ENOENT;
@@ -5089,23 +5130,6 @@ int ResourceManager::getActiveStream(std::vector<Stream*> &activestreams,
     return ret;
 }
 
-template <class T>
-void getOrphanStreams(std::vector<Stream*> &orphanstreams,
-                      std::vector<Stream*> &retrystreams,
-                      std::list<T> sourcestreams)
-{
-    for (typename std::list<T>::iterator iter = sourcestreams.begin();
-                 iter != sourcestreams.end(); iter++) {
-        std::vector <std::shared_ptr<Device>> devices;
-        (*iter)->getAssociatedDevices(devices);
-        if (devices.empty())
-            orphanstreams.push_back(*iter);
-
-        if ((*iter)->suspendedDevIds.size() > 0)
-            retrystreams.push_back(*iter);
-    }
-}
-
 int ResourceManager::getOrphanStream_l(std::vector<Stream*> &orphanstreams,
                                        std::vector<Stream*> &retrystreams)
 {
@@ -5114,20 +5138,17 @@ int ResourceManager::getOrphanStream_l(std::vector<Stream*> &orphanstreams,
     orphanstreams.clear();
     retrystreams.clear();
 
-    getOrphanStreams(orphanstreams, retrystreams, active_streams_ll);
-    getOrphanStreams(orphanstreams, retrystreams, active_streams_ull);
-    getOrphanStreams(orphanstreams, retrystreams, active_streams_ulla);
-    getOrphanStreams(orphanstreams, retrystreams, active_streams_db);
-    getOrphanStreams(orphanstreams, retrystreams, active_streams_comp);
-    getOrphanStreams(orphanstreams, retrystreams, active_streams_st);
-    getOrphanStreams(orphanstreams, retrystreams, active_streams_acd);
-    getOrphanStreams(orphanstreams, retrystreams, active_streams_po);
-    getOrphanStreams(orphanstreams, retrystreams, active_streams_proxy);
-    getOrphanStreams(orphanstreams, retrystreams, active_streams_incall_record);
-    getOrphanStreams(orphanstreams, retrystreams, active_streams_non_tunnel);
-    getOrphanStreams(orphanstreams, retrystreams, active_streams_incall_music);
-    getOrphanStreams(orphanstreams, retrystreams, active_streams_haptics);
-    getOrphanStreams(orphanstreams, retrystreams, active_streams_ultrasound);
+    for (auto &entry : mStreamIndex) {
+        Stream *str = entry.second;
+
+        if (!isOrphanStreamRank(entry.first))
+            continue;
+        if (!str->hasAssociatedDevices())
+            orphanstreams.push_back(str);
+
+        if (str->suspendedDevIds.size() > 0)
+            retrystreams.push_back(str);
+    }
 
     if (orphanstreams.empty() && retrystreams.empty()) {
         ret = -ENOENT;
@@ -5716,6 +5737,8 @@ void ResourceManager::deinit()
     card_status_t state = CARD_STATUS_NONE;
 
     mixerClosed = true;
+    SessionAlsaUtils::invalidateMixerControlCache(NULL);
+    SessionAlsaUtils::invalidateModuleInstanceIdCache();
     mixer_close(audio_virt_mixer);
     mixer_close(audio_hw_mixer);
     if (audio_route) {
@@ -5820,71 +5843,25 @@ int ResourceManager::getNumFEs(const pal_stream_type_t sType) const
 const std::vector<int> ResourceManager::allocateFrontEndExtEcIds()
 {
     std::vector<int> f;
-    f.clear();
-    const int howMany = 1;
-    int id = 0;
-    std::vector<int>::iterator it;
-    if (howMany > listAllPcmExtEcTxFrontEnds.size()) {
-        PAL_ERR(LOG_TAG, "allocateFrontEndExtEcIds: requested for %d external ec front ends, have only %zu error",
-                        howMany, listAllPcmExtEcTxFrontEnds.size());
-        return f;
-    }
-    id = (listAllPcmExtEcTxFrontEnds.size() - 1);
-    it =  (listAllPcmExtEcTxFrontEnds.begin() + id);
-    for (int i = 0; i < howMany; i++) {
-        f.push_back(listAllPcmExtEcTxFrontEnds.at(id));
-        listAllPcmExtEcTxFrontEnds.erase(it);
-        PAL_INFO(LOG_TAG, "allocateFrontEndExtEcIds: front end %d", f[i]);
-        it -= 1;
-        id -= 1;
-    }
+
+    if (pcmExtEcTxFrontEnds.alloc(1, f))
+        PAL_ERR(LOG_TAG, "allocateFrontEndExtEcIds: no external ec front end available");
+
     return f;
 }
 
 void ResourceManager::freeFrontEndEcTxIds(const std::vector<int> frontend)
 {
-    for (int i = 0; i < frontend.size(); i++) {
-        PAL_INFO(LOG_TAG, "freeing ext ec dev %d\n", frontend.at(i));
-        listAllPcmExtEcTxFrontEnds.push_back(frontend.at(i));
-    }
-    return;
+    PAL_INFO(LOG_TAG, "freeing %zu ext ec dev", frontend.size());
+    pcmExtEcTxFrontEnds.release(frontend);
 }
 
-template <typename T>
-void removeDuplicates(std::vector<T> &vec)
-{
-    std::sort(vec.begin(), vec.end());
-    vec.erase(std::unique(vec.begin(), vec.end()), vec.end());
-    return;
-}
-
-const std::vector<int> ResourceManager::allocateFrontEndIds(const struct pal_stream_attributes sAttr, int lDirection)
+PalIdPool *ResourceManager::getFrontEndPool(const struct pal_stream_attributes &sAttr,
+                                            int lDirection)
 {
-    //TODO: lock resource manager
-    std::vector<int> f;
-    f.clear();
-    const int howMany = getNumFEs(sAttr.type);
-    int id = 0;
-    std::vector<int>::iterator it;
-
-    mListFrontEndsMutex.lock();
-    switch(sAttr.type) {
+    switch (sAttr.type) {
         case PAL_STREAM_NON_TUNNEL:
-            if (howMany > listAllNonTunnelSessionIds.size()) {
-                PAL_ERR(LOG_TAG, "allocateFrontEndIds: requested for %d front ends, have only %zu error",
-                                howMany, listAllPcmRecordFrontEnds.size());
-                 goto error;
-            }
-            id = (listAllNonTunnelSessionIds.size() - 1);
-            it =  (listAllNonTunnelSessionIds.begin() + id);
-            for (int i = 0; i < howMany; i++) {
-                f.push_back(listAllNonTunnelSessionIds.at(id));
-                listAllNonTunnelSessionIds.erase(it);
-                PAL_INFO(LOG_TAG, "allocateFrontEndIds: front end %d", f[i]);
-                it -= 1;
-                id -= 1;
-            }
-            break;
+            return &nonTunnelSessionIds;
         case PAL_STREAM_LOW_LATENCY:
         case PAL_STREAM_ULTRA_LOW_LATENCY:
         case PAL_STREAM_GENERIC:
@@ -5904,409 +5881,108 @@ const std::vector<int> ResourceManager::allocateFrontEndIds(const struct pal_str
         case PAL_STREAM_VOICE_RECOGNITION:
             switch (sAttr.direction) {
                 case PAL_AUDIO_INPUT:
-                    if (lDirection == TX_HOSTLESS) {
-                        if (howMany > listAllPcmHostlessTxFrontEnds.size()) {
-                            PAL_ERR(LOG_TAG, "allocateFrontEndIds: requested for %d front ends, have only %zu error",
-                                              howMany, listAllPcmHostlessTxFrontEnds.size());
-                            goto error;
-                        }
-                        id = (listAllPcmHostlessTxFrontEnds.size() - 1);
-                        it = (listAllPcmHostlessTxFrontEnds.begin() + id);
-                        for (int i = 0; i < howMany; i++) {
-                           f.push_back(listAllPcmHostlessTxFrontEnds.at(id));
-                           listAllPcmHostlessTxFrontEnds.erase(it);
-                           PAL_INFO(LOG_TAG, "allocateFrontEndIds: front end %d", f[i]);
-                           it -= 1;
-                           id -= 1;
-                        }
-                    } else {
-                        if (howMany > listAllPcmRecordFrontEnds.size()) {
-                            PAL_ERR(LOG_TAG, "allocateFrontEndIds: requested for %d front ends, have only %zu error",
-                                              howMany, listAllPcmRecordFrontEnds.size());
-                            goto error;
-                        }
-                        id = (listAllPcmRecordFrontEnds.size() - 1);
-                        it = (listAllPcmRecordFrontEnds.begin() + id);
-                        for (int i = 0; i < howMany; i++) {
-                            f.push_back(listAllPcmRecordFrontEnds.at(id));
-                            listAllPcmRecordFrontEnds.erase(it);
-                            PAL_INFO(LOG_TAG, "allocateFrontEndIds: front end %d", f[i]);
-                            it -= 1;
-                            id -= 1;
-                        }
-                    }
-                    break;
+                    if (lDirection == TX_HOSTLESS)
+                        return &pcmHostlessTxFrontEnds;
+                    return &pcmRecordFrontEnds;
                 case PAL_AUDIO_OUTPUT:
                     if (sAttr.type == PAL_STREAM_RAW) {
                         PAL_ERR(LOG_TAG, "Raw output stream not supported");
-                        goto error;
-                    }
-                    if (howMany > listAllPcmPlaybackFrontEnds.size()) {
-                        PAL_ERR(LOG_TAG, "allocateFrontEndIds: requested for %d front ends, have only %zu error",
-                                          howMany, listAllPcmPlaybackFrontEnds.size());
-                        goto error;
-                    }
-                    if (!listAllPcmPlaybackFrontEnds.size()) {
-                        PAL_ERR(LOG_TAG, "allocateFrontEndIds: requested for %d front ends, but we dont have any (%zu) !!!!!!! ",
-                                howMany, listAllPcmPlaybackFrontEnds.size());
-                        goto error;
+                        return nullptr;
                     }
-                    id = (int)(((int)listAllPcmPlaybackFrontEnds.size()) - 1);
-                    if (id < 0) {
-                        PAL_ERR(LOG_TAG, "allocateFrontEndIds: negative iterator id %d !!!!! ", id);
-                        goto error;
-                    }
-                    it =  (listAllPcmPlaybackFrontEnds.begin() + id);
-                    for (int i = 0; i < howMany; i++) {
-                        f.push_back(listAllPcmPlaybackFrontEnds.at(id));
-                        listAllPcmPlaybackFrontEnds.erase(it);
-                        PAL_INFO(LOG_TAG, "allocateFrontEndIds: front end %d", f[i]);
-                        it -= 1;
-                        id -= 1;
-                    }
-                    break;
+                    return &pcmPlaybackFrontEnds;
                 case PAL_AUDIO_INPUT | PAL_AUDIO_OUTPUT:
-                    if (lDirection == RX_HOSTLESS) {
-                        if (howMany > listAllPcmHostlessRxFrontEnds.size()) {
-                            PAL_ERR(LOG_TAG, "allocateFrontEndIds: requested for %d front ends, have only %zu error",
-                                              howMany, listAllPcmHostlessRxFrontEnds.size());
-                            goto error;
-                        }
-                        id = (listAllPcmHostlessRxFrontEnds.size() - 1);
-                        it = (listAllPcmHostlessRxFrontEnds.begin() + id);
-                        for (int i = 0; i < howMany; i++) {
-                           f.push_back(listAllPcmHostlessRxFrontEnds.at(id));
-                           listAllPcmHostlessRxFrontEnds.erase(it);
-                           PAL_INFO(LOG_TAG, "allocateFrontEndIds: front end %d", f[i]);
-                           it -= 1;
-                           id -= 1;
-                        }
-                    } else {
-                        if (howMany > listAllPcmHostlessTxFrontEnds.size()) {
-                            PAL_ERR(LOG_TAG, "allocateFrontEndIds: requested for %d front ends, have only %zu error",
-                                              howMany, listAllPcmHostlessTxFrontEnds.size());
-                            goto error;
-                        }
-                        id = (listAllPcmHostlessTxFrontEnds.size() - 1);
-                        it = (listAllPcmHostlessTxFrontEnds.begin() + id);
-                        for (int i = 0; i < howMany; i++) {
-                           f.push_back(listAllPcmHostlessTxFrontEnds.at(id));
-                           listAllPcmHostlessTxFrontEnds.erase(it);
-                           PAL_INFO(LOG_TAG, "allocateFrontEndIds: front end %d", f[i]);
-                           it -= 1;
-                           id -= 1;
-                        }
-                    }
-                    break;
+                    if (lDirection == RX_HOSTLESS)
+                        return &pcmHostlessRxFrontEnds;
+                    return &pcmHostlessTxFrontEnds;
                 default:
-                    PAL_ERR(LOG_TAG,"direction unsupported");
-                    break;
+                    PAL_ERR(LOG_TAG, "direction unsupported");
+                    return nullptr;
             }
-            break;
         case PAL_STREAM_COMPRESSED:
             switch (sAttr.direction) {
                 case PAL_AUDIO_INPUT:
-                    if (howMany > listAllCompressRecordFrontEnds.size()) {
-                        PAL_ERR(LOG_TAG, "allocateFrontEndIds: requested for %d front ends, have only %zu error",
-                                          howMany, listAllCompressRecordFrontEnds.size());
-                        goto error;
-                    }
-                    id = (listAllCompressRecordFrontEnds.size() - 1);
-                    it = (listAllCompressRecordFrontEnds.begin() + id);
-                    for (int i = 0; i < howMany; i++) {
-                        f.push_back(listAllCompressRecordFrontEnds.at(id));
-                        listAllCompressRecordFrontEnds.erase(it);
-                        PAL_INFO(LOG_TAG, "allocateFrontEndIds: front end %d", f[i]);
-                        it -= 1;
-                        id -= 1;
-                    }
-                    break;
+                    return &compressRecordFrontEnds;
                 case PAL_AUDIO_OUTPUT:
-                    if (howMany > listAllCompressPlaybackFrontEnds.size()) {
-                        PAL_ERR(LOG_TAG, "allocateFrontEndIds: requested for %d front ends, have only %zu error",
-                                          howMany, listAllCompressPlaybackFrontEnds.size());
-                        goto error;
-                    }
-                    id = (listAllCompressPlaybackFrontEnds.size() - 1);
-                    it = (listAllCompressPlaybackFrontEnds.begin() + id);
-                    for (int i = 0; i < howMany; i++) {
-                        f.push_back(listAllCompressPlaybackFrontEnds.at(id));
-                        listAllCompressPlaybackFrontEnds.erase(it);
-                        PAL_INFO(LOG_TAG, "allocateFrontEndIds: front end %d", f[i]);
-                        it -= 1;
-                        id -= 1;
-                    }
-                    break;
+                    return &compressPlaybackFrontEnds;
                 default:
-                    PAL_ERR(LOG_TAG,"direction unsupported");
-                    break;
-                }
-                break;
-        case PAL_STREAM_VOICE_CALL:
-            switch (sAttr.direction) {
-              case PAL_AUDIO_INPUT | PAL_AUDIO_OUTPUT:
-                    if (lDirection == RX_HOSTLESS) {
-                        if (sAttr.info.voice_call_info.VSID == VOICEMMODE1 ||
-                            sAttr.info.voice_call_info.VSID == VOICELBMMODE1) {
-                            f = allocateVoiceFrontEndIds(listAllPcmVoice1RxFrontEnds, howMany);
-                        } else if(sAttr.info.voice_call_info.VSID == VOICEMMODE2 ||
-                            sAttr.info.voice_call_info.VSID == VOICELBMMODE2){
-                            f = allocateVoiceFrontEndIds(listAllPcmVoice2RxFrontEnds, howMany);
-                        } else {
-                            PAL_ERR(LOG_TAG,"invalid VSID 0x%x provided",
-                                    sAttr.info.voice_call_info.VSID);
-                        }
-                    } else {
-                        if (sAttr.info.voice_call_info.VSID == VOICEMMODE1 ||
-                            sAttr.info.voice_call_info.VSID == VOICELBMMODE1) {
-                            f = allocateVoiceFrontEndIds(listAllPcmVoice1TxFrontEnds, howMany);
-                        } else if(sAttr.info.voice_call_info.VSID == VOICEMMODE2 ||
-                            sAttr.info.voice_call_info.VSID == VOICELBMMODE2){
-                            f = allocateVoiceFrontEndIds(listAllPcmVoice2TxFrontEnds, howMany);
-                        } else {
-                            PAL_ERR(LOG_TAG,"invalid VSID 0x%x provided",
-                                    sAttr.info.voice_call_info.VSID);
-                        }
-                    }
-                    break;
-              default:
-                  PAL_ERR(LOG_TAG,"direction unsupported voice must be RX and TX");
-                  break;
+                    PAL_ERR(LOG_TAG, "direction unsupported");
+                    return nullptr;
             }
-            break;
+        case PAL_STREAM_VOICE_CALL:
+            if (sAttr.direction != (PAL_AUDIO_INPUT | PAL_AUDIO_OUTPUT)) {
+                PAL_ERR(LOG_TAG, "direction unsupported voice must be RX and TX");
+                return nullptr;
+            }
+            if (sAttr.info.voice_call_info.VSID == VOICEMMODE1 ||
+                sAttr.info.voice_call_info.VSID == VOICELBMMODE1)
+                return lDirection == RX_HOSTLESS ? &pcmVoice1RxFrontEnds :
+                                                   &pcmVoice1TxFrontEnds;
+            if (sAttr.info.voice_call_info.VSID == VOICEMMODE2 ||
+                sAttr.info.voice_call_info.VSID == VOICELBMMODE2)
+                return lDirection == RX_HOSTLESS ? &pcmVoice2RxFrontEnds :
+                                                   &pcmVoice2TxFrontEnds;
+            PAL_ERR(LOG_TAG, "invalid VSID 0x%x provided",
+                    sAttr.info.voice_call_info.VSID);
+            return nullptr;
         case PAL_STREAM_VOICE_CALL_RECORD:
-            if (howMany > listAllPcmInCallRecordFrontEnds.size()) {
-                    PAL_ERR(LOG_TAG, "allocateFrontEndIds: requested for %d front ends, have only %zu error",
-                                      howMany, listAllPcmInCallRecordFrontEnds.size());
-                    goto error;
-                }
-            id = (listAllPcmInCallRecordFrontEnds.size() - 1);
-            it = (listAllPcmInCallRecordFrontEnds.begin() + id);
-            for (int i = 0; i < howMany; i++) {
-                f.push_back(listAllPcmInCallRecordFrontEnds.at(id));
-                listAllPcmInCallRecordFrontEnds.erase(it);
-                PAL_ERR(LOG_TAG, "allocateFrontEndIds: front end %d", f[i]);
-                it -= 1;
-                id -= 1;
-            }
-            break;
+            return &pcmInCallRecordFrontEnds;
         case PAL_STREAM_VOICE_CALL_MUSIC:
-            if (howMany > listAllPcmInCallMusicFrontEnds.size()) {
-                    PAL_ERR(LOG_TAG, "allocateFrontEndIds: requested for %d front ends, have only %zu error",
-                                      howMany, listAllPcmInCallMusicFrontEnds.size());
-                    goto error;
-                }
-            id = (listAllPcmInCallMusicFrontEnds.size() - 1);
-            it = (listAllPcmInCallMusicFrontEnds.begin() + id);
-            for (int i = 0; i < howMany; i++) {
-                f.push_back(listAllPcmInCallMusicFrontEnds.at(id));
-                listAllPcmInCallMusicFrontEnds.erase(it);
-                PAL_ERR(LOG_TAG, "allocateFrontEndIds: front end %d", f[i]);
-                it -= 1;
-                id -= 1;
-            }
-            break;
-       case PAL_STREAM_CONTEXT_PROXY:
-            if (howMany > listAllPcmContextProxyFrontEnds.size()) {
-                    PAL_ERR(LOG_TAG, "allocateFrontEndIds: requested for %d front ends, have only %zu error",
-                                      howMany, listAllPcmContextProxyFrontEnds.size());
-                    goto error;
-                }
-            id = (listAllPcmContextProxyFrontEnds.size() - 1);
-            it = (listAllPcmContextProxyFrontEnds.begin() + id);
-            for (int i = 0; i < howMany; i++) {
-                f.push_back(listAllPcmContextProxyFrontEnds.at(id));
-                listAllPcmContextProxyFrontEnds.erase(it);
-                PAL_ERR(LOG_TAG, "allocateFrontEndIds: front end %d", f[i]);
-                it -= 1;
-                id -= 1;
-            }
-            break;
+            return &pcmInCallMusicFrontEnds;
+        case PAL_STREAM_CONTEXT_PROXY:
+            return &pcmContextProxyFrontEnds;
         default:
-            break;
+            return nullptr;
     }
-
-error:
-    mListFrontEndsMutex.unlock();
-    return f;
 }
 
-
-const std::vector<int> ResourceManager::allocateVoiceFrontEndIds(std::vector<int> listAllPcmVoiceFrontEnds, const int howMany)
+const std::vector<int> ResourceManager::allocateFrontEndIds(const struct pal_stream_attributes sAttr, int lDirection)
 {
+    PalLatencyScope trace(PAL_TRACE_FE_ALLOC);
     std::vector<int> f;
-    f.clear();
-    int id = 0;
-    std::vector<int>::iterator it;
-    if ( howMany > listAllPcmVoiceFrontEnds.size()) {
-        PAL_ERR(LOG_TAG, "allocate voice FrontEndIds: requested for %d front ends, have only %zu error",
-                howMany, listAllPcmVoiceFrontEnds.size());
+    PalIdPool *pool = getFrontEndPool(sAttr, lDirection);
+
+    if (!pool) {
+        PAL_ERR(LOG_TAG, "no front end pool for stream type %d direction %d",
+                sAttr.type, sAttr.direction);
         return f;
     }
-    id = (listAllPcmVoiceFrontEnds.size() - 1);
-    it =  (listAllPcmVoiceFrontEnds.begin() + id);
-    for (int i = 0; i < howMany; i++) {
-        f.push_back(listAllPcmVoiceFrontEnds.at(id));
-        listAllPcmVoiceFrontEnds.erase(it);
-        PAL_INFO(LOG_TAG, "allocate VoiceFrontEndIds: front end %d", f[i]);
-        it -= 1;
-        id -= 1;
-    }
+    if (pool->alloc(getNumFEs(sAttr.type), f))
+        PAL_ERR(LOG_TAG, "allocateFrontEndIds: front ends exhausted for stream type %d",
+                sAttr.type);
 
     return f;
 }
+
 void ResourceManager::freeFrontEndIds(const std::vector<int> frontend,
                                       const struct pal_stream_attributes sAttr,
                                       int lDirection)
 {
-    mListFrontEndsMutex.lock();
+    PalIdPool *pool = nullptr;
+
     if (frontend.size() <= 0) {
         PAL_ERR(LOG_TAG,"frontend size is invalid");
-        mListFrontEndsMutex.unlock();
         return;
     }
     PAL_INFO(LOG_TAG, "stream type %d, freeing %d\n", sAttr.type,
              frontend.at(0));
 
-    switch(sAttr.type) {
-        case PAL_STREAM_NON_TUNNEL:
-            for (int i = 0; i < frontend.size(); i++) {
-                 listAllNonTunnelSessionIds.push_back(frontend.at(i));
-            }
-            removeDuplicates(listAllNonTunnelSessionIds);
-            break;
-        case PAL_STREAM_LOW_LATENCY:
-        case PAL_STREAM_ULTRA_LOW_LATENCY:
-        case PAL_STREAM_GENERIC:
-        case PAL_STREAM_PROXY:
-        case PAL_STREAM_DEEP_BUFFER:
-        case PAL_STREAM_VOIP:
-        case PAL_STREAM_VOIP_RX:
-        case PAL_STREAM_VOIP_TX:
-        case PAL_STREAM_VOICE_UI:
-        case PAL_STREAM_LOOPBACK:
-        case PAL_STREAM_ACD:
-        case PAL_STREAM_PCM_OFFLOAD:
-        case PAL_STREAM_HAPTICS:
-        case PAL_STREAM_ULTRASOUND:
-        case PAL_STREAM_SENSOR_PCM_DATA:
-        case PAL_STREAM_RAW:
-        case PAL_STREAM_VOICE_RECOGNITION:
-            switch (sAttr.direction) {
-                case PAL_AUDIO_INPUT:
-                    if (lDirection == TX_HOSTLESS) {
-                        for (int i = 0; i < frontend.size(); i++) {
-                            listAllPcmHostlessTxFrontEnds.push_back(frontend.at(i));
-                        }
-                        removeDuplicates(listAllPcmHostlessTxFrontEnds);
-                    } else {
-                        for (int i = 0; i < frontend.size(); i++) {
-                            listAllPcmRecordFrontEnds.push_back(frontend.at(i));
-                        }
-                        removeDuplicates(listAllPcmRecordFrontEnds);
-                    }
-                    break;
-                case PAL_AUDIO_OUTPUT:
-                    for (int i = 0; i < frontend.size(); i++) {
-                        listAllPcmPlaybackFrontEnds.push_back(frontend.at(i));
-                    }
-                    removeDuplicates(listAllPcmPlaybackFrontEnds);
-                    break;
-                case PAL_AUDIO_INPUT | PAL_AUDIO_OUTPUT:
-                    if (lDirection == RX_HOSTLESS) {
-                        for (int i = 0; i < frontend.size(); i++) {
-                            listAllPcmHostlessRxFrontEnds.push_back(frontend.at(i));
-                        }
-                        removeDuplicates(listAllPcmHostlessRxFrontEnds);
-                    } else {
-                        for (int i = 0; i < frontend.size(); i++) {
-                            listAllPcmHostlessTxFrontEnds.push_back(frontend.at(i));
-                        }
-                        removeDuplicates(listAllPcmHostlessTxFrontEnds);
-                    }
-                    break;
-                default:
-                    PAL_ERR(LOG_TAG,"direction unsupported");
-                    break;
-            }
-            break;
-
-        case PAL_STREAM_VOICE_CALL:
-            if (lDirection == RX_HOSTLESS) {
-                for (int i = 0; i < frontend.size(); i++) {
-                    if (sAttr.info.voice_call_info.VSID == VOICEMMODE1 ||
-                        sAttr.info.voice_call_info.VSID == VOICELBMMODE1) {
-                        listAllPcmVoice1RxFrontEnds.push_back(frontend.at(i));
-                    } else {
-                        listAllPcmVoice2RxFrontEnds.push_back(frontend.at(i));
-                    }
+    pool = getFrontEndPool(sAttr, lDirection);
+    if (pool)
+        pool->release(frontend);
+}
 
-                }
-                removeDuplicates(listAllPcmVoice1RxFrontEnds);
-                removeDuplicates(listAllPcmVoice2RxFrontEnds);
-            } else {
-                for (int i = 0; i < frontend.size(); i++) {
-                    if (sAttr.info.voice_call_info.VSID == VOICEMMODE1 ||
-                        sAttr.info.voice_call_info.VSID == VOICELBMMODE1) {
-                        listAllPcmVoice1TxFrontEnds.push_back(frontend.at(i));
-                    } else {
-                        listAllPcmVoice2TxFrontEnds.push_back(frontend.at(i));
-                    }
-                }
-                removeDuplicates(listAllPcmVoice1TxFrontEnds);
-                removeDuplicates(listAllPcmVoice2TxFrontEnds);
-            }
-            break;
+std::string ResourceManager::dumpFrontEndPools()
+{
+    std::string json = "[";
 
-        case PAL_STREAM_COMPRESSED:
-            switch (sAttr.direction) {
-                case PAL_AUDIO_INPUT:
-                    for (int i = 0; i < frontend.size(); i++) {
-                        listAllCompressRecordFrontEnds.push_back(frontend.at(i));
-                    }
-                    removeDuplicates(listAllCompressRecordFrontEnds);
-                    break;
-                case PAL_AUDIO_OUTPUT:
-                    for (int i = 0; i < frontend.size(); i++) {
-                        listAllCompressPlaybackFrontEnds.push_back(frontend.at(i));
-                    }
-                    removeDuplicates(listAllCompressPlaybackFrontEnds);
-                    break;
-                default:
-                    PAL_ERR(LOG_TAG,"direction unsupported");
-                    break;
-                }
-            break;
-        case PAL_STREAM_VOICE_CALL_RECORD:
-        case PAL_STREAM_VOICE_CALL_MUSIC:
-            switch (sAttr.direction) {
-              case PAL_AUDIO_INPUT:
-                for (int i = 0; i < frontend.size(); i++) {
-                    listAllPcmInCallRecordFrontEnds.push_back(frontend.at(i));
-                }
-                removeDuplicates(listAllPcmInCallRecordFrontEnds);
-                break;
-              case PAL_AUDIO_OUTPUT:
-                for (int i = 0; i < frontend.size(); i++) {
-                    listAllPcmInCallMusicFrontEnds.push_back(frontend.at(i));
-                }
-                removeDuplicates(listAllPcmInCallMusicFrontEnds);
-                break;
-              default:
-                break;
-            }
-            break;
-       case PAL_STREAM_CONTEXT_PROXY:
-            for (int i = 0; i < frontend.size(); i++) {
-                 listAllPcmContextProxyFrontEnds.push_back(frontend.at(i));
-            }
-            removeDuplicates(listAllPcmContextProxyFrontEnds);
-            break;
-        default:
-            break;
+    for (int i = 0; frontEndPools[i]; i++) {
+        if (i)
+            json += ",";
+        json += frontEndPools[i]->toJson();
     }
-    mListFrontEndsMutex.unlock();
-    return;
+    json += "]";
+
+    return json;
 }
 
 void ResourceManager::getSharedBEActiveStreamDevs(std::vector <std::tuple<Stream *, uint32_t>> &activeStreamsDevices,
@@ -6412,6 +6088,35 @@ void ResourceManager::getBackEndNames(
         PAL_DBG(LOG_TAG, "getBackEndNames (TX): %s", txBackEndNames[i].second.c_str());
 }
 
+void ResourceManager::lockGraph(const std::vector<std::shared_ptr<Device>> &devices,
+                                std::vector<std::mutex *> &heldBackEnds)
+{
+    std::vector<std::string> beNames;
+    std::string beName;
+    size_t virt;
+    int dev_id;
+
+    for (int i = 0; i < devices.size(); i++) {
+        dev_id = devices[i]->getSndDeviceId();
+        /* devices without a backend entry still serialize among themselves */
+        if (isValidDevId(dev_id))
+            beName.assign(listAllBackEndIds[dev_id].second);
+        else
+            beName.clear();
+        /* virtual ports share the group backend, lock them as one */
+        virt = beName.find("-VIRT-");
+        if (virt != std::string::npos)
+            beName.erase(virt);
+        beNames.push_back(beName);
+    }
+    mGraphLock.lock(beNames, heldBackEnds);
+}
+
+void ResourceManager::unlockGraph(std::vector<std::mutex *> &heldBackEnds)
+{
+    mGraphLock.unlock(heldBackEnds);
+}
+
 /* updated dev2Attr if needed */
 bool ResourceManager::compareAndUpdateDevAttr(const struct pal_device *Dev1Attr,
                                               const struct pal_device_info *Dev1Info,
@@ -8005,6 +7710,19 @@ exit:
     return status;
 }
 
+// JSON reports go out as a strdup'ed string, the caller frees it
+static int getJsonPayload(const std::string &json, void **param_payload,
+                          size_t *payload_size)
+{
+    char *payload = strdup(json.c_str());
+
+    if (!payload)
+        return -ENOMEM;
+    *param_payload = payload;
+    *payload_size = json.size() + 1;
+    return 0;
+}
+
 int ResourceManager::getParameter(uint32_t param_id, void **param_payload,
                      size_t *payload_size, void *query __unused)
 {
@@ -8133,6 +7851,15 @@ int ResourceManager::getParameter(uint32_t param_id, void **param_payload,
             **(bool **)param_payload = isHifiFilterEnabled;
         }
         break;
+        case PAL_PARAM_ID_FE_POOL_STATS:
+            status = getJsonPayload(dumpFrontEndPools(), param_payload, payload_size);
+            break;
+        case PAL_PARAM_ID_LATENCY_TRACE:
+            status = getJsonPayload(PalLatencyTrace::dumpJson(), param_payload, payload_size);
+            break;
+        case PAL_PARAM_ID_DEBUG_DUMP:
+            status = getJsonPayload(PalDebugDump::dumpJson(), param_payload, payload_size);
+            break;
         default:
             status = -EINVAL;
             PAL_ERR(LOG_TAG, "Unknown ParamID:%d", param_id);
@@ -8191,6 +7918,24 @@ int ResourceManager::setParameter(uint32_t param_id, void *param_payload,
 
     mResourceManagerMutex.lock();
     switch (param_id) {
+        case PAL_PARAM_ID_LATENCY_TRACE:
+            PalLatencyTrace::reset();
+            break;
+        case PAL_PARAM_ID_DEBUG_DUMP:
+        {
+            pal_param_debug_dump_t *dump = (pal_param_debug_dump_t *)param_payload;
+
+            if (!dump || payload_size != sizeof(pal_param_debug_dump_t)) {
+                PAL_ERR(LOG_TAG, "Incorrect size : expected (%zu), received(%zu)",
+                        sizeof(pal_param_debug_dump_t), payload_size);
+                status = -EINVAL;
+                break;
+            }
+            if (dump->max_bytes)
+                PalDebugDump::setMaxBytes(dump->max_bytes);
+            PalDebugDump::setPcmTapMask(dump->pcm_tap_mask);
+        }
+        break;
         case PAL_PARAM_ID_UHQA_FLAG:
         {
             pal_param_uhqa_t* param_uhqa_flag = (pal_param_uhqa_t*) param_payload;
@@ -0,0 +1,339 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define LOG_TAG "PAL: StreamHandleTable"
+
+#include <errno.h>
+#include "StreamHandleTable.h"
+#include "PalCommon.h"
+
+/* marks a slot whose stream was erased, probing continues past it */
+#define HANDLE_SLOT_TOMBSTONE (reinterpret_cast<Stream *>(0x1))
+
+StreamHandleTable::StreamHandleTable()
+{
+    for (int i = 0; i < STREAM_HANDLE_TABLE_SIZE; i++) {
+        slots_[i].stream.store(nullptr, std::memory_order_relaxed);
+        slots_[i].state.store(0, std::memory_order_relaxed);
+    }
+    epoch_.store(0, std::memory_order_relaxed);
+    tombstones_ = 0;
+    compactAt_ = STREAM_HANDLE_TABLE_MAX_TOMBSTONES;
+}
+
+uint32_t StreamHandleTable::hash(Stream *s)
+{
+    uint64_t key = reinterpret_cast<uintptr_t>(s);
+
+    key *= 0x9E3779B97F4A7C15ULL;
+    return (uint32_t)(key >> 32) & (STREAM_HANDLE_TABLE_SIZE - 1);
+}
+
+/*
+ * A lookup that missed has to be retried if compact() was running or ran
+ * meanwhile, the stream may have been moved behind the probe.
+ */
+bool StreamHandleTable::retryLookup(uint32_t epoch)
+{
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return (epoch & 1) || epoch_.load(std::memory_order_relaxed) != epoch;
+}
+
+StreamHandleTable::HandleSlot* StreamHandleTable::lookup(Stream *s)
+{
+    uint32_t idx = hash(s);
+    Stream *cur = nullptr;
+
+    for (int i = 0; i < STREAM_HANDLE_TABLE_SIZE; i++) {
+        HandleSlot *slot = &slots_[(idx + i) & (STREAM_HANDLE_TABLE_SIZE - 1)];
+        cur = slot->stream.load(std::memory_order_acquire);
+        if (cur == s)
+            return slot;
+        if (!cur)
+            break;
+    }
+    return nullptr;
+}
+
+StreamHandleTable::HandleSlot* StreamHandleTable::find(Stream *s)
+{
+    HandleSlot *slot = nullptr;
+    uint32_t epoch = 0;
+
+    do {
+        epoch = epoch_.load(std::memory_order_acquire);
+        slot = lookup(s);
+    } while (!slot && retryLookup(epoch));
+
+    return slot;
+}
+
+/*
+ * Turns the tombstones directly in front of an empty slot back into empty
+ * slots. No chain can run through them, since every live entry is reached
+ * from its home slot without crossing an empty one.
+ */
+void StreamHandleTable::reclaim(uint32_t idx)
+{
+    HandleSlot *slot = nullptr;
+
+    if (slots_[(idx + 1) & (STREAM_HANDLE_TABLE_SIZE - 1)].stream.load(
+            std::memory_order_relaxed))
+        return;
+
+    for (int i = 0; i < STREAM_HANDLE_TABLE_SIZE && tombstones_; i++) {
+        slot = &slots_[(idx - i) & (STREAM_HANDLE_TABLE_SIZE - 1)];
+        if (slot->stream.load(std::memory_order_relaxed) != HANDLE_SLOT_TOMBSTONE)
+            break;
+        slot->stream.store(nullptr, std::memory_order_release);
+        tombstones_--;
+    }
+}
+
+/*
+ * Moves every unpinned stream to the first tombstone on its probe path and
+ * then empties every tombstone no probe path runs through. Pinned streams
+ * stay where they are, release() of a pinned stream therefore never misses.
+ */
+void StreamHandleTable::compact()
+{
+    HandleSlot *from = nullptr;
+    HandleSlot *to = nullptr;
+    bool onPath[STREAM_HANDLE_TABLE_SIZE] = {false};
+    uint64_t state = 0;
+    uint64_t gen = 0;
+    uint32_t idx = 0;
+    uint32_t moved = 0;
+    uint32_t tombstones = tombstones_;
+    Stream *cur = nullptr;
+
+    epoch_.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (uint32_t i = 0; i < STREAM_HANDLE_TABLE_SIZE; i++) {
+        from = &slots_[i];
+        cur = from->stream.load(std::memory_order_relaxed);
+        if (!cur || cur == HANDLE_SLOT_TOMBSTONE)
+            continue;
+
+        for (idx = hash(cur); idx != i; idx = (idx + 1) & (STREAM_HANDLE_TABLE_SIZE - 1)) {
+            if (slots_[idx].stream.load(std::memory_order_relaxed) == HANDLE_SLOT_TOMBSTONE)
+                break;
+        }
+        if (idx == i)
+            continue;
+
+        /* a pin racing with the move fails the CAS, the stream stays put */
+        state = from->state.load(std::memory_order_acquire);
+        if ((state & kUserMask) ||
+            !from->state.compare_exchange_strong(state, state | kMoving,
+                 std::memory_order_acq_rel, std::memory_order_acquire))
+            continue;
+
+        to = &slots_[idx];
+        gen = (to->state.load(std::memory_order_relaxed) >> kGenShift) + 1;
+        to->state.store((gen << kGenShift) | (state & kActive), std::memory_order_release);
+        to->stream.store(cur, std::memory_order_release);
+
+        gen = (state >> kGenShift) + 1;
+        from->state.store(gen << kGenShift, std::memory_order_release);
+        from->stream.store(HANDLE_SLOT_TOMBSTONE, std::memory_order_release);
+        moved++;
+    }
+
+    for (uint32_t i = 0; i < STREAM_HANDLE_TABLE_SIZE; i++) {
+        cur = slots_[i].stream.load(std::memory_order_relaxed);
+        if (!cur || cur == HANDLE_SLOT_TOMBSTONE)
+            continue;
+        for (idx = hash(cur); idx != i; idx = (idx + 1) & (STREAM_HANDLE_TABLE_SIZE - 1))
+            onPath[idx] = true;
+    }
+    for (uint32_t i = 0; i < STREAM_HANDLE_TABLE_SIZE; i++) {
+        if (onPath[i] ||
+            slots_[i].stream.load(std::memory_order_relaxed) != HANDLE_SLOT_TOMBSTONE)
+            continue;
+        slots_[i].stream.store(nullptr, std::memory_order_release);
+        tombstones_--;
+    }
+
+    epoch_.fetch_add(1, std::memory_order_release);
+    /* tombstones kept alive by pinned streams must not retrigger right away */
+    compactAt_ = tombstones_ + STREAM_HANDLE_TABLE_MAX_TOMBSTONES;
+    PAL_DBG(LOG_TAG, "moved %u streams, tombstones %u -> %u",
+            moved, tombstones, tombstones_);
+}
+
+int StreamHandleTable::insert(Stream *s)
+{
+    uint32_t idx = 0;
+    uint64_t gen = 0;
+    Stream *cur = nullptr;
+
+    if (!s || s == HANDLE_SLOT_TOMBSTONE)
+        return -EINVAL;
+
+    if (find(s)) {
+        PAL_ERR(LOG_TAG, "stream %pK already present", s);
+        return -EEXIST;
+    }
+
+    idx = hash(s);
+    for (int i = 0; i < STREAM_HANDLE_TABLE_SIZE; i++) {
+        HandleSlot *slot = &slots_[(idx + i) & (STREAM_HANDLE_TABLE_SIZE - 1)];
+        cur = slot->stream.load(std::memory_order_relaxed);
+        if (cur && cur != HANDLE_SLOT_TOMBSTONE)
+            continue;
+
+        if (cur == HANDLE_SLOT_TOMBSTONE)
+            tombstones_--;
+        gen = (slot->state.load(std::memory_order_relaxed) >> kGenShift) + 1;
+        slot->stream.store(s, std::memory_order_release);
+        slot->state.store((gen << kGenShift) | kActive, std::memory_order_release);
+        return 0;
+    }
+
+    PAL_ERR(LOG_TAG, "no free slot for stream %pK", s);
+    return -ENOSPC;
+}
+
+int StreamHandleTable::erase(Stream *s)
+{
+    HandleSlot *slot = find(s);
+    uint64_t gen = 0;
+
+    if (!slot)
+        return -EINVAL;
+
+    /* bump the generation first so that racing pins on this slot fail */
+    gen = (slot->state.load(std::memory_order_relaxed) >> kGenShift) + 1;
+    slot->state.store(gen << kGenShift, std::memory_order_release);
+    slot->stream.store(HANDLE_SLOT_TOMBSTONE, std::memory_order_release);
+    tombstones_++;
+
+    reclaim((uint32_t)(slot - slots_));
+    if (tombstones_ > compactAt_)
+        compact();
+    return 0;
+}
+
+int StreamHandleTable::deactivate(Stream *s, uint32_t *users)
+{
+    HandleSlot *slot = find(s);
+    uint64_t state = 0;
+
+    if (!slot)
+        return -EINVAL;
+
+    state = slot->state.load(std::memory_order_acquire);
+    do {
+        if (!(state & kActive))
+            return -EINVAL;
+    } while (!slot->state.compare_exchange_weak(state, state & ~kActive,
+                 std::memory_order_acq_rel, std::memory_order_acquire));
+
+    if (users)
+        *users = (uint32_t)(state & kUserMask);
+    return 0;
+}
+
+int StreamHandleTable::acquire(Stream *s)
+{
+    uint32_t idx = 0;
+    uint32_t epoch = 0;
+    uint64_t state = 0;
+    uint64_t gen = 0;
+    Stream *cur = nullptr;
+
+    if (!s)
+        return -EINVAL;
+
+    idx = hash(s);
+retry:
+    epoch = epoch_.load(std::memory_order_acquire);
+    for (int i = 0; i < STREAM_HANDLE_TABLE_SIZE; i++) {
+        HandleSlot *slot = &slots_[(idx + i) & (STREAM_HANDLE_TABLE_SIZE - 1)];
+        /*
+         * Load state before the key: a recycled slot always carries a new
+         * generation, so the CAS below cannot pin a different stream.
+         */
+        state = slot->state.load(std::memory_order_acquire);
+        cur = slot->stream.load(std::memory_order_acquire);
+        if (!cur)
+            break;
+        if (cur != s)
+            continue;
+
+        gen = state >> kGenShift;
+        while ((state & kActive) && !(state & kMoving) &&
+               (state >> kGenShift) == gen) {
+            if ((state & kUserMask) == kUserMask)
+                return -EBUSY;
+            if (slot->state.compare_exchange_weak(state, state + 1,
+                    std::memory_order_acq_rel, std::memory_order_acquire))
+                return 0;
+        }
+        break;
+    }
+    if (retryLookup(epoch))
+        goto retry;
+    return -EINVAL;
+}
+
+int StreamHandleTable::release(Stream *s)
+{
+    HandleSlot *slot = find(s);
+    uint64_t state = 0;
+
+    if (!slot)
+        return -EINVAL;
+
+    state = slot->state.load(std::memory_order_acquire);
+    do {
+        if (!(state & kUserMask))
+            return -EINVAL;
+    } while (!slot->state.compare_exchange_weak(state, state - 1,
+                 std::memory_order_acq_rel, std::memory_order_acquire));
+
+    return (!(state & kActive) && (state & kUserMask) == 1) ? 1 : 0;
+}
+
+int StreamHandleTable::getUsers(Stream *s)
+{
+    HandleSlot *slot = find(s);
+
+    if (!slot)
+        return -EINVAL;
+
+    return (int)(slot->state.load(std::memory_order_acquire) & kUserMask);
+}
@@ -42,6 +42,7 @@
 #include <algorithm>
 #include <expat.h>
 #include <map>
+#include <unordered_map>
 #include <regex>
 #include <sstream>
 #include "Stream.h"
@@ -112,6 +113,7 @@ typedef enum {
     CUSTOM_CONFIG_SEL,
     HOSTLESS_SEL,
     SIDETONE_MODE_SEL,
+    SELECTOR_TYPE_MAX,
 } selector_type_t;
 
 const std::map<std::string, selector_type_t> selectorstypeLUT {
@@ -145,9 +147,28 @@ struct kvInfo {
 
 struct allKVs {
     std::vector<int> id_type;
+    std::vector<std::string> id_names;
     std::vector<kvInfo> keys_values;
 };
 
+#define KV_INDEX_MAX_SELECTORS 32
+#define KV_INDEX_INVALID_ID UINT32_MAX
+
+struct kvIndexEntry {
+    const uint32_t *selector_ids;  /* interned selector pairs, sorted */
+    uint32_t num_selector_ids;
+    const kvPairs *kv_pairs;
+    uint32_t num_kv_pairs;
+};
+
+/* usecase KV image compiled at init, keyed by stream type / device id */
+struct kvIndex {
+    /* one entry list per <stream>/<device> tag covering the key, in xml order */
+    std::unordered_map<int32_t, std::vector<std::vector<kvIndexEntry>>> kvs;
+    /* de-duplicated selector names of all those tags */
+    std::unordered_map<int32_t, std::vector<std::string>> selectors;
+};
+
 typedef enum {
     TAG_USECASEXML_ROOT,
     TAG_STREAM_SEL,
@@ -181,6 +202,16 @@ protected:
    static std::vector<allKVs> all_streampps;
    static std::vector<allKVs> all_devices;
    static std::vector<allKVs> all_devicepps;
+   static kvIndex stream_kv_index;
+   static kvIndex streampp_kv_index;
+   static kvIndex device_kv_index;
+   static kvIndex devicepp_kv_index;
+   /* selector value -> interned id, per selector type */
+   static std::unordered_map<std::string, uint32_t> selector_ids[SELECTOR_TYPE_MAX];
+   /* the kv indexes point into one of these: built from xml, or cache mapping */
+   static std::vector<uint32_t> kv_image;
+   static void *kv_image_map;
+   static size_t kv_image_map_size;
 
 public:
     void payloadUsbAudioConfig(uint8_t** payload, size_t* size,
@@ -273,14 +304,21 @@ public:
     static void processKVTypeData(struct user_xml_data *data, const XML_Char **attr);
     static void processKVSelectorData(struct user_xml_data *data, const XML_Char **attr);
     static void processGraphKVData(struct user_xml_data *data, const XML_Char **attr);
-    static bool isIdTypeAvailable(int32_t type, std::vector<int32_t>& id_type);
     static void removeDuplicateSelectors(std::vector<std::string> &gkv_selectors);
     static std::vector <std::string> retrieveSelectors(int32_t type,
         std::vector<allKVs> &any_type);
     static std::vector <std::pair<selector_type_t, std::string>> getSelectorValues(
         std::vector<std::string> &selectors, Stream* s, struct pal_device* dAttr);
-    static bool compareSelectorPairs(std::vector <std::pair<selector_type_t, std::string>>
-        &selector_val, std::vector<std::pair<selector_type_t, std::string>> &filled_selector_pairs);
+    static void buildKVImage(std::vector<uint32_t> &image);
+    static int loadKVIndex(const uint32_t *image, size_t num_words);
+    static void releaseKVImage();
+    static kvIndex* getKVIndex(std::vector<allKVs> &any_type);
+    static uint32_t getSelectorId(const std::pair<selector_type_t, std::string> &selector_pair);
+    static bool matchSelectorIds(const uint32_t *selector_ids, uint32_t num_selector_ids,
+        const uint32_t *filled_ids, size_t filled_size);
+    static int getKVCacheKey(const char *xml_file, uint64_t *key);
+    static int loadKVCache(uint64_t key);
+    static void storeKVCache(uint64_t key);
     static int retrieveKVs(std::vector<std::pair<selector_type_t, std::string>>
         &filled_selector_pairs, uint32_t type, std::vector<allKVs> &any_type,
         std::vector<std::pair<int32_t, int32_t>> &keyVector);
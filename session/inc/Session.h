@@ -76,6 +76,37 @@ typedef enum {
 #define MSPP_SOFT_PAUSE_DELAY 150
 #define DEFAULT_RAMP_PERIOD 0x28
 
+/* longest span answered from the model before the DSP is queried again */
+#define SESSION_TIME_MODEL_REFRESH_US 50000
+/* prediction error beyond which the measured rate replaces the estimate */
+#define SESSION_TIME_MODEL_MAX_ERROR_US 1000
+
+/*
+ * Linear model of the SPR session clock against CLOCK_MONOTONIC, anchored
+ * on the last DSP read. Queries within SESSION_TIME_MODEL_REFRESH_US of
+ * the anchor are extrapolated; a paused or stalled graph shows up as a
+ * zero rate between reads. Sessions reset() it on start, stop, pause,
+ * resume, flush and device switch.
+ */
+class SessionTimeModel
+{
+public:
+    SessionTimeModel() { reset(); };
+    void reset();
+    bool predict(struct pal_session_time *stime);
+    void update(struct pal_session_time *stime);
+private:
+    std::mutex lock;
+    bool anchored;
+    bool rateValid;
+    double rate;
+    uint64_t anchorMonoUs;
+    uint64_t anchorSessionUs;
+    uint64_t anchorAbsoluteUs;
+    uint64_t anchorTimestampUs;
+    uint64_t lastSessionUs;
+};
+
 class Stream;
 class ResourceManager;
 class Session
@@ -102,6 +133,7 @@ protected:
     static int extECRefCnt;
     static std::mutex extECMutex;
     bool frontEndIdAllocated = false;
+    SessionTimeModel timeModel;
     int32_t setInitialVolume();
 public:
     bool isMixerEventCbRegd;
@@ -39,7 +39,9 @@
 #include "Session.h"
 #include "PalAudioRoute.h"
 #include "PalCommon.h"
+#include "PalDebugDump.h"
 #include <tinyalsa/asoundlib.h>
+#include <atomic>
 #include <thread>
 #include <mutex>
 
@@ -74,6 +76,9 @@ private:
     uint32_t svaMiid;
     static std::mutex pcmLpmRefCntMtx;
     static int pcmLpmRefCnt;
+    PalDumpFile *pcmTap;
+    static std::atomic<uint32_t> pcmTapCnt;
+    void tapPcm(pal_stream_type_t type, bool isRead, void *data, int size);
 public:
 
     SessionAlsaPcm(std::shared_ptr<ResourceManager> Rm);
@@ -87,9 +87,18 @@ private:
     static struct mixer_ctl *getBeMixerControl(struct mixer *am, std::string beName,
         uint32_t idx);
     static struct mixer_ctl *getStaticMixerControl(struct mixer *am, std::string name);
+    static int readTagModuleInfo(struct mixer *mixer, const char *pcmDeviceName,
+        std::unordered_map<int, uint32_t> &tagMiids);
 public:
     ~SessionAlsaUtils();
     static bool isRxDevice(uint32_t devId);
+    /* cached mixer_get_ctl_by_name() */
+    static struct mixer_ctl *getMixerControl(struct mixer *am, const char *name);
+    /* drop cached controls of am, or of every mixer when am is NULL */
+    static void invalidateMixerControlCache(struct mixer *am);
+    /* drop cached tag -> MIID maps of the given FEs, or of every FE */
+    static void invalidateModuleInstanceIdCache(const std::vector<int> &DevIds);
+    static void invalidateModuleInstanceIdCache();
     static int setMixerCtlData(struct mixer_ctl *ctl, MixerCtlType id, void *data, int size);
     static int getTagMetadata(int32_t tagsent, std::vector <std::pair<int, int>> &tkv, struct agm_tag_config *tagConfig);
     static int getCalMetadata(std::vector <std::pair<int, int>> &ckv, struct agm_cal_config* calConfig);
@@ -102,6 +111,9 @@ public:
                     const std::vector<int> &RxDevIds, const std::vector<int> &TxDevIds,
                     const std::vector<std::pair<int32_t, std::string>> &rxBackEnds,
                     const std::vector<std::pair<int32_t, std::string>> &txBackEnds);
+    static int openPcmPair(unsigned int card, unsigned int rxDevice,
+                    struct pcm_config *rxConfig, unsigned int txDevice,
+                    struct pcm_config *txConfig, struct pcm **pcmRx, struct pcm **pcmTx);
     static int rwACDBTunnel(Stream * streamHandle, std::shared_ptr<ResourceManager> rmHandle,
                     pal_device_id_t deviceId, void *payload, bool isParamWrite, uint32_t instanceId);
     static int close(Stream * s, std::shared_ptr<ResourceManager> rm, const std::vector<int> &DevIds,
@@ -146,6 +146,8 @@ class SoundTriggerEngineGsl : public SoundTriggerEngine {
              listen_model_type *out_model);
     int32_t DeleteFromMergedModel(char **keyphrases, uint32_t num_keyphrases,
              listen_model_type *in_model, listen_model_type *out_model);
+    uint64_t GetModelHash(Stream *s);
+    void GetMergedModelKey(Stream *exclude, std::vector<uint64_t> &key);
     int32_t ConstructAPMPayload(uint32_t param_id, uint8_t** payload,
                                 uint8_t* data, uint32_t data_size);
     int32_t ProcessStartRecognition(Stream *s);
@@ -172,6 +174,7 @@ class SoundTriggerEngineGsl : public SoundTriggerEngine {
     std::vector<uint32_t> updated_cfg_;
     SoundModelInfo *eng_sm_info_;
     bool sm_merged_;
+    std::map<Stream *, uint64_t> sm_hashes_; // content hash of stream models
     int32_t dev_disconnect_count_;
     eng_state_t eng_state_;
     struct detection_engine_config_voice_wakeup wakeup_config_;
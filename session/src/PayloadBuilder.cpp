@@ -44,6 +44,10 @@
 #include "sp_vi.h"
 #include "sp_rx.h"
 #include "fluence_ffv_common_calibration.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 #if defined(FEATURE_IPQ_OPENWRT) || defined(LINUX_ENABLED)
 #define USECASE_XML_FILE "/etc/usecaseKvManager.xml"
@@ -52,6 +56,16 @@
 #endif
 
 #define USECASE_ARRAX_XML_FILE "/vendor/etc/usecaseKvManager_arrax.xml"
+
+/* compiled usecaseKvManager image, mapped while the cache key matches */
+#if defined(FEATURE_IPQ_OPENWRT) || defined(LINUX_ENABLED)
+#define USECASE_KV_CACHE_DIR "/var/lib/pal"
+#else
+#define USECASE_KV_CACHE_DIR "/data/vendor/audio"
+#endif
+#define USECASE_KV_CACHE_FILE USECASE_KV_CACHE_DIR "/usecaseKvManager.bin"
+#define USECASE_KV_CACHE_MAGIC 0x43564b50 /* "PKVC" */
+#define USECASE_KV_CACHE_VERSION 2
 #define PARAM_ID_CHMIXER_COEFF 0x0800101F
 #define CUSTOM_STEREO_NUM_OUT_CH 0x0002
 #define CUSTOM_STEREO_NUM_IN_CH 0x0002
@@ -181,6 +195,14 @@ std::vector<allKVs> PayloadBuilder::all_streams;
 std::vector<allKVs> PayloadBuilder::all_streampps;
 std::vector<allKVs> PayloadBuilder::all_devices;
 std::vector<allKVs> PayloadBuilder::all_devicepps;
+kvIndex PayloadBuilder::stream_kv_index;
+kvIndex PayloadBuilder::streampp_kv_index;
+kvIndex PayloadBuilder::device_kv_index;
+kvIndex PayloadBuilder::devicepp_kv_index;
+std::unordered_map<std::string, uint32_t> PayloadBuilder::selector_ids[SELECTOR_TYPE_MAX];
+std::vector<uint32_t> PayloadBuilder::kv_image;
+void *PayloadBuilder::kv_image_map = nullptr;
+size_t PayloadBuilder::kv_image_map_size = 0;
 
 template <typename T>
 void PayloadBuilder::populateChannelMap(T pcmChannel, uint8_t numChannel)
@@ -737,6 +759,7 @@ void PayloadBuilder:: processKVTypeData(struct user_xml_data *data,const XML_Cha
             for (int i = 0; i < typeNames.size(); i++) {
                 stream_id = ResourceManager::getStreamType(typeNames[i]);
                 sdTypeKV.id_type.push_back(stream_id);
+                sdTypeKV.id_names.push_back(typeNames[i]);
                 PAL_DBG(LOG_TAG, "type name:%s", typeNames[i].c_str());
             }
             if (data->tag == TAG_STREAM_SEL) {
@@ -755,6 +778,7 @@ void PayloadBuilder:: processKVTypeData(struct user_xml_data *data,const XML_Cha
             for (int i = 0; i < typeNames.size(); i++) {
                 dev_id = ResourceManager::getDeviceId(typeNames[i]);
                 sdTypeKV.id_type.push_back(dev_id);
+                sdTypeKV.id_names.push_back(typeNames[i]);
                 PAL_DBG(LOG_TAG, "device ID name:%s", typeNames[i].c_str());
             }
             if (data->tag == TAG_DEVICE_SEL) {
@@ -902,20 +926,26 @@ int PayloadBuilder::init()
     int ret = 0;
     int bytes_read;
     void *buf = NULL;
+    const char *xml_file = USECASE_XML_FILE;
+    uint64_t cache_key = 0;
     struct user_xml_data tag_data;
     memset(&tag_data, 0, sizeof(tag_data));
     all_streams.clear();
     all_streampps.clear();
     all_devices.clear();
     all_devicepps.clear();
+    releaseKVImage();
 
-    if (getSocId() == ARRAX_SOC_ID) {
-        PAL_INFO(LOG_TAG, "XML parsing started %s", USECASE_ARRAX_XML_FILE);
-        file = fopen(USECASE_ARRAX_XML_FILE, "r");
-    } else {
-        PAL_INFO(LOG_TAG, "XML parsing started %s", USECASE_XML_FILE);
-        file = fopen(USECASE_XML_FILE, "r");
+    if (getSocId() == ARRAX_SOC_ID)
+        xml_file = USECASE_ARRAX_XML_FILE;
+
+    if (!getKVCacheKey(xml_file, &cache_key) && !loadKVCache(cache_key)) {
+        PAL_INFO(LOG_TAG, "usecase KVs mapped from %s", USECASE_KV_CACHE_FILE);
+        goto done;
     }
+
+    PAL_INFO(LOG_TAG, "XML parsing started %s", xml_file);
+    file = fopen(xml_file, "r");
     if (!file) {
         PAL_ERR(LOG_TAG, "Failed to open xml");
         ret = -EINVAL;
@@ -959,10 +989,448 @@ freeParser:
     XML_ParserFree(parser);
 closeFile:
     fclose(file);
+    buildKVImage(kv_image);
+    if (!ret && cache_key)
+        storeKVCache(cache_key);
+    loadKVIndex(kv_image.data(), kv_image.size());
+    /* the index points into kv_image, the parsed tables are no longer used */
+    std::vector<allKVs>().swap(all_streams);
+    std::vector<allKVs>().swap(all_streampps);
+    std::vector<allKVs>().swap(all_devices);
+    std::vector<allKVs>().swap(all_devicepps);
 done:
     return ret;
 }
 
+kvIndex* PayloadBuilder::getKVIndex(std::vector<allKVs> &any_type)
+{
+    if (&any_type == &all_streams)
+        return &stream_kv_index;
+    if (&any_type == &all_streampps)
+        return &streampp_kv_index;
+    if (&any_type == &all_devices)
+        return &device_kv_index;
+    if (&any_type == &all_devicepps)
+        return &devicepp_kv_index;
+
+    PAL_ERR(LOG_TAG, "no kv index for table %pK", &any_type);
+    return nullptr;
+}
+
+uint32_t PayloadBuilder::getSelectorId(
+    const std::pair<selector_type_t, std::string> &selector_pair)
+{
+    if (selector_pair.first <= 0 || selector_pair.first >= SELECTOR_TYPE_MAX)
+        return KV_INDEX_INVALID_ID;
+
+    auto it = selector_ids[selector_pair.first].find(selector_pair.second);
+    if (it == selector_ids[selector_pair.first].end())
+        return KV_INDEX_INVALID_ID;
+
+    return it->second;
+}
+
+/*
+ * Usecase KV image
+ *
+ * The parsed tables are compiled into one flat image of 32 bit words:
+ *
+ *   u32 num_ids, then per interned selector:
+ *       str selector type, str value, u32 id
+ *   for stream, streampp, device and devicepp in turn:
+ *       u32 num_records, then per <stream>/<device> tag and type:
+ *           str type, u32 num_selector_names, str selector_names[]
+ *           u32 num_entries, then per entry:
+ *               u32 num_ids, u32 ids[] (sorted)
+ *               u32 num_kvs, u32 {key, value}[]
+ *
+ * where str is a u32 length followed by the bytes padded to a word. The
+ * kvIndex entries point at the ids and kv pairs inside the image, so the
+ * image mapped from the cache file is used in place and only the type
+ * and selector names are decoded at boot. Types and selector types are
+ * stored by name and resolved again on load, so the image survives
+ * PalDefs.h renumbering.
+ */
+static_assert(sizeof(struct kvPairs) == 2 * sizeof(uint32_t), "kvPairs not packed");
+
+static void kvImagePutU32(std::vector<uint32_t> &out, uint32_t val)
+{
+    out.push_back(val);
+}
+
+static void kvImagePutString(std::vector<uint32_t> &out, const std::string &str)
+{
+    size_t pos = 0;
+
+    kvImagePutU32(out, str.size());
+    pos = out.size();
+    out.resize(pos + (str.size() + sizeof(uint32_t) - 1) / sizeof(uint32_t), 0);
+    memcpy(out.data() + pos, str.data(), str.size());
+}
+
+static std::string kvImageSelectorName(selector_type_t type)
+{
+    for (auto &sel : selectorstypeLUT) {
+        if (sel.second == type)
+            return sel.first;
+    }
+    return std::string();
+}
+
+struct kvImageReader {
+    const uint32_t *pos;
+    const uint32_t *end;
+
+    const uint32_t *getWords(size_t num) {
+        const uint32_t *words = pos;
+
+        if ((size_t)(end - pos) < num)
+            return nullptr;
+        pos += num;
+        return words;
+    }
+
+    bool getU32(uint32_t *val) {
+        const uint32_t *word = getWords(1);
+
+        if (!word)
+            return false;
+        *val = *word;
+        return true;
+    }
+
+    bool getString(std::string *str) {
+        uint32_t len = 0;
+        const uint32_t *words = nullptr;
+
+        if (!getU32(&len))
+            return false;
+        words = getWords(((size_t)len + sizeof(uint32_t) - 1) / sizeof(uint32_t));
+        if (!words)
+            return false;
+        str->assign((const char *)words, len);
+        return true;
+    }
+};
+
+void PayloadBuilder::buildKVImage(std::vector<uint32_t> &image)
+{
+    std::vector<allKVs> *tables[] = {&all_streams, &all_streampps,
+                                     &all_devices, &all_devicepps};
+    std::map<std::pair<selector_type_t, std::string>, uint32_t> ids;
+    uint32_t next_id[SELECTOR_TYPE_MAX] = {0};
+    std::vector<uint32_t> records;
+    std::vector<uint32_t> entry_ids;
+    size_t count_pos = 0;
+    uint32_t num_names = 0;
+    uint32_t id = 0;
+
+    for (auto table : tables) {
+        count_pos = records.size();
+        kvImagePutU32(records, 0);
+        for (auto &kvs : *table) {
+            for (size_t t = 0; t < kvs.id_type.size(); t++) {
+                /* a tag listing the same type twice is only matched once */
+                if (std::find(kvs.id_type.begin(), kvs.id_type.begin() + t,
+                        kvs.id_type[t]) != kvs.id_type.begin() + t)
+                    continue;
+
+                records[count_pos]++;
+                kvImagePutString(records, kvs.id_names[t]);
+                num_names = 0;
+                for (auto &info : kvs.keys_values)
+                    num_names += info.selector_names.size();
+                kvImagePutU32(records, num_names);
+                for (auto &info : kvs.keys_values) {
+                    for (auto &name : info.selector_names)
+                        kvImagePutString(records, name);
+                }
+
+                kvImagePutU32(records, kvs.keys_values.size());
+                for (auto &info : kvs.keys_values) {
+                    entry_ids.clear();
+                    for (auto &pair : info.selector_pairs) {
+                        /* ids are unique across types: type in the top byte */
+                        id = ((uint32_t)pair.first << 24) | next_id[pair.first];
+                        auto it = ids.emplace(pair, id);
+                        if (it.second)
+                            next_id[pair.first]++;
+                        entry_ids.push_back(it.first->second);
+                    }
+                    std::sort(entry_ids.begin(), entry_ids.end());
+                    kvImagePutU32(records, entry_ids.size());
+                    records.insert(records.end(), entry_ids.begin(), entry_ids.end());
+                    kvImagePutU32(records, info.kv_pairs.size());
+                    for (auto &kv : info.kv_pairs) {
+                        kvImagePutU32(records, kv.key);
+                        kvImagePutU32(records, kv.value);
+                    }
+                }
+            }
+        }
+    }
+
+    image.clear();
+    kvImagePutU32(image, ids.size());
+    for (auto &it : ids) {
+        kvImagePutString(image, kvImageSelectorName(it.first.first));
+        kvImagePutString(image, it.first.second);
+        kvImagePutU32(image, it.second);
+    }
+    image.insert(image.end(), records.begin(), records.end());
+    PAL_DBG(LOG_TAG, "usecase KV image %zu bytes", image.size() * sizeof(uint32_t));
+}
+
+int PayloadBuilder::loadKVIndex(const uint32_t *image, size_t num_words)
+{
+    kvIndex *indexes[] = {&stream_kv_index, &streampp_kv_index,
+                          &device_kv_index, &devicepp_kv_index};
+    kvImageReader in = {image, image + num_words};
+    kvIndexEntry entry;
+    const uint32_t *words = nullptr;
+    std::string name, value;
+    uint32_t count = 0, num_records = 0, num_entries = 0, id = 0;
+    int32_t type = 0;
+
+    if (!in.getU32(&count))
+        goto corrupt;
+    for (uint32_t i = 0; i < count; i++) {
+        if (!in.getString(&name) || !in.getString(&value) || !in.getU32(&id) ||
+            selectorstypeLUT.count(name) == 0)
+            goto corrupt;
+        selector_ids[selectorstypeLUT.at(name)].emplace(value, id);
+    }
+
+    for (int t = 0; t < 4; t++) {
+        kvIndex &index = *indexes[t];
+
+        if (!in.getU32(&num_records))
+            goto corrupt;
+        for (uint32_t r = 0; r < num_records; r++) {
+            if (!in.getString(&name))
+                goto corrupt;
+            if (indexes[t] == &device_kv_index || indexes[t] == &devicepp_kv_index)
+                type = ResourceManager::getDeviceId(name);
+            else
+                type = ResourceManager::getStreamType(name);
+
+            std::vector<std::string> &selectors = index.selectors[type];
+            if (!in.getU32(&count))
+                goto corrupt;
+            for (uint32_t i = 0; i < count; i++) {
+                if (!in.getString(&value))
+                    goto corrupt;
+                selectors.push_back(value);
+            }
+
+            if (!in.getU32(&num_entries))
+                goto corrupt;
+            index.kvs[type].emplace_back();
+            std::vector<kvIndexEntry> &group = index.kvs[type].back();
+            group.reserve(num_entries);
+            for (uint32_t e = 0; e < num_entries; e++) {
+                if (!in.getU32(&entry.num_selector_ids) ||
+                    !(entry.selector_ids = in.getWords(entry.num_selector_ids)) ||
+                    !in.getU32(&entry.num_kv_pairs) ||
+                    !(words = in.getWords((size_t)entry.num_kv_pairs * 2)))
+                    goto corrupt;
+                entry.kv_pairs = (const struct kvPairs *)words;
+                group.push_back(entry);
+            }
+        }
+
+        for (auto &it : index.selectors)
+            removeDuplicateSelectors(it.second);
+        PAL_DBG(LOG_TAG, "indexed %zu stream types/device ids", index.kvs.size());
+    }
+
+    if (in.pos != in.end)
+        goto corrupt;
+    return 0;
+
+corrupt:
+    PAL_ERR(LOG_TAG, "corrupt usecase KV image");
+    for (auto index : indexes)
+        *index = kvIndex();
+    for (int i = 0; i < SELECTOR_TYPE_MAX; i++)
+        selector_ids[i].clear();
+    return -EINVAL;
+}
+
+void PayloadBuilder::releaseKVImage()
+{
+    stream_kv_index = kvIndex();
+    streampp_kv_index = kvIndex();
+    device_kv_index = kvIndex();
+    devicepp_kv_index = kvIndex();
+    for (int i = 0; i < SELECTOR_TYPE_MAX; i++)
+        selector_ids[i].clear();
+
+    std::vector<uint32_t>().swap(kv_image);
+    if (kv_image_map) {
+        munmap(kv_image_map, kv_image_map_size);
+        kv_image_map = nullptr;
+        kv_image_map_size = 0;
+    }
+}
+
+struct kvCacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint64_t payload_size;
+};
+
+static void kvCacheHash(uint64_t *hash, const uint8_t *buf, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        *hash ^= buf[i];
+        *hash *= 0x100000001b3ULL;
+    }
+}
+
+static int kvCacheHashFile(uint64_t *hash, const char *path)
+{
+    uint8_t buf[4096];
+    size_t bytes_read = 0;
+    FILE *file = fopen(path, "r");
+
+    if (!file)
+        return -EINVAL;
+    while ((bytes_read = fread(buf, 1, sizeof(buf), file)) > 0)
+        kvCacheHash(hash, buf, bytes_read);
+    fclose(file);
+
+    return 0;
+}
+
+/*
+ * 64 bit FNV-1a over the usecase xml and the sound card name. The card is
+ * part of the key so an image written on one card is never reused on
+ * another. resourcemanager.xml is deliberately left out: nothing in it
+ * feeds the usecase parse, and the stream type, device id and selector
+ * type tables the image depends on are compiled in and resolved by name
+ * on every load.
+ */
+int PayloadBuilder::getKVCacheKey(const char *xml_file, uint64_t *key)
+{
+    const std::string &card = ResourceManager::getSndCardName();
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    if (kvCacheHashFile(&hash, xml_file))
+        return -EINVAL;
+    kvCacheHash(&hash, (const uint8_t *)card.c_str(), card.size() + 1);
+    *key = hash;
+
+    return 0;
+}
+
+int PayloadBuilder::loadKVCache(uint64_t key)
+{
+    int fd = -1;
+    struct stat st;
+    void *addr = MAP_FAILED;
+    struct kvCacheHeader hdr;
+    int ret = -EINVAL;
+
+    fd = open(USECASE_KV_CACHE_FILE, O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+    if (fd < 0)
+        return -ENOENT;
+
+    if (fstat(fd, &st) || st.st_size < sizeof(hdr))
+        goto exit;
+
+    addr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED)
+        goto exit;
+
+    memcpy(&hdr, addr, sizeof(hdr));
+    if (hdr.magic != USECASE_KV_CACHE_MAGIC ||
+        hdr.version != USECASE_KV_CACHE_VERSION ||
+        hdr.key != key ||
+        hdr.payload_size != st.st_size - sizeof(hdr) ||
+        hdr.payload_size % sizeof(uint32_t)) {
+        PAL_INFO(LOG_TAG, "stale usecase KV cache, reparse xml");
+        goto exit;
+    }
+
+    try {
+        ret = loadKVIndex((const uint32_t *)((uint8_t *)addr + sizeof(hdr)),
+                          hdr.payload_size / sizeof(uint32_t));
+    } catch (const std::out_of_range &e) {
+        /* type no longer known to this build */
+        PAL_INFO(LOG_TAG, "usecase KV cache names unknown type, reparse xml");
+        releaseKVImage();
+        ret = -EINVAL;
+    }
+    if (!ret) {
+        /* the index points into the mapping, keep it until the next init */
+        kv_image_map = addr;
+        kv_image_map_size = st.st_size;
+        addr = MAP_FAILED;
+    }
+
+exit:
+    if (addr != MAP_FAILED)
+        munmap(addr, st.st_size);
+    close(fd);
+    return ret;
+}
+
+void PayloadBuilder::storeKVCache(uint64_t key)
+{
+    struct kvCacheHeader hdr;
+    std::string tmp_file = std::string(USECASE_KV_CACHE_FILE) + ".tmp";
+    size_t size = kv_image.size() * sizeof(uint32_t);
+    ssize_t written = 0;
+    size_t offset = 0;
+    int fd = -1;
+
+    hdr.magic = USECASE_KV_CACHE_MAGIC;
+    hdr.version = USECASE_KV_CACHE_VERSION;
+    hdr.key = key;
+    hdr.payload_size = size;
+
+    /* only the PAL owned dir, never a world writable one such as /tmp */
+    if (mkdir(USECASE_KV_CACHE_DIR, 0750) && errno != EEXIST) {
+        PAL_INFO(LOG_TAG, "cannot create %s, %s", USECASE_KV_CACHE_DIR,
+                 strerror(errno));
+        return;
+    }
+
+    /*
+     * Write aside and rename so a crash never leaves a torn cache. A
+     * leftover temp file is removed first, then created exclusively and
+     * never through a symlink.
+     */
+    unlink(tmp_file.c_str());
+    fd = open(tmp_file.c_str(),
+              O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC, 0640);
+    if (fd < 0) {
+        PAL_INFO(LOG_TAG, "cannot create %s, %s", tmp_file.c_str(), strerror(errno));
+        return;
+    }
+    if (write(fd, &hdr, sizeof(hdr)) == sizeof(hdr)) {
+        while (offset < size) {
+            written = write(fd, (uint8_t *)kv_image.data() + offset, size - offset);
+            if (written <= 0)
+                break;
+            offset += written;
+        }
+    }
+    /* the data must be on disk before the rename makes it the cache */
+    if (offset == size && fsync(fd))
+        offset = 0;
+    close(fd);
+
+    if (offset != size || rename(tmp_file.c_str(), USECASE_KV_CACHE_FILE)) {
+        PAL_ERR(LOG_TAG, "failed to store usecase KV cache, %s", strerror(errno));
+        unlink(tmp_file.c_str());
+        return;
+    }
+    PAL_DBG(LOG_TAG, "stored usecase KV cache, %zu bytes", sizeof(hdr) + size);
+}
+
 void PayloadBuilder::payloadTimestamp(std::shared_ptr<std::vector<uint8_t>>& payload,
                                       size_t *size, uint32_t moduleId)
 {
@@ -2249,42 +2717,21 @@ exit:
     return status;
 }
 
-bool PayloadBuilder::compareSelectorPairs(
-    std::vector<std::pair<selector_type_t, std::string>>& selector_pairs,
-    std::vector<std::pair<selector_type_t, std::string>>& filled_selector_pairs)
+bool PayloadBuilder::matchSelectorIds(const uint32_t *selector_ids,
+    uint32_t num_selector_ids, const uint32_t *filled_ids, size_t filled_size)
 {
     int count = 0;
-    bool result = false;
-
-    PAL_DBG(LOG_TAG, "Enter: selector size: %zu filled_sel size: %zu",
-        selector_pairs.size(), filled_selector_pairs.size());
-    if (selector_pairs.size() == filled_selector_pairs.size()) {
-        std::sort(filled_selector_pairs.begin(), filled_selector_pairs.end());
-        std::sort(selector_pairs.begin(), selector_pairs.end());
-        result = std::equal(selector_pairs.begin(), selector_pairs.end(),
-            filled_selector_pairs.begin());
-        if (result) {
-            PAL_DBG(LOG_TAG,"Return True");
-            goto exit;
-        }
-    } else {
-        for (int i = 0; i < filled_selector_pairs.size(); i++) {
-            if (selector_pairs.end() != std::find(selector_pairs.begin(),
-                selector_pairs.end(), filled_selector_pairs[i])) {
-                count++;
-                PAL_DBG(LOG_TAG,"Inside the find loop count=%d", count);
-            }
-        }
-        PAL_DBG(LOG_TAG, "After find count:%d", count);
-        if (filled_selector_pairs.size() == count) {
-            result = true;
-            PAL_DBG(LOG_TAG,"Return True");
-            goto exit;
-        }
+
+    /* both sides sorted: equal sets, or every filled selector listed in the tag */
+    if (num_selector_ids == filled_size)
+        return std::equal(selector_ids, selector_ids + num_selector_ids, filled_ids);
+
+    for (size_t i = 0; i < filled_size; i++) {
+        if (std::binary_search(selector_ids, selector_ids + num_selector_ids,
+                filled_ids[i]))
+            count++;
     }
-exit:
-    PAL_DBG(LOG_TAG, "Exit result: %d", result);
-    return result;
+    return (count == filled_size);
 }
 
 bool PayloadBuilder::findKVs(std::vector<std::pair<selector_type_t, std::string>>
@@ -2292,39 +2739,41 @@ bool PayloadBuilder::findKVs(std::vector<std::pair<selector_type_t, std::string>
     std::vector<std::pair<int, int>> &keyVector)
 {
     bool found = false;
+    uint32_t filled_ids[KV_INDEX_MAX_SELECTORS];
+    size_t filled_size = filled_selector_pairs.size();
+    kvIndex *index = getKVIndex(any_type);
 
-    for (int32_t i = 0; i < any_type.size(); i++) {
-        if (isIdTypeAvailable(type, any_type[i].id_type)) {
-            for (int32_t j = 0; j < any_type[i].keys_values.size(); j++) {
-                if (filled_selector_pairs.empty() != true) {
-                    if (compareSelectorPairs(any_type[i].keys_values[j].selector_pairs,
-                           filled_selector_pairs)) {
-                        for (int32_t k = 0; k < any_type[i].keys_values[j].kv_pairs.size(); k++) {
-                            keyVector.push_back(
-                                std::make_pair(any_type[i].keys_values[j].kv_pairs[k].key,
-                                any_type[i].keys_values[j].kv_pairs[k].value));
-                            PAL_INFO(LOG_TAG, "key: 0x%x value: 0x%x\n",
-                                any_type[i].keys_values[j].kv_pairs[k].key,
-                                any_type[i].keys_values[j].kv_pairs[k].value);
-                        }
-                        found = true;
-                        break;
-                    }
-                } else {
-                    if (any_type[i].keys_values[j].selector_pairs.empty()) {
-                        for (int32_t k = 0; k < any_type[i].keys_values[j].kv_pairs.size(); k++) {
-                            keyVector.push_back(
-                                std::make_pair(any_type[i].keys_values[j].kv_pairs[k].key,
-                                any_type[i].keys_values[j].kv_pairs[k].value));
-                            PAL_INFO(LOG_TAG, "key: 0x%x value: 0x%x\n",
-                                any_type[i].keys_values[j].kv_pairs[k].key,
-                                any_type[i].keys_values[j].kv_pairs[k].value);
-                        }
-                        found = true;
-                        break;
-                    }
-                }
+    if (!index)
+        return found;
+
+    if (filled_size > KV_INDEX_MAX_SELECTORS) {
+        PAL_ERR(LOG_TAG, "too many selectors %zu", filled_size);
+        return found;
+    }
+
+    auto it = index->kvs.find(type);
+    if (it == index->kvs.end())
+        return found;
+
+    for (size_t i = 0; i < filled_size; i++)
+        filled_ids[i] = getSelectorId(filled_selector_pairs[i]);
+    std::sort(filled_ids, filled_ids + filled_size);
+
+    for (auto &group : it->second) {
+        for (auto &entry : group) {
+            if (filled_size ? !matchSelectorIds(entry.selector_ids,
+                                  entry.num_selector_ids, filled_ids, filled_size)
+                            : entry.num_selector_ids)
+                continue;
+
+            for (uint32_t i = 0; i < entry.num_kv_pairs; i++) {
+                keyVector.push_back(std::make_pair(entry.kv_pairs[i].key,
+                    entry.kv_pairs[i].value));
+                PAL_INFO(LOG_TAG, "key: 0x%x value: 0x%x\n", entry.kv_pairs[i].key,
+                    entry.kv_pairs[i].value);
             }
+            found = true;
+            break;
         }
     }
     return found;
@@ -2528,36 +2977,18 @@ void PayloadBuilder::removeDuplicateSelectors(std::vector<std::string> &gkv_sele
     gkv_selectors.erase(end, gkv_selectors.end());
 }
 
-bool PayloadBuilder::isIdTypeAvailable(int32_t type, std::vector<int>& id_type)
-{
-    for (int32_t i = 0; i < id_type.size(); i++) {
-       if (type == id_type[i]){
-           PAL_DBG(LOG_TAG,"idtype :%d passed type :%d", id_type[i], type);
-           return true;
-       }
-    }
-    return false;
-}
-
 std::vector<std::string> PayloadBuilder::retrieveSelectors(int32_t type, std::vector<allKVs> &any_type)
 {
     std::vector<std::string> gkv_selectors;
-    PAL_DBG(LOG_TAG, "Enter: size_of_all :%zu type:%d", any_type.size(), type);
+    kvIndex *index = getKVIndex(any_type);
 
-    /* looping for all keys_and_values selectors and store in the gkv_selectors */
-    for (int32_t i = 0; i < any_type.size(); i++) {
-         if (isIdTypeAvailable(type, any_type[i].id_type)) {
-             PAL_DBG(LOG_TAG, "KeysAndValues_size: %zu", any_type[i].keys_values.size());
-             for(int32_t j = 0; j < any_type[i].keys_values.size(); j++) {
-                 for(int32_t k = 0; k < any_type[i].keys_values[j].selector_names.size(); k++) {
-                     gkv_selectors.push_back(any_type[i].keys_values[j].selector_names[k]);
-                 }
-             }
-         }
-    }
+    PAL_DBG(LOG_TAG, "Enter: size_of_all :%zu type:%d", any_type.size(), type);
+    if (!index)
+        return gkv_selectors;
 
-    if (gkv_selectors.size())
-          removeDuplicateSelectors(gkv_selectors);
+    auto it = index->selectors.find(type);
+    if (it != index->selectors.end())
+        gkv_selectors = it->second;
 
     for (int32_t i = 0; i < gkv_selectors.size(); i++) {
          PAL_DBG(LOG_TAG, "gkv_selectors: %s", gkv_selectors[i].c_str());
@@ -44,12 +44,110 @@
 #include "SessionAlsaVoice.h"
 
 #include <sstream>
+#include <cmath>
+#include <time.h>
 
 struct pcm *Session::pcmEcTx = NULL;
 std::vector<int> Session::pcmDevEcTxIds = {0};
 int Session::extECRefCnt = 0;
 std::mutex Session::extECMutex;
 
+static uint64_t palTimeToUs(const struct pal_time_us &t)
+{
+    return ((uint64_t)t.value_msw << 32) | t.value_lsw;
+}
+
+static void usToPalTime(uint64_t us, struct pal_time_us &t)
+{
+    t.value_lsw = (uint32_t)us;
+    t.value_msw = (uint32_t)(us >> 32);
+}
+
+static uint64_t monotonicUs()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+void SessionTimeModel::reset()
+{
+    std::lock_guard<std::mutex> guard(lock);
+
+    anchored = false;
+    rateValid = false;
+    rate = 0;
+    anchorMonoUs = 0;
+    anchorSessionUs = 0;
+    anchorAbsoluteUs = 0;
+    anchorTimestampUs = 0;
+    lastSessionUs = 0;
+}
+
+bool SessionTimeModel::predict(struct pal_session_time *stime)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    uint64_t elapsedUs = 0;
+    uint64_t sessionUs = 0;
+    uint64_t progressUs = 0;
+
+    if (!rateValid)
+        return false;
+
+    elapsedUs = monotonicUs() - anchorMonoUs;
+    if (elapsedUs >= SESSION_TIME_MODEL_REFRESH_US)
+        return false;
+
+    progressUs = (uint64_t)(rate * elapsedUs);
+    sessionUs = std::max(anchorSessionUs + progressUs, lastSessionUs);
+    lastSessionUs = sessionUs;
+
+    usToPalTime(sessionUs, stime->session_time);
+    usToPalTime(anchorAbsoluteUs + elapsedUs, stime->absolute_time);
+    usToPalTime(anchorTimestampUs + progressUs, stime->timestamp);
+
+    return true;
+}
+
+/* feeds a DSP read into the model; keeps reported session time monotonic */
+void SessionTimeModel::update(struct pal_session_time *stime)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    uint64_t nowUs = monotonicUs();
+    uint64_t sessionUs = palTimeToUs(stime->session_time);
+    uint64_t elapsedUs = nowUs - anchorMonoUs;
+    double measured = 0;
+    double predicted = 0;
+
+    if (anchored && elapsedUs && sessionUs >= anchorSessionUs) {
+        measured = (double)(sessionUs - anchorSessionUs) / elapsedUs;
+        measured = std::min(measured, 1.1);
+        predicted = anchorSessionUs + rate * elapsedUs;
+        if (rateValid && std::abs(predicted - (double)sessionUs) <
+                SESSION_TIME_MODEL_MAX_ERROR_US)
+            rate += (measured - rate) / 4;
+        else
+            rate = measured;
+        rateValid = true;
+    } else {
+        /* first read, or the session clock went backwards */
+        rateValid = false;
+        lastSessionUs = 0;
+    }
+
+    anchored = true;
+    anchorMonoUs = nowUs;
+    anchorSessionUs = sessionUs;
+    anchorAbsoluteUs = palTimeToUs(stime->absolute_time);
+    anchorTimestampUs = palTimeToUs(stime->timestamp);
+
+    if (sessionUs < lastSessionUs)
+        usToPalTime(lastSessionUs, stime->session_time);
+    else
+        lastSessionUs = sessionUs;
+}
+
 Session::Session()
 {
     isMixerEventCbRegd = false;
@@ -805,6 +805,8 @@ int SessionAlsaCompress::disconnectSessionDevice(Stream* streamHandle, pal_strea
     std::vector<std::pair<int32_t, std::string>> txAifBackEndsToDisconnect;
     int32_t status = 0;
 
+    timeModel.reset();
+
     deviceList.push_back(deviceToDisconnect);
     rm->getBackEndNames(deviceList, rxAifBackEndsToDisconnect,
             txAifBackEndsToDisconnect);
@@ -883,6 +885,8 @@ int SessionAlsaCompress::connectSessionDevice(Stream* streamHandle, pal_stream_t
     std::vector<std::pair<int32_t, std::string>> txAifBackEndsToConnect;
     int32_t status = 0;
 
+    timeModel.reset();
+
     deviceList.push_back(deviceToConnect);
     rm->getBackEndNames(deviceList, rxAifBackEndsToConnect,
             txAifBackEndsToConnect);
@@ -951,7 +955,7 @@ int SessionAlsaCompress::setTKV(Stream * s __unused, configType type, effect_pal
                 goto exit;
             }
             tagCntrlName<<stream<<compressDevIds.at(0)<<" "<<setParamTagControl;
-            ctl = mixer_get_ctl_by_name(mixer, tagCntrlName.str().data());
+            ctl = SessionAlsaUtils::getMixerControl(mixer, tagCntrlName.str().data());
             if (!ctl) {
                 PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", tagCntrlName.str().data());
                 status = -ENOENT;
@@ -1024,7 +1028,7 @@ int SessionAlsaCompress::setConfig(Stream * s, configType type, uint32_t tag1,
                 goto exit;
             }
             tagCntrlName << stream << compressDevIds.at(0) << " " << setParamTagControl;
-            ctl = mixer_get_ctl_by_name(mixer, tagCntrlName.str().data());
+            ctl = SessionAlsaUtils::getMixerControl(mixer, tagCntrlName.str().data());
             if (!ctl) {
                 PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", tagCntrlName.str().data());
                 status = -ENOENT;
@@ -1070,6 +1074,9 @@ int SessionAlsaCompress::setConfig(Stream * s, configType type, int tag)
     int tkv_size = 0;
     int ckv_size = 0;
 
+    if (tag == PAUSE_TAG || tag == RESUME_TAG)
+        timeModel.reset();
+
     PAL_DBG(LOG_TAG, "Enter");
     status = s->getStreamAttributes(&sAttr);
     if (0 != status) {
@@ -1086,7 +1093,7 @@ int SessionAlsaCompress::setConfig(Stream * s, configType type, int tag)
     if (compressDevIds.size() > 0)
         beCntrlName<<stream<<compressDevIds.at(0)<<" "<<setBEControl;
 
-    ctl = mixer_get_ctl_by_name(mixer, beCntrlName.str().data());
+    ctl = SessionAlsaUtils::getMixerControl(mixer, beCntrlName.str().data());
     if (!ctl) {
         PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", beCntrlName.str().data());
         return -ENOENT;
@@ -1122,7 +1129,7 @@ int SessionAlsaCompress::setConfig(Stream * s, configType type, int tag)
             }
             //TODO: how to get the id '5'
             tagCntrlName<<stream<<compressDevIds.at(0)<<" "<<setParamTagControl;
-            ctl = mixer_get_ctl_by_name(mixer, tagCntrlName.str().data());
+            ctl = SessionAlsaUtils::getMixerControl(mixer, tagCntrlName.str().data());
             if (!ctl) {
                 PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", tagCntrlName.str().data());
                 return -ENOENT;
@@ -1161,7 +1168,7 @@ int SessionAlsaCompress::setConfig(Stream * s, configType type, int tag)
             status = SessionAlsaUtils::getCalMetadata(ckv, calConfig);
             //TODO: how to get the id '0'
             calCntrlName<<stream<<compressDevIds.at(0)<<" "<<setCalibrationControl;
-            ctl = mixer_get_ctl_by_name(mixer, calCntrlName.str().data());
+            ctl = SessionAlsaUtils::getMixerControl(mixer, calCntrlName.str().data());
             if (!ctl) {
                 PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", calCntrlName.str().data());
                 return -ENOENT;
@@ -1251,6 +1258,8 @@ int SessionAlsaCompress::start(Stream * s)
     struct sessionToPayloadParam streamData;
     memset(&streamData, 0, sizeof(struct sessionToPayloadParam));
 
+    timeModel.reset();
+
     PAL_DBG(LOG_TAG, "Enter");
 
     rm->voteSleepMonitor(s, true);
@@ -1446,6 +1455,8 @@ int SessionAlsaCompress::pause(Stream * s )
 {
     int32_t status = 0;
 
+    timeModel.reset();
+
     PAL_DBG(LOG_TAG, "Enter");
 
     if (compress && playback_started) {
@@ -1461,6 +1472,8 @@ int SessionAlsaCompress::resume(Stream * s __unused)
 {
     int32_t status = 0;
 
+    timeModel.reset();
+
     PAL_DBG(LOG_TAG, "Enter");
 
     if (compress && playback_paused) {
@@ -1479,6 +1492,8 @@ int SessionAlsaCompress::stop(Stream * s __unused)
     struct agm_event_reg_cfg event_cfg;
     struct pal_stream_attributes sAttr;
 
+    timeModel.reset();
+
     PAL_DBG(LOG_TAG, "Enter");
     status = s->getStreamAttributes(&sAttr);
     if (status != 0) {
@@ -1747,7 +1762,7 @@ struct mixer_ctl* SessionAlsaCompress::getFEMixerCtl(const char *controlName, in
 
     *device = compressDevIds.at(0);
     CntrlName << "COMPRESS" << compressDevIds.at(0) << " " << controlName;
-    ctl = mixer_get_ctl_by_name(mixer, CntrlName.str().data());
+    ctl = SessionAlsaUtils::getMixerControl(mixer, CntrlName.str().data());
     if (!ctl) {
         PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", CntrlName.str().data());
         return nullptr;
@@ -1983,6 +1998,8 @@ int SessionAlsaCompress::flush()
     int status = 0;
     PAL_VERBOSE(LOG_TAG, "Enter flush");
 
+    timeModel.reset();
+
     if (playback_started) {
         if (compressDevIds.size() > 0) {
             status = SessionAlsaUtils::flush(rm, compressDevIds.at(0));
@@ -2000,6 +2017,8 @@ int SessionAlsaCompress::drain(pal_drain_type_t type)
 {
     std::shared_ptr<offload_msg> msg;
 
+    timeModel.reset();
+
     if (!compress) {
        PAL_ERR(LOG_TAG, "compress is invalid");
        return -EINVAL;
@@ -2042,11 +2061,15 @@ int SessionAlsaCompress::getParameters(Stream *s __unused, int tagId __unused, u
 int SessionAlsaCompress::getTimestamp(struct pal_session_time *stime)
 {
     int status = 0;
+
+    if (timeModel.predict(stime))
+        return status;
     status = SessionAlsaUtils::getTimestamp(mixer, compressDevIds, spr_miid, stime);
     if (0 != status) {
        PAL_ERR(LOG_TAG, "getTimestamp failed status = %d", status);
        return status;
     }
+    timeModel.update(stime);
     return status;
 }
 
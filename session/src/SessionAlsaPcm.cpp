@@ -67,6 +67,7 @@
 #include "SessionAlsaUtils.h"
 #include "Stream.h"
 #include "ResourceManager.h"
+#include "PalLatencyTrace.h"
 #include "detection_cmn_api.h"
 #include "acd_api.h"
 #include <agm/agm_api.h>
@@ -81,6 +82,7 @@
 
 std::mutex SessionAlsaPcm::pcmLpmRefCntMtx;
 int SessionAlsaPcm::pcmLpmRefCnt = 0;
+std::atomic<uint32_t> SessionAlsaPcm::pcmTapCnt(0);
 
 #define SESSION_ALSA_MMAP_DEFAULT_OUTPUT_SAMPLING_RATE (48000)
 #define SESSION_ALSA_MMAP_PERIOD_SIZE (SESSION_ALSA_MMAP_DEFAULT_OUTPUT_SAMPLING_RATE/1000)
@@ -99,6 +101,7 @@ SessionAlsaPcm::SessionAlsaPcm(std::shared_ptr<ResourceManager> Rm)
    pcm = NULL;
    pcmRx = NULL;
    pcmTx = NULL;
+   pcmTap = NULL;
    mState = SESSION_IDLE;
    ecRefDevId = PAL_DEVICE_OUT_MIN;
    streamHandle = NULL;
@@ -303,7 +306,7 @@ int SessionAlsaPcm::setConfig(Stream * s, configType type, uint32_t tag1,
                 status = -EINVAL;
                 goto exit;
             }
-            ctl = mixer_get_ctl_by_name(mixer, tagCntrlName.str().data());
+            ctl = SessionAlsaUtils::getMixerControl(mixer, tagCntrlName.str().data());
             if (!ctl) {
                 PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", tagCntrlName.str().data());
                 return -ENOENT;
@@ -343,7 +346,7 @@ struct mixer_ctl* SessionAlsaPcm::getFEMixerCtl(const char *controlName, int *de
 
     *device = pcmDevIds.at(0);
     CntrlName << "PCM" <<pcmDevIds.at(0) << " " << controlName;
-    ctl = mixer_get_ctl_by_name(mixer, CntrlName.str().data());
+    ctl = SessionAlsaUtils::getMixerControl(mixer, CntrlName.str().data());
     if (!ctl) {
         PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", CntrlName.str().data());
         return nullptr;
@@ -457,6 +460,9 @@ int SessionAlsaPcm::setConfig(Stream * s, configType type, int tag)
     int tag_config_size = 0;
     int cal_config_size = 0;
 
+    if (tag == PAUSE_TAG || tag == RESUME_TAG)
+        timeModel.reset();
+
     status = s->getStreamAttributes(&sAttr);
     if (status != 0) {
         PAL_ERR(LOG_TAG, "stream get attributes failed");
@@ -480,7 +486,7 @@ int SessionAlsaPcm::setConfig(Stream * s, configType type, int tag)
                 beCntrlName << stream << pcmDevIds.at(0) << " " << setBEControl;
         }
 
-        ctl = mixer_get_ctl_by_name(mixer, beCntrlName.str().data());
+        ctl = SessionAlsaUtils::getMixerControl(mixer, beCntrlName.str().data());
         if (!ctl) {
             PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", beCntrlName.str().data());
             return -ENOENT;
@@ -531,7 +537,7 @@ int SessionAlsaPcm::setConfig(Stream * s, configType type, int tag)
                 goto exit;
             }
 
-            ctl = mixer_get_ctl_by_name(mixer, tagCntrlName.str().data());
+            ctl = SessionAlsaUtils::getMixerControl(mixer, tagCntrlName.str().data());
             if (!ctl) {
                 PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", tagCntrlName.str().data());
                 status = -ENOENT;
@@ -581,7 +587,7 @@ int SessionAlsaPcm::setConfig(Stream * s, configType type, int tag)
                 goto exit;
             }
 
-            ctl = mixer_get_ctl_by_name(mixer, calCntrlName.str().data());
+            ctl = SessionAlsaUtils::getMixerControl(mixer, calCntrlName.str().data());
             if (!ctl) {
                 PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", calCntrlName.str().data());
                 status = -ENOENT;
@@ -698,7 +704,7 @@ int SessionAlsaPcm::setTKV(Stream * s, configType type, effect_pal_payload_t *ef
                 goto exit;
             }
 
-            ctl = mixer_get_ctl_by_name(mixer, tagCntrlName.str().data());
+            ctl = SessionAlsaUtils::getMixerControl(mixer, tagCntrlName.str().data());
             if (!ctl) {
                 PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", tagCntrlName.str().data());
                 status = -ENOENT;
@@ -868,6 +874,9 @@ int SessionAlsaPcm::start(Stream * s)
     struct volume_set_param_info vol_set_param_info;
     uint16_t volSize = 0;
     uint8_t *volPayload = nullptr;
+    uint64_t traceStartNs = 0;
+
+    timeModel.reset();
 
     PAL_DBG(LOG_TAG, "Enter");
 
@@ -903,6 +912,7 @@ int SessionAlsaPcm::start(Stream * s)
         config.stop_threshold = 0;
         config.silence_threshold = 0;
 
+        traceStartNs = PalLatencyTrace::now();
         switch(sAttr.direction) {
             case PAL_AUDIO_INPUT:
                 if (pcmDevIds.size() == 0) {
@@ -970,32 +980,17 @@ int SessionAlsaPcm::start(Stream * s)
                     status = -EINVAL;
                     goto exit;
                 }
-                pcmRx = pcm_open(rm->getVirtualSndCard(), pcmDevRxIds.at(0), PCM_OUT, &config);
-                if (!pcmRx) {
-                    PAL_ERR(LOG_TAG, "pcm-rx open failed");
-                    status = errno;
-                    goto exit;
-                }
-
-                if (!pcm_is_ready(pcmRx)) {
-                    PAL_ERR(LOG_TAG, "pcm-rx open not ready");
-                    status = errno;
-                    goto exit;
-                }
-                pcmTx = pcm_open(rm->getVirtualSndCard(), pcmDevTxIds.at(0), PCM_IN, &config);
-                if (!pcmTx) {
-                    PAL_ERR(LOG_TAG, "pcm-tx open failed");
-                    status = errno;
-                    goto exit;
-                }
-
-                if (!pcm_is_ready(pcmTx)) {
-                    PAL_ERR(LOG_TAG, "pcm-tx open not ready");
-                    status = errno;
+                status = SessionAlsaUtils::openPcmPair(rm->getVirtualSndCard(),
+                                                       pcmDevRxIds.at(0), &config,
+                                                       pcmDevTxIds.at(0), &config,
+                                                       &pcmRx, &pcmTx);
+                if (status) {
+                    PAL_ERR(LOG_TAG, "pcm-rx/tx open failed %d", status);
                     goto exit;
                 }
                 break;
         }
+        PalLatencyTrace::record(PAL_TRACE_PCM_OPEN, traceStartNs);
         mState = SESSION_OPENED;
 
         if (SessionAlsaUtils::isMmapUsecase(sAttr) &&
@@ -1237,7 +1232,9 @@ set_mixer:
             }
 
             if (pcm) {
+                traceStartNs = PalLatencyTrace::now();
                 status = pcm_start(pcm);
+                PalLatencyTrace::record(PAL_TRACE_PCM_START, traceStartNs);
                 if (status) {
                     status = errno;
                     PAL_ERR(LOG_TAG, "pcm_start failed %d", status);
@@ -1302,7 +1299,9 @@ pcm_start:
             }
 
             if (pcm) {
+                traceStartNs = PalLatencyTrace::now();
                 status = pcm_start(pcm);
+                PalLatencyTrace::record(PAL_TRACE_PCM_START, traceStartNs);
                 if (status) {
                     status = errno;
                     PAL_ERR(LOG_TAG, "pcm_start failed %d", status);
@@ -1377,14 +1376,18 @@ pcm_start:
             }
 
             if (pcmRx) {
+                traceStartNs = PalLatencyTrace::now();
                 status = pcm_start(pcmRx);
+                PalLatencyTrace::record(PAL_TRACE_PCM_START, traceStartNs);
                 if (status) {
                     status = errno;
                     PAL_ERR(LOG_TAG, "pcm_start rx failed %d", status);
                 }
             }
             if (pcmTx) {
+                traceStartNs = PalLatencyTrace::now();
                 status = pcm_start(pcmTx);
+                PalLatencyTrace::record(PAL_TRACE_PCM_START, traceStartNs);
                 if (status) {
                     status = errno;
                     PAL_ERR(LOG_TAG, "pcm_start tx failed %d", status);
@@ -1413,6 +1416,9 @@ int SessionAlsaPcm::stop(Stream * s)
     int payload_size = 0;
     int tagId;
     int DeviceId;
+    uint64_t traceStartNs = 0;
+
+    timeModel.reset();
 
     PAL_DBG(LOG_TAG, "Enter");
     status = s->getStreamAttributes(&sAttr);
@@ -1423,7 +1429,9 @@ int SessionAlsaPcm::stop(Stream * s)
     switch (sAttr.direction) {
         case PAL_AUDIO_INPUT:
             if (pcm && isActive()) {
+                traceStartNs = PalLatencyTrace::now();
                 status = pcm_stop(pcm);
+                PalLatencyTrace::record(PAL_TRACE_PCM_STOP, traceStartNs);
                 if (status) {
                     status = errno;
                     PAL_ERR(LOG_TAG, "pcm_stop failed %d", status);
@@ -1432,7 +1440,9 @@ int SessionAlsaPcm::stop(Stream * s)
         break;
         case PAL_AUDIO_OUTPUT:
             if (pcm && isActive()) {
+                traceStartNs = PalLatencyTrace::now();
                 status = pcm_stop(pcm);
+                PalLatencyTrace::record(PAL_TRACE_PCM_STOP, traceStartNs);
                 if (status) {
                     status = errno;
                     PAL_ERR(LOG_TAG, "pcm_stop failed %d", status);
@@ -1468,14 +1478,18 @@ int SessionAlsaPcm::stop(Stream * s)
             break;
         case PAL_AUDIO_INPUT | PAL_AUDIO_OUTPUT:
             if (pcmRx && isActive()) {
+                traceStartNs = PalLatencyTrace::now();
                 status = pcm_stop(pcmRx);
+                PalLatencyTrace::record(PAL_TRACE_PCM_STOP, traceStartNs);
                 if (status) {
                     status = errno;
                     PAL_ERR(LOG_TAG, "pcm_stop - rx failed %d", status);
                 }
             }
             if (pcmTx && isActive()) {
+                traceStartNs = PalLatencyTrace::now();
                 status = pcm_stop(pcmTx);
+                PalLatencyTrace::record(PAL_TRACE_PCM_STOP, traceStartNs);
                 if (status) {
                     status = errno;
                     PAL_ERR(LOG_TAG, "pcm_stop - tx failed %d", status);
@@ -1555,6 +1569,7 @@ int SessionAlsaPcm::close(Stream * s)
     std::vector<int> pcmId;
     struct disable_lpm_info lpm_info;
     bool isStreamAvail = false;
+    uint64_t traceStartNs = 0;
 
     PAL_DBG(LOG_TAG, "Enter");
     if (!frontEndIdAllocated) {
@@ -1599,8 +1614,11 @@ int SessionAlsaPcm::close(Stream * s)
             if (SessionAlsaUtils::isMmapUsecase(sAttr) &&
                 !(sAttr.flags & PAL_STREAM_FLAG_MMAP_NO_IRQ_MASK))
                 deRegisterAdmStream(s);
-            if (pcm)
+            if (pcm) {
+                traceStartNs = PalLatencyTrace::now();
                 status = pcm_close(pcm);
+                PalLatencyTrace::record(PAL_TRACE_PCM_CLOSE, traceStartNs);
+            }
             if (status) {
                 status = errno;
                 PAL_ERR(LOG_TAG, "pcm_close failed %d", status);
@@ -1651,8 +1669,11 @@ int SessionAlsaPcm::close(Stream * s)
                 PAL_DBG(LOG_TAG, "pcm_close pcmLpmRefCnt %d", pcmLpmRefCnt);
             }
 
-            if (pcm)
+            if (pcm) {
+                traceStartNs = PalLatencyTrace::now();
                 status = pcm_close(pcm);
+                PalLatencyTrace::record(PAL_TRACE_PCM_CLOSE, traceStartNs);
+            }
             if (status) {
                 status = errno;
                 PAL_ERR(LOG_TAG, "pcm_close failed %d", status);
@@ -1690,14 +1711,20 @@ int SessionAlsaPcm::close(Stream * s)
             if (status) {
                 PAL_ERR(LOG_TAG, "session alsa close failed with %d", status);
             }
-            if (pcmRx)
+            if (pcmRx) {
+                traceStartNs = PalLatencyTrace::now();
                 status = pcm_close(pcmRx);
+                PalLatencyTrace::record(PAL_TRACE_PCM_CLOSE, traceStartNs);
+            }
             if (status) {
                 status = errno;
                 PAL_ERR(LOG_TAG, "pcm_close - rx failed %d", status);
             }
-            if (pcmTx)
+            if (pcmTx) {
+                traceStartNs = PalLatencyTrace::now();
                 status = pcm_close(pcmTx);
+                PalLatencyTrace::record(PAL_TRACE_PCM_CLOSE, traceStartNs);
+            }
             if (status) {
                 status = errno;
                PAL_ERR(LOG_TAG, "pcm_close - tx failed %d", status);
@@ -1742,6 +1769,10 @@ int SessionAlsaPcm::close(Stream * s)
         eventId = 0;
     }
 exit:
+    if (pcmTap) {
+        PalDebugDump::close(pcmTap);
+        pcmTap = NULL;
+    }
     ecRefDevId = PAL_DEVICE_OUT_MIN;
     PAL_DBG(LOG_TAG, "Exit status: %d", status);
     return status;
@@ -1757,6 +1788,8 @@ int SessionAlsaPcm::disconnectSessionDevice(Stream *streamHandle,
     std::vector<std::pair<int32_t, std::string>> txAifBackEndsToDisconnect;
     int32_t status = 0;
 
+    timeModel.reset();
+
     deviceList.push_back(deviceToDisconnect);
     rm->getBackEndNames(deviceList, rxAifBackEndsToDisconnect,
             txAifBackEndsToDisconnect);
@@ -1844,6 +1877,8 @@ int SessionAlsaPcm::connectSessionDevice(Stream* streamHandle, pal_stream_type_t
     size_t payloadSize = 0;
     struct pal_stream_attributes sAttr;
 
+    timeModel.reset();
+
     deviceList.push_back(deviceToConnect);
     rm->getBackEndNames(deviceList, rxAifBackEndsToConnect,
             txAifBackEndsToConnect);
@@ -1959,6 +1994,8 @@ int SessionAlsaPcm::read(Stream *s, int tag __unused, struct pal_buffer *buf, in
         bytesRead += pcmReadSize;
     }
 
+    if (bytesRead)
+        tapPcm(sAttr.type, true, (char *)buf->buffer + buf->offset, bytesRead);
     *size = bytesRead;
     PAL_VERBOSE(LOG_TAG, "exit bytesRead:%d status:%d ", bytesRead, status);
     return status;
@@ -2056,11 +2093,34 @@ int SessionAlsaPcm::write(Stream *s, int tag, struct pal_buffer *buf, int * size
     }
     bytesWritten += sizeWritten;
     *size = bytesWritten;
+    tapPcm(sAttr.type, false, (char *)buf->buffer + buf->offset, bytesWritten);
 exit:
     PAL_VERBOSE(LOG_TAG, "exit status: %d", status);
     return status;
 }
 
+/*
+ * Copies pcm read/write data to the debug dump writer when the tap of this
+ * stream type is enabled through PAL_PARAM_ID_DEBUG_DUMP. The dump file is
+ * opened on the first tapped buffer and closed with the session.
+ */
+void SessionAlsaPcm::tapPcm(pal_stream_type_t type, bool isRead, void *data,
+                            int size)
+{
+    char path[100];
+
+    if (!PalDebugDump::isPcmTapEnabled(type) || size <= 0)
+        return;
+
+    if (!pcmTap) {
+        snprintf(path, sizeof(path), "%s/pal_pcm_%s_%d_%u.raw",
+                 PAL_DUMP_LOCATION, isRead ? "read" : "write", type,
+                 pcmTapCnt++);
+        pcmTap = PalDebugDump::open(path);
+    }
+    PalDebugDump::write(pcmTap, data, size);
+}
+
 int SessionAlsaPcm::readBufferInit(Stream * /*streamHandle*/, size_t /*noOfBuf*/, size_t /*bufSize*/,
                                    int /*flag*/)
 {
@@ -2596,7 +2656,7 @@ int SessionAlsaPcm::getParameters(Stream *s __unused, int tagId, uint32_t param_
         status = -EINVAL;
         goto exit;
     }
-    ctl = mixer_get_ctl_by_name(mixer, CntrlName.str().data());
+    ctl = SessionAlsaUtils::getMixerControl(mixer, CntrlName.str().data());
     if (!ctl) {
         PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", CntrlName.str().data());
         status = -ENOENT;
@@ -2697,6 +2757,8 @@ int SessionAlsaPcm::getTimestamp(struct pal_session_time *stime)
         status = -EINVAL;
         return status;
     }
+    if (timeModel.predict(stime))
+        return status;
     if (!spr_miid) {
         status = SessionAlsaUtils::getModuleInstanceId(mixer,
                 pcmDevIds.at(0), rxAifBackEnds[0].second.data(),
@@ -2710,6 +2772,8 @@ int SessionAlsaPcm::getTimestamp(struct pal_session_time *stime)
     status = SessionAlsaUtils::getTimestamp(mixer, pcmDevIds, spr_miid, stime);
     if (0 != status)
        PAL_ERR(LOG_TAG, "getTimestamp failed status = %d", status);
+    else
+       timeModel.update(stime);
 
     return status;
 }
@@ -2724,6 +2788,8 @@ int SessionAlsaPcm::flush()
     int status = 0;
     PAL_VERBOSE(LOG_TAG, "Enter flush");
 
+    timeModel.reset();
+
     if (pcmDevIds.size() > 0) {
         status = SessionAlsaUtils::flush(rm, pcmDevIds.at(0));
     } else {
@@ -2925,7 +2991,7 @@ int SessionAlsaPcm::createMmapBuffer(Stream *s, int32_t min_size_frames,
 
 
         CntrlName << stream << pcmDevIds.at(0) << " " << control;
-        ctl = mixer_get_ctl_by_name(mixer, CntrlName.str().data());
+        ctl = SessionAlsaUtils::getMixerControl(mixer, CntrlName.str().data());
         if (!ctl) {
             PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", CntrlName.str().data());
             status = -ENOENT;
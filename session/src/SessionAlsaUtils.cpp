@@ -34,10 +34,20 @@
 #define LOG_TAG "PAL: SessionAlsaUtils"
 
 #include "SessionAlsaUtils.h"
+#include "PalLatencyTrace.h"
 
 #include <sstream>
 #include <string>
 #include <set>
+#include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <system_error>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
 //#include "SessionAlsa.h"
 //#include "SessionAlsaPcm.h"
 //#include "SessionAlsaCompress.h"
@@ -79,6 +89,37 @@ static const char *beCtrlNames[] = {
     " grp config",
 };
 
+/*
+ * mixer_get_ctl_by_name() scans every control of the card, so resolved
+ * controls are kept per mixer until the card goes away or restarts.
+ * Entries are keyed by a hash of the name, so a lookup builds no string,
+ * and a hit is confirmed against the control's own name. Lookups share
+ * the lock; only a miss takes it exclusively.
+ */
+static std::shared_timed_mutex mixerCtlCacheMutex;
+static std::unordered_map<struct mixer *,
+    std::unordered_map<uint64_t, struct mixer_ctl *>> mixerCtlCache;
+static std::atomic<uint64_t> mixerCtlCacheHits(0);
+static uint64_t mixerCtlCacheMisses = 0;
+
+/*
+ * Device start writes backend controls on the shared virtual mixer. With
+ * backend scoped graph locks these writes can come from several streams at
+ * once, and virtual ports of one group also share the group backend control
+ * and the group config of the resource manager. Held only around the writes.
+ */
+static std::mutex beMixerWriteMutex;
+
+/*
+ * tag -> MIID of each FE graph, keyed by the backend the tags were
+ * queried for. Dropped whenever the graph of the FE is opened, closed or
+ * rewired, and for all FEs on SSR.
+ */
+static std::mutex miidCacheMutex;
+static std::map<std::tuple<struct mixer *, int, std::string>,
+    std::unordered_map<int, uint32_t>> miidCache;
+static uint32_t miidCacheGeneration = 0;
+
 struct agmMetaData {
     uint8_t *buf;
     uint32_t size;
@@ -295,27 +336,98 @@ bool SessionAlsaUtils::isMmapUsecase(struct pal_stream_attributes sAttr)
 
 }
 
-struct mixer_ctl *SessionAlsaUtils::getStaticMixerControl(struct mixer *am, std::string name)
+static uint64_t mixerCtlNameHash(const char *name)
 {
-    std::ostringstream cntrlName;
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    /* 64 bit FNV-1a */
+    for (; *name; name++) {
+        hash ^= (uint8_t)*name;
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+static struct mixer_ctl *findCachedMixerCtl(struct mixer *am, uint64_t hash,
+        const char *name)
+{
+    auto ctls = mixerCtlCache.find(am);
+    if (ctls == mixerCtlCache.end())
+        return NULL;
 
-    cntrlName << name;
-    PAL_DBG(LOG_TAG, "mixer control name is %s", cntrlName.str().data());
+    auto it = ctls->second.find(hash);
+    if (it == ctls->second.end() || strcmp(mixer_ctl_get_name(it->second), name))
+        return NULL;
 
-    return mixer_get_ctl_by_name(am, cntrlName.str().data());
+    return it->second;
+}
+
+struct mixer_ctl *SessionAlsaUtils::getMixerControl(struct mixer *am, const char *name)
+{
+    struct mixer_ctl *ctl = NULL;
+    uint64_t hash = 0;
+
+    if (!am || !name)
+        return NULL;
+
+    hash = mixerCtlNameHash(name);
+    {
+        std::shared_lock<std::shared_timed_mutex> lock(mixerCtlCacheMutex);
+
+        ctl = findCachedMixerCtl(am, hash, name);
+    }
+    if (ctl) {
+        mixerCtlCacheHits.fetch_add(1, std::memory_order_relaxed);
+        return ctl;
+    }
+
+    std::lock_guard<std::shared_timed_mutex> lock(mixerCtlCacheMutex);
+    ctl = findCachedMixerCtl(am, hash, name);
+    if (ctl)
+        return ctl;
+
+    ctl = mixer_get_ctl_by_name(am, name);
+    mixerCtlCacheMisses++;
+    /*
+     * Failed lookups are not cached, the control may show up later. A
+     * name whose hash is taken by another control stays uncached too.
+     */
+    if (ctl)
+        mixerCtlCache[am].emplace(hash, ctl);
+
+    return ctl;
+}
+
+void SessionAlsaUtils::invalidateMixerControlCache(struct mixer *am)
+{
+    std::lock_guard<std::shared_timed_mutex> lock(mixerCtlCacheMutex);
+
+    PAL_VERBOSE(LOG_TAG, "mixer ctl cache: %llu hits, %llu misses",
+        (unsigned long long)mixerCtlCacheHits.load(std::memory_order_relaxed),
+        (unsigned long long)mixerCtlCacheMisses);
+    if (am)
+        mixerCtlCache.erase(am);
+    else
+        mixerCtlCache.clear();
+}
+
+struct mixer_ctl *SessionAlsaUtils::getStaticMixerControl(struct mixer *am, std::string name)
+{
+    PAL_DBG(LOG_TAG, "mixer control name is %s", name.c_str());
+
+    return getMixerControl(am, name.c_str());
 }
 
 struct mixer_ctl *SessionAlsaUtils::getFeMixerControl(struct mixer *am, std::string feName,
         uint32_t idx)
 {
-    std::ostringstream cntrlName;
     struct mixer_ctl *ctl = NULL;
 
-    cntrlName << feName << feCtrlNames[idx];
-    PAL_DBG(LOG_TAG, "mixer control %s", cntrlName.str().data());
-    ctl = mixer_get_ctl_by_name(am, cntrlName.str().data());
+    feName += feCtrlNames[idx];
+    PAL_DBG(LOG_TAG, "mixer control %s", feName.c_str());
+    ctl = getMixerControl(am, feName.c_str());
     if (!ctl)
-        PAL_FATAL(LOG_TAG, "invalid mixer control: %s", cntrlName.str().data());
+        PAL_FATAL(LOG_TAG, "invalid mixer control: %s", feName.c_str());
 
     return ctl;
 }
@@ -323,11 +435,9 @@ struct mixer_ctl *SessionAlsaUtils::getFeMixerControl(struct mixer *am, std::str
 struct mixer_ctl *SessionAlsaUtils::getBeMixerControl(struct mixer *am, std::string beName,
         uint32_t idx)
 {
-    std::ostringstream cntrlName;
-
-    cntrlName << beName << beCtrlNames[idx];
-    PAL_DBG(LOG_TAG, "mixer control %s", cntrlName.str().data());
-    return mixer_get_ctl_by_name(am, cntrlName.str().data());
+    beName += beCtrlNames[idx];
+    PAL_DBG(LOG_TAG, "mixer control %s", beName.c_str());
+    return getMixerControl(am, beName.c_str());
 }
 
 int SessionAlsaUtils::open(Stream * streamHandle, std::shared_ptr<ResourceManager> rmHandle,
@@ -358,6 +468,9 @@ int SessionAlsaUtils::open(Stream * streamHandle, std::shared_ptr<ResourceManage
     struct pal_device_info devinfo = {};
     struct pal_device dAttr;
     PayloadBuilder* builder = nullptr;
+    uint64_t traceStartNs = PalLatencyTrace::now();
+
+    invalidateModuleInstanceIdCache(DevIds);
 
     PAL_DBG(LOG_TAG, "Entry \n");
 
@@ -537,6 +650,7 @@ int SessionAlsaUtils::open(Stream * streamHandle, std::shared_ptr<ResourceManage
         streamDeviceMetaData.buf = nullptr;
         deviceMetaData.buf = nullptr;
     }
+    PalLatencyTrace::record(PAL_TRACE_SESSION_METADATA, traceStartNs);
 freeMetaData:
     if (streamDeviceMetaData.buf)
         free(streamDeviceMetaData.buf);
@@ -573,6 +687,8 @@ int SessionAlsaUtils::close(Stream * streamHandle, std::shared_ptr<ResourceManag
     struct mixer_ctl *beMetaDataMixerCtrl = nullptr;
     struct mixer *mixerHandle = nullptr;
 
+    invalidateModuleInstanceIdCache(DevIds);
+
     status = streamHandle->getStreamAttributes(&sAttr);
     if(0 != status) {
         PAL_ERR(LOG_TAG, "getStreamAttributes Failed \n");
@@ -840,6 +956,7 @@ int SessionAlsaUtils::setDeviceCustomPayload(std::shared_ptr<ResourceManager> rm
         return -EINVAL;
     }
 
+    std::lock_guard<std::mutex> lock(beMixerWriteMutex);
     return mixer_ctl_set_array(ctl, payload, size);
 }
 
@@ -917,6 +1034,7 @@ int SessionAlsaUtils::setDeviceMediaConfig(std::shared_ptr<ResourceManager> rmHa
         aif_media_config[3] = AGM_DATA_FORMAT_FIXED_POINT;
     }
 
+    std::lock_guard<std::mutex> lock(beMixerWriteMutex);
     // if it's virtual port, need to set group attribute as well
     if (rmHandle->activeGroupDevConfig &&
         (dAttr->id == PAL_DEVICE_OUT_SPEAKER ||
@@ -991,7 +1109,7 @@ int SessionAlsaUtils::getTimestamp(struct mixer *mixer, const std::vector<int> &
         return -EINVAL;
     }
     CntrlName<<pcmDeviceName<<" "<<getParamControl;
-    ctl = mixer_get_ctl_by_name(mixer, CntrlName.str().data());
+    ctl = getMixerControl(mixer, CntrlName.str().data());
     if (!ctl) {
         PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", CntrlName.str().data());
         return -ENOENT;
@@ -1032,10 +1150,9 @@ exit:
     return status;
 }
 
-int SessionAlsaUtils::getModuleInstanceId(struct mixer *mixer, int device, const char *intf_name,
-                       int tag_id, uint32_t *miid)
+int SessionAlsaUtils::readTagModuleInfo(struct mixer *mixer, const char *pcmDeviceName,
+                       std::unordered_map<int, uint32_t> &tagMiids)
 {
-    char *pcmDeviceName = NULL;
     char const *control = "getTaggedInfo";
     char *mixer_str;
     struct mixer_ctl *ctl;
@@ -1044,17 +1161,6 @@ int SessionAlsaUtils::getModuleInstanceId(struct mixer *mixer, int device, const
     struct gsl_tag_module_info *tag_info;
     struct gsl_tag_module_info_entry *tag_entry;
     int offset = 0;
-    std::shared_ptr<ResourceManager> rm = ResourceManager::getInstance();
-
-    pcmDeviceName = rm->getDeviceNameFromID(device);
-    if(!pcmDeviceName){
-        PAL_ERR(LOG_TAG, "Device name from id %d not found", device);
-        return -EINVAL;
-    }
-
-    ret = setStreamMetadataType(mixer, device, intf_name);
-    if (ret)
-        return ret;
 
     ctl_len = strlen(pcmDeviceName) + 1 + strlen(control) + 1;
     mixer_str = (char *)calloc(1, ctl_len);
@@ -1064,7 +1170,7 @@ int SessionAlsaUtils::getModuleInstanceId(struct mixer *mixer, int device, const
     snprintf(mixer_str, ctl_len, "%s %s", pcmDeviceName, control);
 
     PAL_DBG(LOG_TAG, "- mixer -%s-\n", mixer_str);
-    ctl = mixer_get_ctl_by_name(mixer, mixer_str);
+    ctl = getMixerControl(mixer, mixer_str);
     if (!ctl) {
         PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", mixer_str);
         free(mixer_str);
@@ -1085,8 +1191,7 @@ int SessionAlsaUtils::getModuleInstanceId(struct mixer *mixer, int device, const
         return ret;
     }
     tag_info = (struct gsl_tag_module_info *)payload;
-    PAL_DBG(LOG_TAG, "num of tags associated with stream %d is %d\n", device, tag_info->num_tags);
-    ret = -1;
+    PAL_DBG(LOG_TAG, "num of tags associated with %s is %d\n", pcmDeviceName, tag_info->num_tags);
     tag_entry = (struct gsl_tag_module_info_entry *)(&tag_info->tag_module_entry[0]);
     offset = 0;
     for (i = 0; i < tag_info->num_tags; i++) {
@@ -1094,29 +1199,94 @@ int SessionAlsaUtils::getModuleInstanceId(struct mixer *mixer, int device, const
 
         PAL_DBG(LOG_TAG, "tag id[%d] = 0x%x, num_modules = 0x%x\n", i, tag_entry->tag_id, tag_entry->num_modules);
         offset = sizeof(struct gsl_tag_module_info_entry) + (tag_entry->num_modules * sizeof(struct gsl_module_id_info_entry));
-        if (tag_entry->tag_id == tag_id) {
-            struct gsl_module_id_info_entry *mod_info_entry;
-
-            if (tag_entry->num_modules) {
-                 mod_info_entry = &tag_entry->module_entry[0];
-                 *miid = mod_info_entry->module_iid;
-                 PAL_DBG(LOG_TAG, "MIID is 0x%x\n", *miid);
-                 ret = 0;
-                 break;
+        /* first module carrying the tag wins, as with a direct lookup */
+        if (tag_entry->num_modules && !tagMiids.count(tag_entry->tag_id))
+            tagMiids[tag_entry->tag_id] = tag_entry->module_entry[0].module_iid;
+    }
+
+    free(payload);
+    free(mixer_str);
+    return 0;
+}
+
+int SessionAlsaUtils::getModuleInstanceId(struct mixer *mixer, int device, const char *intf_name,
+                       int tag_id, uint32_t *miid)
+{
+    char *pcmDeviceName = NULL;
+    int ret = 0;
+    uint32_t generation = 0;
+    std::unordered_map<int, uint32_t> tagMiids;
+    std::shared_ptr<ResourceManager> rm = ResourceManager::getInstance();
+
+    pcmDeviceName = rm->getDeviceNameFromID(device);
+    if(!pcmDeviceName){
+        PAL_ERR(LOG_TAG, "Device name from id %d not found", device);
+        return -EINVAL;
+    }
+
+    /* later tag and cal writes on this FE rely on the selected backend */
+    ret = setStreamMetadataType(mixer, device, intf_name);
+    if (ret)
+        return ret;
+
+    auto key = std::make_tuple(mixer, device, std::string(intf_name));
+    {
+        std::lock_guard<std::mutex> lock(miidCacheMutex);
+        auto entry = miidCache.find(key);
+        if (entry != miidCache.end()) {
+            auto it = entry->second.find(tag_id);
+            if (it != entry->second.end()) {
+                *miid = it->second;
+                PAL_VERBOSE(LOG_TAG, "cached MIID 0x%x for tag 0x%x", *miid, tag_id);
+                return 0;
             }
         }
+        generation = miidCacheGeneration;
     }
 
-    if (*miid == 0) {
-         ret = -EINVAL;
-         PAL_ERR(LOG_TAG, "No matching MIID found for tag: 0x%x, error:%d", tag_id, ret);
+    /* not cached, or the graph gained the tag since it was cached */
+    ret = readTagModuleInfo(mixer, pcmDeviceName, tagMiids);
+    if (ret)
+        return ret;
+
+    auto it = tagMiids.find(tag_id);
+    if (it != tagMiids.end() && it->second) {
+        *miid = it->second;
+        PAL_DBG(LOG_TAG, "MIID is 0x%x\n", *miid);
+    } else {
+        ret = -EINVAL;
+        PAL_ERR(LOG_TAG, "No matching MIID found for tag: 0x%x, error:%d", tag_id, ret);
     }
 
-    free(payload);
-    free(mixer_str);
+    std::lock_guard<std::mutex> lock(miidCacheMutex);
+    /* skip the store if the graph was rewired while reading */
+    if (generation == miidCacheGeneration)
+        miidCache[key] = std::move(tagMiids);
+
     return ret;
 }
 
+void SessionAlsaUtils::invalidateModuleInstanceIdCache(const std::vector<int> &DevIds)
+{
+    std::lock_guard<std::mutex> lock(miidCacheMutex);
+
+    miidCacheGeneration++;
+    for (auto it = miidCache.begin(); it != miidCache.end();) {
+        if (std::find(DevIds.begin(), DevIds.end(), std::get<1>(it->first)) != DevIds.end())
+            it = miidCache.erase(it);
+        else
+            it++;
+    }
+}
+
+void SessionAlsaUtils::invalidateModuleInstanceIdCache()
+{
+    std::lock_guard<std::mutex> lock(miidCacheMutex);
+
+    miidCacheGeneration++;
+    miidCache.clear();
+}
+
 int SessionAlsaUtils::getTagsWithModuleInfo(struct mixer *mixer, int device, const char *intf_name,
                                             uint8_t *payload)
 {
@@ -1148,7 +1318,7 @@ int SessionAlsaUtils::getTagsWithModuleInfo(struct mixer *mixer, int device, con
     snprintf(mixer_str, ctl_len, "%s %s", pcmDeviceName, control);
 
     PAL_DBG(LOG_TAG, "- mixer -%s-\n", mixer_str);
-    ctl = mixer_get_ctl_by_name(mixer, mixer_str);
+    ctl = getMixerControl(mixer, mixer_str);
     if (!ctl) {
         PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", mixer_str);
         free(mixer_str);
@@ -1200,7 +1370,7 @@ int SessionAlsaUtils::setMixerParameter(struct mixer *mixer, int device,
     snprintf(mixer_str, ctl_len, "%s %s", pcmDeviceName, control);
 
     PAL_DBG(LOG_TAG, "- mixer -%s-\n", mixer_str);
-    ctl = mixer_get_ctl_by_name(mixer, mixer_str);
+    ctl = getMixerControl(mixer, mixer_str);
     if (!ctl) {
         PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", mixer_str);
         free(mixer_str);
@@ -1236,7 +1406,7 @@ int SessionAlsaUtils::setStreamMetadataType(struct mixer *mixer, int device, con
     }
     snprintf(mixer_str, ctl_len, "%s %s", pcmDeviceName, control);
     PAL_DBG(LOG_TAG, "- mixer -%s-\n", mixer_str);
-    ctl = mixer_get_ctl_by_name(mixer, mixer_str);
+    ctl = getMixerControl(mixer, mixer_str);
     if (!ctl) {
         PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", mixer_str);
         free(mixer_str);
@@ -1290,7 +1460,7 @@ int SessionAlsaUtils::registerMixerEvent(struct mixer *mixer, int device, void *
     snprintf(mixer_str, ctl_len, "%s %s", pcmDeviceName, control);
 
     PAL_DBG(LOG_TAG, "- mixer -%s-\n", mixer_str);
-    ctl = mixer_get_ctl_by_name(mixer, mixer_str);
+    ctl = getMixerControl(mixer, mixer_str);
     if (!ctl) {
         PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", mixer_str);
         free(mixer_str);
@@ -1329,7 +1499,7 @@ int SessionAlsaUtils::setECRefPath(struct mixer *mixer, int device, const char *
     snprintf(mixer_str, ctl_len, "%s %s", pcmDeviceName, control);
 
     printf("%s mixer -%s-\n", __func__, mixer_str);
-    ctl = mixer_get_ctl_by_name(mixer, mixer_str);
+    ctl = getMixerControl(mixer, mixer_str);
     if (!ctl) {
         printf("Invalid mixer control: %s\n", mixer_str);
         free(mixer_str);
@@ -1366,7 +1536,7 @@ int SessionAlsaUtils::mixerWriteDatapathParams(struct mixer *mixer, int device,
     snprintf(mixer_str, ctl_len, "%s %s", pcmDeviceName, control);
 
     PAL_DBG(LOG_TAG, "- mixer -%s-\n", mixer_str);
-    ctl = mixer_get_ctl_by_name(mixer, mixer_str);
+    ctl = getMixerControl(mixer, mixer_str);
     if (!ctl) {
         PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", mixer_str);
         free(mixer_str);
@@ -1380,6 +1550,52 @@ int SessionAlsaUtils::mixerWriteDatapathParams(struct mixer *mixer, int device,
     return ret;
 }
 
+/*
+ * Runs helperLane on a new thread and callerLane on this one, then joins.
+ * If no thread can be spawned both run here in turn, helperLane first, and
+ * false is returned.
+ */
+static bool runLanes(const std::function<void()> &helperLane,
+    const std::function<void()> &callerLane)
+{
+    std::thread helper;
+    bool parallel = true;
+
+    try {
+        helper = std::thread(helperLane);
+    } catch (const std::system_error &e) {
+        PAL_INFO(LOG_TAG, "running the rx and tx lanes in turn: %s", e.what());
+        parallel = false;
+        helperLane();
+    }
+    callerLane();
+    if (helper.joinable())
+        helper.join();
+
+    return parallel;
+}
+
+/* FE and BE metadata and FE connect of one direction of a loopback session */
+static void setLoopbackLaneControls(struct mixer_ctl **feMixerCtrls,
+    struct mixer_ctl *beMixerCtrl, const std::string &backEndName,
+    const struct agmMetaData &streamMetaData, const struct agmMetaData &deviceMetaData,
+    const struct agmMetaData &streamDeviceMetaData)
+{
+    mixer_ctl_set_enum_by_string(feMixerCtrls[FE_CONTROL], "ZERO");
+    if (streamMetaData.size)
+        mixer_ctl_set_array(feMixerCtrls[FE_METADATA], (void *)streamMetaData.buf,
+                streamMetaData.size);
+    if (deviceMetaData.size)
+        mixer_ctl_set_array(beMixerCtrl, (void *)deviceMetaData.buf,
+                deviceMetaData.size);
+    if (streamDeviceMetaData.size) {
+        mixer_ctl_set_enum_by_string(feMixerCtrls[FE_CONTROL], backEndName.data());
+        mixer_ctl_set_array(feMixerCtrls[FE_METADATA], (void *)streamDeviceMetaData.buf,
+                streamDeviceMetaData.size);
+    }
+    mixer_ctl_set_enum_by_string(feMixerCtrls[FE_CONNECT], backEndName.data());
+}
+
 int SessionAlsaUtils::open(Stream * streamHandle, std::shared_ptr<ResourceManager> rmHandle,
     const std::vector<int> &RxDevIds, const std::vector<int> &TxDevIds,
     const std::vector<std::pair<int32_t, std::string>> &rxBackEnds,
@@ -1416,6 +1632,10 @@ int SessionAlsaUtils::open(Stream * streamHandle, std::shared_ptr<ResourceManage
     sidetone_mode_t sidetoneMode = SIDETONE_OFF;
     struct pal_device dAttr;
     bool isDeviceFound = false;
+    uint64_t startNs = 0, rxNs = 0, txNs = 0;
+
+    invalidateModuleInstanceIdCache(RxDevIds);
+    invalidateModuleInstanceIdCache(TxDevIds);
 
     if (RxDevIds.empty() || TxDevIds.empty()) {
         PAL_ERR(LOG_TAG, "RX and TX FE Dev Ids are empty");
@@ -1640,35 +1860,23 @@ int SessionAlsaUtils::open(Stream * streamHandle, std::shared_ptr<ResourceManage
 
     txDevNum = !rxDevNum;
 
-    /** set TX mixer controls */
-    mixer_ctl_set_enum_by_string(txFeMixerCtrls[FE_CONTROL], "ZERO");
-    if (streamTxMetaData.size)
-        mixer_ctl_set_array(txFeMixerCtrls[FE_METADATA], (void *)streamTxMetaData.buf,
-                streamTxMetaData.size);
-    if (deviceTxMetaData.size)
-        mixer_ctl_set_array(txBeMixerCtrl, (void *)deviceTxMetaData.buf,
-                deviceTxMetaData.size);
-    if (streamDeviceTxMetaData.size) {
-        mixer_ctl_set_enum_by_string(txFeMixerCtrls[FE_CONTROL], txBackEnds[0].second.data());
-        mixer_ctl_set_array(txFeMixerCtrls[FE_METADATA], (void *)streamDeviceTxMetaData.buf,
-                streamDeviceTxMetaData.size);
-    }
-    mixer_ctl_set_enum_by_string(txFeMixerCtrls[FE_CONNECT], txBackEnds[0].second.data());
+    /** set TX and RX mixer controls, they touch separate FE/BE controls */
+    startNs = PalLatencyTrace::now();
+    runLanes([&]() {
+        uint64_t laneNs = PalLatencyTrace::now();
 
-    /** set RX mixer controls */
-    mixer_ctl_set_enum_by_string(rxFeMixerCtrls[FE_CONTROL], "ZERO");
-    if (streamRxMetaData.size)
-        mixer_ctl_set_array(rxFeMixerCtrls[FE_METADATA], (void *)streamRxMetaData.buf,
-                streamRxMetaData.size);
-    if (deviceRxMetaData.size)
-        mixer_ctl_set_array(rxBeMixerCtrl, (void *)deviceRxMetaData.buf,
-                deviceRxMetaData.size);
-    if (streamDeviceRxMetaData.size) {
-        mixer_ctl_set_enum_by_string(rxFeMixerCtrls[FE_CONTROL], rxBackEnds[0].second.data());
-        mixer_ctl_set_array(rxFeMixerCtrls[FE_METADATA], (void *)streamDeviceRxMetaData.buf,
-                streamDeviceRxMetaData.size);
-    }
-    mixer_ctl_set_enum_by_string(rxFeMixerCtrls[FE_CONNECT], rxBackEnds[0].second.data());
+        setLoopbackLaneControls(txFeMixerCtrls, txBeMixerCtrl, txBackEnds[0].second,
+                streamTxMetaData, deviceTxMetaData, streamDeviceTxMetaData);
+        txNs = PalLatencyTrace::now() - laneNs;
+    }, [&]() {
+        uint64_t laneNs = PalLatencyTrace::now();
+
+        setLoopbackLaneControls(rxFeMixerCtrls, rxBeMixerCtrl, rxBackEnds[0].second,
+                streamRxMetaData, deviceRxMetaData, streamDeviceRxMetaData);
+        rxNs = PalLatencyTrace::now() - laneNs;
+    });
+    PalLatencyTrace::record(PAL_TRACE_PCM_PAIR_SETUP, startNs);
+    PalLatencyTrace::recordDelta(PAL_TRACE_PCM_PAIR_SETUP_SERIAL, 0, rxNs + txNs);
 
     if (sAttr.type != PAL_STREAM_VOICE_CALL) {
         txFeMixerCtrls[FE_LOOPBACK] = getFeMixerControl(mixerHandle, txFeName.str(), FE_LOOPBACK);
@@ -1696,6 +1904,83 @@ exit:
     return status;
 }
 
+/* pcm_open of one direction, returns 0 or a negative errno; a pcm that is
+ * not ready is left in *pcm for the caller to close
+ */
+static int openPcmLane(unsigned int card, unsigned int device, unsigned int flags,
+    struct pcm_config *config, struct pcm **pcm, uint64_t *laneNs)
+{
+    uint64_t startNs = PalLatencyTrace::now();
+    int status = 0;
+
+    *pcm = pcm_open(card, device, flags, config);
+    if (!*pcm || !pcm_is_ready(*pcm)) {
+        status = errno ? -errno : -EINVAL;
+        PAL_ERR(LOG_TAG, "pcm-%s open failed on device %u: %s",
+                (flags & PCM_IN) ? "tx" : "rx", device,
+                *pcm ? pcm_get_error(*pcm) : "no memory");
+    }
+    *laneNs = PalLatencyTrace::now() - startNs;
+
+    return status;
+}
+
+static void closePcmPair(struct pcm **pcmRx, struct pcm **pcmTx)
+{
+    if (*pcmRx)
+        pcm_close(*pcmRx);
+    if (*pcmTx)
+        pcm_close(*pcmTx);
+    *pcmRx = NULL;
+    *pcmTx = NULL;
+}
+
+/*
+ * RX and TX graphs of a hostless or loopback session are independent until
+ * pcm_start, so the RX pcm_open runs on a helper thread while this thread
+ * opens TX. If the parallel open fails, or no thread can be spawned, they
+ * are opened in turn, RX first. On error both pcms are closed and set to
+ * NULL.
+ */
+int SessionAlsaUtils::openPcmPair(unsigned int card, unsigned int rxDevice,
+    struct pcm_config *rxConfig, unsigned int txDevice,
+    struct pcm_config *txConfig, struct pcm **pcmRx, struct pcm **pcmTx)
+{
+    uint64_t startNs = PalLatencyTrace::now();
+    uint64_t rxNs = 0, txNs = 0;
+    int rxStatus = 0, txStatus = 0;
+    bool parallel = false;
+
+    *pcmRx = NULL;
+    *pcmTx = NULL;
+
+    parallel = runLanes([&]() {
+        rxStatus = openPcmLane(card, rxDevice, PCM_OUT, rxConfig, pcmRx, &rxNs);
+    }, [&]() {
+        txStatus = openPcmLane(card, txDevice, PCM_IN, txConfig, pcmTx, &txNs);
+    });
+
+    if ((rxStatus || txStatus) && parallel) {
+        PAL_INFO(LOG_TAG, "parallel pcm open failed rx %d tx %d, opening in turn",
+                 rxStatus, txStatus);
+        closePcmPair(pcmRx, pcmTx);
+        rxStatus = openPcmLane(card, rxDevice, PCM_OUT, rxConfig, pcmRx, &rxNs);
+        txStatus = 0;
+        if (!rxStatus)
+            txStatus = openPcmLane(card, txDevice, PCM_IN, txConfig, pcmTx, &txNs);
+    }
+
+    PalLatencyTrace::record(PAL_TRACE_PCM_PAIR_OPEN, startNs);
+    PalLatencyTrace::recordDelta(PAL_TRACE_PCM_PAIR_OPEN_SERIAL, 0, rxNs + txNs);
+
+    if (rxStatus || txStatus) {
+        closePcmPair(pcmRx, pcmTx);
+        return rxStatus ? rxStatus : txStatus;
+    }
+
+    return 0;
+}
+
 int SessionAlsaUtils::openDev(std::shared_ptr<ResourceManager> rmHandle,
     const std::vector<int> &DevIds, int32_t backEndId, std::string backEndName)
 {
@@ -1811,6 +2096,9 @@ int SessionAlsaUtils::close(Stream * streamHandle, std::shared_ptr<ResourceManag
     uint32_t streamDevicePropId[] = {0x08000010, 1, 0x3}; /** gsl_subgraph_platform_driver_props.xml */
     uint32_t i, rxDevNum, txDevNum;
 
+    invalidateModuleInstanceIdCache(RxDevIds);
+    invalidateModuleInstanceIdCache(TxDevIds);
+
     status = streamHandle->getStreamAttributes(&sAttr);
     if(0 != status) {
         PAL_ERR(LOG_TAG, "getStreamAttributes Failed \n");
@@ -1992,6 +2280,8 @@ int SessionAlsaUtils::disconnectSessionDevice(Stream* streamHandle, pal_stream_t
     int sub = 1;
     uint32_t i;
 
+    invalidateModuleInstanceIdCache(pcmDevIds);
+
     switch (streamType) {
         case PAL_STREAM_COMPRESSED:
             disconnectCtrlName << COMPRESS_SND_DEV_NAME_PREFIX << pcmDevIds.at(0) << " disconnect";
@@ -2022,7 +2312,7 @@ int SessionAlsaUtils::disconnectSessionDevice(Stream* streamHandle, pal_stream_t
             break;
     }
     status = rmHandle->getVirtualAudioMixer(&mixerHandle);
-    disconnectCtrl = mixer_get_ctl_by_name(mixerHandle, disconnectCtrlName.str().data());
+    disconnectCtrl = getMixerControl(mixerHandle, disconnectCtrlName.str().data());
     if (!disconnectCtrl) {
         PAL_ERR(LOG_TAG, "invalid mixer control: %s", disconnectCtrlName.str().data());
         return -EINVAL;
@@ -2096,6 +2386,9 @@ int SessionAlsaUtils::disconnectSessionDevice(Stream* streamHandle, pal_stream_t
     struct mixer_ctl *txFeMixerCtrls[FE_MAX_NUM_MIXER_CONTROLS] = { nullptr };
     std::ostringstream txFeName;
 
+    invalidateModuleInstanceIdCache(pcmTxDevIds);
+    invalidateModuleInstanceIdCache(pcmRxDevIds);
+
     switch (streamType) {
          case PAL_STREAM_ULTRASOUND:
          case PAL_STREAM_LOOPBACK:
@@ -2120,7 +2413,7 @@ int SessionAlsaUtils::disconnectSessionDevice(Stream* streamHandle, pal_stream_t
             break;
     }
     status = rmHandle->getVirtualAudioMixer(&mixerHandle);
-    disconnectCtrl = mixer_get_ctl_by_name(mixerHandle, disconnectCtrlName.str().data());
+    disconnectCtrl = getMixerControl(mixerHandle, disconnectCtrlName.str().data());
     if (!disconnectCtrl) {
         PAL_ERR(LOG_TAG, "invalid mixer control: %s", disconnectCtrlName.str().data());
         return -EINVAL;
@@ -2150,6 +2443,8 @@ int SessionAlsaUtils::connectSessionDevice(Session* sess, Stream* streamHandle,
     PayloadBuilder* builder = new PayloadBuilder();
     std::shared_ptr<ResourceManager> rm = ResourceManager::getInstance();
 
+    invalidateModuleInstanceIdCache(pcmDevIds);
+
     status = rmHandle->getVirtualAudioMixer(&mixerHandle);
     if (status) {
         PAL_ERR(LOG_TAG, "get mixer handle failed %d", status);
@@ -2259,7 +2554,7 @@ int SessionAlsaUtils::connectSessionDevice(Session* sess, Stream* streamHandle,
          }
     }
 
-    connectCtrl = mixer_get_ctl_by_name(mixerHandle, connectCtrlName.str().data());
+    connectCtrl = getMixerControl(mixerHandle, connectCtrlName.str().data());
     if (!connectCtrl) {
         PAL_ERR(LOG_TAG, "invalid mixer control: %s", connectCtrlName.str().data());
         status = -EINVAL;
@@ -2291,6 +2586,9 @@ int SessionAlsaUtils::connectSessionDevice(Session* sess, Stream* streamHandle,
     size_t payloadSize = 0;
     bool is_out_dev = false;
 
+    invalidateModuleInstanceIdCache(pcmTxDevIds);
+    invalidateModuleInstanceIdCache(pcmRxDevIds);
+
     if (dAttr.id > PAL_DEVICE_OUT_MIN && dAttr.id < PAL_DEVICE_OUT_MAX) {
         is_out_dev = true;
         connectCtrlName << PCM_SND_DEV_NAME_PREFIX << pcmRxDevIds.at(0) << " connect";
@@ -2329,7 +2627,7 @@ int SessionAlsaUtils::connectSessionDevice(Session* sess, Stream* streamHandle,
         }
     }
 
-    connectCtrl = mixer_get_ctl_by_name(mixerHandle, connectCtrlName.str().data());
+    connectCtrl = getMixerControl(mixerHandle, connectCtrlName.str().data());
     if (!connectCtrl) {
         PAL_ERR(LOG_TAG, "invalid mixer control: %s", connectCtrlName.str().data());
         status = -EINVAL;
@@ -2385,6 +2683,7 @@ int SessionAlsaUtils::setupSessionDevice(Stream* streamHandle, pal_stream_type_t
     struct mixer_ctl *aifMdCtrl = nullptr;
     PayloadBuilder* builder = new PayloadBuilder();
     struct mixer *mixerHandle = nullptr;
+    uint64_t traceStartNs = PalLatencyTrace::now();
     uint32_t devicePropId[] = {0x08000010, 2, 0x2, 0x5};
     uint32_t streamDevicePropId[] = {0x08000010, 1, 0x3}; /** gsl_subgraph_platform_driver_props.xml */
     bool is_compress = false;
@@ -2394,6 +2693,8 @@ int SessionAlsaUtils::setupSessionDevice(Stream* streamHandle, pal_stream_type_t
     struct vsid_info vsidinfo = {};
     sidetone_mode_t sidetoneMode = SIDETONE_OFF;
 
+    invalidateModuleInstanceIdCache(pcmDevIds);
+
     status = rmHandle->getVirtualAudioMixer(&mixerHandle);
     if (status) {
         PAL_VERBOSE(LOG_TAG, "get mixer handle failed %d", status);
@@ -2547,7 +2848,7 @@ int SessionAlsaUtils::setupSessionDevice(Stream* streamHandle, pal_stream_type_t
 
     status = rmHandle->getVirtualAudioMixer(&mixerHandle);
 
-    aifMdCtrl = mixer_get_ctl_by_name(mixerHandle, aifMdName.str().data());
+    aifMdCtrl = getMixerControl(mixerHandle, aifMdName.str().data());
     PAL_DBG(LOG_TAG, "mixer control %s", aifMdName.str().data());
     if (!aifMdCtrl) {
         PAL_ERR(LOG_TAG, "invalid mixer control: %s", aifMdName.str().data());
@@ -2557,7 +2858,7 @@ int SessionAlsaUtils::setupSessionDevice(Stream* streamHandle, pal_stream_type_t
     if (deviceMetaData.size)
         mixer_ctl_set_array(aifMdCtrl, (void *)deviceMetaData.buf, deviceMetaData.size);
 
-    feCtrl = mixer_get_ctl_by_name(mixerHandle, cntrlName.str().data());
+    feCtrl = getMixerControl(mixerHandle, cntrlName.str().data());
     PAL_DBG(LOG_TAG, "mixer control %s", cntrlName.str().data());
     if (!feCtrl) {
         PAL_ERR(LOG_TAG, "invalid mixer control: %s", cntrlName.str().data());
@@ -2566,7 +2867,7 @@ int SessionAlsaUtils::setupSessionDevice(Stream* streamHandle, pal_stream_type_t
     }
     mixer_ctl_set_enum_by_string(feCtrl, aifBackEndsToConnect[0].second.data());
 
-    feMdCtrl = mixer_get_ctl_by_name(mixerHandle, feMdName.str().data());
+    feMdCtrl = getMixerControl(mixerHandle, feMdName.str().data());
     PAL_DBG(LOG_TAG, "mixer control %s", feMdName.str().data());
     if (!feMdCtrl) {
         PAL_ERR(LOG_TAG, "invalid mixer control: %s", feMdName.str().data());
@@ -2575,6 +2876,8 @@ int SessionAlsaUtils::setupSessionDevice(Stream* streamHandle, pal_stream_type_t
     }
     if (streamDeviceMetaData.size)
         mixer_ctl_set_array(feMdCtrl, (void *)streamDeviceMetaData.buf, streamDeviceMetaData.size);
+
+    PalLatencyTrace::record(PAL_TRACE_SESSION_METADATA, traceStartNs);
 freeMetaData:
     free(streamDeviceMetaData.buf);
     free(deviceMetaData.buf);
@@ -654,6 +654,7 @@ int SessionAlsaVoice::setTaggedSlotMask(Stream * s)
 int SessionAlsaVoice::start(Stream * s)
 {
     struct pcm_config config;
+    struct pcm_config txConfig;
     struct pal_stream_attributes sAttr;
     int32_t status = 0;
     std::shared_ptr<Device> rxDevice = nullptr;
@@ -699,39 +700,24 @@ int SessionAlsaVoice::start(Stream * s)
     }
     setExtECRef(s, rxDevice, true);
 
-    pcmRx = pcm_open(rm->getVirtualSndCard(), pcmDevRxIds.at(0), PCM_OUT, &config);
-    if (!pcmRx) {
-        PAL_ERR(LOG_TAG, "Exit pcm-rx open failed");
-        status = -EINVAL;
-        goto err_pcm_open;
-    }
-
-    if (!pcm_is_ready(pcmRx)) {
-        PAL_ERR(LOG_TAG, "Exit pcm-rx open not ready");
-        status = -EINVAL;
-        goto err_pcm_open;
-    }
-
-    config.rate = sAttr.in_media_config.sample_rate;
+    txConfig = config;
+    txConfig.rate = sAttr.in_media_config.sample_rate;
     if (sAttr.in_media_config.bit_width == 32)
-        config.format = PCM_FORMAT_S32_LE;
+        txConfig.format = PCM_FORMAT_S32_LE;
     else if (sAttr.in_media_config.bit_width == 24)
-        config.format = PCM_FORMAT_S24_3LE;
+        txConfig.format = PCM_FORMAT_S24_3LE;
     else if (sAttr.in_media_config.bit_width == 16)
-        config.format = PCM_FORMAT_S16_LE;
-    config.channels = sAttr.in_media_config.ch_info.channels;
-    config.period_size = in_buf_size;
-    config.period_count = in_buf_count;
-
-    pcmTx = pcm_open(rm->getVirtualSndCard(), pcmDevTxIds.at(0), PCM_IN, &config);
-    if (!pcmTx) {
-        PAL_ERR(LOG_TAG, "Exit pcm-tx open failed");
-        status = -EINVAL;
-        goto err_pcm_open;
-    }
-
-    if (!pcm_is_ready(pcmTx)) {
-        PAL_ERR(LOG_TAG, "Exit pcm-tx open not ready");
+        txConfig.format = PCM_FORMAT_S16_LE;
+    txConfig.channels = sAttr.in_media_config.ch_info.channels;
+    txConfig.period_size = in_buf_size;
+    txConfig.period_count = in_buf_count;
+
+    status = SessionAlsaUtils::openPcmPair(rm->getVirtualSndCard(),
+                                           pcmDevRxIds.at(0), &config,
+                                           pcmDevTxIds.at(0), &txConfig,
+                                           &pcmRx, &pcmTx);
+    if (status) {
+        PAL_ERR(LOG_TAG, "Exit pcm open failed %d", status);
         status = -EINVAL;
         goto err_pcm_open;
     }
@@ -1287,7 +1273,7 @@ int SessionAlsaVoice::payloadTaged(Stream * s, configType type, int tag,
                 goto exit;
             }
             tagCntrlName<<stream<<" "<<setParamTagControl;
-            ctl = mixer_get_ctl_by_name(mixer, tagCntrlName.str().data());
+            ctl = SessionAlsaUtils::getMixerControl(mixer, tagCntrlName.str().data());
             if (!ctl) {
                 PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", tagCntrlName.str().data());
                 return -ENOENT;
@@ -1787,7 +1773,7 @@ int SessionAlsaVoice::setVoiceMixerParameter(Stream * s, struct mixer *mixer,
     snprintf(mixer_str, ctl_len, "%s %s", stream, control);
 
     PAL_VERBOSE(LOG_TAG, "- mixer -%s-\n", mixer_str);
-    ctl = mixer_get_ctl_by_name(mixer, mixer_str);
+    ctl = SessionAlsaUtils::getMixerControl(mixer, mixer_str);
     if (!ctl) {
         PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", mixer_str);
         free(mixer_str);
@@ -105,7 +105,8 @@ int32_t SoundTriggerEngine::CreateBuffer(uint32_t buffer_size,
 
     PAL_DBG(LOG_TAG, "Enter");
     if (!buffer_) {
-        buffer_ = new PalRingBuffer(buffer_size);
+        /* only the LAB thread writes, readers are the 2nd stage engines and client */
+        buffer_ = new PalRingBuffer(buffer_size, true);
         if (!buffer_) {
             PAL_ERR(LOG_TAG, "Failed to allocate memory for ring buffer");
             status = -ENOMEM;
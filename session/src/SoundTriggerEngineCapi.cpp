@@ -40,6 +40,9 @@
 #include "Stream.h"
 #include "SoundTriggerPlatformInfo.h"
 
+/* upper bound of a single wait for LAB data, exit flags are rechecked after it */
+#define READER_WAIT_TIMEOUT_MS 50
+
 ST_DBG_DECLARE(static int keyword_detection_cnt = 0);
 ST_DBG_DECLARE(static int user_verification_cnt = 0);
 
@@ -140,9 +143,10 @@ int32_t SoundTriggerEngineCapi::StartKeywordDetection()
     size_t end_idx = 0;
     capi_v2_buf_t capi_result;
     bool buffer_advanced = false;
+    int32_t wait_status = 0;
     size_t lab_buffer_size = 0;
     bool first_buffer_processed = false;
-    FILE *keyword_detection_fd = nullptr;
+    PalDumpFile *keyword_detection_fd = nullptr;
     ChronoSteadyClock_t process_start;
     ChronoSteadyClock_t process_end;
     ChronoSteadyClock_t capi_call_start;
@@ -223,6 +227,14 @@ int32_t SoundTriggerEngineCapi::StartKeywordDetection()
         goto exit;
     }
 
+    /* a window the ring can never satisfy would spin the loop below */
+    if (buffer_start_ >= buffer_end_ || !buffer_size_) {
+        status = -EINVAL;
+        PAL_ERR(LOG_TAG, "Invalid read window, start %u end %u size %u",
+                buffer_start_, buffer_end_, buffer_size_);
+        goto exit;
+    }
+
     process_start = std::chrono::steady_clock::now();
     while (!exit_buffering_ &&
         (bytes_processed_ < buffer_end_ - buffer_start_)) {
@@ -235,16 +247,34 @@ int32_t SoundTriggerEngineCapi::StartKeywordDetection()
 
         /* advance the offset to ensure we are reading at the right place */
         if (!buffer_advanced && buffer_start_ > 0) {
-            if (reader_->advanceReadOffset(buffer_start_)) {
-                buffer_advanced = true;
-            } else {
+            wait_status = reader_->waitForData(buffer_start_, READER_WAIT_TIMEOUT_MS);
+            if (wait_status == -ETIMEDOUT)
                 continue;
+            if (wait_status) {
+                status = wait_status;
+                PAL_ERR(LOG_TAG, "Failed to wait for keyword start, status %d", status);
+                goto exit;
             }
+            if (!reader_->advanceReadOffset(buffer_start_))
+                continue;
+            buffer_advanced = true;
         }
 
-        if (reader_->getUnreadSize() < buffer_size_)
+        /* sleep until the writer has buffered enough data for one process call */
+        wait_status = reader_->waitForData(buffer_size_, READER_WAIT_TIMEOUT_MS);
+        if (wait_status == -ETIMEDOUT)
             continue;
+        if (wait_status) {
+            status = wait_status;
+            PAL_ERR(LOG_TAG, "Failed to wait for data, status %d", status);
+            goto exit;
+        }
 
+        /*
+         * CAPI process() may work on its input in place, so it must not see
+         * ring memory the writer and other readers share. read() copies the
+         * window out and retries internally if the writer laps it.
+         */
         read_size = reader_->read((void*)process_input_buff, buffer_size_);
         if (read_size == 0) {
             continue;
@@ -379,9 +409,10 @@ int32_t SoundTriggerEngineCapi::StartUserVerification()
     int32_t read_size = 0;
     capi_v2_buf_t capi_result;
     bool buffer_advanced = false;
+    int32_t wait_status = 0;
     StreamSoundTrigger *str = nullptr;
     struct detection_event_info *info = nullptr;
-    FILE *user_verification_fd = nullptr;
+    PalDumpFile *user_verification_fd = nullptr;
     ChronoSteadyClock_t process_start;
     ChronoSteadyClock_t process_end;
     ChronoSteadyClock_t capi_call_start;
@@ -496,6 +527,14 @@ int32_t SoundTriggerEngineCapi::StartUserVerification()
     if (kw_start_timestamp_ > 0)
         buffer_start_ = UsToBytes(kw_start_timestamp_);
 
+    /* a window the ring can never satisfy would spin the loop below */
+    if (buffer_start_ >= buffer_end_ || !buffer_size_) {
+        status = -EINVAL;
+        PAL_ERR(LOG_TAG, "Invalid read window, start %u end %u size %u",
+                buffer_start_, buffer_end_, buffer_size_);
+        goto exit;
+    }
+
     process_start = std::chrono::steady_clock::now();
     while (!exit_buffering_ &&
         (bytes_processed_ < buffer_end_ - buffer_start_)) {
@@ -508,16 +547,34 @@ int32_t SoundTriggerEngineCapi::StartUserVerification()
 
         /* advance the offset to ensure we are reading at the right place */
         if (!buffer_advanced && buffer_start_ > 0) {
-            if (reader_->advanceReadOffset(buffer_start_)) {
-                buffer_advanced = true;
-            } else {
+            wait_status = reader_->waitForData(buffer_start_, READER_WAIT_TIMEOUT_MS);
+            if (wait_status == -ETIMEDOUT)
                 continue;
+            if (wait_status) {
+                status = wait_status;
+                PAL_ERR(LOG_TAG, "Failed to wait for keyword start, status %d", status);
+                goto exit;
             }
+            if (!reader_->advanceReadOffset(buffer_start_))
+                continue;
+            buffer_advanced = true;
         }
 
-        if (reader_->getUnreadSize() < buffer_size_)
+        /* sleep until the writer has buffered enough data for one process call */
+        wait_status = reader_->waitForData(buffer_size_, READER_WAIT_TIMEOUT_MS);
+        if (wait_status == -ETIMEDOUT)
             continue;
+        if (wait_status) {
+            status = wait_status;
+            PAL_ERR(LOG_TAG, "Failed to wait for data, status %d", status);
+            goto exit;
+        }
 
+        /*
+         * CAPI process() may work on its input in place, so it must not see
+         * ring memory the writer and other readers share. read() copies the
+         * window out and retries internally if the writer laps it.
+         */
         read_size = reader_->read((void*)process_input_buff, buffer_size_);
         if (read_size == 0) {
             continue;
@@ -526,6 +583,7 @@ int32_t SoundTriggerEngineCapi::StartUserVerification()
             PAL_ERR(LOG_TAG, "Failed to read from buffer, status %d", status);
             goto exit;
         }
+
         PAL_INFO(LOG_TAG, "Processed: %u, start: %u, end: %u",
                  bytes_processed_, buffer_start_, buffer_end_);
         stream_input->bufs_num = 1;
@@ -34,6 +34,8 @@
 #include "SoundTriggerEngineGsl.h"
 
 #include <cutils/trace.h>
+#include <set>
+#include <string>
 
 #include "Session.h"
 #include "Stream.h"
@@ -212,7 +214,7 @@ int32_t SoundTriggerEngineGsl::StartBuffering(Stream *s) {
     bool event_notified = false;
     StreamSoundTrigger *st = (StreamSoundTrigger *)s;
     struct pal_mmap_position mmap_pos;
-    FILE *dsp_output_fd = nullptr;
+    PalDumpFile *dsp_output_fd = nullptr;
     ChronoSteadyClock_t kw_transfer_begin;
     ChronoSteadyClock_t kw_transfer_end;
     size_t retry_cnt = 0;
@@ -1102,7 +1104,7 @@ int32_t SoundTriggerEngineGsl::MergeSoundModels(uint32_t num_models,
     }
 
     if (st_info_->GetEnableDebugDumps()) {
-        ST_DBG_DECLARE(FILE *sm_fd = NULL;
+        ST_DBG_DECLARE(PalDumpFile *sm_fd = NULL;
             static int sm_cnt = 0);
         ST_DBG_FILE_OPEN_WR(sm_fd, ST_DEBUG_DUMP_LOCATION,
             "st_smlib_output_merged_sm", "bin", sm_cnt);
@@ -1124,6 +1126,27 @@ cleanup:
     return status;
 }
 
+/*
+ * Number of keyphrases in the merged model once the keyphrases of st_info are
+ * added to or deleted from eng_info. A keyphrase both models have is merged
+ * into one.
+ */
+static uint32_t GetMergedKeyPhraseCount(SoundModelInfo *eng_info,
+                                        SoundModelInfo *st_info, bool add) {
+    std::set<std::string> keyphrases;
+
+    for (uint32_t i = 0; i < eng_info->GetNumKeyPhrases(); i++)
+        keyphrases.insert(eng_info->GetKeyPhrases()[i]);
+    for (uint32_t i = 0; i < st_info->GetNumKeyPhrases(); i++) {
+        if (add)
+            keyphrases.insert(st_info->GetKeyPhrases()[i]);
+        else
+            keyphrases.erase(st_info->GetKeyPhrases()[i]);
+    }
+
+    return keyphrases.size();
+}
+
 int32_t SoundTriggerEngineGsl::AddSoundModel(Stream *s, uint8_t *data,
                                               uint32_t data_size){
 
@@ -1132,7 +1155,9 @@ int32_t SoundTriggerEngineGsl::AddSoundModel(Stream *s, uint8_t *data,
     StreamSoundTrigger *st = dynamic_cast<StreamSoundTrigger *>(s);
     listen_model_type **in_models = nullptr;
     listen_model_type out_model = {};
-    SoundModelInfo *sm_info;
+    SoundModelInfo *sm_info = nullptr;
+    std::vector<uint64_t> merge_key;
+    bool cache_hit = false;
 
     PAL_VERBOSE(LOG_TAG, "Enter");
     if (st->GetSoundModelInfo()->GetModelData()) {
@@ -1155,6 +1180,7 @@ int32_t SoundTriggerEngineGsl::AddSoundModel(Stream *s, uint8_t *data,
     }
 
     st->GetSoundModelInfo()->SetModelData(data, data_size);
+    sm_hashes_[s] = MergedSoundModelCache::HashModel(data, data_size);
 
     /* Check for remaining stream sound models to merge */
     for (int i = 0; i < eng_streams_.size(); i++) {
@@ -1198,6 +1224,26 @@ int32_t SoundTriggerEngineGsl::AddSoundModel(Stream *s, uint8_t *data,
         }
     }
 
+    /*
+     * Reuse the merged model if this set of models was merged before. The
+     * incoming stream is not in eng_streams_ yet, add its model to the key.
+     */
+    GetMergedModelKey(s, merge_key);
+    merge_key.push_back(sm_hashes_[s]);
+    sm_info = new SoundModelInfo();
+    cache_hit = MergedSoundModelCache::GetInstance()->Get(merge_key, sm_info);
+    if (cache_hit && sm_info->GetNumKeyPhrases() !=
+        GetMergedKeyPhraseCount(eng_sm_info_, st->GetSoundModelInfo(), true)) {
+        PAL_ERR(LOG_TAG, "cached model has %u keyphrases, expected %u, merging again",
+            sm_info->GetNumKeyPhrases(),
+            GetMergedKeyPhraseCount(eng_sm_info_, st->GetSoundModelInfo(), true));
+        cache_hit = false;
+        delete sm_info;
+        sm_info = new SoundModelInfo();
+    }
+    if (cache_hit)
+        goto update;
+
     /* Merge this stream model with remaining streams models */
     num_models = 2;
     SoundModelInfo::AllocArrayPtrs((char***)&in_models, num_models,
@@ -1219,36 +1265,34 @@ int32_t SoundTriggerEngineGsl::AddSoundModel(Stream *s, uint8_t *data,
         PAL_ERR(LOG_TAG, "merge models failed");
         goto cleanup;
     }
-    sm_info = new SoundModelInfo();
     sm_info->SetModelData(out_model.data, out_model.size);
 
     /* Populate sound model info for the merged stream models */
     status = QuerySoundModel(sm_info, out_model.data, out_model.size);
-    if (status) {
-        delete sm_info;
+    if (status)
         goto cleanup;
-    }
 
-    if (out_model.size < eng_sm_info_->GetModelSize()) {
+update:
+    if (sm_info->GetModelSize() < eng_sm_info_->GetModelSize()) {
         PAL_ERR(LOG_TAG, "Unexpected, merged model sz %d < current sz %d",
-            out_model.size, eng_sm_info_->GetModelSize());
-        delete sm_info;
+            sm_info->GetModelSize(), eng_sm_info_->GetModelSize());
         status = -EINVAL;
         goto cleanup;
     }
-    SoundModelInfo::FreeArrayPtrs((char **)in_models, num_models);
-    in_models = nullptr;
+    if (!cache_hit)
+        MergedSoundModelCache::GetInstance()->Put(merge_key, sm_info);
 
     /* Update the new merged model */
     PAL_INFO(LOG_TAG, "Updated sound model: current size %d, new size %d",
-        eng_sm_info_->GetModelSize(), out_model.size);
+        eng_sm_info_->GetModelSize(), sm_info->GetModelSize());
     *eng_sm_info_ = *sm_info;
     sm_merged_ = true;
 
-    delete sm_info;
     PAL_DBG(LOG_TAG, "Exit: status %d", status);
-    return 0;
 cleanup:
+    if (sm_info)
+        delete sm_info;
+
     if (out_model.data)
         free(out_model.data);
 
@@ -1258,6 +1302,35 @@ cleanup:
     return status;
 }
 
+uint64_t SoundTriggerEngineGsl::GetModelHash(Stream *s) {
+    StreamSoundTrigger *st = dynamic_cast<StreamSoundTrigger *>(s);
+    auto iter = sm_hashes_.find(s);
+
+    if (iter != sm_hashes_.end())
+        return iter->second;
+
+    sm_hashes_[s] = MergedSoundModelCache::HashModel(
+        st->GetSoundModelInfo()->GetModelData(),
+        st->GetSoundModelInfo()->GetModelSize());
+
+    return sm_hashes_[s];
+}
+
+/*
+ * Key of the merged model built from the sound models of all attached
+ * streams except the given one.
+ */
+void SoundTriggerEngineGsl::GetMergedModelKey(Stream *exclude,
+                                              std::vector<uint64_t> &key) {
+    key.clear();
+    for (int i = 0; i < eng_streams_.size(); i++) {
+        StreamSoundTrigger *sst = dynamic_cast<StreamSoundTrigger *>(eng_streams_[i]);
+        if (exclude != eng_streams_[i] && sst && sst->GetSoundModelInfo() &&
+            sst->GetSoundModelInfo()->GetModelData())
+            key.push_back(GetModelHash(eng_streams_[i]));
+    }
+}
+
 int32_t SoundTriggerEngineGsl::DeleteFromMergedModel(char **keyphrases,
     uint32_t num_keyphrases, listen_model_type *in_model,
     listen_model_type *out_model) {
@@ -1322,7 +1395,7 @@ int32_t SoundTriggerEngineGsl::DeleteFromMergedModel(char **keyphrases,
     }
 
     if (st_info_->GetEnableDebugDumps()) {
-        ST_DBG_DECLARE(FILE *sm_fd = NULL; static int sm_cnt = 0);
+        ST_DBG_DECLARE(PalDumpFile *sm_fd = NULL; static int sm_cnt = 0);
         ST_DBG_FILE_OPEN_WR(sm_fd, ST_DEBUG_DUMP_LOCATION,
             "st_smlib_output_deleted_sm", "bin", sm_cnt);
         ST_DBG_FILE_WRITE(sm_fd, merge_model.data, merge_model.size);
@@ -1350,12 +1423,15 @@ int32_t SoundTriggerEngineGsl::DeleteSoundModel(Stream *s) {
     listen_model_type in_model = {};
     listen_model_type out_model = {};
     SoundModelInfo *sm_info = nullptr;
+    std::vector<uint64_t> merge_key;
+    bool cache_hit = false;
 
     PAL_VERBOSE(LOG_TAG, "Enter");
     if (!st->GetSoundModelInfo()->GetModelData()) {
         PAL_DBG(LOG_TAG, "Stream model data already deleted");
         return 0;
     }
+    sm_hashes_.erase(s);
 
     PAL_VERBOSE(LOG_TAG, "sm_data %pK, sm_size %d",
           st->GetSoundModelInfo()->GetModelData(),
@@ -1406,6 +1482,22 @@ int32_t SoundTriggerEngineGsl::DeleteSoundModel(Stream *s) {
         goto cleanup;
     }
 
+    /* Reuse the merged model of the remaining models if seen before */
+    GetMergedModelKey(s, merge_key);
+    sm_info = new SoundModelInfo();
+    cache_hit = MergedSoundModelCache::GetInstance()->Get(merge_key, sm_info);
+    if (cache_hit && sm_info->GetNumKeyPhrases() !=
+        GetMergedKeyPhraseCount(eng_sm_info_, st->GetSoundModelInfo(), false)) {
+        PAL_ERR(LOG_TAG, "cached model has %u keyphrases, expected %u, deleting again",
+            sm_info->GetNumKeyPhrases(),
+            GetMergedKeyPhraseCount(eng_sm_info_, st->GetSoundModelInfo(), false));
+        cache_hit = false;
+        delete sm_info;
+        sm_info = new SoundModelInfo();
+    }
+    if (cache_hit)
+        goto update;
+
     /* Existing merged model from which the current stream model to be deleted */
     in_model.data = eng_sm_info_->GetModelData();
     in_model.size = eng_sm_info_->GetModelSize();
@@ -1416,7 +1508,6 @@ int32_t SoundTriggerEngineGsl::DeleteSoundModel(Stream *s) {
 
     if (status)
         goto cleanup;
-    sm_info = new SoundModelInfo();
     sm_info->SetModelData(out_model.data, out_model.size);
 
     /* Update existing merged model info with new merged model */
@@ -1425,23 +1516,26 @@ int32_t SoundTriggerEngineGsl::DeleteSoundModel(Stream *s) {
     if (status)
         goto cleanup;
 
-    if (out_model.size > eng_sm_info_->GetModelSize()) {
+update:
+    if (sm_info->GetModelSize() > eng_sm_info_->GetModelSize()) {
         PAL_ERR(LOG_TAG, "Unexpected, merged model sz %d > current sz %d",
-            out_model.size, eng_sm_info_->GetModelSize());
-        delete sm_info;
+            sm_info->GetModelSize(), eng_sm_info_->GetModelSize());
         status = -EINVAL;
         goto cleanup;
     }
+    if (!cache_hit)
+        MergedSoundModelCache::GetInstance()->Put(merge_key, sm_info);
 
     PAL_INFO(LOG_TAG, "Updated sound model: current size %d, new size %d",
-        eng_sm_info_->GetModelSize(), out_model.size);
+        eng_sm_info_->GetModelSize(), sm_info->GetModelSize());
 
     *eng_sm_info_ = *sm_info;
     sm_merged_ = true;
 
-    return 0;
-
 cleanup:
+    if (sm_info)
+        delete sm_info;
+
     if (out_model.data)
         free(out_model.data);
 
@@ -2564,7 +2658,7 @@ void SoundTriggerEngineGsl::HandleSessionEvent(uint32_t event_id __unused,
         ar_mem_cpy(custom_detection_event, size, data, size);
     }
     if (st_info_->GetEnableDebugDumps()) {
-        ST_DBG_DECLARE(FILE *det_event_fd = NULL;
+        ST_DBG_DECLARE(PalDumpFile *det_event_fd = NULL;
             static int det_event_cnt = 0);
         ST_DBG_FILE_OPEN_WR(det_event_fd, ST_DEBUG_DUMP_LOCATION,
             "det_event", "bin", det_event_cnt);
@@ -168,7 +168,10 @@ protected:
     static std::mutex pauseMutex;
     bool mutexLockedbyRm = false;
     sem_t mInUse;
+    uint64_t mSsrDropDeadlineUs = 0;
     int connectToDefaultDevice(Stream* streamHandle, uint32_t dir);
+    uint64_t getSsrDropDeadline(size_t size, uint32_t frameSize, uint32_t sampleRate);
+    static void waitForSsrDropDeadline(uint64_t deadlineUs);
 public:
     virtual ~Stream() {};
     struct pal_volume_data* mVolumeData = NULL;
@@ -220,6 +223,8 @@ public:
     uint32_t getRenderLatency();
     uint32_t getLatency();
     int32_t getAssociatedDevices(std::vector <std::shared_ptr<Device>> &adevices);
+    bool hasAssociatedDevices() { return !mDevices.empty(); }
+    bool isDeviceAssociated(std::shared_ptr<Device> d);
     int32_t getAssociatedPalDevices(std::vector <struct pal_device> &palDevices);
     void clearOutPalDevices();
     void addPalDevice(struct pal_device *dattr) { mPalDevice.push_back(*dattr); }
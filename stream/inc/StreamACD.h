@@ -143,222 +143,175 @@ class StreamACD : public Stream {
     void SetEngineDetectionData(struct acd_context_event *event);
     struct acd_recognition_cfg *GetRecognitionConfig();
  private:
-    class ACDEventConfigData {
-     public:
-        ACDEventConfigData() {}
-        virtual ~ACDEventConfigData() {}
+    /*
+     * Events are small values built on the caller's stack and passed by
+     * reference through ProcessEvent, so no event allocates. id_ selects
+     * which member of data_ is valid; the typed subclasses add no members.
+     */
+    struct ACDLoadEventConfigData {
+        void *data_;
     };
 
-    class ACDEventConfig {
-     public:
-        explicit ACDEventConfig(int32_t ev_id)
-            : id_(ev_id), data_(nullptr) {}
-        virtual ~ACDEventConfig() {}
+    struct ACDRecognitionCfgEventConfigData {
+        void *data_;
+    };
 
-        int32_t id_; // event id
-        std::shared_ptr<ACDEventConfigData> data_; // event specific data
+    struct ACDContextCfgEventConfigData {
+        void *data_;
     };
 
-    class ACDLoadEventConfigData : public ACDEventConfigData {
-     public:
-        ACDLoadEventConfigData(void *data): data_(data) {}
-        ~ACDLoadEventConfigData() {}
+    struct ACDStartRecognitionEventConfigData {
+        bool restart_;
+    };
+
+    struct ACDStopRecognitionEventConfigData {
+        bool deferred_;
+    };
 
+    struct ACDDetectedEventConfigData {
         void *data_;
     };
 
+    struct ACDConcurrentStreamEventConfigData {
+        bool is_active_;
+    };
+
+    struct ACDDeviceConnectedEventConfigData {
+        pal_device_id_t dev_id_;
+    };
+
+    struct ACDDeviceDisconnectedEventConfigData {
+        pal_device_id_t dev_id_;
+    };
+
+    struct ACDECRefEventConfigData {
+        bool is_enable_;
+    };
+
+    class ACDEventConfig {
+     public:
+        explicit ACDEventConfig(int32_t ev_id)
+            : id_(ev_id), data_(), dev_(nullptr) {}
+
+        int32_t id_; // event id
+        union {
+            ACDLoadEventConfigData load_;
+            ACDRecognitionCfgEventConfigData rec_cfg_;
+            ACDContextCfgEventConfigData context_cfg_;
+            ACDStartRecognitionEventConfigData start_;
+            ACDStopRecognitionEventConfigData stop_;
+            ACDDetectedEventConfigData detected_;
+            ACDConcurrentStreamEventConfigData concurrent_;
+            ACDDeviceConnectedEventConfigData dev_connected_;
+            ACDDeviceDisconnectedEventConfigData dev_disconnected_;
+            ACDECRefEventConfigData ec_ref_;
+        } data_; // event specific data
+        std::shared_ptr<Device> dev_; // ec ref device, ACD_EV_EC_REF only
+    };
+
     class ACDLoadEventConfig : public ACDEventConfig {
      public:
         ACDLoadEventConfig(void *data)
             : ACDEventConfig(ACD_EV_LOAD_SOUND_MODEL) {
-           data_ = std::make_shared<ACDLoadEventConfigData>(data);
+            data_.load_.data_ = data;
         }
-        ~ACDLoadEventConfig() {}
     };
 
     class ACDUnloadEventConfig : public ACDEventConfig {
      public:
         ACDUnloadEventConfig() : ACDEventConfig(ACD_EV_UNLOAD_SOUND_MODEL) {}
-        ~ACDUnloadEventConfig() {}
-    };
-
-    class ACDRecognitionCfgEventConfigData : public ACDEventConfigData {
-     public:
-        ACDRecognitionCfgEventConfigData(void *data): data_(data) {}
-        ~ACDRecognitionCfgEventConfigData() {}
-
-        void *data_;
     };
 
     class ACDRecognitionCfgEventConfig : public ACDEventConfig {
      public:
         ACDRecognitionCfgEventConfig(void *data)
             : ACDEventConfig(ACD_EV_RECOGNITION_CONFIG) {
-            data_ = std::make_shared<ACDRecognitionCfgEventConfigData>(data);
+            data_.rec_cfg_.data_ = data;
         }
-        ~ACDRecognitionCfgEventConfig() {}
-    };
-
-    class ACDContextCfgEventConfigData : public ACDEventConfigData {
-     public:
-        ACDContextCfgEventConfigData(void *data): data_(data) {}
-        ~ACDContextCfgEventConfigData() {}
-
-        void *data_;
     };
 
     class ACDContextCfgEventConfig : public ACDEventConfig {
      public:
         ACDContextCfgEventConfig(void *data)
             : ACDEventConfig(ACD_EV_CONTEXT_CONFIG) {
-            data_ = std::make_shared<ACDContextCfgEventConfigData>(data);
+            data_.context_cfg_.data_ = data;
         }
-        ~ACDContextCfgEventConfig() {}
-    };
-
-    class ACDStartRecognitionEventConfigData : public ACDEventConfigData {
-     public:
-        ACDStartRecognitionEventConfigData(int32_t rs) : restart_(rs) {}
-        ~ACDStartRecognitionEventConfigData() {}
-
-        bool restart_;
     };
 
     class ACDStartRecognitionEventConfig : public ACDEventConfig {
      public:
         ACDStartRecognitionEventConfig(bool restart)
             : ACDEventConfig(ACD_EV_START_RECOGNITION) {
-            data_ = std::make_shared<ACDStartRecognitionEventConfigData>(restart);
+            data_.start_.restart_ = restart;
         }
-        ~ACDStartRecognitionEventConfig() {}
-    };
-
-    class ACDStopRecognitionEventConfigData : public ACDEventConfigData {
-     public:
-        ACDStopRecognitionEventConfigData(bool deferred) : deferred_(deferred) {}
-        ~ACDStopRecognitionEventConfigData() {}
-
-        bool deferred_;
     };
 
     class ACDStopRecognitionEventConfig : public ACDEventConfig {
      public:
         ACDStopRecognitionEventConfig(bool deferred)
             : ACDEventConfig(ACD_EV_STOP_RECOGNITION) {
-            data_ = std::make_shared<ACDStopRecognitionEventConfigData>(deferred);
+            data_.stop_.deferred_ = deferred;
         }
-        ~ACDStopRecognitionEventConfig() {}
-    };
-
-    class ACDDetectedEventConfigData : public ACDEventConfigData {
-     public:
-        ACDDetectedEventConfigData(void *data) : data_(data) {}
-        ~ACDDetectedEventConfigData() {}
-
-        void *data_;
     };
 
     class ACDDetectedEventConfig : public ACDEventConfig {
      public:
         ACDDetectedEventConfig(void *data) : ACDEventConfig(ACD_EV_DETECTED) {
-            data_ = std::make_shared<ACDDetectedEventConfigData>(data);
+            data_.detected_.data_ = data;
         }
-        ~ACDDetectedEventConfig() {}
-    };
-
-    class ACDConcurrentStreamEventConfigData : public ACDEventConfigData {
-     public:
-        ACDConcurrentStreamEventConfigData(bool active)
-            : is_active_(active) {}
-        ~ACDConcurrentStreamEventConfigData() {}
-
-        bool is_active_;
     };
 
     class ACDConcurrentStreamEventConfig : public ACDEventConfig {
      public:
         ACDConcurrentStreamEventConfig (bool active)
             : ACDEventConfig(ACD_EV_CONCURRENT_STREAM) {
-            data_ = std::make_shared<ACDConcurrentStreamEventConfigData>(active);
+            data_.concurrent_.is_active_ = active;
         }
-        ~ACDConcurrentStreamEventConfig () {}
     };
 
     class ACDPauseEventConfig : public ACDEventConfig {
      public:
         ACDPauseEventConfig() : ACDEventConfig(ACD_EV_PAUSE) { }
-        ~ACDPauseEventConfig() {}
     };
 
     class ACDResumeEventConfig : public ACDEventConfig {
      public:
         ACDResumeEventConfig() : ACDEventConfig(ACD_EV_RESUME) { }
-        ~ACDResumeEventConfig() {}
-    };
-
-    class ACDDeviceConnectedEventConfigData : public ACDEventConfigData {
-     public:
-        ACDDeviceConnectedEventConfigData(pal_device_id_t id)
-            : dev_id_(id) {}
-        ~ACDDeviceConnectedEventConfigData() {}
-
-        pal_device_id_t dev_id_;
     };
 
     class ACDDeviceConnectedEventConfig : public ACDEventConfig {
      public:
         ACDDeviceConnectedEventConfig(pal_device_id_t id)
             : ACDEventConfig(ACD_EV_DEVICE_CONNECTED) {
-            data_ = std::make_shared<ACDDeviceConnectedEventConfigData>(id);
+            data_.dev_connected_.dev_id_ = id;
         }
-        ~ACDDeviceConnectedEventConfig() {}
     };
 
-    class ACDDeviceDisconnectedEventConfigData : public ACDEventConfigData {
-     public:
-        ACDDeviceDisconnectedEventConfigData(pal_device_id_t id)
-            : dev_id_(id) {}
-        ~ACDDeviceDisconnectedEventConfigData() {}
-
-        pal_device_id_t dev_id_;
-    };
     class ACDDeviceDisconnectedEventConfig : public ACDEventConfig {
      public:
         ACDDeviceDisconnectedEventConfig(pal_device_id_t id)
             : ACDEventConfig(ACD_EV_DEVICE_DISCONNECTED) {
-            data_ = std::make_shared<ACDDeviceDisconnectedEventConfigData>(id);
+            data_.dev_disconnected_.dev_id_ = id;
         }
-        ~ACDDeviceDisconnectedEventConfig() {}
     };
 
-    class ACDECRefEventConfigData : public ACDEventConfigData {
-     public:
-        ACDECRefEventConfigData(std::shared_ptr<Device> dev, bool is_enable)
-            : dev_(dev), is_enable_(is_enable) {}
-        ~ACDECRefEventConfigData() {}
-
-        std::shared_ptr<Device> dev_;
-        bool is_enable_;
-    };
     class ACDECRefEventConfig : public ACDEventConfig {
      public:
         ACDECRefEventConfig(std::shared_ptr<Device> dev, bool is_enable)
             : ACDEventConfig(ACD_EV_EC_REF) {
-            data_ = std::make_shared<ACDECRefEventConfigData>(dev, is_enable);
+            dev_ = dev;
+            data_.ec_ref_.is_enable_ = is_enable;
         }
-        ~ACDECRefEventConfig() {}
     };
 
     class ACDSSROfflineConfig : public ACDEventConfig {
      public:
         ACDSSROfflineConfig() : ACDEventConfig(ACD_EV_SSR_OFFLINE) { }
-        ~ACDSSROfflineConfig() {}
     };
 
     class ACDSSROnlineConfig : public ACDEventConfig {
      public:
         ACDSSROnlineConfig() : ACDEventConfig(ACD_EV_SSR_ONLINE) { }
-        ~ACDSSROnlineConfig() {}
     };
 
     class ACDState {
@@ -370,7 +323,7 @@ class StreamACD : public Stream {
         int32_t GetStateId() { return state_id_; }
 
      protected:
-        virtual int32_t ProcessEvent(std::shared_ptr<ACDEventConfig> ev_cfg) = 0;
+        virtual int32_t ProcessEvent(ACDEventConfig &ev_cfg) = 0;
 
         void TransitTo(int32_t state_id) { acd_stream_.TransitTo(state_id); }
 
@@ -386,7 +339,7 @@ class StreamACD : public Stream {
         ACDIdle(StreamACD& acd_stream)
             : ACDState(acd_stream, ACD_STATE_IDLE) {}
         ~ACDIdle() {}
-        int32_t ProcessEvent(std::shared_ptr<ACDEventConfig> ev_cfg) override;
+        int32_t ProcessEvent(ACDEventConfig &ev_cfg) override;
     };
 
     class ACDLoaded : public ACDState {
@@ -394,14 +347,14 @@ class StreamACD : public Stream {
         ACDLoaded(StreamACD& acd_stream)
             : ACDState(acd_stream, ACD_STATE_LOADED) {}
         ~ACDLoaded() {}
-        int32_t ProcessEvent(std::shared_ptr<ACDEventConfig> ev_cfg) override;
+        int32_t ProcessEvent(ACDEventConfig &ev_cfg) override;
     };
     class ACDActive : public ACDState {
      public:
         ACDActive(StreamACD& acd_stream)
             : ACDState(acd_stream, ACD_STATE_ACTIVE) {}
         ~ACDActive() {}
-        int32_t ProcessEvent(std::shared_ptr<ACDEventConfig> ev_cfg) override;
+        int32_t ProcessEvent(ACDEventConfig &ev_cfg) override;
     };
 
     class ACDDetected : public ACDState {
@@ -409,7 +362,7 @@ class StreamACD : public Stream {
         ACDDetected(StreamACD& acd_stream)
             : ACDState(acd_stream, ACD_STATE_DETECTED) {}
         ~ACDDetected() {}
-        int32_t ProcessEvent(std::shared_ptr<ACDEventConfig> ev_cfg) override;
+        int32_t ProcessEvent(ACDEventConfig &ev_cfg) override;
     };
 
     class ACDSSR : public ACDState {
@@ -417,12 +370,12 @@ class StreamACD : public Stream {
         ACDSSR(StreamACD& acd_stream)
             : ACDState(acd_stream, ACD_STATE_SSR) {}
         ~ACDSSR() {}
-        int32_t ProcessEvent(std::shared_ptr<ACDEventConfig> ev_cfg) override;
+        int32_t ProcessEvent(ACDEventConfig &ev_cfg) override;
     };
 
     void AddState(ACDState* state);
     int32_t GetPreviousStateId();
-    int32_t ProcessInternalEvent(std::shared_ptr<ACDEventConfig> ev_cfg);
+    int32_t ProcessInternalEvent(ACDEventConfig &ev_cfg);
 
     int32_t SetupStreamConfig(const struct st_uuid *vendor_uuid);
     int32_t UpdateRecognitionConfig(struct acd_recognition_cfg *config);
@@ -37,6 +37,7 @@
 #include "Stream.h"
 #include "SoundTriggerEngine.h"
 #include "PalRingBuffer.h"
+#include "PalEventExecutor.h"
 #include "SoundTriggerPlatformInfo.h"
 #include "SoundTriggerUtils.h"
 
@@ -96,6 +97,7 @@ enum {
 
 class ResourceManager;
 class SoundModelInfo;
+class StreamSoundTriggerAllocTest;
 
 class StreamSoundTrigger : public Stream {
  public:
@@ -169,6 +171,7 @@ class StreamSoundTrigger : public Stream {
     void TransitTo(int32_t state_id);
 
     friend class PalRingBufferReader;
+    friend class StreamSoundTriggerAllocTest;
     bool IsCaptureRequested() { return capture_requested_; }
     uint32_t GetRecognitionMode() { return recognition_mode_; }
     uint32_t GetHistBufDuration() { return hist_buf_duration_; }
@@ -210,225 +213,181 @@ class StreamSoundTrigger : public Stream {
         int32_t sm_size_;
     };
 
-    class StEventConfigData {
-     public:
-        StEventConfigData() {}
-        virtual ~StEventConfigData() {}
+    /*
+     * Events are small values built on the caller's stack and passed by
+     * reference through ProcessEvent, so driving the state machine (and
+     * every LAB read) performs no heap allocation. id_ selects which member
+     * of data_ is valid. The typed subclasses below only fill in id_ and
+     * data_, they add no members, so copying one as StEventConfig is safe.
+     */
+    struct StLoadEventConfigData {
+        void *data_;
     };
 
-    class StEventConfig {
-     public:
-        explicit StEventConfig(int32_t ev_id)
-            : id_(ev_id), data_(nullptr) {}
-        virtual ~StEventConfig() {}
+    struct StRecognitionCfgEventConfigData {
+        void *data_;
+    };
 
-        int32_t id_; // event id
-        std::shared_ptr<StEventConfigData> data_; // event specific data
+    struct StStartRecognitionEventConfigData {
+        bool restart_;
     };
 
-    class StLoadEventConfigData : public StEventConfigData {
-     public:
-        StLoadEventConfigData(void *data): data_(data) {}
-        ~StLoadEventConfigData() {}
+    struct StStopRecognitionEventConfigData {
+        bool deferred_;
+    };
+
+    struct StDetectedEventConfigData {
+        int32_t det_type_;
+    };
 
+    struct StReadBufferEventConfigData {
         void *data_;
     };
 
+    struct StConcurrentStreamEventConfigData {
+        bool is_active_;
+    };
+
+    struct StECRefEventConfigData {
+        bool is_enable_;
+    };
+
+    struct StDeviceConnectedEventConfigData {
+        pal_device_id_t dev_id_;
+    };
+
+    struct StDeviceDisconnectedEventConfigData {
+        pal_device_id_t dev_id_;
+    };
+
+    class StEventConfig {
+     public:
+        explicit StEventConfig(int32_t ev_id)
+            : id_(ev_id), data_(), dev_(nullptr) {}
+
+        int32_t id_; // event id
+        union {
+            StLoadEventConfigData load_;
+            StRecognitionCfgEventConfigData rec_cfg_;
+            StStartRecognitionEventConfigData start_;
+            StStopRecognitionEventConfigData stop_;
+            StDetectedEventConfigData detected_;
+            StReadBufferEventConfigData read_buf_;
+            StConcurrentStreamEventConfigData concurrent_;
+            StECRefEventConfigData ec_ref_;
+            StDeviceConnectedEventConfigData dev_connected_;
+            StDeviceDisconnectedEventConfigData dev_disconnected_;
+        } data_; // event specific data
+        std::shared_ptr<Device> dev_; // ec ref device, ST_EV_EC_REF only
+    };
+
     class StLoadEventConfig : public StEventConfig {
      public:
         StLoadEventConfig(void *data)
             : StEventConfig(ST_EV_LOAD_SOUND_MODEL) {
-           data_ = std::make_shared<StLoadEventConfigData>(data);
+            data_.load_.data_ = data;
         }
-        ~StLoadEventConfig() {}
     };
 
     class StUnloadEventConfig : public StEventConfig {
      public:
         StUnloadEventConfig() : StEventConfig(ST_EV_UNLOAD_SOUND_MODEL) {}
-        ~StUnloadEventConfig() {}
-    };
-
-    class StRecognitionCfgEventConfigData : public StEventConfigData {
-     public:
-        StRecognitionCfgEventConfigData(void *data): data_(data) {}
-        ~StRecognitionCfgEventConfigData() {}
-
-        void *data_;
     };
 
     class StRecognitionCfgEventConfig : public StEventConfig {
      public:
         StRecognitionCfgEventConfig(void *data)
             : StEventConfig(ST_EV_RECOGNITION_CONFIG) {
-            data_ = std::make_shared<StRecognitionCfgEventConfigData>(data);
+            data_.rec_cfg_.data_ = data;
         }
-        ~StRecognitionCfgEventConfig() {}
-    };
-
-    class StStartRecognitionEventConfigData : public StEventConfigData {
-     public:
-        StStartRecognitionEventConfigData(int32_t rs) : restart_(rs) {}
-        ~StStartRecognitionEventConfigData() {}
-
-        bool restart_;
     };
 
     class StStartRecognitionEventConfig : public StEventConfig {
      public:
         StStartRecognitionEventConfig(bool restart)
             : StEventConfig(ST_EV_START_RECOGNITION) {
-            data_ = std::make_shared<StStartRecognitionEventConfigData>(restart);
+            data_.start_.restart_ = restart;
         }
-        ~StStartRecognitionEventConfig() {}
-    };
-
-    class StStopRecognitionEventConfigData : public StEventConfigData {
-     public:
-        StStopRecognitionEventConfigData(bool deferred) : deferred_(deferred) {}
-        ~StStopRecognitionEventConfigData() {}
-
-        bool deferred_;
     };
 
     class StStopRecognitionEventConfig : public StEventConfig {
      public:
         StStopRecognitionEventConfig(bool deferred)
             : StEventConfig(ST_EV_STOP_RECOGNITION) {
-            data_ = std::make_shared<StStopRecognitionEventConfigData>(deferred);
+            data_.stop_.deferred_ = deferred;
         }
-        ~StStopRecognitionEventConfig() {}
-    };
-
-    class StDetectedEventConfigData : public StEventConfigData {
-     public:
-        StDetectedEventConfigData(int32_t type) : det_type_(type) {}
-        ~StDetectedEventConfigData() {}
-
-        int32_t det_type_;
     };
 
     class StDetectedEventConfig : public StEventConfig {
      public:
         StDetectedEventConfig(int32_t type) : StEventConfig(ST_EV_DETECTED) {
-            data_ = std::make_shared<StDetectedEventConfigData>(type);
+            data_.detected_.det_type_ = type;
         }
-        ~StDetectedEventConfig() {}
-    };
-
-    class StReadBufferEventConfigData : public StEventConfigData {
-     public:
-        StReadBufferEventConfigData(void *data) : data_(data) {}
-        ~StReadBufferEventConfigData() {}
-
-        void *data_;
     };
 
     class StReadBufferEventConfig : public StEventConfig {
      public:
         StReadBufferEventConfig(void *data) : StEventConfig(ST_EV_READ_BUFFER) {
-            data_ = std::make_shared<StReadBufferEventConfigData>(data);
+            data_.read_buf_.data_ = data;
         }
-        ~StReadBufferEventConfig() {}
     };
 
     class StStopBufferingEventConfig : public StEventConfig {
      public:
         StStopBufferingEventConfig () : StEventConfig(ST_EV_STOP_BUFFERING) {}
-        ~StStopBufferingEventConfig () {}
-    };
-
-    class StConcurrentStreamEventConfigData : public StEventConfigData {
-     public:
-        StConcurrentStreamEventConfigData(bool active)
-            : is_active_(active) {}
-        ~StConcurrentStreamEventConfigData() {}
-
-        bool is_active_;
     };
 
     class StConcurrentStreamEventConfig : public StEventConfig {
      public:
         StConcurrentStreamEventConfig (bool active)
             : StEventConfig(ST_EV_CONCURRENT_STREAM) {
-            data_ = std::make_shared<StConcurrentStreamEventConfigData>(active);
+            data_.concurrent_.is_active_ = active;
         }
-        ~StConcurrentStreamEventConfig () {}
     };
 
     class StPauseEventConfig : public StEventConfig {
      public:
         StPauseEventConfig() : StEventConfig(ST_EV_PAUSE) { }
-        ~StPauseEventConfig() {}
     };
 
     class StResumeEventConfig : public StEventConfig {
      public:
         StResumeEventConfig() : StEventConfig(ST_EV_RESUME) { }
-        ~StResumeEventConfig() {}
     };
 
-    class StECRefEventConfigData : public StEventConfigData {
-     public:
-        StECRefEventConfigData(std::shared_ptr<Device> dev, bool is_enable)
-            : dev_(dev), is_enable_(is_enable) {}
-        ~StECRefEventConfigData() {}
-
-        std::shared_ptr<Device> dev_;
-        bool is_enable_;
-    };
     class StECRefEventConfig : public StEventConfig {
      public:
         StECRefEventConfig(std::shared_ptr<Device> dev, bool is_enable)
             : StEventConfig(ST_EV_EC_REF) {
-            data_ = std::make_shared<StECRefEventConfigData>(dev, is_enable);
+            dev_ = dev;
+            data_.ec_ref_.is_enable_ = is_enable;
         }
-        ~StECRefEventConfig() {}
     };
-    class StDeviceConnectedEventConfigData : public StEventConfigData {
-     public:
-        StDeviceConnectedEventConfigData(pal_device_id_t id)
-            : dev_id_(id) {}
-        ~StDeviceConnectedEventConfigData() {}
 
-        pal_device_id_t dev_id_;
-    };
     class StDeviceConnectedEventConfig : public StEventConfig {
      public:
         StDeviceConnectedEventConfig(pal_device_id_t id)
             : StEventConfig(ST_EV_DEVICE_CONNECTED) {
-            data_ = std::make_shared<StDeviceConnectedEventConfigData>(id);
+            data_.dev_connected_.dev_id_ = id;
         }
-        ~StDeviceConnectedEventConfig() {}
     };
 
-    class StDeviceDisconnectedEventConfigData : public StEventConfigData {
-     public:
-        StDeviceDisconnectedEventConfigData(pal_device_id_t id)
-            : dev_id_(id) {}
-        ~StDeviceDisconnectedEventConfigData() {}
-
-        pal_device_id_t dev_id_;
-    };
     class StDeviceDisconnectedEventConfig : public StEventConfig {
      public:
         StDeviceDisconnectedEventConfig(pal_device_id_t id)
             : StEventConfig(ST_EV_DEVICE_DISCONNECTED) {
-            data_ = std::make_shared<StDeviceDisconnectedEventConfigData>(id);
+            data_.dev_disconnected_.dev_id_ = id;
         }
-        ~StDeviceDisconnectedEventConfig() {}
     };
 
     class StSSROfflineConfig : public StEventConfig {
      public:
         StSSROfflineConfig() : StEventConfig(ST_EV_SSR_OFFLINE) { }
-        ~StSSROfflineConfig() {}
     };
 
     class StSSROnlineConfig : public StEventConfig {
      public:
         StSSROnlineConfig() : StEventConfig(ST_EV_SSR_ONLINE) { }
-        ~StSSROnlineConfig() {}
     };
 
     class StState {
@@ -440,7 +399,7 @@ class StreamSoundTrigger : public Stream {
         int32_t GetStateId() { return state_id_; }
 
      protected:
-        virtual int32_t ProcessEvent(std::shared_ptr<StEventConfig> ev_cfg) = 0;
+        virtual int32_t ProcessEvent(StEventConfig &ev_cfg) = 0;
 
         void TransitTo(int32_t state_id) { st_stream_.TransitTo(state_id); }
 
@@ -456,7 +415,7 @@ class StreamSoundTrigger : public Stream {
         StIdle(StreamSoundTrigger& st_stream)
             : StState(st_stream, ST_STATE_IDLE) {}
         ~StIdle() {}
-        int32_t ProcessEvent(std::shared_ptr<StEventConfig> ev_cfg) override;
+        int32_t ProcessEvent(StEventConfig &ev_cfg) override;
     };
 
     class StLoaded : public StState {
@@ -464,7 +423,7 @@ class StreamSoundTrigger : public Stream {
         StLoaded(StreamSoundTrigger& st_stream)
             : StState(st_stream, ST_STATE_LOADED) {}
         ~StLoaded() {}
-        int32_t ProcessEvent(std::shared_ptr<StEventConfig> ev_cfg) override;
+        int32_t ProcessEvent(StEventConfig &ev_cfg) override;
     };
 
     class StActive : public StState {
@@ -472,7 +431,7 @@ class StreamSoundTrigger : public Stream {
         StActive(StreamSoundTrigger& st_stream)
             : StState(st_stream, ST_STATE_ACTIVE) {}
         ~StActive() {}
-        int32_t ProcessEvent(std::shared_ptr<StEventConfig> ev_cfg) override;
+        int32_t ProcessEvent(StEventConfig &ev_cfg) override;
     };
 
     class StDetected : public StState {
@@ -480,7 +439,7 @@ class StreamSoundTrigger : public Stream {
         StDetected(StreamSoundTrigger& st_stream)
             : StState(st_stream, ST_STATE_DETECTED) {}
         ~StDetected() {}
-        int32_t ProcessEvent(std::shared_ptr<StEventConfig> ev_cfg) override;
+        int32_t ProcessEvent(StEventConfig &ev_cfg) override;
     };
 
     class StBuffering : public StState {
@@ -488,7 +447,7 @@ class StreamSoundTrigger : public Stream {
         StBuffering(StreamSoundTrigger& st_stream)
             : StState(st_stream, ST_STATE_BUFFERING) {}
         ~StBuffering() {}
-        int32_t ProcessEvent(std::shared_ptr<StEventConfig> ev_cfg) override;
+        int32_t ProcessEvent(StEventConfig &ev_cfg) override;
     };
 
     class StSSR : public StState {
@@ -496,7 +455,7 @@ class StreamSoundTrigger : public Stream {
         StSSR(StreamSoundTrigger& st_stream)
             : StState(st_stream, ST_STATE_SSR) {}
         ~StSSR() {}
-        int32_t ProcessEvent(std::shared_ptr<StEventConfig> ev_cfg) override;
+        int32_t ProcessEvent(StEventConfig &ev_cfg) override;
     };
 
     pal_device_id_t GetAvailCaptureDevice();
@@ -535,16 +494,12 @@ class StreamSoundTrigger : public Stream {
                                         uint32_t *event_data,
                                         uint64_t cookie __unused);
 
-    static void TimerThread(StreamSoundTrigger& st_stream);
     void PostDelayedStop();
     void CancelDelayedStop();
     void InternalStopRecognition();
-    std::thread timer_thread_;
+    std::shared_ptr<PalEventQueue> timer_queue_;
     std::mutex timer_mutex_;
-    std::condition_variable timer_start_cond_;
-    std::condition_variable timer_wait_cond_;
-    bool timer_stop_waiting_;
-    bool exit_timer_thread_;
+    uint64_t stop_timer_id_;
     bool pending_stop_;
     bool paused_;
     bool device_opened_;
@@ -552,7 +507,7 @@ class StreamSoundTrigger : public Stream {
 
     void AddState(StState* state);
     int32_t GetPreviousStateId();
-    int32_t ProcessInternalEvent(std::shared_ptr<StEventConfig> ev_cfg);
+    int32_t ProcessInternalEvent(StEventConfig &ev_cfg);
     void GetUUID(class SoundTriggerUUID *uuid, struct pal_st_sound_model
                                                           *sound_model);
     std::shared_ptr<SoundTriggerPlatformInfo> st_info_;
@@ -596,7 +551,7 @@ class StreamSoundTrigger : public Stream {
     uint32_t pre_roll_duration_;
     bool use_lpi_;
     uint32_t model_id_;
-    FILE *lab_fd_;
+    PalDumpFile *lab_fd_;
     bool rejection_notified_;
     ChronoSteadyClock_t transit_start_time_;
     ChronoSteadyClock_t transit_end_time_;
@@ -62,6 +62,7 @@
 
 #define LOG_TAG "PAL: Stream"
 #include <semaphore.h>
+#include <time.h>
 #include "Stream.h"
 #include "StreamPCM.h"
 #include "StreamInCall.h"
@@ -519,6 +520,11 @@ int32_t Stream::getAssociatedDevices(std::vector <std::shared_ptr<Device>> &aDev
     return status;
 }
 
+bool Stream::isDeviceAssociated(std::shared_ptr<Device> d)
+{
+    return std::find(mDevices.begin(), mDevices.end(), d) != mDevices.end();
+}
+
 void Stream::clearOutPalDevices()
 {
     std::vector <struct pal_device>::iterator dIter;
@@ -792,6 +798,38 @@ bool Stream::isStreamAudioOutFmtSupported(pal_audio_fmt_t format)
     }
 }
 
+/*
+ * While the card is offline, reads and writes are dropped against a
+ * virtual device consuming size bytes in real time. Called with
+ * mStreamMutex held; the caller waits for the returned deadline after
+ * releasing it so stop, close and device switch are not held off.
+ */
+uint64_t Stream::getSsrDropDeadline(size_t size, uint32_t frameSize, uint32_t sampleRate)
+{
+    struct timespec ts;
+    uint64_t nowUs = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    nowUs = (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+
+    /* a caller running late starts a new period instead of bursting */
+    if (mSsrDropDeadlineUs < nowUs)
+        mSsrDropDeadlineUs = nowUs;
+    mSsrDropDeadlineUs += (uint64_t)size * 1000000 / frameSize / sampleRate;
+
+    return mSsrDropDeadlineUs;
+}
+
+void Stream::waitForSsrDropDeadline(uint64_t deadlineUs)
+{
+    struct timespec ts;
+
+    ts.tv_sec = deadlineUs / 1000000;
+    ts.tv_nsec = (deadlineUs % 1000000) * 1000;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+        ;
+}
+
 int32_t Stream::getTimestamp(struct pal_session_time *stime)
 {
     int32_t status = 0;
@@ -1029,6 +1067,7 @@ int32_t Stream::disconnectStreamDevice(Stream* streamHandle, pal_device_id_t dev
 int32_t Stream::disconnectStreamDevice_l(Stream* streamHandle, pal_device_id_t dev_id)
 {
     int32_t status = 0;
+    std::vector<std::mutex *> heldBackEnds;
 
     if (currentState == STREAM_IDLE) {
         for (int i = 0; i < mDevices.size(); i++) {
@@ -1052,22 +1091,22 @@ int32_t Stream::disconnectStreamDevice_l(Stream* streamHandle, pal_device_id_t d
             if (currentState != STREAM_STOPPED) {
                 rm->deregisterDevice(mDevices[i], this);
             }
-            rm->lockGraph();
+            rm->lockGraph({mDevices[i]}, heldBackEnds);
             status = session->disconnectSessionDevice(streamHandle, mStreamAttr->type, mDevices[i]);
             if (0 != status) {
                 PAL_ERR(LOG_TAG, "disconnectSessionDevice failed:%d", status);
-                rm->unlockGraph();
+                rm->unlockGraph(heldBackEnds);
                 goto exit;
             }
             if (currentState != STREAM_INIT && currentState != STREAM_STOPPED) {
                 status = mDevices[i]->stop();
                 if (0 != status) {
                     PAL_ERR(LOG_TAG, "device stop failed with status %d", status);
-                    rm->unlockGraph();
+                    rm->unlockGraph(heldBackEnds);
                     goto exit;
                 }
             }
-            rm->unlockGraph();
+            rm->unlockGraph(heldBackEnds);
 
             status = mDevices[i]->close();
             if (0 != status) {
@@ -1099,6 +1138,7 @@ int32_t Stream::connectStreamDevice_l(Stream* streamHandle, struct pal_device *d
     std::shared_ptr<Device> dev = nullptr;
     std::string newBackEndName;
     std::string curBackEndName;
+    std::vector<std::mutex *> heldBackEnds;
 
     if (!dattr) {
         PAL_ERR(LOG_TAG, "invalid params");
@@ -1160,23 +1200,23 @@ int32_t Stream::connectStreamDevice_l(Stream* streamHandle, struct pal_device *d
         goto dev_close;
     }
 
-    rm->lockGraph();
+    rm->lockGraph({dev}, heldBackEnds);
     if (currentState != STREAM_INIT && currentState != STREAM_STOPPED) {
         status = dev->start();
         if (0 != status) {
             PAL_ERR(LOG_TAG, "device %d name %s, start failed with status %d",
                 dev->getSndDeviceId(), dev->getPALDeviceName().c_str(), status);
-            rm->unlockGraph();
+            rm->unlockGraph(heldBackEnds);
             goto dev_close;
         }
     }
     status = session->connectSessionDevice(streamHandle, mStreamAttr->type, dev);
     if (0 != status) {
         PAL_ERR(LOG_TAG, "connectSessionDevice failed:%d", status);
-        rm->unlockGraph();
+        rm->unlockGraph(heldBackEnds);
         goto dev_stop;
     }
-    rm->unlockGraph();
+    rm->unlockGraph(heldBackEnds);
     if (currentState != STREAM_STOPPED) {
         rm->registerDevice(dev, this);
     }
@@ -1777,7 +1817,8 @@ bool Stream::checkStreamMatch(pal_device_id_t pal_device_id,
 
 int Stream::initStreamSmph()
 {
-    return sem_init(&mInUse, 0, 1);
+    /* posted by the last user after the stream is deactivated */
+    return sem_init(&mInUse, 0, 0);
 }
 
 int Stream::deinitStreamSmph()
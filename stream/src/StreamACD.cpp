@@ -212,7 +212,7 @@ int32_t StreamACD::close()
 
     std::lock_guard<std::mutex> lck(mStreamMutex);
 
-    std::shared_ptr<ACDEventConfig> ev_cfg(new ACDUnloadEventConfig());
+    ACDUnloadEventConfig ev_cfg;
     status = cur_state_->ProcessEvent(ev_cfg);
 
     if (rec_config_) {
@@ -241,8 +241,7 @@ int32_t StreamACD::start()
     PAL_DBG(LOG_TAG, "Enter, stream direction %d", mStreamAttr->direction);
 
     std::lock_guard<std::mutex> lck(mStreamMutex);
-    std::shared_ptr<ACDEventConfig> ev_cfg(
-       new ACDStartRecognitionEventConfig(false));
+    ACDStartRecognitionEventConfig ev_cfg(false);
     status = cur_state_->ProcessEvent(ev_cfg);
     if (!status) {
         currentState = STREAM_STARTED;
@@ -258,8 +257,7 @@ int32_t StreamACD::stop()
 
     PAL_DBG(LOG_TAG, "Enter");
     std::lock_guard<std::mutex> lck(mStreamMutex);
-    std::shared_ptr<ACDEventConfig> ev_cfg(
-       new ACDStopRecognitionEventConfig(false));
+    ACDStopRecognitionEventConfig ev_cfg(false);
     status = cur_state_->ProcessEvent(ev_cfg);
     if (!status) {
         currentState = STREAM_STOPPED;
@@ -273,7 +271,7 @@ int32_t StreamACD::Resume() {
 
     PAL_DBG(LOG_TAG, "Enter");
     std::lock_guard<std::mutex> lck(mStreamMutex);
-    std::shared_ptr<ACDEventConfig> ev_cfg(new ACDResumeEventConfig());
+    ACDResumeEventConfig ev_cfg;
     status = cur_state_->ProcessEvent(ev_cfg);
     if (status)
         PAL_ERR(LOG_TAG, "Error:%d Resume failed", status);
@@ -288,7 +286,7 @@ int32_t StreamACD::Pause() {
 
     PAL_DBG(LOG_TAG, "Enter");
     std::lock_guard<std::mutex> lck(mStreamMutex);
-    std::shared_ptr<ACDEventConfig> ev_cfg(new ACDPauseEventConfig());
+    ACDPauseEventConfig ev_cfg;
     status = cur_state_->ProcessEvent(ev_cfg);
     if (status)
         PAL_ERR(LOG_TAG, "Error:%d Pause failed", status);
@@ -305,8 +303,7 @@ int32_t StreamACD::HandleConcurrentStream(bool active) {
     if (active == false)
         mStreamMutex.lock();
 
-    std::shared_ptr<ACDEventConfig> ev_cfg(
-        new ACDConcurrentStreamEventConfig(active));
+    ACDConcurrentStreamEventConfig ev_cfg(active);
     status = cur_state_->ProcessEvent(ev_cfg);
 
     if (active == true)
@@ -349,8 +346,7 @@ int32_t StreamACD::setParameters(uint32_t param_id, void *payload)
     std::lock_guard<std::mutex> lck(mStreamMutex);
     switch (param_id) {
     case PAL_PARAM_ID_LOAD_SOUND_MODEL: {
-        std::shared_ptr<ACDEventConfig> ev_cfg(
-                new ACDLoadEventConfig((void *)param_payload->payload));
+        ACDLoadEventConfig ev_cfg((void *)param_payload->payload);
         status = cur_state_->ProcessEvent(ev_cfg);
         break;
         }
@@ -361,14 +357,12 @@ int32_t StreamACD::setParameters(uint32_t param_id, void *payload)
 
         opaque_ptr = (uint8_t *)config + config->data_offset;
         opaque_ptr += sizeof(struct st_param_header);
-        std::shared_ptr<ACDEventConfig> ev_cfg(
-              new ACDRecognitionCfgEventConfig((void *)opaque_ptr));
+        ACDRecognitionCfgEventConfig ev_cfg((void *)opaque_ptr);
           status = cur_state_->ProcessEvent(ev_cfg);
           break;
       }
       case PAL_PARAM_ID_CONTEXT_LIST: {
-          std::shared_ptr<ACDEventConfig> ev_cfg(
-              new ACDContextCfgEventConfig((void *)param_payload->payload));
+          ACDContextCfgEventConfig ev_cfg((void *)param_payload->payload);
           status = cur_state_->ProcessEvent(ev_cfg);
           break;
       }
@@ -422,8 +416,7 @@ int32_t StreamACD::setECRef(std::shared_ptr<Device> dev, bool is_enable)
 int32_t StreamACD::setECRef_l(std::shared_ptr<Device> dev, bool is_enable)
 {
     int32_t status = 0;
-    std::shared_ptr<ACDEventConfig> ev_cfg(
-        new ACDECRefEventConfig(dev, is_enable));
+    ACDECRefEventConfig ev_cfg(dev, is_enable);
 
     PAL_DBG(LOG_TAG, "Enter, enable %d", is_enable);
 
@@ -575,8 +568,7 @@ void StreamACD::SetEngineDetectionData(struct acd_context_event *event)
 {
     PAL_DBG(LOG_TAG, "Enter");
     mStreamMutex.lock();
-    std::shared_ptr<ACDEventConfig> ev_cfg(
-       new ACDDetectedEventConfig((void *)event));
+    ACDDetectedEventConfig ev_cfg((void *)event);
     cur_state_->ProcessEvent(ev_cfg);
     mStreamMutex.unlock();
     PAL_DBG(LOG_TAG, "Exit");
@@ -630,8 +622,7 @@ int32_t StreamACD::DisconnectDevice(pal_device_id_t device_id) {
      * device disconnect and connect.
      */
     mStreamMutex.lock();
-    std::shared_ptr<ACDEventConfig> ev_cfg(
-        new ACDDeviceDisconnectedEventConfig(device_id));
+    ACDDeviceDisconnectedEventConfig ev_cfg(device_id);
     status = cur_state_->ProcessEvent(ev_cfg);
     if (status)
         PAL_ERR(LOG_TAG, "Error:%d Failed to disconnect device %d", status, device_id);
@@ -645,8 +636,7 @@ int32_t StreamACD::ConnectDevice(pal_device_id_t device_id) {
     int32_t status = 0;
 
     PAL_DBG(LOG_TAG, "Enter");
-    std::shared_ptr<ACDEventConfig> ev_cfg(
-        new ACDDeviceConnectedEventConfig(device_id));
+    ACDDeviceConnectedEventConfig ev_cfg(device_id);
     status = cur_state_->ProcessEvent(ev_cfg);
     if (status)
         PAL_ERR(LOG_TAG, "Error:%d Failed to connect device %d", status, device_id);
@@ -731,7 +721,7 @@ void StreamACD::TransitTo(int32_t state_id)
 }
 
 int32_t StreamACD::ProcessInternalEvent(
-    std::shared_ptr<ACDEventConfig> ev_cfg) {
+    ACDEventConfig &ev_cfg) {
     return cur_state_->ProcessEvent(ev_cfg);
 }
 
@@ -885,7 +875,7 @@ int32_t StreamACD::UpdateRecognitionConfig(struct acd_recognition_cfg *acd_recog
 
     // dump acd recognition config data
     if (acd_info_->GetEnableDebugDumps()) {
-        ST_DBG_DECLARE(FILE *rec_opaque_fd = NULL; static int rec_opaque_cnt = 0);
+        ST_DBG_DECLARE(PalDumpFile *rec_opaque_fd = NULL; static int rec_opaque_cnt = 0);
         ST_DBG_FILE_OPEN_WR(rec_opaque_fd, ST_DEBUG_DUMP_LOCATION,
             "acd_rec_config", "bin", rec_opaque_cnt);
         ST_DBG_FILE_WRITE(rec_opaque_fd,
@@ -911,7 +901,7 @@ int32_t StreamACD::UpdateRecognitionConfig(struct acd_recognition_cfg *acd_recog
 
     // dump acd context config data
     if (acd_info_->GetEnableDebugDumps()) {
-        ST_DBG_DECLARE(FILE *ctx_opaque_fd = NULL; static int ctx_opaque_cnt = 0);
+        ST_DBG_DECLARE(PalDumpFile *ctx_opaque_fd = NULL; static int ctx_opaque_cnt = 0);
         ST_DBG_FILE_OPEN_WR(ctx_opaque_fd, ST_DEBUG_DUMP_LOCATION,
             "acd_context_config", "bin", ctx_opaque_cnt);
         ST_DBG_FILE_WRITE(ctx_opaque_fd,
@@ -973,7 +963,7 @@ int32_t StreamACD::UpdateContextConfig(struct pal_param_context_list *config)
 
     // dump acd context config data
     if (acd_info_->GetEnableDebugDumps()) {
-        ST_DBG_DECLARE(FILE *ctx_opaque_fd = NULL; static int ctx_opaque_cnt = 0);
+        ST_DBG_DECLARE(PalDumpFile *ctx_opaque_fd = NULL; static int ctx_opaque_cnt = 0);
         ST_DBG_FILE_OPEN_WR(ctx_opaque_fd, ST_DEBUG_DUMP_LOCATION,
             "acd_context_config", "bin", ctx_opaque_cnt);
         ST_DBG_FILE_WRITE(ctx_opaque_fd,
@@ -1034,17 +1024,16 @@ void StreamACD::EventNotificationThread(StreamACD *stream)
 }
 
 int32_t StreamACD::ACDIdle::ProcessEvent(
-    std::shared_ptr<ACDEventConfig> ev_cfg)
+    ACDEventConfig &ev_cfg)
 {
     int32_t status = 0;
 
     PAL_DBG(LOG_TAG, "ACDIdle: handle event %d for stream instance %u",
-        ev_cfg->id_, acd_stream_.mInstanceID);
+        ev_cfg.id_, acd_stream_.mInstanceID);
 
-    switch (ev_cfg->id_) {
+    switch (ev_cfg.id_) {
         case ACD_EV_LOAD_SOUND_MODEL: {
-            ACDLoadEventConfigData *data =
-                (ACDLoadEventConfigData *)ev_cfg->data_.get();
+            ACDLoadEventConfigData *data = &ev_cfg.data_.load_;
             struct pal_st_sound_model *pal_acd_sm;
 
             pal_acd_sm = (struct pal_st_sound_model *)data->data_;
@@ -1052,8 +1041,7 @@ int32_t StreamACD::ACDIdle::ProcessEvent(
             break;
         }
         case ACD_EV_RECOGNITION_CONFIG: {
-            ACDRecognitionCfgEventConfigData *data =
-                (ACDRecognitionCfgEventConfigData *)ev_cfg->data_.get();
+            ACDRecognitionCfgEventConfigData *data = &ev_cfg.data_.rec_cfg_;
             status = acd_stream_.SendRecognitionConfig(
                (struct acd_recognition_cfg *)data->data_);
             if (status)
@@ -1062,8 +1050,7 @@ int32_t StreamACD::ACDIdle::ProcessEvent(
             break;
         }
         case ACD_EV_CONTEXT_CONFIG: {
-            ACDContextCfgEventConfigData *data =
-                (ACDContextCfgEventConfigData *)ev_cfg->data_.get();
+            ACDContextCfgEventConfigData *data = &ev_cfg.data_.context_cfg_;
             status = acd_stream_.SendContextConfig(
                (struct pal_param_context_list *)data->data_);
             if (0 != status) {
@@ -1081,8 +1068,7 @@ int32_t StreamACD::ACDIdle::ProcessEvent(
             break;
         }
         case ACD_EV_DEVICE_DISCONNECTED: {
-            ACDDeviceDisconnectedEventConfigData *data =
-                (ACDDeviceDisconnectedEventConfigData *)ev_cfg->data_.get();
+            ACDDeviceDisconnectedEventConfigData *data = &ev_cfg.data_.dev_disconnected_;
             pal_device_id_t device_id = data->dev_id_;
             if (acd_stream_.mDevices.size() == 0) {
                 PAL_DBG(LOG_TAG, "No device to disconnect");
@@ -1102,8 +1088,7 @@ int32_t StreamACD::ACDIdle::ProcessEvent(
         }
         case ACD_EV_DEVICE_CONNECTED: {
             std::shared_ptr<Device> dev = nullptr;
-            ACDDeviceConnectedEventConfigData *data =
-                (ACDDeviceConnectedEventConfigData *)ev_cfg->data_.get();
+            ACDDeviceConnectedEventConfigData *data = &ev_cfg.data_.dev_connected_;
             pal_device_id_t dev_id = data->dev_id_;
 
             dev = acd_stream_.GetPalDevice(dev_id, false);
@@ -1129,21 +1114,21 @@ int32_t StreamACD::ACDIdle::ProcessEvent(
             TransitTo(ACD_STATE_SSR);
             break;
         default:
-            PAL_DBG(LOG_TAG, "Unhandled event %d", ev_cfg->id_);
+            PAL_DBG(LOG_TAG, "Unhandled event %d", ev_cfg.id_);
             break;
     }
     return status;
 }
 
 int32_t StreamACD::ACDLoaded::ProcessEvent(
-    std::shared_ptr<ACDEventConfig> ev_cfg)
+    ACDEventConfig &ev_cfg)
 {
     int32_t status = 0;
 
     PAL_DBG(LOG_TAG, "ACDLoaded: handle event %d for stream instance %u",
-        ev_cfg->id_, acd_stream_.mInstanceID);
+        ev_cfg.id_, acd_stream_.mInstanceID);
 
-    switch (ev_cfg->id_) {
+    switch (ev_cfg.id_) {
         case ACD_EV_UNLOAD_SOUND_MODEL: {
             status = acd_stream_.engine_->TeardownEngine(&acd_stream_, acd_stream_.context_config_);
             if (status)
@@ -1176,7 +1161,7 @@ int32_t StreamACD::ACDLoaded::ProcessEvent(
             std::shared_ptr<CaptureProfile> cap_prof = nullptr;
 
             // Do not update capture profile when resuming stream
-            if (ev_cfg->id_ == ACD_EV_START_RECOGNITION) {
+            if (ev_cfg.id_ == ACD_EV_START_RECOGNITION) {
                 backend_update = acd_stream_.rm->UpdateSoundTriggerCaptureProfile(
                     &acd_stream_, true);
                 if (backend_update) {
@@ -1259,8 +1244,7 @@ int32_t StreamACD::ACDLoaded::ProcessEvent(
             break;
         }
         case ACD_EV_DEVICE_DISCONNECTED:{
-            ACDDeviceDisconnectedEventConfigData *data =
-                (ACDDeviceDisconnectedEventConfigData *)ev_cfg->data_.get();
+            ACDDeviceDisconnectedEventConfigData *data = &ev_cfg.data_.dev_disconnected_;
             pal_device_id_t device_id = data->dev_id_;
 
             if (acd_stream_.mDevices.size() == 0) {
@@ -1291,8 +1275,7 @@ int32_t StreamACD::ACDLoaded::ProcessEvent(
         }
         case ACD_EV_DEVICE_CONNECTED: {
             std::shared_ptr<Device> dev = nullptr;
-            ACDDeviceConnectedEventConfigData *data =
-                (ACDDeviceConnectedEventConfigData *)ev_cfg->data_.get();
+            ACDDeviceConnectedEventConfigData *data = &ev_cfg.data_.dev_connected_;
             pal_device_id_t dev_id = data->dev_id_;
 
             dev = acd_stream_.GetPalDevice(dev_id, false);
@@ -1354,8 +1337,7 @@ int32_t StreamACD::ACDLoaded::ProcessEvent(
             break;
         }
         case ACD_EV_RECOGNITION_CONFIG: {
-            ACDRecognitionCfgEventConfigData *data =
-                (ACDRecognitionCfgEventConfigData *)ev_cfg->data_.get();
+            ACDRecognitionCfgEventConfigData *data = &ev_cfg.data_.rec_cfg_;
             status = acd_stream_.SendRecognitionConfig(
                (struct acd_recognition_cfg *)data->data_);
             if (0 != status)
@@ -1364,8 +1346,7 @@ int32_t StreamACD::ACDLoaded::ProcessEvent(
             break;
         }
         case ACD_EV_CONTEXT_CONFIG: {
-            ACDContextCfgEventConfigData *data =
-                (ACDContextCfgEventConfigData *)ev_cfg->data_.get();
+            ACDContextCfgEventConfigData *data = &ev_cfg.data_.context_cfg_;
             status = acd_stream_.SendContextConfig(
                (struct pal_param_context_list *)data->data_);
             if (0 != status)
@@ -1373,10 +1354,9 @@ int32_t StreamACD::ACDLoaded::ProcessEvent(
             break;
         }
         case ACD_EV_EC_REF: {
-            ACDECRefEventConfigData *data =
-                (ACDECRefEventConfigData *)ev_cfg->data_.get();
+            ACDECRefEventConfigData *data = &ev_cfg.data_.ec_ref_;
             Stream *s = static_cast<Stream *>(&acd_stream_);
-            status = acd_stream_.engine_->setECRef(s, data->dev_,
+            status = acd_stream_.engine_->setECRef(s, ev_cfg.dev_,
                 data->is_enable_);
             if (status)
                 PAL_ERR(LOG_TAG, "Error:%d Failed to set EC Ref in engine", status);
@@ -1386,8 +1366,7 @@ int32_t StreamACD::ACDLoaded::ProcessEvent(
             std::shared_ptr<CaptureProfile> new_cap_prof = nullptr;
             bool active = false;
 
-            ACDConcurrentStreamEventConfigData *data =
-                (ACDConcurrentStreamEventConfigData *)ev_cfg->data_.get();
+            ACDConcurrentStreamEventConfigData *data = &ev_cfg.data_.concurrent_;
             active = data->is_active_;
             new_cap_prof = acd_stream_.GetCurrentCaptureProfile();
             if (!new_cap_prof) {
@@ -1411,15 +1390,13 @@ int32_t StreamACD::ACDLoaded::ProcessEvent(
                     new_cap_prof->GetSampleRate(),
                     new_cap_prof->isECRequired());
                 if (!active) {
-                    std::shared_ptr<ACDEventConfig> ev_cfg1(
-                        new ACDDeviceDisconnectedEventConfig(acd_stream_.GetAvailCaptureDevice()));
+                    ACDDeviceDisconnectedEventConfig ev_cfg1(acd_stream_.GetAvailCaptureDevice());
                     status = acd_stream_.ProcessInternalEvent(ev_cfg1);
                     if (status)
                         PAL_ERR(LOG_TAG, "Error:%d Failed to disconnect device %d", status,
                                     acd_stream_.GetAvailCaptureDevice());
                 } else {
-                    std::shared_ptr<ACDEventConfig> ev_cfg1(
-                        new ACDDeviceConnectedEventConfig(acd_stream_.GetAvailCaptureDevice()));
+                    ACDDeviceConnectedEventConfig ev_cfg1(acd_stream_.GetAvailCaptureDevice());
                     status = acd_stream_.ProcessInternalEvent(ev_cfg1);
                     if (status)
                         PAL_ERR(LOG_TAG, "Error:%d Failed to connect device %d", status, acd_stream_.GetAvailCaptureDevice());
@@ -1430,8 +1407,7 @@ int32_t StreamACD::ACDLoaded::ProcessEvent(
             break;
         }
         case ACD_EV_DETECTED: {
-            ACDDetectedEventConfigData *data =
-                (ACDDetectedEventConfigData *) ev_cfg->data_.get();
+            ACDDetectedEventConfigData *data = &ev_cfg.data_.detected_;
             std::unique_lock<std::mutex> lck(acd_stream_.mutex_);
             acd_stream_.CacheEventData((struct acd_context_event *)data->data_);
             break;
@@ -1440,13 +1416,13 @@ int32_t StreamACD::ACDLoaded::ProcessEvent(
             if (acd_stream_.state_for_restore_ == ACD_STATE_NONE) {
                 acd_stream_.state_for_restore_ = ACD_STATE_LOADED;
             }
-            std::shared_ptr<ACDEventConfig> ev_cfg(new ACDUnloadEventConfig());
+            ACDUnloadEventConfig ev_cfg;
             status = acd_stream_.ProcessInternalEvent(ev_cfg);
             TransitTo(ACD_STATE_SSR);
             break;
         }
         default: {
-            PAL_DBG(LOG_TAG, "Unhandled event %d", ev_cfg->id_);
+            PAL_DBG(LOG_TAG, "Unhandled event %d", ev_cfg.id_);
             break;
         }
     }
@@ -1454,17 +1430,16 @@ int32_t StreamACD::ACDLoaded::ProcessEvent(
 }
 
 int32_t StreamACD::ACDActive::ProcessEvent(
-    std::shared_ptr<ACDEventConfig> ev_cfg)
+    ACDEventConfig &ev_cfg)
 {
     int32_t status = 0;
 
     PAL_DBG(LOG_TAG, "ACDActive handle event %d for stream instance %u",
-        ev_cfg->id_, acd_stream_.mInstanceID);
+        ev_cfg.id_, acd_stream_.mInstanceID);
 
-    switch (ev_cfg->id_) {
+    switch (ev_cfg.id_) {
         case ACD_EV_DETECTED: {
-            ACDDetectedEventConfigData *data =
-                (ACDDetectedEventConfigData *) ev_cfg->data_.get();
+            ACDDetectedEventConfigData *data = &ev_cfg.data_.detected_;
             std::unique_lock<std::mutex> lck(acd_stream_.mutex_);
             acd_stream_.CacheEventData((struct acd_context_event *)data->data_);
             if (acd_stream_.cached_event_data_) {
@@ -1485,8 +1460,8 @@ int32_t StreamACD::ACDActive::ProcessEvent(
         case ACD_EV_STOP_RECOGNITION: {
             // Do not update capture profile when pausing stream
             bool backend_update = false;
-            if (ev_cfg->id_ == ACD_EV_STOP_RECOGNITION ||
-                ev_cfg->id_ == ACD_EV_UNLOAD_SOUND_MODEL) {
+            if (ev_cfg.id_ == ACD_EV_STOP_RECOGNITION ||
+                ev_cfg.id_ == ACD_EV_UNLOAD_SOUND_MODEL) {
                 backend_update = acd_stream_.rm->UpdateSoundTriggerCaptureProfile(
                     &acd_stream_, false);
                 if (backend_update) {
@@ -1522,7 +1497,7 @@ int32_t StreamACD::ACDActive::ProcessEvent(
             }
 
             TransitTo(ACD_STATE_LOADED);
-            if (ev_cfg->id_ == ACD_EV_UNLOAD_SOUND_MODEL) {
+            if (ev_cfg.id_ == ACD_EV_UNLOAD_SOUND_MODEL) {
                 status = acd_stream_.ProcessInternalEvent(ev_cfg);
                 if (status != 0)
                     PAL_ERR(LOG_TAG, "Failed to unload sound model, status = %d", status);
@@ -1530,8 +1505,7 @@ int32_t StreamACD::ACDActive::ProcessEvent(
             break;
         }
         case ACD_EV_DEVICE_DISCONNECTED: {
-            ACDDeviceDisconnectedEventConfigData *data =
-                (ACDDeviceDisconnectedEventConfigData *)ev_cfg->data_.get();
+            ACDDeviceDisconnectedEventConfigData *data = &ev_cfg.data_.dev_disconnected_;
             pal_device_id_t device_id = data->dev_id_;
 
             int curr_device_id = acd_stream_.mDevices[0]->getSndDeviceId();
@@ -1564,8 +1538,7 @@ int32_t StreamACD::ACDActive::ProcessEvent(
             break;
         }
         case ACD_EV_DEVICE_CONNECTED: {
-            ACDDeviceConnectedEventConfigData *data =
-                (ACDDeviceConnectedEventConfigData *)ev_cfg->data_.get();
+            ACDDeviceConnectedEventConfigData *data = &ev_cfg.data_.dev_connected_;
             pal_device_id_t dev_id = data->dev_id_;
             std::shared_ptr<Device> dev = nullptr;
 
@@ -1622,8 +1595,7 @@ int32_t StreamACD::ACDActive::ProcessEvent(
             break;
         }
         case ACD_EV_RECOGNITION_CONFIG: {
-            ACDRecognitionCfgEventConfigData *data =
-                (ACDRecognitionCfgEventConfigData *)ev_cfg->data_.get();
+            ACDRecognitionCfgEventConfigData *data = &ev_cfg.data_.rec_cfg_;
             status = acd_stream_.SendRecognitionConfig(
                (struct acd_recognition_cfg *)data->data_);
             if (0 != status)
@@ -1632,8 +1604,7 @@ int32_t StreamACD::ACDActive::ProcessEvent(
             break;
         }
         case ACD_EV_CONTEXT_CONFIG: {
-            ACDContextCfgEventConfigData *data =
-                (ACDContextCfgEventConfigData *)ev_cfg->data_.get();
+            ACDContextCfgEventConfigData *data = &ev_cfg.data_.context_cfg_;
             status = acd_stream_.SendContextConfig(
                (struct pal_param_context_list *)data->data_);
             if (0 != status)
@@ -1642,10 +1613,9 @@ int32_t StreamACD::ACDActive::ProcessEvent(
             break;
         }
         case ACD_EV_EC_REF: {
-            ACDECRefEventConfigData *data =
-                (ACDECRefEventConfigData *)ev_cfg->data_.get();
+            ACDECRefEventConfigData *data = &ev_cfg.data_.ec_ref_;
             Stream *s = static_cast<Stream *>(&acd_stream_);
-            status = acd_stream_.engine_->setECRef(s, data->dev_,
+            status = acd_stream_.engine_->setECRef(s, ev_cfg.dev_,
                 data->is_enable_);
             if (status) {
                 PAL_ERR(LOG_TAG, "Error:%d Failed to set EC Ref in engine", status);
@@ -1656,8 +1626,7 @@ int32_t StreamACD::ACDActive::ProcessEvent(
             std::shared_ptr<CaptureProfile> new_cap_prof = nullptr;
             bool active = false;
 
-            ACDConcurrentStreamEventConfigData *data =
-                (ACDConcurrentStreamEventConfigData *)ev_cfg->data_.get();
+            ACDConcurrentStreamEventConfigData *data = &ev_cfg.data_.concurrent_;
             active = data->is_active_;
             new_cap_prof = acd_stream_.GetCurrentCaptureProfile();
             if (!new_cap_prof) {
@@ -1681,15 +1650,13 @@ int32_t StreamACD::ACDActive::ProcessEvent(
                     new_cap_prof->GetSampleRate(),
                     new_cap_prof->isECRequired());
                 if (!active) {
-                    std::shared_ptr<ACDEventConfig> ev_cfg1(
-                        new ACDDeviceDisconnectedEventConfig(acd_stream_.GetAvailCaptureDevice()));
+                    ACDDeviceDisconnectedEventConfig ev_cfg1(acd_stream_.GetAvailCaptureDevice());
                     status = acd_stream_.ProcessInternalEvent(ev_cfg1);
                     if (status)
                         PAL_ERR(LOG_TAG, "Error:%d Failed to disconnect device %d", status,
                                     acd_stream_.GetAvailCaptureDevice());
                 } else {
-                    std::shared_ptr<ACDEventConfig> ev_cfg1(
-                        new ACDDeviceConnectedEventConfig(acd_stream_.GetAvailCaptureDevice()));
+                    ACDDeviceConnectedEventConfig ev_cfg1(acd_stream_.GetAvailCaptureDevice());
                     status = acd_stream_.ProcessInternalEvent(ev_cfg1);
                     if (status)
                         PAL_ERR(LOG_TAG, "Error:%d Failed to connect device %d", status, acd_stream_.GetAvailCaptureDevice());
@@ -1703,8 +1670,7 @@ int32_t StreamACD::ACDActive::ProcessEvent(
             if (acd_stream_.state_for_restore_ == ACD_STATE_NONE) {
                 acd_stream_.state_for_restore_ = ACD_STATE_ACTIVE;
             }
-            std::shared_ptr<ACDEventConfig> ev_cfg1(
-                new ACDUnloadEventConfig());
+            ACDUnloadEventConfig ev_cfg1;
             status = acd_stream_.ProcessInternalEvent(ev_cfg1);
             TransitTo(ACD_STATE_SSR);
             break;
@@ -1720,7 +1686,7 @@ int32_t StreamACD::ACDActive::ProcessEvent(
             break;
         }
         default: {
-            PAL_DBG(LOG_TAG, "Unhandled event %d", ev_cfg->id_);
+            PAL_DBG(LOG_TAG, "Unhandled event %d", ev_cfg.id_);
             break;
         }
     }
@@ -1732,17 +1698,16 @@ int32_t StreamACD::ACDActive::ProcessEvent(
 }
 
 int32_t StreamACD::ACDDetected::ProcessEvent(
-    std::shared_ptr<ACDEventConfig> ev_cfg)
+    ACDEventConfig &ev_cfg)
 {
     int32_t status = 0;
 
     PAL_DBG(LOG_TAG, "ACDDetected: handle event %d for stream instance %u",
-        ev_cfg->id_, acd_stream_.mInstanceID);
+        ev_cfg.id_, acd_stream_.mInstanceID);
 
-    switch (ev_cfg->id_) {
+    switch (ev_cfg.id_) {
         case ACD_EV_DETECTED: {
-            ACDDetectedEventConfigData *data =
-                (ACDDetectedEventConfigData *) ev_cfg->data_.get();
+            ACDDetectedEventConfigData *data = &ev_cfg.data_.detected_;
             std::unique_lock<std::mutex> lck(acd_stream_.mutex_);
             acd_stream_.CacheEventData((struct acd_context_event *)data->data_);
             break;
@@ -1766,7 +1731,7 @@ int32_t StreamACD::ACDDetected::ProcessEvent(
             TransitTo(ACD_STATE_LOADED);
             status = acd_stream_.ProcessInternalEvent(ev_cfg);
             if (status)
-                PAL_ERR(LOG_TAG, "Error:%d Failed to process event %d", status, ev_cfg->id_);
+                PAL_ERR(LOG_TAG, "Error:%d Failed to process event %d", status, ev_cfg.id_);
             break;
         case ACD_EV_UNLOAD_SOUND_MODEL:
         case ACD_EV_STOP_RECOGNITION:
@@ -1778,13 +1743,13 @@ int32_t StreamACD::ACDDetected::ProcessEvent(
 
             status = acd_stream_.ProcessInternalEvent(ev_cfg);
             if (status)
-                PAL_ERR(LOG_TAG, "Error:%d Failed to process event %d", status, ev_cfg->id_);
+                PAL_ERR(LOG_TAG, "Error:%d Failed to process event %d", status, ev_cfg.id_);
             break;
         case ACD_EV_SSR_OFFLINE:
             TransitTo(ACD_STATE_ACTIVE);
             status = acd_stream_.ProcessInternalEvent(ev_cfg);
             if (status)
-                PAL_ERR(LOG_TAG, "Error:%d Failed to process event %d", status, ev_cfg->id_);
+                PAL_ERR(LOG_TAG, "Error:%d Failed to process event %d", status, ev_cfg.id_);
             acd_stream_.state_for_restore_ = ACD_STATE_DETECTED;
             break;
         case ACD_EV_RECOGNITION_CONFIG:
@@ -1801,7 +1766,7 @@ int32_t StreamACD::ACDDetected::ProcessEvent(
             TransitTo(ACD_STATE_ACTIVE);
             status = acd_stream_.ProcessInternalEvent(ev_cfg);
             if (status)
-                PAL_ERR(LOG_TAG, "Error:%d Failed to process event %d", status, ev_cfg->id_);
+                PAL_ERR(LOG_TAG, "Error:%d Failed to process event %d", status, ev_cfg.id_);
 
             break;
         }
@@ -1810,14 +1775,14 @@ int32_t StreamACD::ACDDetected::ProcessEvent(
     return status;
 }
 
-int32_t StreamACD::ACDSSR::ProcessEvent(std::shared_ptr<ACDEventConfig> ev_cfg)
+int32_t StreamACD::ACDSSR::ProcessEvent(ACDEventConfig &ev_cfg)
 {
     int32_t status = 0;
 
     PAL_DBG(LOG_TAG, "ACDSSR: handle event %d for stream instance %u",
-        ev_cfg->id_, acd_stream_.mInstanceID);
+        ev_cfg.id_, acd_stream_.mInstanceID);
 
-    switch (ev_cfg->id_) {
+    switch (ev_cfg.id_) {
         case ACD_EV_SSR_ONLINE: {
             TransitTo(ACD_STATE_IDLE);
 
@@ -1843,8 +1808,7 @@ int32_t StreamACD::ACDSSR::ProcessEvent(std::shared_ptr<ACDEventConfig> ev_cfg)
 
             if (acd_stream_.state_for_restore_ == ACD_STATE_ACTIVE ||
                 acd_stream_.state_for_restore_ == ACD_STATE_DETECTED) {
-                std::shared_ptr<ACDEventConfig> ev_cfg1(
-                    new ACDStartRecognitionEventConfig(false));
+                ACDStartRecognitionEventConfig ev_cfg1(false);
                 status = acd_stream_.ProcessInternalEvent(ev_cfg1);
                 if (0 != status) {
                     PAL_ERR(LOG_TAG, "Failed to Start, status %d", status);
@@ -1863,8 +1827,7 @@ int32_t StreamACD::ACDSSR::ProcessEvent(std::shared_ptr<ACDEventConfig> ev_cfg)
                     acd_stream_.state_for_restore_);
                 status = -EINVAL;
             } else {
-                ACDLoadEventConfigData *data =
-                    (ACDLoadEventConfigData *)ev_cfg->data_.get();
+                ACDLoadEventConfigData *data = &ev_cfg.data_.load_;
                 struct pal_st_sound_model *pal_acd_sm;
 
                 pal_acd_sm = (struct pal_st_sound_model *)data->data_;
@@ -1883,8 +1846,7 @@ int32_t StreamACD::ACDSSR::ProcessEvent(std::shared_ptr<ACDEventConfig> ev_cfg)
             break;
         }
         case ACD_EV_RECOGNITION_CONFIG: {
-            ACDRecognitionCfgEventConfigData *data =
-                (ACDRecognitionCfgEventConfigData *)ev_cfg->data_.get();
+            ACDRecognitionCfgEventConfigData *data = &ev_cfg.data_.rec_cfg_;
 
             if (acd_stream_.context_config_)
                 free(acd_stream_.context_config_);
@@ -1898,8 +1860,7 @@ int32_t StreamACD::ACDSSR::ProcessEvent(std::shared_ptr<ACDEventConfig> ev_cfg)
             break;
         }
         case ACD_EV_CONTEXT_CONFIG: {
-            ACDContextCfgEventConfigData *data =
-                (ACDContextCfgEventConfigData *)ev_cfg->data_.get();
+            ACDContextCfgEventConfigData *data = &ev_cfg.data_.context_cfg_;
 
             if (acd_stream_.context_config_)
                 free(acd_stream_.context_config_);
@@ -1914,8 +1875,7 @@ int32_t StreamACD::ACDSSR::ProcessEvent(std::shared_ptr<ACDEventConfig> ev_cfg)
         case ACD_EV_START_RECOGNITION: {
             if (acd_stream_.state_for_restore_ == ACD_STATE_LOADED ||
                 acd_stream_.state_for_restore_ == ACD_STATE_DETECTED) {
-                ACDStartRecognitionEventConfigData *data =
-                    (ACDStartRecognitionEventConfigData *)ev_cfg->data_.get();
+                ACDStartRecognitionEventConfigData *data = &ev_cfg.data_.start_;
                 if (!acd_stream_.rec_config_) {
                     PAL_ERR(LOG_TAG, "Recognition config not set %d", data->restart_);
                     status = -EINVAL;
@@ -1947,11 +1907,11 @@ int32_t StreamACD::ACDSSR::ProcessEvent(std::shared_ptr<ACDEventConfig> ev_cfg)
             break;
         }
         default: {
-            PAL_INFO(LOG_TAG, "Unhandled event %d", ev_cfg->id_);
+            PAL_INFO(LOG_TAG, "Unhandled event %d", ev_cfg.id_);
             return status;
         }
     }
-    PAL_DBG(LOG_TAG, "Exit: ACDSSR: event %d handled", ev_cfg->id_);
+    PAL_DBG(LOG_TAG, "Exit: ACDSSR: event %d handled", ev_cfg.id_);
 
     return status;
 }
@@ -1960,7 +1920,7 @@ int32_t StreamACD::ssrDownHandler() {
     int32_t status = 0;
 
     std::lock_guard<std::mutex> lck(mStreamMutex);
-    std::shared_ptr<ACDEventConfig> ev_cfg(new ACDSSROfflineConfig());
+    ACDSSROfflineConfig ev_cfg;
     status = cur_state_->ProcessEvent(ev_cfg);
 
     return status;
@@ -1970,7 +1930,7 @@ int32_t StreamACD::ssrUpHandler() {
     int32_t status = 0;
 
     std::lock_guard<std::mutex> lck(mStreamMutex);
-    std::shared_ptr<ACDEventConfig> ev_cfg(new ACDSSROnlineConfig());
+    ACDSSROnlineConfig ev_cfg;
     status = cur_state_->ProcessEvent(ev_cfg);
 
     return status;
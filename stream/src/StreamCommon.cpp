@@ -217,6 +217,7 @@ exit:
 int32_t  StreamCommon::close()
 {
     int32_t status = 0;
+    std::vector<std::mutex *> heldBackEnds;
     mStreamMutex.lock();
 
     if (currentState == STREAM_IDLE) {
@@ -236,9 +237,9 @@ int32_t  StreamCommon::close()
         mStreamMutex.lock();
     }
 
-    rm->lockGraph();
+    rm->lockGraph(mDevices, heldBackEnds);
     status = session->close(this);
-    rm->unlockGraph();
+    rm->unlockGraph(heldBackEnds);
     if (0 != status) {
         PAL_ERR(LOG_TAG, "Error:session close failed with status %d", status);
     }
@@ -262,6 +263,7 @@ int32_t  StreamCommon::close()
 int32_t StreamCommon::start()
 {
     int32_t status = 0;
+    std::vector<std::mutex *> heldBackEnds;
 
     PAL_DBG(LOG_TAG, "Enter. session handle - %pK mStreamAttr->direction - %d state %d",
             session, mStreamAttr->direction, currentState);
@@ -275,19 +277,19 @@ int32_t StreamCommon::start()
     }
 
     if (currentState == STREAM_INIT || currentState == STREAM_STOPPED) {
-        rm->lockGraph();
+        rm->lockGraph(mDevices, heldBackEnds);
         status = start_device();
         if (0 != status) {
-            rm->unlockGraph();
+            rm->unlockGraph(heldBackEnds);
             goto exit;
         }
         PAL_VERBOSE(LOG_TAG, "device started successfully");
         status = startSession();
         if (0 != status) {
-            rm->unlockGraph();
+            rm->unlockGraph(heldBackEnds);
             goto exit;
         }
-        rm->unlockGraph();
+        rm->unlockGraph(heldBackEnds);
         PAL_VERBOSE(LOG_TAG, "session start successful");
 
         /*pcm_open and pcm_start done at once here,
@@ -368,6 +370,7 @@ exit:
 int32_t StreamCommon::stop()
 {
     int32_t status = 0;
+    std::vector<std::mutex *> heldBackEnds;
 
     mStreamMutex.lock();
     PAL_DBG(LOG_TAG, "Enter. session handle - %pK mStreamAttr->direction - %d state %d",
@@ -385,7 +388,7 @@ int32_t StreamCommon::stop()
         PAL_VERBOSE(LOG_TAG, "In %s, device count - %zu",
                     GET_DIR_STR(mStreamAttr->direction), mDevices.size());
 
-        rm->lockGraph();
+        rm->lockGraph(mDevices, heldBackEnds);
         status = session->stop(this);
         if (0 != status) {
             PAL_ERR(LOG_TAG, "Error:%s session stop failed with status %d",
@@ -399,7 +402,7 @@ int32_t StreamCommon::stop()
                          GET_DIR_STR(mStreamAttr->direction), status);
              }
         }
-        rm->unlockGraph();
+        rm->unlockGraph(heldBackEnds);
         PAL_VERBOSE(LOG_TAG, "devices stop successful");
     } else if (currentState == STREAM_STOPPED || currentState == STREAM_IDLE) {
         PAL_INFO(LOG_TAG, "Stream is already in Stopped state %d", currentState);
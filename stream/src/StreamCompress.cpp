@@ -166,6 +166,7 @@ StreamCompress::StreamCompress(const struct pal_stream_attributes *sattr, struct
 int32_t StreamCompress::open()
 {
     int32_t status = 0;
+    std::vector<std::mutex *> heldBackEnds;
     mStreamMutex.lock();
 
     PAL_DBG(LOG_TAG,"Enter, session handle - %p device count - %zu state %d",
@@ -188,9 +189,9 @@ int32_t StreamCompress::open()
     }
 
     if (currentState == STREAM_IDLE) {
-        rm->lockGraph();
+        rm->lockGraph(mDevices, heldBackEnds);
         status = session->open(this);
-        rm->unlockGraph();
+        rm->unlockGraph(heldBackEnds);
         if (0 != status) {
            PAL_ERR(LOG_TAG,"session open failed with status %d", status);
            goto exit;
@@ -226,6 +227,7 @@ exit:
 int32_t StreamCompress::close()
 {
     int32_t status = 0;
+    std::vector<std::mutex *> heldBackEnds;
 
     mStreamMutex.lock();
     if (currentState == STREAM_IDLE) {
@@ -244,9 +246,9 @@ int32_t StreamCompress::close()
         }
         mStreamMutex.lock();
     }
-    rm->lockGraph();
+    rm->lockGraph(mDevices, heldBackEnds);
     status = session->close(this);
-    rm->unlockGraph();
+    rm->unlockGraph(heldBackEnds);
     if (0 != status) {
         PAL_ERR(LOG_TAG,"session close failed with status %d", status);
     }
@@ -297,6 +299,7 @@ StreamCompress::~StreamCompress()
 int32_t StreamCompress::stop()
 {
     int32_t status = 0;
+    std::vector<std::mutex *> heldBackEnds;
 
     mStreamMutex.lock();
     PAL_DBG(LOG_TAG,"Enter. state %d session handle - %p mStreamAttr->direction %d",
@@ -314,7 +317,7 @@ int32_t StreamCompress::stop()
         case PAL_AUDIO_OUTPUT:
             PAL_VERBOSE(LOG_TAG,"In PAL_AUDIO_OUTPUT case, device count - %zu", mDevices.size());
 
-            rm->lockGraph();
+            rm->lockGraph(mDevices, heldBackEnds);
             status = session->stop(this);
             if (0 != status) {
                 PAL_ERR(LOG_TAG,"Rx session stop failed with status %d",status);
@@ -330,11 +333,11 @@ int32_t StreamCompress::stop()
                     PAL_ERR(LOG_TAG,"Rx device stop failed with status %d",status);
                 }
             }
-            rm->unlockGraph();
+            rm->unlockGraph(heldBackEnds);
             PAL_VERBOSE(LOG_TAG,"devices stop successful");
             break;
         case PAL_AUDIO_INPUT:
-             rm->lockGraph();
+             rm->lockGraph(mDevices, heldBackEnds);
             for (int32_t i = 0; i < mDevices.size(); i++) {
                 PAL_ERR(LOG_TAG, "device %d name %s, going to stop",
                         mDevices[i]->getSndDeviceId(),
@@ -350,7 +353,7 @@ int32_t StreamCompress::stop()
             if (0 != status) {
                 PAL_ERR(LOG_TAG,"Tx session stop failed with status %d",status);
             }
-            rm->unlockGraph();
+            rm->unlockGraph(heldBackEnds);
             PAL_VERBOSE(LOG_TAG,"session stop successful");
             break;
         default:
@@ -376,6 +379,7 @@ exit:
 int32_t StreamCompress::start()
 {
     int32_t status = 0, devStatus = 0, cachedStatus = 0;
+    std::vector<std::mutex *> heldBackEnds;
     int32_t tmp = 0;
     bool a2dpSuspend = false;
 
@@ -400,7 +404,7 @@ int32_t StreamCompress::start()
             if (0 != status)
                 goto exit;
 
-            rm->lockGraph();
+            rm->lockGraph(mDevices, heldBackEnds);
             /* Any device start success will be treated as positive status.
              * This allows stream be played even if one of devices failed to start.
              */
@@ -428,7 +432,7 @@ int32_t StreamCompress::start()
             if (0 != status) {
                 status = cachedStatus;
                 PAL_ERR(LOG_TAG, "Rx device start failed with status %d", status);
-                rm->unlockGraph();
+                rm->unlockGraph(heldBackEnds);
                 goto exit;
             } else {
                 PAL_VERBOSE(LOG_TAG, "devices started successfully");
@@ -437,7 +441,7 @@ int32_t StreamCompress::start()
             status = session->prepare(this);
             if (0 != status) {
                 PAL_ERR(LOG_TAG,"Rx session prepare is failed with status %d",status);
-                rm->unlockGraph();
+                rm->unlockGraph(heldBackEnds);
                 goto session_fail;
             }
             PAL_VERBOSE(LOG_TAG,"session prepare successful");
@@ -449,16 +453,16 @@ int32_t StreamCompress::start()
                     rm->ssrHandler(CARD_STATUS_OFFLINE);
                 }
                 status = 0;
-                rm->unlockGraph();
+                rm->unlockGraph(heldBackEnds);
                 goto session_fail;
             }
             if (0 != status) {
                 PAL_ERR(LOG_TAG,"Rx session start is failed with status %d",status);
-                rm->unlockGraph();
+                rm->unlockGraph(heldBackEnds);
                 goto session_fail;
             }
             PAL_VERBOSE(LOG_TAG, "session start successful");
-            rm->unlockGraph();
+            rm->unlockGraph(heldBackEnds);
 
             if (a2dpSuspend) {
                 PAL_DBG(LOG_TAG, "mute the stream on speaker");
@@ -471,7 +475,7 @@ int32_t StreamCompress::start()
             break;
         case PAL_AUDIO_INPUT:
             PAL_VERBOSE(LOG_TAG, "Inside PAL_AUDIO_INPUT device count - %zu", mDevices.size());
-            rm->lockGraph();
+            rm->lockGraph(mDevices, heldBackEnds);
             for (int32_t i = 0; i < mDevices.size(); i++) {
                 PAL_ERR(LOG_TAG, "device %d name %s, going to start",
                         mDevices[i]->getSndDeviceId(),
@@ -480,7 +484,7 @@ int32_t StreamCompress::start()
                 if (0 != status) {
                     PAL_ERR(LOG_TAG, "Tx device start failed with status %d",
                             status);
-                    rm->unlockGraph();
+                    rm->unlockGraph(heldBackEnds);
                     goto exit;
                 }
             }
@@ -489,7 +493,7 @@ int32_t StreamCompress::start()
             if (0 != status) {
                 PAL_ERR(LOG_TAG, "Tx session prepare is failed with status %d",
                         status);
-                rm->unlockGraph();
+                rm->unlockGraph(heldBackEnds);
                 goto session_fail;
             }
             PAL_VERBOSE(LOG_TAG, "session prepare successful");
@@ -500,12 +504,12 @@ int32_t StreamCompress::start()
                     rm->ssrHandler(CARD_STATUS_OFFLINE);
                 }
                 status = 0;
-                rm->unlockGraph();
+                rm->unlockGraph(heldBackEnds);
                 goto session_fail;
             }
             if (0 != status) {
                 PAL_ERR(LOG_TAG,"Tx session start is failed with status %d",status);
-                rm->unlockGraph();
+                rm->unlockGraph(heldBackEnds);
                 goto session_fail;
             }
             for (int i = 0; i < mDevices.size(); i++) {
@@ -513,7 +517,7 @@ int32_t StreamCompress::start()
             }
             currentState = STREAM_STARTED;
             PAL_VERBOSE(LOG_TAG, "session start successful");
-            rm->unlockGraph();
+            rm->unlockGraph(heldBackEnds);
             break;
         default:
             status = -EINVAL;
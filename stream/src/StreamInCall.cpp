@@ -172,6 +172,7 @@ exit:
 int32_t  StreamInCall::close()
 {
     int32_t status = 0;
+    std::vector<std::mutex *> heldBackEnds;
     mStreamMutex.lock();
 
     if (currentState == STREAM_IDLE) {
@@ -191,9 +192,9 @@ int32_t  StreamInCall::close()
         mStreamMutex.lock();
     }
 
-    rm->lockGraph();
+    rm->lockGraph(mDevices, heldBackEnds);
     status = session->close(this);
-    rm->unlockGraph();
+    rm->unlockGraph(heldBackEnds);
     if (0 != status) {
         PAL_ERR(LOG_TAG, "session close failed with status %d", status);
     }
@@ -211,6 +212,7 @@ int32_t  StreamInCall::close()
 int32_t StreamInCall::start()
 {
     int32_t status = 0;
+    std::vector<std::mutex *> heldBackEnds;
 
     PAL_DBG(LOG_TAG, "Enter. session handle - %pK mStreamAttr->direction - %d state %d",
               session, mStreamAttr->direction, currentState);
@@ -226,7 +228,7 @@ int32_t StreamInCall::start()
     if (currentState == STREAM_INIT || currentState == STREAM_STOPPED) {
         switch (mStreamAttr->direction) {
         case PAL_AUDIO_OUTPUT:
-            rm->lockGraph();
+            rm->lockGraph(mDevices, heldBackEnds);
             PAL_VERBOSE(LOG_TAG, "Inside PAL_AUDIO_OUTPUT device count - %zu",
                             mDevices.size());
 
@@ -234,7 +236,7 @@ int32_t StreamInCall::start()
             if (0 != status) {
                 PAL_ERR(LOG_TAG, "Rx session prepare is failed with status %d",
                         status);
-                rm->unlockGraph();
+                rm->unlockGraph(heldBackEnds);
                 goto exit;
             }
             PAL_VERBOSE(LOG_TAG, "session prepare successful");
@@ -252,17 +254,17 @@ int32_t StreamInCall::start()
                  * during SSR up Handling.
                  */
                 status = 0;
-                rm->unlockGraph();
+                rm->unlockGraph(heldBackEnds);
                 goto exit;
             }
             if (0 != status) {
                 PAL_ERR(LOG_TAG, "Rx session start is failed with status %d",
                         status);
-                rm->unlockGraph();
+                rm->unlockGraph(heldBackEnds);
                 goto exit;
             }
             PAL_VERBOSE(LOG_TAG, "session start successful");
-            rm->unlockGraph();
+            rm->unlockGraph(heldBackEnds);
             break;
 
         case PAL_AUDIO_INPUT:
@@ -481,6 +483,7 @@ int32_t  StreamInCall::read(struct pal_buffer* buf)
 {
     int32_t status = 0;
     int32_t size;
+    uint64_t deadlineUs = 0;
     PAL_VERBOSE(LOG_TAG, "Enter. session handle - %pK, state %d",
             session, currentState);
 
@@ -501,10 +504,11 @@ int32_t  StreamInCall::read(struct pal_buffer* buf)
         }
         size = buf->size;
         memset(buf->buffer, 0, size);
-        usleep((uint64_t)size * 1000000 / streamSize / sampleRate);
+        deadlineUs = getSsrDropDeadline(size, streamSize, sampleRate);
+        mStreamMutex.unlock();
+        waitForSsrDropDeadline(deadlineUs);
         PAL_DBG(LOG_TAG, "Sound card offline, dropped buffer size - %d", size);
-        status = size;
-        goto exit;
+        return size;
     }
 
     if (currentState == STREAM_STARTED) {
@@ -551,6 +555,7 @@ int32_t  StreamInCall::write(struct pal_buffer* buf)
     uint32_t byteWidth = 0;
     uint32_t sampleRate = 0;
     uint32_t channelCount = 0;
+    uint64_t deadlineUs = 0;
 
     PAL_VERBOSE(LOG_TAG, "Enter. session handle - %pK, state %d",
             session, currentState);
@@ -570,9 +575,10 @@ int32_t  StreamInCall::write(struct pal_buffer* buf)
             return -EINVAL;
         }
         size = buf->size;
-        usleep((uint64_t)size * 1000000 / frameSize / sampleRate);
-        PAL_DBG(LOG_TAG, "dropped buffer size - %d", size);
+        deadlineUs = getSsrDropDeadline(size, frameSize, sampleRate);
         mStreamMutex.unlock();
+        waitForSsrDropDeadline(deadlineUs);
+        PAL_DBG(LOG_TAG, "dropped buffer size - %d", size);
         PAL_VERBOSE(LOG_TAG, "Exit size: %d", size);
         return size;
     }
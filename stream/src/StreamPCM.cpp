@@ -183,6 +183,7 @@ StreamPCM::StreamPCM(const struct pal_stream_attributes *sattr, struct pal_devic
 int32_t  StreamPCM::open()
 {
     int32_t status = 0;
+    std::vector<std::mutex *> heldBackEnds;
     int32_t ret = 0;
 
     PAL_DBG(LOG_TAG, "Enter. session handle - %pK device count - %zu", session,
@@ -207,9 +208,9 @@ int32_t  StreamPCM::open()
     }
 
     if (currentState == STREAM_IDLE) {
-        rm->lockGraph();
+        rm->lockGraph(mDevices, heldBackEnds);
         status = session->open(this);
-        rm->unlockGraph();
+        rm->unlockGraph(heldBackEnds);
         if (0 != status) {
             PAL_ERR(LOG_TAG, "session open failed with status %d", status);
             goto exit;
@@ -284,6 +285,7 @@ exit:
 int32_t  StreamPCM::close()
 {
     int32_t status = 0;
+    std::vector<std::mutex *> heldBackEnds;
     mStreamMutex.lock();
 
     if (currentState == STREAM_IDLE) {
@@ -303,9 +305,9 @@ int32_t  StreamPCM::close()
         mStreamMutex.lock();
     }
 
-    rm->lockGraph();
+    rm->lockGraph(mDevices, heldBackEnds);
     status = session->close(this);
-    rm->unlockGraph();
+    rm->unlockGraph(heldBackEnds);
     if (0 != status) {
         PAL_ERR(LOG_TAG, "session close failed with status %d", status);
     }
@@ -359,6 +361,7 @@ StreamPCM::~StreamPCM()
 int32_t StreamPCM::start()
 {
     int32_t status = 0, devStatus = 0, cachedStatus = 0;
+    std::vector<std::mutex *> heldBackEnds;
     int32_t tmp = 0;
     bool a2dpSuspend = false;
 
@@ -384,7 +387,7 @@ int32_t StreamPCM::start()
             if (0 != status)
                 goto exit;
 
-            rm->lockGraph();
+            rm->lockGraph(mDevices, heldBackEnds);
             /* Any device start success will be treated as positive status.
              * This allows stream be played even if one of devices failed to start.
              */
@@ -412,7 +415,7 @@ int32_t StreamPCM::start()
             if (0 != status) {
                 status = cachedStatus;
                 PAL_ERR(LOG_TAG, "Rx device start failed with status %d", status);
-                rm->unlockGraph();
+                rm->unlockGraph(heldBackEnds);
                 goto exit;
             } else {
                 PAL_VERBOSE(LOG_TAG, "devices started successfully");
@@ -422,7 +425,7 @@ int32_t StreamPCM::start()
             if (0 != status) {
                 PAL_ERR(LOG_TAG, "Rx session prepare is failed with status %d",
                         status);
-                rm->unlockGraph();
+                rm->unlockGraph(heldBackEnds);
                 goto session_fail;
             }
             PAL_VERBOSE(LOG_TAG, "session prepare successful");
@@ -440,17 +443,17 @@ int32_t StreamPCM::start()
                  * during SSR up Handling.
                  */
                 status = 0;
-                rm->unlockGraph();
+                rm->unlockGraph(heldBackEnds);
                 goto session_fail;
             }
             if (0 != status) {
                 PAL_ERR(LOG_TAG, "Rx session start is failed with status %d",
                         status);
-                rm->unlockGraph();
+                rm->unlockGraph(heldBackEnds);
                 goto session_fail;
             }
             PAL_VERBOSE(LOG_TAG, "session start successful");
-            rm->unlockGraph();
+            rm->unlockGraph(heldBackEnds);
 
             if (a2dpSuspend) {
                 PAL_DBG(LOG_TAG, "mute the stream on speaker");
@@ -465,13 +468,13 @@ int32_t StreamPCM::start()
             PAL_VERBOSE(LOG_TAG, "Inside PAL_AUDIO_INPUT device count - %zu",
                         mDevices.size());
 
-            rm->lockGraph();
+            rm->lockGraph(mDevices, heldBackEnds);
             for (int32_t i=0; i < mDevices.size(); i++) {
                 status = mDevices[i]->start();
                 if (0 != status) {
                     PAL_ERR(LOG_TAG, "Tx device start is failed with status %d",
                             status);
-                    rm->unlockGraph();
+                    rm->unlockGraph(heldBackEnds);
                     goto exit;
                 }
             }
@@ -480,7 +483,7 @@ int32_t StreamPCM::start()
             if (0 != status) {
                 PAL_ERR(LOG_TAG, "Tx session prepare is failed with status %d",
                         status);
-                rm->unlockGraph();
+                rm->unlockGraph(heldBackEnds);
                 goto session_fail;
             }
             PAL_VERBOSE(LOG_TAG, "session prepare successful");
@@ -493,11 +496,11 @@ int32_t StreamPCM::start()
             * This will ensure read buffer and completion of pcm start happens
             * in one go.
             */
-            rm->unlockGraph();
+            rm->unlockGraph(heldBackEnds);
             mStreamMutex.unlock();
             rm->lockActiveStream();
             mStreamMutex.lock();
-            rm->lockGraph();
+            rm->lockGraph(mDevices, heldBackEnds);
 
             status = session->start(this);
             if (errno == -ENETRESET) {
@@ -507,24 +510,24 @@ int32_t StreamPCM::start()
                 }
                 status = 0;
                 cachedState = STREAM_STARTED;
-                rm->unlockGraph();
+                rm->unlockGraph(heldBackEnds);
                 rm->unlockActiveStream();
                 goto session_fail;
             }
             if (0 != status) {
                 PAL_ERR(LOG_TAG, "Tx session start is failed with status %d",
                         status);
-                rm->unlockGraph();
+                rm->unlockGraph(heldBackEnds);
                 rm->unlockActiveStream();
                 goto session_fail;
             }
-            rm->unlockGraph();
+            rm->unlockGraph(heldBackEnds);
             PAL_VERBOSE(LOG_TAG, "session start successful");
             break;
         case PAL_AUDIO_OUTPUT | PAL_AUDIO_INPUT:
             PAL_VERBOSE(LOG_TAG, "Inside Loopback case device count - %zu",
                         mDevices.size());
-            rm->lockGraph();
+            rm->lockGraph(mDevices, heldBackEnds);
             // start output device
             for (int32_t i=0; i < mDevices.size(); i++)
             {
@@ -535,7 +538,7 @@ int32_t StreamPCM::start()
                 if (0 != status) {
                     PAL_ERR(LOG_TAG, "Rx device start is failed with status %d",
                             status);
-                    rm->unlockGraph();
+                    rm->unlockGraph(heldBackEnds);
                     goto exit;
                 }
             }
@@ -548,7 +551,7 @@ int32_t StreamPCM::start()
                 status = mDevices[i]->start();
                 if (0 != status) {
                     PAL_ERR(LOG_TAG, "Tx device start is failed with status %d", status);
-                    rm->unlockGraph();
+                    rm->unlockGraph(heldBackEnds);
                     goto exit;
                 }
             }
@@ -557,7 +560,7 @@ int32_t StreamPCM::start()
             status = session->prepare(this);
             if (0 != status) {
                 PAL_ERR(LOG_TAG, "session prepare is failed with status %d", status);
-                rm->unlockGraph();
+                rm->unlockGraph(heldBackEnds);
                 goto session_fail;
             }
             PAL_VERBOSE(LOG_TAG, "session prepare successful");
@@ -570,15 +573,15 @@ int32_t StreamPCM::start()
                 }
                 status = 0;
                 cachedState = STREAM_STARTED;
-                rm->unlockGraph();
+                rm->unlockGraph(heldBackEnds);
                 goto session_fail;
             }
             if (0 != status) {
                 PAL_ERR(LOG_TAG, "session start is failed with status %d", status);
-                rm->unlockGraph();
+                rm->unlockGraph(heldBackEnds);
                 goto session_fail;
             }
-            rm->unlockGraph();
+            rm->unlockGraph(heldBackEnds);
             PAL_VERBOSE(LOG_TAG, "session start successful");
             break;
         default:
@@ -628,6 +631,7 @@ exit:
 int32_t StreamPCM::stop()
 {
     int32_t status = 0;
+    std::vector<std::mutex *> heldBackEnds;
 
     mStreamMutex.lock();
     PAL_DBG(LOG_TAG, "Enter. session handle - %pK mStreamAttr->direction - %d state %d",
@@ -647,7 +651,7 @@ int32_t StreamPCM::stop()
             PAL_VERBOSE(LOG_TAG, "In PAL_AUDIO_OUTPUT case, device count - %zu",
                         mDevices.size());
 
-            rm->lockGraph();
+            rm->lockGraph(mDevices, heldBackEnds);
             status = session->stop(this);
             if (0 != status) {
                 PAL_ERR(LOG_TAG, "Rx session stop failed with status %d", status);
@@ -658,11 +662,11 @@ int32_t StreamPCM::stop()
                 status = mDevices[i]->stop();
                 if (0 != status) {
                     PAL_ERR(LOG_TAG, "Rx device stop failed with status %d", status);
-                    rm->unlockGraph();
+                    rm->unlockGraph(heldBackEnds);
                     goto exit;
                 }
             }
-            rm->unlockGraph();
+            rm->unlockGraph(heldBackEnds);
             PAL_VERBOSE(LOG_TAG, "devices stop successful");
             break;
 
@@ -670,7 +674,7 @@ int32_t StreamPCM::stop()
             PAL_ERR(LOG_TAG, "In PAL_AUDIO_INPUT case, device count - %zu",
                         mDevices.size());
 
-            rm->lockGraph();
+            rm->lockGraph(mDevices, heldBackEnds);
             for (int32_t i=0; i < mDevices.size(); i++) {
                 status = mDevices[i]->stop();
                 if (0 != status) {
@@ -682,17 +686,17 @@ int32_t StreamPCM::stop()
             status = session->stop(this);
             if (0 != status) {
                 PAL_ERR(LOG_TAG, "Tx session stop failed with status %d", status);
-                rm->unlockGraph();
+                rm->unlockGraph(heldBackEnds);
                 goto exit;
             }
-            rm->unlockGraph();
+            rm->unlockGraph(heldBackEnds);
             PAL_VERBOSE(LOG_TAG, "session stop successful");
             break;
 
         case PAL_AUDIO_OUTPUT | PAL_AUDIO_INPUT:
             PAL_VERBOSE(LOG_TAG, "In LOOPBACK case, device count - %zu", mDevices.size());
 
-            rm->lockGraph();
+            rm->lockGraph(mDevices, heldBackEnds);
             for (int32_t i=0; i < mDevices.size(); i++) {
                 int32_t dev_id = mDevices[i]->getSndDeviceId();
                 if (dev_id <= PAL_DEVICE_IN_MIN || dev_id >= PAL_DEVICE_IN_MAX)
@@ -718,11 +722,11 @@ int32_t StreamPCM::stop()
                  if (0 != status) {
                      PAL_ERR(LOG_TAG, "Rx device stop is failed with status %d",
                              status);
-                     rm->unlockGraph();
+                     rm->unlockGraph(heldBackEnds);
                      goto exit;
                 }
             }
-            rm->unlockGraph();
+            rm->unlockGraph(heldBackEnds);
             PAL_VERBOSE(LOG_TAG, "RX devices stop successful");
             break;
         default:
@@ -871,6 +875,7 @@ int32_t  StreamPCM::read(struct pal_buffer* buf)
 {
     int32_t status = 0;
     int32_t size;
+    uint64_t deadlineUs = 0;
     PAL_VERBOSE(LOG_TAG, "Enter. session handle - %pK, state %d",
             session, currentState);
 
@@ -891,10 +896,11 @@ int32_t  StreamPCM::read(struct pal_buffer* buf)
         }
         size = buf->size;
         memset(buf->buffer, 0, size);
-        usleep((uint64_t)size * 1000000 / streamSize / sampleRate);
+        deadlineUs = getSsrDropDeadline(size, streamSize, sampleRate);
+        mStreamMutex.unlock();
+        waitForSsrDropDeadline(deadlineUs);
         PAL_DBG(LOG_TAG, "Sound card offline, dropped buffer size - %d", size);
-        status = size;
-        goto exit;
+        return size;
     }
 
     if (currentState == STREAM_STARTED) {
@@ -940,6 +946,7 @@ int32_t StreamPCM::write(struct pal_buffer* buf)
     uint32_t byteWidth = 0;
     uint32_t sampleRate = 0;
     uint32_t channelCount = 0;
+    uint64_t deadlineUs = 0;
 
     PAL_VERBOSE(LOG_TAG, "Enter. session handle - %pK, state %d",
             session, currentState);
@@ -961,9 +968,10 @@ int32_t StreamPCM::write(struct pal_buffer* buf)
             goto exit;
         }
         size = buf->size;
-        usleep((uint64_t)size * 1000000 / frameSize / sampleRate);
-        PAL_DBG(LOG_TAG, "dropped buffer size - %d", size);
+        deadlineUs = getSsrDropDeadline(size, frameSize, sampleRate);
         mStreamMutex.unlock();
+        waitForSsrDropDeadline(deadlineUs);
+        PAL_DBG(LOG_TAG, "dropped buffer size - %d", size);
         PAL_VERBOSE(LOG_TAG, "Exit size: %d", size);
         return size;
     }
@@ -132,6 +132,7 @@ exit:
 int32_t  StreamSensorPCMData::close()
 {
     int32_t status = 0;
+    std::vector<std::mutex *> heldBackEnds;
     mStreamMutex.lock();
 
     if (currentState == STREAM_IDLE) {
@@ -150,9 +151,9 @@ int32_t  StreamSensorPCMData::close()
             PAL_ERR(LOG_TAG, "Error:stream stop failed. status %d",  status);
         mStreamMutex.lock();
     }
-    rm->lockGraph();
+    rm->lockGraph(mDevices, heldBackEnds);
     status = session->close(this);
-    rm->unlockGraph();
+    rm->unlockGraph(heldBackEnds);
     if (0 != status) {
         PAL_ERR(LOG_TAG, "Error:session close failed with status %d", status);
     }
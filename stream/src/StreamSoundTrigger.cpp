@@ -234,26 +234,17 @@ StreamSoundTrigger::StreamSoundTrigger(struct pal_stream_attributes *sattr,
         paused_ = true;
     }
 
-    timer_thread_ = std::thread(TimerThread, std::ref(*this));
-    timer_stop_waiting_ = false;
-    exit_timer_thread_ = false;
+    timer_queue_ = PalEventExecutor::getBlockingInstance()->createQueue(
+        "st_stop_timer", PAL_EXEC_LANE_NORMAL);
+    stop_timer_id_ = 0;
 
     PAL_DBG(LOG_TAG, "Exit");
 }
 
 StreamSoundTrigger::~StreamSoundTrigger() {
+    /* a deferred stop takes mStreamMutex, so wait for it before locking */
+    timer_queue_->close();
     mStreamMutex.lock();
-    {
-        std::lock_guard<std::mutex> lck(timer_mutex_);
-        exit_timer_thread_ = true;
-        timer_stop_waiting_ = true;
-        timer_wait_cond_.notify_one();
-        timer_start_cond_.notify_one();
-    }
-    if (timer_thread_.joinable()) {
-        PAL_DBG(LOG_TAG, "Join timer thread");
-        timer_thread_.join();
-    }
 
     st_states_.clear();
     engines_.clear();
@@ -306,7 +297,7 @@ int32_t StreamSoundTrigger::close() {
     PAL_DBG(LOG_TAG, "Enter, stream direction %d", mStreamAttr->direction);
 
     std::lock_guard<std::mutex> lck(mStreamMutex);
-    std::shared_ptr<StEventConfig> ev_cfg(new StUnloadEventConfig());
+    StUnloadEventConfig ev_cfg;
     status = cur_state_->ProcessEvent(ev_cfg);
 
     if (sm_config_) {
@@ -336,8 +327,7 @@ int32_t StreamSoundTrigger::start() {
     currentState = STREAM_STARTED;
 
     rejection_notified_ = false;
-    std::shared_ptr<StEventConfig> ev_cfg(
-       new StStartRecognitionEventConfig(false));
+    StStartRecognitionEventConfig ev_cfg(false);
     status = cur_state_->ProcessEvent(ev_cfg);
     // restore cached state if start fails
     if (status)
@@ -361,8 +351,7 @@ int32_t StreamSoundTrigger::stop() {
     std::lock_guard<std::mutex> lck(mStreamMutex);
     currentState = STREAM_STOPPED;
 
-    std::shared_ptr<StEventConfig> ev_cfg(
-       new StStopRecognitionEventConfig(false));
+    StStopRecognitionEventConfig ev_cfg(false);
     status = cur_state_->ProcessEvent(ev_cfg);
 
     rm->unlockActiveStream();
@@ -390,20 +379,21 @@ int32_t StreamSoundTrigger::read(struct pal_buffer* buf) {
         this->force_nlpi_vote = true;
     }
 
-    std::shared_ptr<StEventConfig> ev_cfg(
-        new StReadBufferEventConfig((void *)buf));
+    StReadBufferEventConfig ev_cfg((void *)buf);
     size = cur_state_->ProcessEvent(ev_cfg);
 
     /*
      * st stream read pcm data from ringbuffer with almost no
-     * delay, sleep for some time after each read even if read
-     * fails or no enough data in ring buffer
+     * delay, wait up to one buffer duration after each read even
+     * if read fails or no enough data in ring buffer. The wait
+     * returns as soon as the next buffer is available.
      */
     if (size <= 0 || reader_->getUnreadSize() < buf->size) {
         sleep_ms = (buf->size * BITS_PER_BYTE * MS_PER_SEC) /
             (sm_cfg_->GetSampleRate() * sm_cfg_->GetBitWidth() *
              sm_cfg_->GetOutChannels());
-        std::this_thread::sleep_for(std::chrono::milliseconds(sleep_ms));
+        if (reader_->waitForData(buf->size, sleep_ms) == -EINVAL)
+            std::this_thread::sleep_for(std::chrono::milliseconds(sleep_ms));
     }
 
     PAL_VERBOSE(LOG_TAG, "Exit, read size %d", size);
@@ -531,8 +521,7 @@ int32_t StreamSoundTrigger::setParameters(uint32_t param_id, void *payload) {
     std::lock_guard<std::mutex> lck(mStreamMutex);
     switch (param_id) {
         case PAL_PARAM_ID_LOAD_SOUND_MODEL: {
-            std::shared_ptr<StEventConfig> ev_cfg(
-                new StLoadEventConfig((void *)param_payload->payload));
+            StLoadEventConfig ev_cfg((void *)param_payload->payload);
             status = cur_state_->ProcessEvent(ev_cfg);
             if (!status)
                 currentState = STREAM_OPENED;
@@ -543,8 +532,7 @@ int32_t StreamSoundTrigger::setParameters(uint32_t param_id, void *payload) {
             * Currently spf needs graph stop and start for next detection.
             * Handle this event similar to fresh start config.
             */
-            std::shared_ptr<StEventConfig> ev_cfg(
-                new StRecognitionCfgEventConfig((void *)param_payload->payload));
+            StRecognitionCfgEventConfig ev_cfg((void *)param_payload->payload);
             status = cur_state_->ProcessEvent(ev_cfg);
             break;
         }
@@ -555,8 +543,7 @@ int32_t StreamSoundTrigger::setParameters(uint32_t param_id, void *payload) {
             * and when the stream state is in buffering.
             */
             if (GetCurrentStateId() == ST_STATE_BUFFERING) {
-                std::shared_ptr<StEventConfig> ev_cfg(
-                    new StStopRecognitionEventConfig(false));
+                StStopRecognitionEventConfig ev_cfg(false);
                 status = cur_state_->ProcessEvent(ev_cfg);
             } else {
                 PAL_INFO(LOG_TAG, "Stream not in buffering state, ignore");
@@ -589,8 +576,7 @@ int32_t StreamSoundTrigger::HandleConcurrentStream(bool active) {
     }
 
     PAL_DBG(LOG_TAG, "Enter");
-    std::shared_ptr<StEventConfig> ev_cfg(
-        new StConcurrentStreamEventConfig(active));
+    StConcurrentStreamEventConfig ev_cfg(active);
     status = cur_state_->ProcessEvent(ev_cfg);
 
     if (active) {
@@ -648,8 +634,7 @@ int32_t StreamSoundTrigger::setECRef(std::shared_ptr<Device> dev, bool is_enable
 
 int32_t StreamSoundTrigger::setECRef_l(std::shared_ptr<Device> dev, bool is_enable) {
     int32_t status = 0;
-    std::shared_ptr<StEventConfig> ev_cfg(
-        new StECRefEventConfig(dev, is_enable));
+    StECRefEventConfig ev_cfg(dev, is_enable);
 
     PAL_DBG(LOG_TAG, "Enter, enable %d", is_enable);
 
@@ -691,8 +676,7 @@ int32_t StreamSoundTrigger::DisconnectDevice(pal_device_id_t device_id) {
      * device disconnect and connect.
      */
     mStreamMutex.lock();
-    std::shared_ptr<StEventConfig> ev_cfg(
-        new StDeviceDisconnectedEventConfig(device_id));
+    StDeviceDisconnectedEventConfig ev_cfg(device_id);
     status = cur_state_->ProcessEvent(ev_cfg);
     if (status) {
         PAL_ERR(LOG_TAG, "Failed to disconnect device %d", device_id);
@@ -707,8 +691,7 @@ int32_t StreamSoundTrigger::ConnectDevice(pal_device_id_t device_id) {
     int32_t status = 0;
 
     PAL_DBG(LOG_TAG, "Enter");
-    std::shared_ptr<StEventConfig> ev_cfg(
-        new StDeviceConnectedEventConfig(device_id));
+    StDeviceConnectedEventConfig ev_cfg(device_id);
     status = cur_state_->ProcessEvent(ev_cfg);
     if (status) {
         PAL_ERR(LOG_TAG, "Failed to connect device %d", device_id);
@@ -724,7 +707,7 @@ int32_t StreamSoundTrigger::Resume() {
 
     PAL_DBG(LOG_TAG, "Enter");
     std::lock_guard<std::mutex> lck(mStreamMutex);
-    std::shared_ptr<StEventConfig> ev_cfg(new StResumeEventConfig());
+    StResumeEventConfig ev_cfg;
     status = cur_state_->ProcessEvent(ev_cfg);
     if (status) {
         PAL_ERR(LOG_TAG, "Resume failed");
@@ -739,7 +722,7 @@ int32_t StreamSoundTrigger::Pause() {
 
     PAL_DBG(LOG_TAG, "Enter");
     std::lock_guard<std::mutex> lck(mStreamMutex);
-    std::shared_ptr<StEventConfig> ev_cfg(new StPauseEventConfig());
+    StPauseEventConfig ev_cfg;
     status = cur_state_->ProcessEvent(ev_cfg);
     if (status) {
         PAL_ERR(LOG_TAG, "Pause failed");
@@ -918,8 +901,7 @@ int32_t StreamSoundTrigger::SetEngineDetectionState(int32_t det_type) {
         reader_->updateState(READER_ENABLED);
     }
 
-    std::shared_ptr<StEventConfig> ev_cfg(
-       new StDetectedEventConfig(det_type));
+    StDetectedEventConfig ev_cfg(det_type);
     status = cur_state_->ProcessEvent(ev_cfg);
 
     /*
@@ -944,54 +926,33 @@ void StreamSoundTrigger::InternalStopRecognition() {
     PAL_DBG(LOG_TAG, "Enter");
     std::lock_guard<std::mutex> lck(mStreamMutex);
     if (pending_stop_) {
-        std::shared_ptr<StEventConfig> ev_cfg(
-           new StStopRecognitionEventConfig(true));
+        StStopRecognitionEventConfig ev_cfg(true);
         status = cur_state_->ProcessEvent(ev_cfg);
     }
     PAL_DBG(LOG_TAG, "Exit, status %d", status);
 }
 
-void StreamSoundTrigger::TimerThread(StreamSoundTrigger& st_stream) {
-    PAL_DBG(LOG_TAG, "Enter");
-
-    std::unique_lock<std::mutex> lck(st_stream.timer_mutex_);
-    while (!st_stream.exit_timer_thread_) {
-        st_stream.timer_start_cond_.wait(lck);
-        if (st_stream.exit_timer_thread_)
-            break;
-
-        if (st_stream.GetCurrentStateId() == ST_STATE_BUFFERING &&
-            !st_stream.second_stage_processing_) {
-            st_stream.timer_wait_cond_.wait_for(lck,
-                std::chrono::milliseconds(ST_LAB_DEFERRED_STOP_DELAY_MS));
-        } else {
-            st_stream.timer_wait_cond_.wait_for(lck,
-                std::chrono::milliseconds(ST_DEFERRED_STOP_DELAY_MS));
-        }
-
-        if (!st_stream.timer_stop_waiting_ && !st_stream.exit_timer_thread_) {
-            st_stream.timer_mutex_.unlock();
-            st_stream.InternalStopRecognition();
-            st_stream.timer_mutex_.lock();
-        }
-    }
-    PAL_DBG(LOG_TAG, "Exit");
-}
-
 void StreamSoundTrigger::PostDelayedStop() {
+    uint32_t delay_ms = ST_DEFERRED_STOP_DELAY_MS;
+
     PAL_VERBOSE(LOG_TAG, "Post Delayed Stop for %p", this);
     pending_stop_ = true;
+    if (GetCurrentStateId() == ST_STATE_BUFFERING &&
+        !second_stage_processing_)
+        delay_ms = ST_LAB_DEFERRED_STOP_DELAY_MS;
+
     std::lock_guard<std::mutex> lck(timer_mutex_);
-    timer_stop_waiting_ = false;
-    timer_start_cond_.notify_one();
+    timer_queue_->cancel(stop_timer_id_);
+    stop_timer_id_ = timer_queue_->postDelayed(
+        [this] { InternalStopRecognition(); }, delay_ms);
 }
 
 void StreamSoundTrigger::CancelDelayedStop() {
     PAL_VERBOSE(LOG_TAG, "Cancel Delayed stop for %p", this);
     pending_stop_ = false;
     std::lock_guard<std::mutex> lck(timer_mutex_);
-    timer_stop_waiting_ = true;
-    timer_wait_cond_.notify_one();
+    timer_queue_->cancel(stop_timer_id_);
+    stop_timer_id_ = 0;
 }
 
 std::shared_ptr<SoundTriggerEngine> StreamSoundTrigger::HandleEngineLoad(
@@ -1583,7 +1544,7 @@ int32_t StreamSoundTrigger::SendRecognitionConfig(
 
     // dump recognition config opaque data
     if (config->data_size > 0 && st_info_->GetEnableDebugDumps()) {
-        ST_DBG_DECLARE(FILE *rec_opaque_fd = NULL; static int rec_opaque_cnt = 0);
+        ST_DBG_DECLARE(PalDumpFile *rec_opaque_fd = NULL; static int rec_opaque_cnt = 0);
         ST_DBG_FILE_OPEN_WR(rec_opaque_fd, ST_DEBUG_DUMP_LOCATION,
             "rec_config_opaque", "bin", rec_opaque_cnt);
         ST_DBG_FILE_WRITE(rec_opaque_fd,
@@ -2316,7 +2277,7 @@ int32_t StreamSoundTrigger::GenerateCallbackEvent(
         if ((*event)->data_offset > 0 && (*event)->data_size > 0 &&
             st_info_->GetEnableDebugDumps()) {
             opaque_data = (uint8_t *)phrase_event + phrase_event->common.data_offset;
-            ST_DBG_DECLARE(FILE *det_opaque_fd = NULL; static int det_opaque_cnt = 0);
+            ST_DBG_DECLARE(PalDumpFile *det_opaque_fd = NULL; static int det_opaque_cnt = 0);
             ST_DBG_FILE_OPEN_WR(det_opaque_fd, ST_DEBUG_DUMP_LOCATION,
                 "det_event_opaque", "bin", det_opaque_cnt);
             ST_DBG_FILE_WRITE(det_opaque_fd, opaque_data, (*event)->data_size);
@@ -2983,23 +2944,22 @@ void StreamSoundTrigger::TransitTo(int32_t state_id) {
 }
 
 int32_t StreamSoundTrigger::ProcessInternalEvent(
-    std::shared_ptr<StEventConfig> ev_cfg) {
+    StEventConfig &ev_cfg) {
     return cur_state_->ProcessEvent(ev_cfg);
 }
 
 int32_t StreamSoundTrigger::StIdle::ProcessEvent(
-    std::shared_ptr<StEventConfig> ev_cfg) {
+    StEventConfig &ev_cfg) {
 
     int32_t status = 0;
 
     PAL_DBG(LOG_TAG, "StIdle: handle event %d for stream instance %u",
-        ev_cfg->id_, st_stream_.mInstanceID);
+        ev_cfg.id_, st_stream_.mInstanceID);
 
-    switch (ev_cfg->id_) {
+    switch (ev_cfg.id_) {
         case ST_EV_LOAD_SOUND_MODEL: {
             std::shared_ptr<CaptureProfile> cap_prof = nullptr;
-            StLoadEventConfigData *data =
-                (StLoadEventConfigData *)ev_cfg->data_.get();
+            StLoadEventConfigData *data = &ev_cfg.data_.load_;
             class SoundTriggerUUID uuid;
             struct pal_st_sound_model * pal_st_sm;
 
@@ -3130,8 +3090,7 @@ int32_t StreamSoundTrigger::StIdle::ProcessEvent(
             break;
         }
         case ST_EV_DEVICE_DISCONNECTED: {
-            StDeviceDisconnectedEventConfigData *data =
-                (StDeviceDisconnectedEventConfigData *)ev_cfg->data_.get();
+            StDeviceDisconnectedEventConfigData *data = &ev_cfg.data_.dev_disconnected_;
             pal_device_id_t device_id = data->dev_id_;
             if (st_stream_.mDevices.size() == 0) {
                 PAL_DBG(LOG_TAG, "No device to disconnect");
@@ -3152,8 +3111,7 @@ int32_t StreamSoundTrigger::StIdle::ProcessEvent(
         case ST_EV_DEVICE_CONNECTED: {
             struct pal_device *pal_dev = new struct pal_device;
             std::shared_ptr<Device> dev = nullptr;
-            StDeviceConnectedEventConfigData *data =
-                (StDeviceConnectedEventConfigData *)ev_cfg->data_.get();
+            StDeviceConnectedEventConfigData *data = &ev_cfg.data_.dev_connected_;
             pal_device_id_t dev_id = data->dev_id_;
 
             // mDevices should be empty as we have just disconnected device
@@ -3189,9 +3147,8 @@ int32_t StreamSoundTrigger::StIdle::ProcessEvent(
             std::shared_ptr<CaptureProfile> new_cap_prof = nullptr;
             bool active = false;
 
-            if (ev_cfg->id_ == ST_EV_CONCURRENT_STREAM) {
-                StConcurrentStreamEventConfigData *data =
-                    (StConcurrentStreamEventConfigData *)ev_cfg->data_.get();
+            if (ev_cfg.id_ == ST_EV_CONCURRENT_STREAM) {
+                StConcurrentStreamEventConfigData *data = &ev_cfg.data_.concurrent_;
                 active = data->is_active_;
             }
             new_cap_prof = st_stream_.GetCurrentCaptureProfile();
@@ -3256,8 +3213,7 @@ int32_t StreamSoundTrigger::StIdle::ProcessEvent(
 
                     TransitTo(ST_STATE_LOADED);
                     if (st_stream_.isActive()) {
-                        std::shared_ptr<StEventConfig> ev_cfg1(
-                            new StStartRecognitionEventConfig(false));
+                        StStartRecognitionEventConfig ev_cfg1(false);
                         status = st_stream_.ProcessInternalEvent(ev_cfg1);
                         if (0 != status) {
                             PAL_ERR(LOG_TAG, "Failed to Start, status %d", status);
@@ -3283,7 +3239,7 @@ int32_t StreamSoundTrigger::StIdle::ProcessEvent(
             TransitTo(ST_STATE_SSR);
             break;
         default: {
-            PAL_DBG(LOG_TAG, "Unhandled event %d", ev_cfg->id_);
+            PAL_DBG(LOG_TAG, "Unhandled event %d", ev_cfg.id_);
             break;
         }
     }
@@ -3292,14 +3248,14 @@ int32_t StreamSoundTrigger::StIdle::ProcessEvent(
 }
 
 int32_t StreamSoundTrigger::StLoaded::ProcessEvent(
-    std::shared_ptr<StEventConfig> ev_cfg) {
+    StEventConfig &ev_cfg) {
 
     int32_t status = 0;
 
     PAL_DBG(LOG_TAG, "StLoaded: handle event %d for stream instance %u",
-        ev_cfg->id_, st_stream_.mInstanceID);
+        ev_cfg.id_, st_stream_.mInstanceID);
 
-    switch (ev_cfg->id_) {
+    switch (ev_cfg.id_) {
         case ST_EV_UNLOAD_SOUND_MODEL: {
             int ret = 0;
 
@@ -3345,8 +3301,7 @@ int32_t StreamSoundTrigger::StLoaded::ProcessEvent(
             break;
         }
         case ST_EV_RECOGNITION_CONFIG: {
-            StRecognitionCfgEventConfigData *data =
-                (StRecognitionCfgEventConfigData *)ev_cfg->data_.get();
+            StRecognitionCfgEventConfigData *data = &ev_cfg.data_.rec_cfg_;
             status = st_stream_.SendRecognitionConfig(
                (struct pal_st_recognition_config *)data->data_);
             if (0 != status) {
@@ -3378,8 +3333,7 @@ int32_t StreamSoundTrigger::StLoaded::ProcessEvent(
             if (st_stream_.paused_) {
                break; // Concurrency is active, start later.
             }
-            StStartRecognitionEventConfigData *data =
-                (StStartRecognitionEventConfigData *)ev_cfg->data_.get();
+            StStartRecognitionEventConfigData *data = &ev_cfg.data_.start_;
             if (!st_stream_.rec_config_) {
                 PAL_ERR(LOG_TAG, "Recognition config not set %d", data->restart_);
                 status = -EINVAL;
@@ -3398,8 +3352,8 @@ int32_t StreamSoundTrigger::StLoaded::ProcessEvent(
              * 2. resume excuted and current common capture profile is null
              */
             if (!st_stream_.common_cp_update_disable_ &&
-                (ev_cfg->id_ == ST_EV_START_RECOGNITION ||
-                (ev_cfg->id_ == ST_EV_RESUME &&
+                (ev_cfg.id_ == ST_EV_START_RECOGNITION ||
+                (ev_cfg.id_ == ST_EV_RESUME &&
                 !st_stream_.rm->GetSoundTriggerCaptureProfile()))) {
                 backend_update = st_stream_.rm->UpdateSoundTriggerCaptureProfile(
                     &st_stream_, true);
@@ -3498,8 +3452,7 @@ int32_t StreamSoundTrigger::StLoaded::ProcessEvent(
             break;
         }
         case ST_EV_DEVICE_DISCONNECTED:{
-            StDeviceDisconnectedEventConfigData *data =
-                (StDeviceDisconnectedEventConfigData *)ev_cfg->data_.get();
+            StDeviceDisconnectedEventConfigData *data = &ev_cfg.data_.dev_disconnected_;
             pal_device_id_t device_id = data->dev_id_;
             if (st_stream_.mDevices.size() == 0) {
                 PAL_DBG(LOG_TAG, "No device to disconnect");
@@ -3532,8 +3485,7 @@ int32_t StreamSoundTrigger::StLoaded::ProcessEvent(
         case ST_EV_DEVICE_CONNECTED: {
             struct pal_device *pal_dev = new struct pal_device;
             std::shared_ptr<Device> dev = nullptr;
-            StDeviceConnectedEventConfigData *data =
-                (StDeviceConnectedEventConfigData *)ev_cfg->data_.get();
+            StDeviceConnectedEventConfigData *data = &ev_cfg.data_.dev_connected_;
             pal_device_id_t dev_id = data->dev_id_;
             std::vector<std::shared_ptr<SoundTriggerEngine>> tmp_engines;
 
@@ -3643,9 +3595,8 @@ int32_t StreamSoundTrigger::StLoaded::ProcessEvent(
             std::shared_ptr<CaptureProfile> new_cap_prof = nullptr;
             bool active = false;
 
-            if (ev_cfg->id_ == ST_EV_CONCURRENT_STREAM) {
-                StConcurrentStreamEventConfigData *data =
-                    (StConcurrentStreamEventConfigData *)ev_cfg->data_.get();
+            if (ev_cfg.id_ == ST_EV_CONCURRENT_STREAM) {
+                StConcurrentStreamEventConfigData *data = &ev_cfg.data_.concurrent_;
                 active = data->is_active_;
             }
             new_cap_prof = st_stream_.GetCurrentCaptureProfile();
@@ -3688,16 +3639,15 @@ int32_t StreamSoundTrigger::StLoaded::ProcessEvent(
             if (st_stream_.state_for_restore_ == ST_STATE_NONE) {
                 st_stream_.state_for_restore_ = ST_STATE_LOADED;
             }
-            std::shared_ptr<StEventConfig> ev_cfg(new StUnloadEventConfig());
+            StUnloadEventConfig ev_cfg;
             status = st_stream_.ProcessInternalEvent(ev_cfg);
             TransitTo(ST_STATE_SSR);
             break;
         }
         case ST_EV_EC_REF: {
-            StECRefEventConfigData *data =
-                (StECRefEventConfigData *)ev_cfg->data_.get();
+            StECRefEventConfigData *data = &ev_cfg.data_.ec_ref_;
             Stream *s = static_cast<Stream *>(&st_stream_);
-            status = st_stream_.gsl_engine_->setECRef(s, data->dev_,
+            status = st_stream_.gsl_engine_->setECRef(s, ev_cfg.dev_,
                 data->is_enable_, st_stream_.ec_rx_dev_ == nullptr);
             if (status) {
                 PAL_ERR(LOG_TAG, "Failed to set EC Ref in gsl engine");
@@ -3723,7 +3673,7 @@ int32_t StreamSoundTrigger::StLoaded::ProcessEvent(
             break;
         }
         default: {
-            PAL_DBG(LOG_TAG, "Unhandled event %d", ev_cfg->id_);
+            PAL_DBG(LOG_TAG, "Unhandled event %d", ev_cfg.id_);
             break;
         }
     }
@@ -3731,17 +3681,16 @@ int32_t StreamSoundTrigger::StLoaded::ProcessEvent(
 }
 
 int32_t StreamSoundTrigger::StActive::ProcessEvent(
-    std::shared_ptr<StEventConfig> ev_cfg) {
+    StEventConfig &ev_cfg) {
 
     int32_t status = 0;
 
     PAL_DBG(LOG_TAG, "StActive: handle event %d for stream instance %u",
-        ev_cfg->id_, st_stream_.mInstanceID);
+        ev_cfg.id_, st_stream_.mInstanceID);
 
-    switch (ev_cfg->id_) {
+    switch (ev_cfg.id_) {
         case ST_EV_DETECTED: {
-            StDetectedEventConfigData *data =
-                (StDetectedEventConfigData *) ev_cfg->data_.get();
+            StDetectedEventConfigData *data = &ev_cfg.data_.detected_;
             if (data->det_type_ != GMM_DETECTED)
                 break;
             if (!st_stream_.rec_config_->capture_requested &&
@@ -3768,8 +3717,8 @@ int32_t StreamSoundTrigger::StActive::ProcessEvent(
             // Do not update capture profile when pausing stream
             bool backend_update = false;
             if (!st_stream_.common_cp_update_disable_ &&
-                (ev_cfg->id_ == ST_EV_STOP_RECOGNITION ||
-                ev_cfg->id_ == ST_EV_UNLOAD_SOUND_MODEL)) {
+                (ev_cfg.id_ == ST_EV_STOP_RECOGNITION ||
+                ev_cfg.id_ == ST_EV_UNLOAD_SOUND_MODEL)) {
                 backend_update = st_stream_.rm->UpdateSoundTriggerCaptureProfile(
                     &st_stream_, false);
                 if (backend_update) {
@@ -3819,7 +3768,7 @@ int32_t StreamSoundTrigger::StActive::ProcessEvent(
                 }
             }
             TransitTo(ST_STATE_LOADED);
-            if (ev_cfg->id_ == ST_EV_UNLOAD_SOUND_MODEL) {
+            if (ev_cfg.id_ == ST_EV_UNLOAD_SOUND_MODEL) {
                 status = st_stream_.ProcessInternalEvent(ev_cfg);
                 if (status != 0) {
                     PAL_ERR(LOG_TAG, "Failed to unload sound model, status = %d",
@@ -3829,10 +3778,9 @@ int32_t StreamSoundTrigger::StActive::ProcessEvent(
             break;
         }
         case ST_EV_EC_REF: {
-            StECRefEventConfigData *data =
-                (StECRefEventConfigData *)ev_cfg->data_.get();
+            StECRefEventConfigData *data = &ev_cfg.data_.ec_ref_;
             Stream *s = static_cast<Stream *>(&st_stream_);
-            status = st_stream_.gsl_engine_->setECRef(s, data->dev_,
+            status = st_stream_.gsl_engine_->setECRef(s, ev_cfg.dev_,
                 data->is_enable_, st_stream_.ec_rx_dev_ == nullptr);
             if (status) {
                 PAL_ERR(LOG_TAG, "Failed to set EC Ref in gsl engine");
@@ -3844,8 +3792,7 @@ int32_t StreamSoundTrigger::StActive::ProcessEvent(
             break;
         }
         case ST_EV_DEVICE_DISCONNECTED: {
-            StDeviceDisconnectedEventConfigData *data =
-                (StDeviceDisconnectedEventConfigData *)ev_cfg->data_.get();
+            StDeviceDisconnectedEventConfigData *data = &ev_cfg.data_.dev_disconnected_;
             pal_device_id_t device_id = data->dev_id_;
             if (st_stream_.mDevices.size() == 0) {
                 PAL_DBG(LOG_TAG, "No device to disconnect");
@@ -3886,8 +3833,7 @@ int32_t StreamSoundTrigger::StActive::ProcessEvent(
         case ST_EV_DEVICE_CONNECTED: {
             struct pal_device *pal_dev = new struct pal_device;
             std::shared_ptr<Device> dev = nullptr;
-            StDeviceConnectedEventConfigData *data =
-                (StDeviceConnectedEventConfigData *)ev_cfg->data_.get();
+            StDeviceConnectedEventConfigData *data = &ev_cfg.data_.dev_connected_;
             pal_device_id_t dev_id = data->dev_id_;
 
             // mDevices should be empty as we have just disconnected device
@@ -3959,9 +3905,8 @@ int32_t StreamSoundTrigger::StActive::ProcessEvent(
             std::shared_ptr<CaptureProfile> new_cap_prof = nullptr;
             bool active = false;
 
-            if (ev_cfg->id_ == ST_EV_CONCURRENT_STREAM) {
-                StConcurrentStreamEventConfigData *data =
-                    (StConcurrentStreamEventConfigData *)ev_cfg->data_.get();
+            if (ev_cfg.id_ == ST_EV_CONCURRENT_STREAM) {
+                StConcurrentStreamEventConfigData *data = &ev_cfg.data_.concurrent_;
                 active = data->is_active_;
             }
             new_cap_prof = st_stream_.GetCurrentCaptureProfile();
@@ -3981,8 +3926,7 @@ int32_t StreamSoundTrigger::StActive::ProcessEvent(
                     new_cap_prof->GetSampleRate(),
                     new_cap_prof->isECRequired());
                 if (!active) {
-                    std::shared_ptr<StEventConfig> ev_cfg1(
-                        new StStopRecognitionEventConfig(false));
+                    StStopRecognitionEventConfig ev_cfg1(false);
                     status = st_stream_.ProcessInternalEvent(ev_cfg1);
                     if (status) {
                         PAL_ERR(LOG_TAG, "Failed to Stop, status %d", status);
@@ -4007,18 +3951,16 @@ int32_t StreamSoundTrigger::StActive::ProcessEvent(
             if (st_stream_.state_for_restore_ == ST_STATE_NONE) {
                 st_stream_.state_for_restore_ = ST_STATE_ACTIVE;
             }
-            std::shared_ptr<StEventConfig> ev_cfg1(
-                new StStopRecognitionEventConfig(false));
+            StStopRecognitionEventConfig ev_cfg1(false);
             status = st_stream_.ProcessInternalEvent(ev_cfg1);
 
-            std::shared_ptr<StEventConfig> ev_cfg2(
-                new StUnloadEventConfig());
+            StUnloadEventConfig ev_cfg2;
             status = st_stream_.ProcessInternalEvent(ev_cfg2);
             TransitTo(ST_STATE_SSR);
             break;
         }
         default: {
-            PAL_DBG(LOG_TAG, "Unhandled event %d", ev_cfg->id_);
+            PAL_DBG(LOG_TAG, "Unhandled event %d", ev_cfg.id_);
             break;
         }
     }
@@ -4026,13 +3968,13 @@ int32_t StreamSoundTrigger::StActive::ProcessEvent(
 }
 
 int32_t StreamSoundTrigger::StDetected::ProcessEvent(
-    std::shared_ptr<StEventConfig> ev_cfg) {
+    StEventConfig &ev_cfg) {
     int32_t status = 0;
 
     PAL_DBG(LOG_TAG, "StDetected: handle event %d for stream instance %u",
-        ev_cfg->id_, st_stream_.mInstanceID);
+        ev_cfg.id_, st_stream_.mInstanceID);
 
-    switch (ev_cfg->id_) {
+    switch (ev_cfg.id_) {
         case ST_EV_START_RECOGNITION: {
             // Client restarts next recognition without config changed.
             st_stream_.CancelDelayedStop();
@@ -4095,7 +4037,7 @@ int32_t StreamSoundTrigger::StDetected::ProcessEvent(
             }
             TransitTo(ST_STATE_LOADED);
 
-            if (ev_cfg->id_ == ST_EV_UNLOAD_SOUND_MODEL) {
+            if (ev_cfg.id_ == ST_EV_UNLOAD_SOUND_MODEL) {
                 status = st_stream_.ProcessInternalEvent(ev_cfg);
                 if (status != 0) {
                     PAL_ERR(LOG_TAG, "Failed to unload sound model, status = %d",
@@ -4200,21 +4142,18 @@ int32_t StreamSoundTrigger::StDetected::ProcessEvent(
             if (st_stream_.state_for_restore_ == ST_STATE_NONE) {
                 st_stream_.state_for_restore_ = ST_STATE_LOADED;
             }
-            std::shared_ptr<StEventConfig> ev_cfg1(
-                new StStopRecognitionEventConfig(false));
+            StStopRecognitionEventConfig ev_cfg1(false);
             status = st_stream_.ProcessInternalEvent(ev_cfg1);
 
-            std::shared_ptr<StEventConfig> ev_cfg2(
-                new StUnloadEventConfig());
+            StUnloadEventConfig ev_cfg2;
             status = st_stream_.ProcessInternalEvent(ev_cfg2);
             TransitTo(ST_STATE_SSR);
             break;
         }
         case ST_EV_EC_REF: {
-            StECRefEventConfigData *data =
-                (StECRefEventConfigData *)ev_cfg->data_.get();
+            StECRefEventConfigData *data = &ev_cfg.data_.ec_ref_;
             Stream *s = static_cast<Stream *>(&st_stream_);
-            status = st_stream_.gsl_engine_->setECRef(s, data->dev_,
+            status = st_stream_.gsl_engine_->setECRef(s, ev_cfg.dev_,
                 data->is_enable_, st_stream_.ec_rx_dev_ == nullptr);
             if (status) {
                 PAL_ERR(LOG_TAG, "Failed to set EC Ref in gsl engine");
@@ -4222,7 +4161,7 @@ int32_t StreamSoundTrigger::StDetected::ProcessEvent(
             break;
         }
         default: {
-            PAL_DBG(LOG_TAG, "Unhandled event %d", ev_cfg->id_);
+            PAL_DBG(LOG_TAG, "Unhandled event %d", ev_cfg.id_);
             break;
         }
     }
@@ -4230,26 +4169,41 @@ int32_t StreamSoundTrigger::StDetected::ProcessEvent(
 }
 
 int32_t StreamSoundTrigger::StBuffering::ProcessEvent(
-   std::shared_ptr<StEventConfig> ev_cfg) {
+   StEventConfig &ev_cfg) {
     int32_t status = 0;
 
     PAL_DBG(LOG_TAG, "StBuffering: handle event %d for stream instance %u",
-        ev_cfg->id_, st_stream_.mInstanceID);
+        ev_cfg.id_, st_stream_.mInstanceID);
 
-    switch (ev_cfg->id_) {
+    switch (ev_cfg.id_) {
         case ST_EV_READ_BUFFER: {
-            StReadBufferEventConfigData *data =
-                (StReadBufferEventConfigData *)ev_cfg->data_.get();
+            StReadBufferEventConfigData *data = &ev_cfg.data_.read_buf_;
             struct pal_buffer *buf = (struct pal_buffer *)data->data_;
+            struct iovec iov[2];
 
             if (!st_stream_.reader_) {
                 PAL_ERR(LOG_TAG, "no reader exists");
                 status = -EINVAL;
                 break;
             }
-            status = st_stream_.reader_->read(buf->buffer, buf->size);
-            if (st_stream_.st_info_->GetEnableDebugDumps()) {
-                ST_DBG_FILE_WRITE(st_stream_.lab_fd_, buf->buffer, buf->size);
+            /*
+             * Copy the unread window straight into the client buffer and
+             * only then release it. A writer lapping the window drops it
+             * and the reader peeks again from the oldest valid byte.
+             */
+            do {
+                status = st_stream_.reader_->peek(iov, buf->size);
+                if (status <= 0)
+                    break;
+                ar_mem_cpy(buf->buffer, iov[0].iov_len, iov[0].iov_base,
+                           iov[0].iov_len);
+                if (iov[1].iov_len)
+                    ar_mem_cpy(buf->buffer + iov[0].iov_len, iov[1].iov_len,
+                               iov[1].iov_base, iov[1].iov_len);
+                status = st_stream_.reader_->commit(status);
+            } while (status == -EOVERFLOW);
+            if (status > 0 && st_stream_.st_info_->GetEnableDebugDumps()) {
+                ST_DBG_FILE_WRITE(st_stream_.lab_fd_, buf->buffer, status);
             }
             break;
         }
@@ -4262,8 +4216,7 @@ int32_t StreamSoundTrigger::StBuffering::ProcessEvent(
                 rm->voteSleepMonitor(&st_stream_, false, true);
                 st_stream_.force_nlpi_vote = false;
             }
-            StStartRecognitionEventConfigData *data =
-                (StStartRecognitionEventConfigData *)ev_cfg->data_.get();
+            StStartRecognitionEventConfigData *data = &ev_cfg.data_.start_;
             PAL_DBG(LOG_TAG, "StBuffering: start recognition, is restart %d",
                     data->restart_);
             st_stream_.CancelDelayedStop();
@@ -4389,7 +4342,7 @@ int32_t StreamSoundTrigger::StBuffering::ProcessEvent(
                     PAL_ERR(LOG_TAG, "Device close failed, status %d", status);
             }
             TransitTo(ST_STATE_LOADED);
-            if (ev_cfg->id_ == ST_EV_UNLOAD_SOUND_MODEL) {
+            if (ev_cfg.id_ == ST_EV_UNLOAD_SOUND_MODEL) {
                 status = st_stream_.ProcessInternalEvent(ev_cfg);
                 if (status != 0) {
                     PAL_ERR(LOG_TAG, "Failed to unload sound model, status = %d",
@@ -4401,8 +4354,7 @@ int32_t StreamSoundTrigger::StBuffering::ProcessEvent(
         }
         case ST_EV_DETECTED: {
             // Second stage detections fall here.
-            StDetectedEventConfigData *data =
-                (StDetectedEventConfigData *)ev_cfg->data_.get();
+            StDetectedEventConfigData *data = &ev_cfg.data_.detected_;
             if (data->det_type_ == GMM_DETECTED) {
                 break;
             }
@@ -4536,21 +4488,18 @@ int32_t StreamSoundTrigger::StBuffering::ProcessEvent(
                     st_stream_.state_for_restore_ = ST_STATE_LOADED;
             }
 
-            std::shared_ptr<StEventConfig> ev_cfg2(
-                new StStopRecognitionEventConfig(false));
+            StStopRecognitionEventConfig ev_cfg2(false);
             status = st_stream_.ProcessInternalEvent(ev_cfg2);
 
-            std::shared_ptr<StEventConfig> ev_cfg3(
-                new StUnloadEventConfig());
+            StUnloadEventConfig ev_cfg3;
             status = st_stream_.ProcessInternalEvent(ev_cfg3);
             TransitTo(ST_STATE_SSR);
             break;
         }
         case ST_EV_EC_REF: {
-            StECRefEventConfigData *data =
-                (StECRefEventConfigData *)ev_cfg->data_.get();
+            StECRefEventConfigData *data = &ev_cfg.data_.ec_ref_;
             Stream *s = static_cast<Stream *>(&st_stream_);
-            status = st_stream_.gsl_engine_->setECRef(s, data->dev_,
+            status = st_stream_.gsl_engine_->setECRef(s, ev_cfg.dev_,
                 data->is_enable_, st_stream_.ec_rx_dev_ == nullptr);
             if (status) {
                 PAL_ERR(LOG_TAG, "Failed to set EC Ref in gsl engine");
@@ -4558,7 +4507,7 @@ int32_t StreamSoundTrigger::StBuffering::ProcessEvent(
             break;
         }
         default: {
-            PAL_DBG(LOG_TAG, "Unhandled event %d", ev_cfg->id_);
+            PAL_DBG(LOG_TAG, "Unhandled event %d", ev_cfg.id_);
             break;
         }
     }
@@ -4566,13 +4515,13 @@ int32_t StreamSoundTrigger::StBuffering::ProcessEvent(
 }
 
 int32_t StreamSoundTrigger::StSSR::ProcessEvent(
-   std::shared_ptr<StEventConfig> ev_cfg) {
+   StEventConfig &ev_cfg) {
     int32_t status = 0;
 
     PAL_DBG(LOG_TAG, "StSSR: handle event %d for stream instance %u",
-        ev_cfg->id_, st_stream_.mInstanceID);
+        ev_cfg.id_, st_stream_.mInstanceID);
 
-    switch (ev_cfg->id_) {
+    switch (ev_cfg.id_) {
         case ST_EV_SSR_ONLINE: {
             TransitTo(ST_STATE_IDLE);
             /*
@@ -4603,8 +4552,7 @@ int32_t StreamSoundTrigger::StSSR::ProcessEvent(
             }
             if (st_stream_.state_for_restore_ == ST_STATE_LOADED ||
                 st_stream_.state_for_restore_ == ST_STATE_ACTIVE) {
-                std::shared_ptr<StEventConfig> ev_cfg1(
-                    new StLoadEventConfig(st_stream_.sm_config_));
+                StLoadEventConfig ev_cfg1(st_stream_.sm_config_);
                 status = st_stream_.ProcessInternalEvent(ev_cfg1);
                 if (0 != status) {
                     PAL_ERR(LOG_TAG, "Failed to load sound model, status %d",
@@ -4623,15 +4571,14 @@ int32_t StreamSoundTrigger::StSSR::ProcessEvent(
             }
 
             if (st_stream_.state_for_restore_ == ST_STATE_ACTIVE) {
-                std::shared_ptr<StEventConfig> ev_cfg2(
-                    new StStartRecognitionEventConfig(false));
+                StStartRecognitionEventConfig ev_cfg2(false);
                 status = st_stream_.ProcessInternalEvent(ev_cfg2);
                 if (0 != status) {
                     PAL_ERR(LOG_TAG, "Failed to Start, status %d", status);
                     break;
                 }
             }
-            PAL_DBG(LOG_TAG, "StSSR: event %d handled", ev_cfg->id_);
+            PAL_DBG(LOG_TAG, "StSSR: event %d handled", ev_cfg.id_);
             st_stream_.state_for_restore_ = ST_STATE_NONE;
             break;
         }
@@ -4641,8 +4588,7 @@ int32_t StreamSoundTrigger::StSSR::ProcessEvent(
                     st_stream_.state_for_restore_);
                 status = -EINVAL;
             } else {
-                StLoadEventConfigData *data =
-                    (StLoadEventConfigData *)ev_cfg->data_.get();
+                StLoadEventConfigData *data = &ev_cfg.data_.load_;
                 status = st_stream_.UpdateSoundModel(
                     (struct pal_st_sound_model *)data->data_);
                 if (0 != status) {
@@ -4670,8 +4616,7 @@ int32_t StreamSoundTrigger::StSSR::ProcessEvent(
                     st_stream_.state_for_restore_);
                 status = -EINVAL;
             } else {
-                StRecognitionCfgEventConfigData *data =
-                    (StRecognitionCfgEventConfigData *)ev_cfg->data_.get();
+                StRecognitionCfgEventConfigData *data = &ev_cfg.data_.rec_cfg_;
                 status = st_stream_.UpdateRecognitionConfig(
                     (struct pal_st_recognition_config *)data->data_);
                 if (0 != status) {
@@ -4687,8 +4632,7 @@ int32_t StreamSoundTrigger::StSSR::ProcessEvent(
                     st_stream_.state_for_restore_);
                 status = -EINVAL;
             } else {
-                StStartRecognitionEventConfigData *data =
-                    (StStartRecognitionEventConfigData *)ev_cfg->data_.get();
+                StStartRecognitionEventConfigData *data = &ev_cfg.data_.start_;
                 if (!st_stream_.rec_config_) {
                     PAL_ERR(LOG_TAG, "Recognition config not set %d", data->restart_);
                     status = -EINVAL;
@@ -4724,7 +4668,7 @@ int32_t StreamSoundTrigger::StSSR::ProcessEvent(
             status = -EIO;
             break;
         default: {
-            PAL_DBG(LOG_TAG, "Unhandled event %d", ev_cfg->id_);
+            PAL_DBG(LOG_TAG, "Unhandled event %d", ev_cfg.id_);
             break;
         }
     }
@@ -4737,7 +4681,7 @@ int32_t StreamSoundTrigger::ssrDownHandler() {
 
     std::lock_guard<std::mutex> lck(mStreamMutex);
     common_cp_update_disable_ = true;
-    std::shared_ptr<StEventConfig> ev_cfg(new StSSROfflineConfig());
+    StSSROfflineConfig ev_cfg;
     status = cur_state_->ProcessEvent(ev_cfg);
     common_cp_update_disable_ = false;
 
@@ -4749,7 +4693,7 @@ int32_t StreamSoundTrigger::ssrUpHandler() {
 
     std::lock_guard<std::mutex> lck(mStreamMutex);
     common_cp_update_disable_ = true;
-    std::shared_ptr<StEventConfig> ev_cfg(new StSSROnlineConfig());
+    StSSROnlineConfig ev_cfg;
     status = cur_state_->ProcessEvent(ev_cfg);
     common_cp_update_disable_ = false;
 
@@ -0,0 +1,225 @@
+/*
+ * Copyright (c) 2024 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Host stress test for PalGraphLock, the resource manager graph lock.
+ *
+ * Stream threads run control operations (open, start, stop, close) on
+ * their own backends, some of them sharing one. Each operation holds the
+ * graph lock for a fixed time, standing in for the graph work done under
+ * it. A device switch thread takes the lock exclusively now and then.
+ * The same load runs twice: once with every operation taking the lock
+ * exclusively, which is how the global graph mutex behaved, and once with
+ * the backend scoped lock. Per mode the tail latency of the operations is
+ * printed, from asking for the lock to releasing it.
+ *
+ * The test fails if two holders of one backend, or an exclusive holder
+ * and anyone else, are ever inside at the same time, or if a mode does
+ * not finish in time (deadlock).
+ *
+ * Build from the top of the tree:
+ *   g++ -std=c++14 -O2 -pthread -DLINUX_ENABLED -D__unused= -I. -Iutils/inc \
+ *       test/PalGraphLockStressTest.cpp utils/src/PalGraphLock.cpp \
+ *       -o PalGraphLockStressTest
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include "PalGraphLock.h"
+
+#define STRESS_OPS_PER_STREAM   200
+#define STRESS_OP_US            500
+#define STRESS_SWITCH_EVERY_MS  20
+#define STRESS_SWITCH_US        2000
+#define STRESS_TIMEOUT_S        60
+
+/* stream -> backends of its devices; speaker and handset share a group */
+static const std::vector<std::vector<std::string>> streamBackEnds = {
+    {"CODEC_DMA-LPAIF_WSA-RX-0"},                         /* music */
+    {"CODEC_DMA-LPAIF_WSA-RX-0"},                         /* notification */
+    {"CODEC_DMA-LPAIF_RXTX-RX-0"},                        /* headphone */
+    {"CODEC_DMA-LPAIF_VA-TX-0"},                          /* voice ui */
+    {"CODEC_DMA-LPAIF_RXTX-TX-3"},                        /* voip tx */
+    {"CODEC_DMA-LPAIF_WSA-RX-0", "CODEC_DMA-LPAIF_RXTX-RX-0"}, /* combo */
+    {"SLIM-DEV1-TX-0"},                                   /* sensor pcm */
+    {"PCM_RT_PROXY-RX-0"},                                /* haptics */
+};
+
+struct holder {
+    std::atomic<int> inside;
+    holder() : inside(0) {};
+};
+
+static std::vector<std::string> allBackEnds;
+static std::vector<holder> holders(16);
+static std::atomic<int> exclusiveInside(0);
+static std::atomic<int> sharedInside(0);
+static std::atomic<bool> failed(false);
+
+static int backEndIndex(const std::string &name)
+{
+    return std::find(allBackEnds.begin(), allBackEnds.end(), name) - allBackEnds.begin();
+}
+
+static void busy(int us)
+{
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+static void enterScoped(const std::vector<std::string> &backEnds)
+{
+    std::vector<int> idx;
+
+    if (exclusiveInside.load())
+        failed = true;
+    sharedInside++;
+    for (auto &be : backEnds)
+        idx.push_back(backEndIndex(be));
+    std::sort(idx.begin(), idx.end());
+    idx.erase(std::unique(idx.begin(), idx.end()), idx.end());
+    for (int i : idx) {
+        if (holders[i].inside.fetch_add(1))
+            failed = true;
+    }
+    busy(STRESS_OP_US);
+    for (int i : idx)
+        holders[i].inside--;
+    sharedInside--;
+}
+
+static void enterExclusive(int us)
+{
+    if (exclusiveInside.fetch_add(1) || sharedInside.load())
+        failed = true;
+    busy(us);
+    exclusiveInside--;
+}
+
+static uint64_t percentile(std::vector<uint64_t> &v, int pct)
+{
+    size_t i = (v.size() * pct) / 100;
+
+    return v[std::min(i, v.size() - 1)];
+}
+
+static bool runMode(bool scoped)
+{
+    PalGraphLock graphLock;
+    std::vector<std::thread> streams;
+    std::vector<std::vector<uint64_t>> latencies(streamBackEnds.size());
+    std::vector<uint64_t> all;
+    std::atomic<int> running(streamBackEnds.size());
+    std::thread switcher;
+    auto begin = std::chrono::steady_clock::now();
+
+    for (size_t s = 0; s < streamBackEnds.size(); s++) {
+        streams.emplace_back([&, s]() {
+            std::vector<std::mutex *> held;
+
+            for (int op = 0; op < STRESS_OPS_PER_STREAM; op++) {
+                auto t0 = std::chrono::steady_clock::now();
+
+                if (scoped) {
+                    graphLock.lock(streamBackEnds[s], held);
+                    enterScoped(streamBackEnds[s]);
+                    graphLock.unlock(held);
+                } else {
+                    graphLock.lock();
+                    enterExclusive(STRESS_OP_US);
+                    graphLock.unlock();
+                }
+                latencies[s].push_back(std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - t0).count());
+            }
+            running--;
+        });
+    }
+
+    switcher = std::thread([&]() {
+        while (running.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(STRESS_SWITCH_EVERY_MS));
+            graphLock.lock();
+            enterExclusive(STRESS_SWITCH_US);
+            graphLock.unlock();
+        }
+    });
+
+    while (running.load()) {
+        if (std::chrono::steady_clock::now() - begin > std::chrono::seconds(STRESS_TIMEOUT_S)) {
+            printf("%s: no progress after %ds, deadlock\n", scoped ? "scoped" : "global",
+                   STRESS_TIMEOUT_S);
+            /* threads are stuck in the lock, do not wait for them */
+            exit(1);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    for (auto &t : streams)
+        t.join();
+    switcher.join();
+
+    for (auto &l : latencies)
+        all.insert(all.end(), l.begin(), l.end());
+    std::sort(all.begin(), all.end());
+    printf("%-6s: %zu ops in %lldms, latency us p50 %llu p90 %llu p99 %llu max %llu\n",
+           scoped ? "scoped" : "global", all.size(),
+           (long long)std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now() - begin).count(),
+           (unsigned long long)percentile(all, 50), (unsigned long long)percentile(all, 90),
+           (unsigned long long)percentile(all, 99), (unsigned long long)all.back());
+
+    return !failed.load();
+}
+
+int main()
+{
+    for (auto &backEnds : streamBackEnds) {
+        for (auto &be : backEnds) {
+            if (backEndIndex(be) == (int)allBackEnds.size())
+                allBackEnds.push_back(be);
+        }
+    }
+
+    if (!runMode(false) || !runMode(true)) {
+        printf("FAIL: graph lock exclusion violated\n");
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
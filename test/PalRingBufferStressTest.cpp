@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2024 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Host stress test for the lock-free mode of PalRingBuffer, as used for
+ * sound trigger LAB data: one writer, readers using read() and
+ * peek()/commit(), and a thread resetting the buffer and re-enabling the
+ * readers the way SoundTriggerEngineGsl does on detection and restart.
+ *
+ * The writer streams consecutive 32 bit words. A reader fails the test if
+ * a chunk is not consecutive, i.e. torn by a lapping writer, or if it
+ * returns data written before a reset the reader already observed.
+ *
+ * ThreadSanitizer reports the payload copies of writer and readers as
+ * racing. That is by design, every copy is validated against the cursors
+ * before it is kept, and only the data checks below decide the result.
+ *
+ * Build from the top of the tree with the log headers of the platform:
+ *   g++ -std=c++14 -O2 -pthread -DLINUX_ENABLED -D__unused= -I. -Iutils/inc \
+ *       test/PalRingBufferStressTest.cpp utils/src/PalRingBuffer.cpp \
+ *       -o PalRingBufferStressTest
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+#include "PalRingBuffer.h"
+#include "PalCommon.h"
+
+/* commits invalidated by a reset are expected and log at ERR */
+uint32_t pal_log_lvl = 0;
+
+#define STRESS_BUFFER_SIZE    (4096 * 4)
+#define STRESS_WRITE_WORDS    384
+#define STRESS_READ_BYTES     2048
+#define STRESS_READERS        3
+#define STRESS_RESETS_MAX     1024
+#define STRESS_DURATION_MS    2000
+
+static PalRingBuffer ring(STRESS_BUFFER_SIZE, true);
+static PalRingBufferReader *readers[STRESS_READERS];
+static std::atomic<bool> stopTest(false);
+static std::atomic<uint32_t> wordsWritten(0);
+/* lowest word a reader may see once it observed the reset generation */
+static std::atomic<uint32_t> resetFloor[STRESS_RESETS_MAX];
+static std::atomic<uint32_t> resetGen(0);
+static std::atomic<uint32_t> errors(0);
+static std::atomic<uint64_t> bytesRead(0);
+
+static void writerLoop()
+{
+    uint32_t words[STRESS_WRITE_WORDS];
+    uint32_t next = 0;
+    size_t written = 0;
+
+    while (!stopTest.load()) {
+        for (int i = 0; i < STRESS_WRITE_WORDS; i++)
+            words[i] = next + i;
+        written = ring.write(words, sizeof(words));
+        next += written / sizeof(uint32_t);
+        wordsWritten.store(next, std::memory_order_release);
+        if (!written)
+            std::this_thread::yield();
+    }
+}
+
+static bool checkChunk(const char *tag, const uint32_t *words, size_t count,
+                       uint32_t gen)
+{
+    uint32_t floor = resetFloor[gen].load(std::memory_order_acquire);
+
+    if (!count)
+        return true;
+
+    if (words[0] < floor) {
+        printf("%s: read word %u from before reset %u (floor %u)\n", tag,
+               words[0], gen, floor);
+        return false;
+    }
+    for (size_t i = 1; i < count; i++) {
+        if (words[i] != words[0] + i) {
+            printf("%s: torn chunk, word %zu is %u, expected %u\n", tag, i,
+                   words[i], (uint32_t)(words[0] + i));
+            return false;
+        }
+    }
+    return true;
+}
+
+static void readerLoop(int idx)
+{
+    PalRingBufferReader *reader = readers[idx];
+    uint32_t words[STRESS_READ_BYTES / sizeof(uint32_t)];
+    struct iovec iov[2];
+    uint32_t gen = 0;
+    int32_t size = 0;
+    bool ok = false;
+
+    while (!stopTest.load()) {
+        gen = resetGen.load(std::memory_order_acquire);
+        if (reader->waitForData(STRESS_READ_BYTES / 2, 10))
+            continue;
+
+        if (idx & 1) {
+            size = reader->peek(iov, STRESS_READ_BYTES);
+            if (size <= 0)
+                continue;
+            memcpy(words, iov[0].iov_base, iov[0].iov_len);
+            memcpy((char *)words + iov[0].iov_len, iov[1].iov_base,
+                   iov[1].iov_len);
+            ok = checkChunk("peek", words, size / sizeof(uint32_t), gen);
+            /* a failed commit means the peeked data was invalidated */
+            if (reader->commit(size) < 0)
+                continue;
+        } else {
+            size = reader->read(words, STRESS_READ_BYTES);
+            if (size <= 0)
+                continue;
+            ok = checkChunk("read", words, size / sizeof(uint32_t), gen);
+        }
+        if (!ok)
+            errors++;
+        bytesRead += size;
+    }
+}
+
+static void resetLoop()
+{
+    uint32_t gen = 0;
+
+    while (!stopTest.load() && gen + 1 < STRESS_RESETS_MAX) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        resetFloor[gen + 1].store(wordsWritten.load(std::memory_order_acquire),
+                                  std::memory_order_release);
+        ring.reset();
+        for (int i = 0; i < STRESS_READERS; i++)
+            readers[i]->updateState(READER_ENABLED);
+        resetGen.store(++gen, std::memory_order_release);
+    }
+}
+
+int main()
+{
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < STRESS_READERS; i++) {
+        readers[i] = ring.newReader();
+        readers[i]->updateState(READER_ENABLED);
+    }
+
+    threads.emplace_back(writerLoop);
+    for (int i = 0; i < STRESS_READERS; i++)
+        threads.emplace_back(readerLoop, i);
+    threads.emplace_back(resetLoop);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(STRESS_DURATION_MS));
+    stopTest.store(true);
+    for (auto &t : threads)
+        t.join();
+
+    printf("resets %u, words written %u, bytes read %llu, errors %u\n",
+           resetGen.load(), wordsWritten.load(),
+           (unsigned long long)bytesRead.load(), errors.load());
+    return errors.load() ? EXIT_FAILURE : EXIT_SUCCESS;
+}
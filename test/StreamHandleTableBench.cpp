@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2024 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Host microbenchmark for StreamHandleTable, the lock free handle table
+ * behind ResourceManager::increase/decreaseStreamUserCounter.
+ *
+ * Reports the cost of a pin/unpin pair as the number of live streams and
+ * pinning threads grows, and the cost of a miss after heavy open/close
+ * churn, which must stay flat now that tombstones are reclaimed.
+ *
+ * Build from the top of the tree with the log headers of the platform:
+ *   g++ -std=c++14 -O2 -pthread -DLINUX_ENABLED -I. -Iresource_manager/inc \
+ *       test/StreamHandleTableBench.cpp resource_manager/src/StreamHandleTable.cpp \
+ *       -o StreamHandleTableBench
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "StreamHandleTable.h"
+#include "PalCommon.h"
+
+uint32_t pal_log_lvl = PAL_LOG_ERR;
+
+#define BENCH_ITERATIONS    (1 << 20)
+#define BENCH_CHURN_CYCLES  100000
+#define BENCH_MAX_THREADS   8
+
+static StreamHandleTable table;
+static char streams[STREAM_HANDLE_TABLE_SIZE * 4][64];
+
+static Stream *fakeStream(int i)
+{
+    return reinterpret_cast<Stream *>(&streams[i]);
+}
+
+static double nsPerOp(std::chrono::steady_clock::time_point begin, long ops)
+{
+    std::chrono::duration<double, std::nano> ns =
+        std::chrono::steady_clock::now() - begin;
+
+    return ns.count() / ops;
+}
+
+static void pinLoop(int first, int count, long iterations, int *errors)
+{
+    for (long i = 0; i < iterations; i++) {
+        Stream *s = fakeStream(first + (int)(i % count));
+
+        if (table.acquire(s) || table.release(s) < 0)
+            (*errors)++;
+    }
+}
+
+static int benchPin(int live, int threads)
+{
+    std::vector<std::thread> workers;
+    std::vector<int> errors(threads, 0);
+    std::chrono::steady_clock::time_point begin;
+    int per_thread = live / threads;
+    int ret = 0;
+
+    for (int i = 0; i < live; i++)
+        table.insert(fakeStream(i));
+
+    begin = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; t++)
+        workers.emplace_back(pinLoop, t * per_thread, per_thread,
+                             (long)BENCH_ITERATIONS, &errors[t]);
+    for (auto &w : workers)
+        w.join();
+    printf("live %3d threads %d: %6.1f ns per pin/unpin\n", live, threads,
+           nsPerOp(begin, (long)BENCH_ITERATIONS));
+
+    for (int i = 0; i < live; i++)
+        table.erase(fakeStream(i));
+    for (int t = 0; t < threads; t++)
+        ret += errors[t];
+    return ret;
+}
+
+static int benchChurn(int live)
+{
+    std::chrono::steady_clock::time_point begin;
+    Stream *absent = fakeStream(STREAM_HANDLE_TABLE_SIZE * 4 - 1);
+    int pool = STREAM_HANDLE_TABLE_SIZE * 4 - 1;
+    int errors = 0;
+
+    for (int i = 0; i < live; i++)
+        table.insert(fakeStream(i));
+
+    begin = std::chrono::steady_clock::now();
+    for (long i = 0; i < BENCH_ITERATIONS; i++)
+        if (!table.acquire(absent))
+            errors++;
+    printf("live %3d before churn: %6.1f ns per miss\n", live,
+           nsPerOp(begin, (long)BENCH_ITERATIONS));
+
+    /* close the oldest stream and open a new one, as a busy client would */
+    for (long c = 0; c < BENCH_CHURN_CYCLES; c++) {
+        if (table.erase(fakeStream((int)(c % pool))) ||
+            table.insert(fakeStream((int)((c + live) % pool))))
+            errors++;
+    }
+
+    begin = std::chrono::steady_clock::now();
+    for (long i = 0; i < BENCH_ITERATIONS; i++)
+        if (!table.acquire(absent))
+            errors++;
+    printf("live %3d after churn:  %6.1f ns per miss\n", live,
+           nsPerOp(begin, (long)BENCH_ITERATIONS));
+
+    for (long c = BENCH_CHURN_CYCLES; c < BENCH_CHURN_CYCLES + live; c++)
+        table.erase(fakeStream((int)(c % pool)));
+    return errors;
+}
+
+int main()
+{
+    int errors = 0;
+
+    for (int live = 8; live <= 128; live *= 4)
+        for (int threads = 1; threads <= BENCH_MAX_THREADS; threads *= 2)
+            errors += benchPin(live, threads);
+
+    for (int live = 8; live <= 128; live *= 4)
+        errors += benchChurn(live);
+
+    if (errors)
+        printf("FAILED: %d unexpected results\n", errors);
+    return errors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
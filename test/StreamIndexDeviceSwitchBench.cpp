@@ -0,0 +1,252 @@
+/*
+ * Copyright (c) 2024 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Target benchmark for the ResourceManager stream index, with the 20+
+ * streams a busy device switch has to walk.
+ *
+ * Opens BENCH_STREAMS playback and capture streams through libar-pal, then
+ * reports, under the ResourceManager lock as the switch paths take it:
+ *  - getActiveStream_l for the old and the new device and getOrphanStream_l,
+ *    the lookups every device switch starts with
+ *  - getConcurrentTxStream_l and getActiveEchoReferenceRxDevices_l, the EC
+ *    reference decisions made for each stream that switches
+ * and, end to end, pal_stream_set_device moving one playback stream
+ * between speaker and handset while the other streams stay open.
+ *
+ * Needs a LINUX_ENABLED target with the PAL configs installed. Build it
+ * with the include paths of libar-pal (see Makefile.am):
+ *   g++ -std=c++14 -O2 -pthread -DLINUX_ENABLED -I. -Istream/inc \
+ *       -Idevice/inc -Isession/inc -Iresource_manager/inc -Iutils/inc \
+ *       -Icontext_manager/inc -I<sysroot>/usr/include/agm \
+ *       -I<sysroot>/usr/include/spf test/StreamIndexDeviceSwitchBench.cpp \
+ *       -lar-pal -o StreamIndexDeviceSwitchBench
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include "PalApi.h"
+#include "ResourceManager.h"
+#include "Device.h"
+#include "Stream.h"
+
+#define BENCH_STREAMS       24
+#define BENCH_ITERATIONS    100000
+#define BENCH_SWITCHES      50
+
+struct BenchStreamCfg {
+    pal_stream_type_t type;
+    pal_stream_direction_t dir;
+    pal_device_id_t dev;
+};
+
+/* spread over several types so per type instance limits are not hit */
+static const BenchStreamCfg benchCfgs[] = {
+    {PAL_STREAM_LOW_LATENCY, PAL_AUDIO_OUTPUT, PAL_DEVICE_OUT_SPEAKER},
+    {PAL_STREAM_DEEP_BUFFER, PAL_AUDIO_OUTPUT, PAL_DEVICE_OUT_SPEAKER},
+    {PAL_STREAM_GENERIC, PAL_AUDIO_OUTPUT, PAL_DEVICE_OUT_SPEAKER},
+    {PAL_STREAM_LOW_LATENCY, PAL_AUDIO_INPUT, PAL_DEVICE_IN_HANDSET_MIC},
+    {PAL_STREAM_DEEP_BUFFER, PAL_AUDIO_INPUT, PAL_DEVICE_IN_HANDSET_MIC},
+};
+
+static std::vector<pal_stream_handle_t *> handles;
+
+static double nsPerOp(std::chrono::steady_clock::time_point begin, long ops)
+{
+    std::chrono::duration<double, std::nano> ns =
+        std::chrono::steady_clock::now() - begin;
+
+    return ns.count() / ops;
+}
+
+static void fillDevice(struct pal_device *dev, pal_device_id_t id)
+{
+    memset(dev, 0, sizeof(*dev));
+    dev->id = id;
+    dev->config.sample_rate = 48000;
+    dev->config.bit_width = 16;
+    dev->config.aud_fmt_id = PAL_AUDIO_FMT_PCM_S16_LE;
+    dev->config.ch_info.channels = id == PAL_DEVICE_IN_HANDSET_MIC ? 1 : 2;
+}
+
+static int openStreams(void)
+{
+    struct pal_stream_attributes attr;
+    struct pal_device dev;
+    pal_stream_handle_t *handle = nullptr;
+    int attempts = 0;
+
+    while (handles.size() < BENCH_STREAMS && attempts < BENCH_STREAMS * 2) {
+        const BenchStreamCfg &cfg = benchCfgs[attempts++ %
+            (sizeof(benchCfgs) / sizeof(benchCfgs[0]))];
+
+        fillDevice(&dev, cfg.dev);
+        memset(&attr, 0, sizeof(attr));
+        attr.type = cfg.type;
+        attr.direction = cfg.dir;
+        if (cfg.dir == PAL_AUDIO_INPUT)
+            attr.in_media_config = dev.config;
+        else
+            attr.out_media_config = dev.config;
+
+        if (!pal_stream_open(&attr, 1, &dev, 0, NULL, NULL, 0, &handle))
+            handles.push_back(handle);
+    }
+
+    printf("opened %zu streams in %d attempts\n", handles.size(), attempts);
+    return handles.size() >= 20 ? 0 : -ENOSPC;
+}
+
+static int benchQueries(std::shared_ptr<ResourceManager> rm,
+                        std::shared_ptr<Device> oldDev,
+                        std::shared_ptr<Device> newDev)
+{
+    std::vector<Stream*> active;
+    std::vector<Stream*> orphans;
+    std::vector<Stream*> retries;
+    std::vector<Stream*> txStreams;
+    std::chrono::steady_clock::time_point begin;
+    Stream *rxStream = reinterpret_cast<Stream *>(handles[0]);
+    Stream *txStream = nullptr;
+    size_t found = 0;
+
+    for (auto handle : handles) {
+        pal_stream_direction_t dir = PAL_AUDIO_OUTPUT;
+
+        reinterpret_cast<Stream *>(handle)->getStreamDirection(&dir);
+        if (dir == PAL_AUDIO_INPUT) {
+            txStream = reinterpret_cast<Stream *>(handle);
+            break;
+        }
+    }
+
+    rm->lockResourceManagerMutex();
+
+    begin = std::chrono::steady_clock::now();
+    for (long i = 0; i < BENCH_ITERATIONS; i++) {
+        rm->getActiveStream_l(active, oldDev);
+        found += active.size();
+        rm->getActiveStream_l(active, newDev);
+        found += active.size();
+        rm->getOrphanStream_l(orphans, retries);
+    }
+    printf("%zu streams: %8.1f ns per switch lookup (active old/new, orphan)\n",
+           handles.size(), nsPerOp(begin, BENCH_ITERATIONS));
+
+    begin = std::chrono::steady_clock::now();
+    for (long i = 0; i < BENCH_ITERATIONS; i++) {
+        txStreams = rm->getConcurrentTxStream_l(rxStream, newDev);
+        if (txStream)
+            rm->getActiveEchoReferenceRxDevices_l(txStream);
+    }
+    printf("%zu streams: %8.1f ns per EC reference decision\n",
+           handles.size(), nsPerOp(begin, BENCH_ITERATIONS));
+
+    rm->unlockResourceManagerMutex();
+
+    /* the speaker streams must have been found on every old device lookup */
+    return found >= (size_t)BENCH_ITERATIONS ? 0 : -ENOENT;
+}
+
+static void benchSwitch(void)
+{
+    struct pal_device dev;
+    std::chrono::steady_clock::time_point begin;
+    int status = 0;
+    int i = 0;
+
+    begin = std::chrono::steady_clock::now();
+    for (i = 0; i < BENCH_SWITCHES; i++) {
+        fillDevice(&dev, (i & 1) ? PAL_DEVICE_OUT_SPEAKER :
+                   PAL_DEVICE_OUT_HANDSET);
+        status = pal_stream_set_device(handles[0], 1, &dev);
+        if (status)
+            break;
+    }
+    if (status) {
+        printf("pal_stream_set_device failed at switch %d, status %d\n", i,
+               status);
+        return;
+    }
+    printf("%zu streams: %8.1f us per pal_stream_set_device\n",
+           handles.size(), nsPerOp(begin, BENCH_SWITCHES) / 1000);
+}
+
+int main()
+{
+    std::shared_ptr<ResourceManager> rm = nullptr;
+    std::shared_ptr<Device> speaker = nullptr;
+    std::shared_ptr<Device> handset = nullptr;
+    struct pal_device dev;
+    int status = 0;
+
+    status = pal_init();
+    if (status) {
+        printf("pal_init failed, status %d\n", status);
+        return EXIT_FAILURE;
+    }
+    rm = ResourceManager::getInstance();
+
+    status = openStreams();
+    if (status) {
+        printf("need at least 20 streams open\n");
+        goto close;
+    }
+
+    fillDevice(&dev, PAL_DEVICE_OUT_SPEAKER);
+    speaker = Device::getInstance(&dev, rm);
+    fillDevice(&dev, PAL_DEVICE_OUT_HANDSET);
+    handset = Device::getInstance(&dev, rm);
+    if (!speaker || !handset) {
+        status = -EINVAL;
+        goto close;
+    }
+
+    status = benchQueries(rm, speaker, handset);
+    if (!status)
+        benchSwitch();
+
+close:
+    for (auto handle : handles)
+        pal_stream_close(handle);
+    handles.clear();
+    speaker = nullptr;
+    handset = nullptr;
+    rm = nullptr;
+    pal_deinit();
+    return status ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2024 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Test that the sound trigger buffering path does not touch the heap. It
+ * opens a voice UI stream, points it at a LAB ring of its own and drives
+ * StBuffering::ProcessEvent with StReadBufferEventConfig the way
+ * StreamSoundTrigger::read does, with operator new replaced by a counting
+ * version. Any allocation while an event is built, copied or processed,
+ * or an out of order LAB word, fails the test.
+ *
+ * The stream is opened through libar-pal, so this runs on a LINUX_ENABLED
+ * target with the PAL configs installed and debug dumps disabled. Build it
+ * with the include paths of libar-pal (see Makefile.am):
+ *   g++ -std=c++14 -O2 -pthread -DLINUX_ENABLED -I. -Istream/inc \
+ *       -Idevice/inc -Isession/inc -Iresource_manager/inc -Iutils/inc \
+ *       -Icontext_manager/inc -I<sysroot>/usr/include/agm \
+ *       -I<sysroot>/usr/include/spf test/StreamSoundTriggerAllocTest.cpp \
+ *       -lar-pal -o StreamSoundTriggerAllocTest
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <new>
+#include "PalApi.h"
+#include "StreamSoundTrigger.h"
+
+#define ALLOC_TEST_RING_SIZE     (4096 * 4)
+#define ALLOC_TEST_READ_BYTES    1024
+#define ALLOC_TEST_WRITE_WORDS   384
+#define ALLOC_TEST_ITERATIONS    10000
+
+static std::atomic<bool> counting(false);
+static std::atomic<uint64_t> allocations(0);
+
+static void *countedAlloc(size_t size)
+{
+    if (counting.load(std::memory_order_relaxed))
+        allocations++;
+    return malloc(size ? size : 1);
+}
+
+void *operator new(size_t size)
+{
+    void *p = countedAlloc(size);
+
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void *operator new[](size_t size)
+{
+    void *p = countedAlloc(size);
+
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept
+{
+    return countedAlloc(size);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept
+{
+    return countedAlloc(size);
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void operator delete[](void *p, size_t) noexcept { free(p); }
+
+class StreamSoundTriggerAllocTest {
+ public:
+    static int32_t run(StreamSoundTrigger *st);
+
+ private:
+    static bool checkChunk(const uint32_t *words, size_t count,
+                           uint32_t *next);
+};
+
+bool StreamSoundTriggerAllocTest::checkChunk(const uint32_t *words,
+                                             size_t count, uint32_t *next)
+{
+    /* a lapped reader skips ahead, but never back and never inside a chunk */
+    if (count && words[0] < *next) {
+        printf("read word %u, already read up to %u\n", words[0], *next);
+        return false;
+    }
+    for (size_t i = 1; i < count; i++) {
+        if (words[i] != words[0] + i) {
+            printf("torn chunk, word %zu is %u, expected %u\n", i, words[i],
+                   (uint32_t)(words[0] + i));
+            return false;
+        }
+    }
+    if (count)
+        *next = words[count - 1] + 1;
+    return true;
+}
+
+int32_t StreamSoundTriggerAllocTest::run(StreamSoundTrigger *st)
+{
+    PalRingBuffer ring(ALLOC_TEST_RING_SIZE, true);
+    PalRingBufferReader *reader = nullptr;
+    PalRingBufferReader *savedReader = nullptr;
+    StreamSoundTrigger::StBuffering *buffering = nullptr;
+    uint32_t words[ALLOC_TEST_WRITE_WORDS];
+    uint32_t labWords[ALLOC_TEST_READ_BYTES / sizeof(uint32_t)];
+    struct pal_buffer buf;
+    uint32_t written = 0;
+    uint32_t next = 0;
+    uint64_t bytesRead = 0;
+    int32_t status = 0;
+
+    if (st->st_info_->GetEnableDebugDumps()) {
+        printf("disable sound trigger debug dumps to run this test\n");
+        return -EINVAL;
+    }
+
+    reader = ring.newReader();
+    if (!reader)
+        return -ENOMEM;
+    reader->updateState(READER_ENABLED);
+
+    memset(&buf, 0, sizeof(buf));
+    buf.buffer = (uint8_t *)labWords;
+
+    std::lock_guard<std::mutex> lck(st->mStreamMutex);
+    savedReader = st->reader_;
+    st->reader_ = reader;
+    buffering = static_cast<StreamSoundTrigger::StBuffering *>(
+        st->st_buffering_);
+
+    for (int i = 0; i < ALLOC_TEST_ITERATIONS; i++) {
+        /* write a little faster than we read so the reader gets lapped */
+        for (int j = 0; j < ALLOC_TEST_WRITE_WORDS; j++)
+            words[j] = written + j;
+        written += ring.write(words, sizeof(words)) / sizeof(uint32_t);
+
+        buf.size = sizeof(labWords);
+        counting.store(true);
+        {
+            StreamSoundTrigger::StReadBufferEventConfig ev_cfg((void *)&buf);
+            StreamSoundTrigger::StEventConfig copy = ev_cfg;
+
+            status = buffering->ProcessEvent(copy);
+        }
+        counting.store(false);
+
+        if (status < 0) {
+            printf("read event failed, status %d\n", status);
+            break;
+        }
+        if (!checkChunk(labWords, status / sizeof(uint32_t), &next)) {
+            status = -EINVAL;
+            break;
+        }
+        bytesRead += status;
+        status = 0;
+    }
+
+    st->reader_ = savedReader;
+    ring.removeReader(reader);
+    delete reader;
+
+    printf("words written %u, bytes read %llu, allocations %llu\n", written,
+           (unsigned long long)bytesRead,
+           (unsigned long long)allocations.load());
+    if (!status && allocations.load())
+        status = -ENOMEM;
+
+    return status;
+}
+
+int main()
+{
+    struct pal_stream_attributes attr;
+    struct pal_device dev;
+    pal_stream_handle_t *handle = nullptr;
+    int32_t status = 0;
+
+    status = pal_init();
+    if (status) {
+        printf("pal_init failed, status %d\n", status);
+        return EXIT_FAILURE;
+    }
+
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PAL_STREAM_VOICE_UI;
+    attr.direction = PAL_AUDIO_INPUT;
+    attr.in_media_config.sample_rate = 16000;
+    attr.in_media_config.bit_width = 16;
+    attr.in_media_config.aud_fmt_id = PAL_AUDIO_FMT_PCM_S16_LE;
+    attr.in_media_config.ch_info.channels = 1;
+    memset(&dev, 0, sizeof(dev));
+    dev.id = PAL_DEVICE_IN_HANDSET_VA_MIC;
+    dev.config = attr.in_media_config;
+
+    status = pal_stream_open(&attr, 1, &dev, 0, NULL, NULL, 0, &handle);
+    if (status) {
+        printf("voice UI stream open failed, status %d\n", status);
+        goto deinit;
+    }
+
+    status = StreamSoundTriggerAllocTest::run(
+        reinterpret_cast<StreamSoundTrigger *>(handle));
+
+    pal_stream_close(handle);
+deinit:
+    pal_deinit();
+    printf("%s\n", status ? "FAILED" : "PASSED");
+    return status ? EXIT_FAILURE : EXIT_SUCCESS;
+}
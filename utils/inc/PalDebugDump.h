@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PALDEBUGDUMP_H_
+#define PALDEBUGDUMP_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+
+#define PAL_DUMP_LOCATION "/data/vendor/audio"
+/* hand-off slots between callers and the writer thread, power of two */
+#define PAL_DUMP_QUEUE_SLOTS 512
+/* default cap on dump data queued but not yet written */
+#define PAL_DUMP_DEFAULT_MAX_BYTES (4 * 1024 * 1024)
+/* payload bytes per arena chunk, a write takes as many as it needs */
+#define PAL_DUMP_CHUNK_SIZE 4096
+
+struct PalDumpFile;
+struct PalDumpMsg;
+struct PalDumpChunk;
+
+/*
+ * Debug dump writer. open/write/close only copy the data into a bounded
+ * lock-free queue; a single background thread does every fopen, fwrite,
+ * fflush and fclose, so dumps can stay enabled without adding file I/O
+ * to the audio or detection threads. write() copies into chunks of an
+ * arena preallocated by the first open with the cap at that time, so it
+ * neither allocates nor takes a lock. Data that would take the queued
+ * bytes over the cap, or finds no free chunk or queue slot, is dropped
+ * and counted. The thread is started by the first open as well, a
+ * process that never dumps has neither.
+ */
+class PalDebugDump
+{
+public:
+    /* returns nullptr if the dump cannot be queued, writes to it are no-ops */
+    static PalDumpFile *open(const char *path);
+    static void write(PalDumpFile *file, const void *buf, size_t size);
+    static void close(PalDumpFile *file);
+    static void setMaxBytes(size_t maxBytes);
+    /* bit n enables the SessionAlsaPcm read/write tap of pal_stream_type_t n */
+    static void setPcmTapMask(uint64_t mask);
+    static bool isPcmTapEnabled(uint32_t streamType);
+    static std::string dumpJson();
+private:
+    struct slot {
+        std::atomic<uint64_t> seq;
+        PalDumpMsg *msg;
+    };
+    PalDebugDump();
+    static PalDebugDump *getInstance();
+    static void writerLoop(PalDebugDump &dump);
+    bool push(PalDumpMsg *msg);
+    PalDumpMsg *pop();
+    bool hasMsg();
+    void notifyWriter();
+    void pushControl(PalDumpMsg *msg);
+    PalDumpChunk *allocChunk();
+    void freeChunks(PalDumpChunk *chunk);
+    slot slots_[PAL_DUMP_QUEUE_SLOTS];
+    std::atomic<uint64_t> head_;
+    uint64_t tail_;
+    std::once_flag writerStarted_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    /* set while the writer sleeps, producers only notify then */
+    std::atomic<bool> writerWaiting_;
+    PalDumpChunk *arena_;
+    std::atomic<size_t> arenaChunks_;
+    /* free chunk index + 1 in the low half, ABA tag in the high half */
+    std::atomic<uint64_t> freeHead_;
+    std::atomic<size_t> maxBytes_;
+    std::atomic<size_t> queuedBytes_;
+    std::atomic<size_t> peakQueuedBytes_;
+    std::atomic<uint64_t> writtenBytes_;
+    std::atomic<uint64_t> droppedBytes_;
+    std::atomic<uint64_t> droppedChunks_;
+    std::atomic<uint64_t> failedOpens_;
+    /* checked on every pcm read/write, kept off the instance */
+    static std::atomic<uint64_t> pcmTapMask_;
+};
+
+#endif //PALDEBUGDUMP_H_
@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PALEVENTEXECUTOR_H_
+#define PALEVENTEXECUTOR_H_
+
+#include <stdint.h>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define PAL_BLOCKING_EXECUTOR_WORKERS 4
+
+typedef enum {
+    PAL_EXEC_LANE_RT = 0,    /* async stream open/start, dispatched first */
+    PAL_EXEC_LANE_NORMAL,
+    PAL_EXEC_LANE_MAX,
+} pal_exec_lane_t;
+
+class PalEventExecutor;
+
+/*
+ * Serial queue on the executor: tasks posted to one queue never
+ * run concurrently and run in posting (or timer expiry) order, so they
+ * can replace the dedicated thread of a single object.
+ */
+class PalEventQueue : public std::enable_shared_from_this<PalEventQueue>
+{
+public:
+    ~PalEventQueue() {};
+    int32_t post(std::function<void()> task);
+    /* returns a timer id for cancel(), 0 if the queue is closed */
+    uint64_t postDelayed(std::function<void()> task, uint32_t delayMs);
+    void cancel(uint64_t timerId);
+    /* drops pending tasks and timers, a running task completes */
+    void clear();
+    /* clear() and wait for a running task; later posts are rejected */
+    void close();
+    void dumpStats();
+private:
+    friend class PalEventExecutor;
+    struct task {
+        std::function<void()> fn;
+        uint64_t readyNs;
+    };
+    PalEventQueue(PalEventExecutor *executor, const std::string &name,
+        pal_exec_lane_t lane);
+    PalEventExecutor *executor_;
+    std::string name_;
+    pal_exec_lane_t lane_;
+    std::deque<task> pending_;
+    bool scheduled_;
+    bool running_;
+    bool closed_;
+    std::thread::id runner_;
+    std::condition_variable idle_cv_;
+    uint64_t tasks_;
+    uint64_t waitSumNs_;
+    uint64_t waitMaxNs_;
+    uint64_t runSumNs_;
+};
+
+class PalEventExecutor
+{
+public:
+    /* pool for tasks that block on the driver or DSP, such as graph open,
+     * start and stop
+     */
+    static PalEventExecutor *getBlockingInstance();
+    std::shared_ptr<PalEventQueue> createQueue(const std::string &name,
+        pal_exec_lane_t lane);
+    void dumpStats();
+private:
+    friend class PalEventQueue;
+    struct timer {
+        uint64_t deadlineNs;
+        std::weak_ptr<PalEventQueue> queue;
+        std::function<void()> fn;
+    };
+    PalEventExecutor(int workers);
+    static uint64_t now();
+    static void workerLoop(PalEventExecutor &executor);
+    void enqueueLocked(std::shared_ptr<PalEventQueue> queue,
+        std::function<void()> fn, uint64_t readyNs);
+    void fireTimersLocked(uint64_t nowNs, uint64_t *nextNs);
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<std::thread> workers_;
+    std::deque<std::shared_ptr<PalEventQueue>> ready_[PAL_EXEC_LANE_MAX];
+    std::map<uint64_t, timer> timers_;
+    uint64_t nextTimerId_;
+    std::vector<std::weak_ptr<PalEventQueue>> queues_;
+};
+
+#endif //PALEVENTEXECUTOR_H_
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2024 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PALGRAPHLOCK_H_
+#define PALGRAPHLOCK_H_
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+/*
+ * Graph lock of the resource manager. lock() excludes everyone, as the old
+ * global graph mutex did. lock(backEnds, held) takes the graph lock shared
+ * plus one mutex per backend name, so graph changes on disjoint backends
+ * run in parallel. Backend mutexes are created on first use and taken in
+ * ascending address order, so overlapping callers cannot deadlock. held
+ * returns the backend mutexes taken and must be handed back to unlock().
+ */
+class PalGraphLock
+{
+public:
+    PalGraphLock() {};
+    void lock() { graphMutex.lock(); };
+    void unlock() { graphMutex.unlock(); };
+    void lock(const std::vector<std::string> &backEnds, std::vector<std::mutex *> &held);
+    void unlock(std::vector<std::mutex *> &held);
+private:
+    std::shared_timed_mutex graphMutex;
+    std::mutex backEndMutexesLock;
+    std::map<std::string, std::unique_ptr<std::mutex>> backEndMutexes;
+};
+
+#endif //PALGRAPHLOCK_H_
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PALIDPOOL_H_
+#define PALIDPOOL_H_
+
+#include <stdint.h>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*
+ * Fixed set of integer IDs (FE/session ids) handed out by a free bitmap.
+ * Each pool has its own lock so allocations from different pools do not
+ * contend. Shared pools hand out IDs without reserving them, which is how
+ * voice call front ends behave since both VSIDs may reuse the same FE.
+ */
+class PalIdPool
+{
+public:
+    PalIdPool(const char *name, bool shared = false);
+    void add(int id);
+    void clear();
+    int alloc(int howMany, std::vector<int> &ids);
+    int release(const std::vector<int> &ids);
+    size_t size();
+    size_t available();
+    void reportLeaks();
+    std::string toJson();
+private:
+    int indexOf(int id);
+    bool isFree(size_t idx) { return freeMask[idx / 64] & (1ULL << (idx % 64)); };
+    void setFree(size_t idx, bool free);
+
+    std::mutex mutex;
+    std::string name;
+    bool shared;
+    std::vector<int> ids;           /* sorted ascending */
+    std::vector<uint64_t> freeMask; /* bit i set when ids[i] is free */
+    size_t inUse;
+    size_t peakInUse;
+    uint64_t allocCount;
+    uint64_t failCount;
+    uint64_t badFreeCount;
+};
+
+#endif //PALIDPOOL_H_
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PALLATENCYTRACE_H_
+#define PALLATENCYTRACE_H_
+
+#include <stdint.h>
+#include <atomic>
+#include <string>
+
+/* log2 microsecond buckets, the last one collects everything >= 2^30us */
+#define PAL_TRACE_HISTOGRAM_BUCKETS 32
+
+typedef enum {
+    PAL_TRACE_STREAM_OPEN = 0,
+    PAL_TRACE_STREAM_START,
+    PAL_TRACE_STREAM_STOP,
+    PAL_TRACE_STREAM_CLOSE,
+    PAL_TRACE_STREAM_SET_DEVICE,
+    PAL_TRACE_FE_ALLOC,
+    PAL_TRACE_SESSION_METADATA,
+    PAL_TRACE_PCM_OPEN,
+    PAL_TRACE_PCM_START,
+    PAL_TRACE_PCM_STOP,
+    PAL_TRACE_PCM_CLOSE,
+    PAL_TRACE_PCM_PAIR_OPEN,
+    PAL_TRACE_PCM_PAIR_OPEN_SERIAL,
+    PAL_TRACE_PCM_PAIR_SETUP,
+    PAL_TRACE_PCM_PAIR_SETUP_SERIAL,
+    PAL_TRACE_PHASE_MAX,
+} pal_trace_phase_t;
+
+class PalLatencyHistogram
+{
+public:
+    PalLatencyHistogram() { reset(); };
+    void record(uint64_t us);
+    void reset();
+    std::string toJson();
+private:
+    uint64_t percentile(uint64_t total, uint32_t pct);
+    std::atomic<uint64_t> buckets[PAL_TRACE_HISTOGRAM_BUCKETS];
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> sumUs;
+    std::atomic<uint64_t> maxUs;
+};
+
+class PalLatencyTrace
+{
+public:
+    static uint64_t now();
+    static void record(pal_trace_phase_t phase, uint64_t startNs);
+    static void recordDelta(pal_trace_phase_t phase, uint64_t startNs,
+        uint64_t endNs);
+    static void reset();
+    static std::string dumpJson();
+private:
+    static PalLatencyHistogram histograms[PAL_TRACE_PHASE_MAX];
+};
+
+/* records the lifetime of the object under the given phase */
+class PalLatencyScope
+{
+public:
+    PalLatencyScope(pal_trace_phase_t phase) :
+        phase_(phase), startNs_(PalLatencyTrace::now()) {};
+    ~PalLatencyScope() { PalLatencyTrace::record(phase_, startNs_); };
+private:
+    pal_trace_phase_t phase_;
+    uint64_t startNs_;
+};
+
+#endif //PALLATENCYTRACE_H_
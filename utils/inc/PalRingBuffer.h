@@ -36,15 +36,21 @@
 #include <stdlib.h>
 #include <memory>
 #include <mutex>
+#include <condition_variable>
+#include <atomic>
 #include <vector>
 #include <string>
 #include <iostream>
 #include <string.h>
+#include <sys/uio.h>
 
 #ifndef PALRINGBUFFER_H_
 #define PALRINGBUFFER_H_
 
 #define DEFAULT_PAL_RING_BUFFER_SIZE 4096 * 10
+/* max readers attached to a lock-free ring buffer */
+#define PAL_RING_BUFFER_MAX_READERS 16
+#define PAL_RING_BUFFER_CACHE_LINE_SIZE 64
 
 typedef enum {
     READER_DISABLED = 0,
@@ -59,17 +65,35 @@ class PalRingBufferReader {
          : ringBuffer_(buffer),
            unreadSize_(0),
            readOffset_(0),
+           readPos_(0),
+           peekPos_(0),
+           overrunSize_(0),
            state_(READER_DISABLED) {}
 
     ~PalRingBufferReader() {};
 
     size_t advanceReadOffset(size_t advanceSize);
     int32_t read(void* readBuffer, size_t readSize);
+    /*
+     * zero-copy read: expose up to readSize unread bytes in place as one
+     * or two regions (iov[1] is empty unless the data wraps). The data
+     * stays reserved until commit() consumes it, so only read-only
+     * consumers may use it in place. In lock-free mode commit() returns
+     * -EOVERFLOW if a writer lapped the region while the reader was being
+     * re-enabled; the reader is then already resynced to the oldest valid
+     * byte and the caller drops the data and peeks again.
+     */
+    int32_t peek(struct iovec iov[2], size_t readSize);
+    int32_t commit(size_t commitSize);
+    /* block until readSize bytes are unread, the reader is disabled or timeout */
+    int32_t waitForData(size_t readSize, uint32_t timeoutMs);
     void updateState(pal_ring_buffer_reader_state state);
     void getIndices(uint32_t *startIndice, uint32_t *endIndice);
     size_t getUnreadSize();
     void reset();
     bool isEnabled() { return state_ == READER_ENABLED; }
+    /* bytes lost because the writer lapped this reader, lock-free mode only */
+    uint64_t getOverrunSize() { return overrunSize_.load(std::memory_order_relaxed); }
 
     friend class PalRingBuffer;
     friend class StreamSoundTrigger;
@@ -78,21 +102,50 @@ class PalRingBufferReader {
     PalRingBuffer *ringBuffer_;
     size_t unreadSize_;
     size_t readOffset_;
-    pal_ring_buffer_reader_state state_;
+    /*
+     * lock-free mode: monotonic read cursor, compared against the
+     * writer's monotonic cursor. Padded so the writer polling other
+     * readers does not bounce this reader's cache line.
+     */
+    char padBefore_[PAL_RING_BUFFER_CACHE_LINE_SIZE];
+    std::atomic<uint64_t> readPos_;
+    char padAfter_[PAL_RING_BUFFER_CACHE_LINE_SIZE];
+    /* cursor handed out by the last peek(), only used by the reading thread */
+    uint64_t peekPos_;
+    std::atomic<uint64_t> overrunSize_;
+    std::atomic<pal_ring_buffer_reader_state> state_;
+
+    int32_t readLockFree(void* readBuffer, size_t bufferSize);
+    size_t advanceReadOffsetLockFree(size_t advanceSize);
+    uint64_t clampReadPos(uint64_t readPos, uint64_t writePos);
+    size_t unreadSize();
 };
 
 class PalRingBuffer {
  public:
-    explicit PalRingBuffer(size_t bufferSize)
+    /*
+     * lockFree selects the single-producer/multi-consumer mode: write()
+     * and the reader data path then only touch atomic cursors, and
+     * mutex_ is left to reader management and state changes. Only one
+     * thread may write in that mode, reset() may race with it.
+     */
+    explicit PalRingBuffer(size_t bufferSize, bool lockFree = false)
         : buffer_((char*)(new char[bufferSize])),
           startIndex(0),
           endIndex(0),
           writeOffset_(0),
-          bufferEnd_(bufferSize) {}
+          bufferEnd_(bufferSize),
+          lockFree_(lockFree),
+          writePos_(0),
+          writeEnd_(0),
+          waiters_(0) {
+        for (int i = 0; i < PAL_RING_BUFFER_MAX_READERS; i++)
+            readers_[i].store(nullptr, std::memory_order_relaxed);
+    }
 
     ~PalRingBuffer() {
         if (buffer_)
-            delete buffer_;
+            delete[] buffer_;
 
         for (int i = 0; i < readOffsets_.size(); i++)
             delete readOffsets_[i];
@@ -109,16 +162,34 @@ class PalRingBuffer {
     void reset();
     size_t getBufferSize() { return bufferEnd_; };
     void resizeRingBuffer(size_t bufferSize);
+    bool isLockFree() { return lockFree_; }
 
  protected:
     std::mutex mutex_;
+    std::condition_variable cv_;
     char* buffer_;
     uint32_t startIndex;
     uint32_t endIndex;
     size_t writeOffset_;
     size_t bufferEnd_;
     std::vector<PalRingBufferReader*> readOffsets_;
+    const bool lockFree_;
+    char padBefore_[PAL_RING_BUFFER_CACHE_LINE_SIZE];
+    std::atomic<uint64_t> writePos_;
+    /*
+     * end of the write in progress, stored before the copy starts. Readers
+     * validate copies against it, the writer may have sized its copy while
+     * they were disabled by reset().
+     */
+    std::atomic<uint64_t> writeEnd_;
+    char padAfter_[PAL_RING_BUFFER_CACHE_LINE_SIZE];
+    std::atomic<PalRingBufferReader*> readers_[PAL_RING_BUFFER_MAX_READERS];
+    std::atomic<uint32_t> waiters_;
     void updateUnReadSize(size_t writtenSize);
+    size_t getFreeSizeLockFree(uint64_t writePos);
+    size_t writeLockFree(void* writeBuffer, size_t writeSize);
+    void copyFrom(uint64_t pos, void* dst, size_t size);
+    void notifyWaiters();
     friend class PalRingBufferReader;
 };
 #endif
@@ -30,11 +30,19 @@
 #ifndef SOUND_TRIGGER_UTILS_H
 #define SOUND_TRIGGER_UTILS_H
 
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
 #include "PalDefs.h"
+#include "PalDebugDump.h"
 #include "ListenSoundModelLib.h"
 
 #define MAX_KW_USERS_NAME_LEN (2 * MAX_STRING_LEN)
 #define MAX_CONF_LEVEL_VALUE 100
+#define MERGED_SM_CACHE_MAX_BYTES (8 * 1024 * 1024)
 
 enum {
     SML_PARSER_SUCCESS = 0,
@@ -310,33 +318,23 @@ typedef enum st_param_id_type {
 #define ST_DEBUG_DUMP_LOCATION "/data/vendor/audio"
 #define ST_DBG_DECLARE(args...) args
 
+/* dump files are written by the PalDebugDump thread, fptr is a PalDumpFile * */
 #define ST_DBG_FILE_OPEN_WR(fptr, fpath, fname, fextn, fcount) \
 do {\
     char fptr_fn[100];\
 \
     snprintf(fptr_fn, sizeof(fptr_fn), "%s/%s_%d.%s", fpath, fname, fcount, fextn);\
-    fptr = fopen(fptr_fn, "wb");\
-    if (!fptr) { \
-        ALOGE("%s: File open failed %s: %s", \
-              __func__, fptr_fn, strerror(errno)); \
-    } \
+    fptr = PalDebugDump::open(fptr_fn);\
 } while (0)
 
 #define ST_DBG_FILE_CLOSE(fptr) \
 do {\
-    if (fptr) { fclose (fptr); }\
+    PalDebugDump::close(fptr);\
 } while (0)
 
 #define ST_DBG_FILE_WRITE(fptr, buf, buf_size) \
 do {\
-    if (fptr) {\
-        size_t ret_bytes = fwrite(buf, 1, buf_size, fptr);\
-        if (ret_bytes != (size_t)buf_size) {\
-            ALOGE("%s: fwrite %zu < %zu", __func__,\
-                  ret_bytes, (size_t)buf_size);\
-        }\
-        fflush(fptr);\
-    }\
+    PalDebugDump::write(fptr, buf, buf_size);\
 } while (0)
 
 /* Listen Sound Model Library APIs */
@@ -488,4 +486,38 @@ private:
     uint8_t *det_cf_levels_;
     uint32_t cf_levels_size_;
 };
+
+/*
+ * Process wide LRU cache of merged sound models, keyed by the content
+ * hashes of the models a merged model was built from (order independent).
+ * An entry holds the merged model together with the keyphrase, user and
+ * conf level info queried from it, so a hit replaces both the SML merge
+ * or delete and the header query with a copy. Entries are evicted least
+ * recently used first once the cached model bytes exceed max_bytes.
+ */
+class MergedSoundModelCache {
+ public:
+    static std::shared_ptr<MergedSoundModelCache> GetInstance();
+    MergedSoundModelCache & operator=(MergedSoundModelCache &rhs) = delete;
+    MergedSoundModelCache(size_t max_bytes = MERGED_SM_CACHE_MAX_BYTES);
+    ~MergedSoundModelCache();
+    static uint64_t HashModel(const uint8_t *data, uint32_t size);
+    bool Get(std::vector<uint64_t> key, SoundModelInfo *sm_info);
+    void Put(std::vector<uint64_t> key, SoundModelInfo *sm_info);
+    void Clear();
+
+ private:
+    typedef std::pair<std::vector<uint64_t>,
+                      std::unique_ptr<SoundModelInfo>> CacheEntry;
+
+    static std::shared_ptr<MergedSoundModelCache> cache_;
+    static std::mutex cache_instance_mutex_;
+    std::mutex mutex_;
+    std::list<CacheEntry> lru_;
+    std::map<std::vector<uint64_t>, std::list<CacheEntry>::iterator> index_;
+    size_t max_bytes_;
+    size_t cur_bytes_;
+    uint32_t hits_;
+    uint32_t misses_;
+};
 #endif // SOUND_TRIGGER_UTILS_H
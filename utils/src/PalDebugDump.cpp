@@ -0,0 +1,438 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define LOG_TAG "PAL: PalDebugDump"
+
+#include "PalDebugDump.h"
+#include "PalCommon.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <new>
+#include <sstream>
+#include <thread>
+
+typedef enum {
+    PAL_DUMP_MSG_OPEN = 0,
+    PAL_DUMP_MSG_WRITE,
+    PAL_DUMP_MSG_CLOSE,
+} pal_dump_msg_type_t;
+
+struct PalDumpFile {
+    FILE *fp;
+    std::string path;
+    uint64_t written;
+    std::atomic<uint64_t> dropped;
+};
+
+std::atomic<uint64_t> PalDebugDump::pcmTapMask_(0);
+
+struct PalDumpMsg {
+    pal_dump_msg_type_t type;
+    PalDumpFile *file;
+    size_t size;
+    /* payload of a write, nullptr for open and close */
+    PalDumpChunk *chunk;
+};
+
+/* the message of a write lives in its first chunk */
+struct PalDumpChunk {
+    PalDumpMsg msg;
+    PalDumpChunk *next;
+    size_t size;
+    std::atomic<uint32_t> nextFree;
+    uint8_t data[PAL_DUMP_CHUNK_SIZE];
+};
+
+PalDebugDump::PalDebugDump() :
+    head_(0),
+    tail_(0),
+    writerWaiting_(false),
+    arena_(nullptr),
+    arenaChunks_(0),
+    freeHead_(0),
+    maxBytes_(PAL_DUMP_DEFAULT_MAX_BYTES),
+    queuedBytes_(0),
+    peakQueuedBytes_(0),
+    writtenBytes_(0),
+    droppedBytes_(0),
+    droppedChunks_(0),
+    failedOpens_(0)
+{
+    for (uint64_t i = 0; i < PAL_DUMP_QUEUE_SLOTS; i++) {
+        slots_[i].seq.store(i, std::memory_order_relaxed);
+        slots_[i].msg = nullptr;
+    }
+}
+
+PalDebugDump *PalDebugDump::getInstance()
+{
+    static PalDebugDump *dump = new PalDebugDump();
+
+    return dump;
+}
+
+/*
+ * Bounded multi-producer queue: a slot is free for position pos when its
+ * sequence equals pos and holds a message once it equals pos + 1. Only
+ * the writer thread pops.
+ */
+bool PalDebugDump::push(PalDumpMsg *msg)
+{
+    uint64_t pos = head_.load(std::memory_order_relaxed);
+    slot *s = nullptr;
+
+    for (;;) {
+        s = &slots_[pos & (PAL_DUMP_QUEUE_SLOTS - 1)];
+        uint64_t seq = s->seq.load(std::memory_order_acquire);
+        int64_t diff = (int64_t)seq - (int64_t)pos;
+
+        if (diff == 0) {
+            if (head_.compare_exchange_weak(pos, pos + 1,
+                    std::memory_order_relaxed))
+                break;
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = head_.load(std::memory_order_relaxed);
+        }
+    }
+    s->msg = msg;
+    s->seq.store(pos + 1, std::memory_order_release);
+    notifyWriter();
+
+    return true;
+}
+
+void PalDebugDump::notifyWriter()
+{
+    /* order the slot publish before the flag check, pairs with writerLoop() */
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (writerWaiting_.load(std::memory_order_relaxed)) {
+        /* the writer checks hasMsg() under mutex_, so take it to avoid a
+         * lost wakeup between the check and the wait */
+        std::lock_guard<std::mutex> lock(mutex_);
+        cv_.notify_one();
+    }
+}
+
+bool PalDebugDump::hasMsg()
+{
+    slot *s = &slots_[tail_ & (PAL_DUMP_QUEUE_SLOTS - 1)];
+
+    return s->seq.load(std::memory_order_acquire) == tail_ + 1;
+}
+
+PalDumpMsg *PalDebugDump::pop()
+{
+    slot *s = &slots_[tail_ & (PAL_DUMP_QUEUE_SLOTS - 1)];
+    PalDumpMsg *msg = nullptr;
+
+    if (s->seq.load(std::memory_order_acquire) != tail_ + 1)
+        return nullptr;
+
+    msg = s->msg;
+    s->seq.store(tail_ + PAL_DUMP_QUEUE_SLOTS, std::memory_order_release);
+    tail_++;
+
+    return msg;
+}
+
+/*
+ * Lock-free stack of free arena chunks. The tag in the head changes on
+ * every pop and push, so a pop that read a stale nextFree fails its CAS.
+ */
+PalDumpChunk *PalDebugDump::allocChunk()
+{
+    uint64_t head = freeHead_.load(std::memory_order_acquire);
+    uint64_t next = 0;
+    uint32_t idx = 0;
+
+    do {
+        idx = (uint32_t)head;
+        if (!idx)
+            return nullptr;
+        next = (((head >> 32) + 1) << 32) |
+            arena_[idx - 1].nextFree.load(std::memory_order_relaxed);
+    } while (!freeHead_.compare_exchange_weak(head, next,
+                 std::memory_order_acquire, std::memory_order_acquire));
+
+    return &arena_[idx - 1];
+}
+
+void PalDebugDump::freeChunks(PalDumpChunk *chunk)
+{
+    PalDumpChunk *next = nullptr;
+    uint64_t head = 0;
+    uint64_t idx = 0;
+
+    for (; chunk; chunk = next) {
+        next = chunk->next;
+        idx = (uint64_t)(chunk - arena_) + 1;
+        head = freeHead_.load(std::memory_order_relaxed);
+        do {
+            chunk->nextFree.store((uint32_t)head, std::memory_order_relaxed);
+        } while (!freeHead_.compare_exchange_weak(head,
+                     (((head >> 32) + 1) << 32) | idx,
+                     std::memory_order_release, std::memory_order_relaxed));
+    }
+}
+
+/* open and close must not be lost, wait for the writer to free a slot */
+void PalDebugDump::pushControl(PalDumpMsg *msg)
+{
+    while (!push(msg))
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+void PalDebugDump::writerLoop(PalDebugDump &dump)
+{
+    PalDumpMsg *msg = nullptr;
+    PalDumpFile *file = nullptr;
+    PalDumpChunk *chunk = nullptr;
+    size_t ret = 0;
+
+    for (;;) {
+        msg = dump.pop();
+        if (!msg) {
+            std::unique_lock<std::mutex> lock(dump.mutex_);
+            dump.writerWaiting_.store(true, std::memory_order_relaxed);
+            /* order the flag store before hasMsg(), pairs with notifyWriter() */
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            dump.cv_.wait(lock, [&dump] { return dump.hasMsg(); });
+            dump.writerWaiting_.store(false, std::memory_order_relaxed);
+            continue;
+        }
+
+        file = msg->file;
+        switch (msg->type) {
+        case PAL_DUMP_MSG_OPEN:
+            file->fp = fopen(file->path.c_str(), "wb");
+            if (!file->fp) {
+                PAL_ERR(LOG_TAG, "open %s failed: %s", file->path.c_str(),
+                    strerror(errno));
+                dump.failedOpens_++;
+            }
+            break;
+        case PAL_DUMP_MSG_WRITE:
+            if (file->fp) {
+                ret = 0;
+                for (chunk = msg->chunk; chunk; chunk = chunk->next)
+                    ret += fwrite(chunk->data, 1, chunk->size, file->fp);
+                if (ret != msg->size)
+                    PAL_ERR(LOG_TAG, "%s: fwrite %zu < %zu",
+                        file->path.c_str(), ret, msg->size);
+                fflush(file->fp);
+                file->written += ret;
+                dump.writtenBytes_ += ret;
+            }
+            dump.queuedBytes_ -= msg->size;
+            break;
+        case PAL_DUMP_MSG_CLOSE:
+            if (file->fp)
+                fclose(file->fp);
+            PAL_DBG(LOG_TAG, "%s: wrote %llu bytes, dropped %llu",
+                file->path.c_str(), (unsigned long long)file->written,
+                (unsigned long long)file->dropped.load());
+            delete file;
+            break;
+        }
+        /* a write message goes back to the arena with its first chunk */
+        if (msg->chunk)
+            dump.freeChunks(msg->chunk);
+        else
+            free(msg);
+    }
+}
+
+PalDumpFile *PalDebugDump::open(const char *path)
+{
+    PalDebugDump *dump = getInstance();
+    PalDumpFile *file = nullptr;
+    PalDumpMsg *msg = nullptr;
+
+    /* writes and closes need a file from here, so this is the first use */
+    std::call_once(dump->writerStarted_, [dump]() {
+        size_t chunks = std::max(dump->maxBytes_.load() / PAL_DUMP_CHUNK_SIZE,
+            (size_t)1);
+
+        dump->arena_ = new (std::nothrow) PalDumpChunk[chunks];
+        if (!dump->arena_) {
+            PAL_ERR(LOG_TAG, "no memory for %zu dump chunks, dropping writes",
+                chunks);
+            chunks = 0;
+        }
+        for (size_t i = 0; i < chunks; i++) {
+            dump->arena_[i].next = nullptr;
+            dump->freeChunks(&dump->arena_[i]);
+        }
+        dump->arenaChunks_ = chunks;
+        std::thread(writerLoop, std::ref(*dump)).detach();
+    });
+
+    msg = (PalDumpMsg *)calloc(1, sizeof(PalDumpMsg));
+    if (!msg)
+        goto err;
+
+    file = new PalDumpFile();
+    file->fp = nullptr;
+    file->path = path;
+    file->written = 0;
+    file->dropped = 0;
+    msg->type = PAL_DUMP_MSG_OPEN;
+    msg->file = file;
+    dump->pushControl(msg);
+
+    return file;
+
+err:
+    PAL_ERR(LOG_TAG, "no memory to open %s", path);
+    dump->failedOpens_++;
+    return nullptr;
+}
+
+void PalDebugDump::write(PalDumpFile *file, const void *buf, size_t size)
+{
+    PalDebugDump *dump = getInstance();
+    PalDumpChunk *first = nullptr;
+    PalDumpChunk *last = nullptr;
+    PalDumpChunk *chunk = nullptr;
+    size_t offset = 0;
+    size_t queued = 0;
+    size_t peak = 0;
+
+    if (!file || !buf || !size)
+        return;
+
+    queued = dump->queuedBytes_.fetch_add(size) + size;
+    if (queued > dump->maxBytes_.load(std::memory_order_relaxed))
+        goto drop;
+
+    for (offset = 0; offset < size; offset += chunk->size) {
+        chunk = dump->allocChunk();
+        if (!chunk)
+            goto drop_chunks;
+        chunk->size = std::min(size - offset, (size_t)PAL_DUMP_CHUNK_SIZE);
+        chunk->next = nullptr;
+        memcpy(chunk->data, (const uint8_t *)buf + offset, chunk->size);
+        if (last)
+            last->next = chunk;
+        else
+            first = chunk;
+        last = chunk;
+    }
+
+    first->msg.type = PAL_DUMP_MSG_WRITE;
+    first->msg.file = file;
+    first->msg.size = size;
+    first->msg.chunk = first;
+    if (!dump->push(&first->msg))
+        goto drop_chunks;
+
+    peak = dump->peakQueuedBytes_.load(std::memory_order_relaxed);
+    while (queued > peak &&
+           !dump->peakQueuedBytes_.compare_exchange_weak(peak, queued))
+        ;
+    return;
+
+drop_chunks:
+    dump->freeChunks(first);
+drop:
+    dump->queuedBytes_ -= size;
+    dump->droppedBytes_ += size;
+    dump->droppedChunks_++;
+    file->dropped += size;
+}
+
+void PalDebugDump::close(PalDumpFile *file)
+{
+    PalDumpMsg *msg = nullptr;
+
+    if (!file)
+        return;
+
+    msg = (PalDumpMsg *)calloc(1, sizeof(PalDumpMsg));
+    if (!msg) {
+        PAL_ERR(LOG_TAG, "no memory to close %s, leaking it",
+            file->path.c_str());
+        return;
+    }
+    msg->type = PAL_DUMP_MSG_CLOSE;
+    msg->file = file;
+    getInstance()->pushControl(msg);
+}
+
+void PalDebugDump::setMaxBytes(size_t maxBytes)
+{
+    PAL_INFO(LOG_TAG, "max queued dump bytes %zu", maxBytes);
+    getInstance()->maxBytes_ = maxBytes;
+}
+
+void PalDebugDump::setPcmTapMask(uint64_t mask)
+{
+    PAL_INFO(LOG_TAG, "pcm tap mask 0x%llx", (unsigned long long)mask);
+    pcmTapMask_ = mask;
+}
+
+bool PalDebugDump::isPcmTapEnabled(uint32_t streamType)
+{
+    if (streamType >= 64)
+        return false;
+
+    return pcmTapMask_.load(std::memory_order_relaxed) &
+        (1ULL << streamType);
+}
+
+std::string PalDebugDump::dumpJson()
+{
+    PalDebugDump *dump = getInstance();
+    std::ostringstream out;
+
+    out << "{\"max_bytes\":" << dump->maxBytes_.load()
+        << ",\"arena_bytes\":" << dump->arenaChunks_.load() * PAL_DUMP_CHUNK_SIZE
+        << ",\"queued_bytes\":" << dump->queuedBytes_.load()
+        << ",\"peak_queued_bytes\":" << dump->peakQueuedBytes_.load()
+        << ",\"written_bytes\":" << dump->writtenBytes_.load()
+        << ",\"dropped_bytes\":" << dump->droppedBytes_.load()
+        << ",\"dropped_chunks\":" << dump->droppedChunks_.load()
+        << ",\"failed_opens\":" << dump->failedOpens_.load()
+        << ",\"pcm_tap_mask\":" << pcmTapMask_.load()
+        << "}";
+
+    return out.str();
+}
@@ -0,0 +1,278 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define LOG_TAG "PAL: PalEventExecutor"
+
+#include "PalEventExecutor.h"
+#include "PalCommon.h"
+
+#include <errno.h>
+#include <time.h>
+#include <algorithm>
+
+PalEventQueue::PalEventQueue(PalEventExecutor *executor, const std::string &name,
+    pal_exec_lane_t lane) :
+    executor_(executor),
+    name_(name),
+    lane_(lane),
+    scheduled_(false),
+    running_(false),
+    closed_(false),
+    tasks_(0),
+    waitSumNs_(0),
+    waitMaxNs_(0),
+    runSumNs_(0)
+{
+}
+
+int32_t PalEventQueue::post(std::function<void()> task)
+{
+    std::lock_guard<std::mutex> lock(executor_->mutex_);
+
+    if (closed_) {
+        PAL_ERR(LOG_TAG, "queue %s is closed", name_.c_str());
+        return -EINVAL;
+    }
+    executor_->enqueueLocked(shared_from_this(), std::move(task),
+        PalEventExecutor::now());
+
+    return 0;
+}
+
+uint64_t PalEventQueue::postDelayed(std::function<void()> task, uint32_t delayMs)
+{
+    std::lock_guard<std::mutex> lock(executor_->mutex_);
+    uint64_t id = 0;
+
+    if (closed_) {
+        PAL_ERR(LOG_TAG, "queue %s is closed", name_.c_str());
+        return 0;
+    }
+
+    id = ++executor_->nextTimerId_;
+    executor_->timers_[id] = {PalEventExecutor::now() + (uint64_t)delayMs * 1000000,
+        shared_from_this(), std::move(task)};
+    /* a worker may be sleeping towards a later deadline */
+    executor_->cv_.notify_one();
+
+    return id;
+}
+
+void PalEventQueue::cancel(uint64_t timerId)
+{
+    std::lock_guard<std::mutex> lock(executor_->mutex_);
+
+    executor_->timers_.erase(timerId);
+}
+
+void PalEventQueue::clear()
+{
+    std::lock_guard<std::mutex> lock(executor_->mutex_);
+
+    pending_.clear();
+    for (auto it = executor_->timers_.begin(); it != executor_->timers_.end();) {
+        if (it->second.queue.lock().get() == this)
+            it = executor_->timers_.erase(it);
+        else
+            it++;
+    }
+}
+
+void PalEventQueue::close()
+{
+    clear();
+
+    std::unique_lock<std::mutex> lock(executor_->mutex_);
+    closed_ = true;
+    /* a task closing its own queue cannot wait for itself */
+    if (runner_ != std::this_thread::get_id())
+        idle_cv_.wait(lock, [this] { return !running_; });
+    lock.unlock();
+
+    dumpStats();
+}
+
+void PalEventQueue::dumpStats()
+{
+    std::lock_guard<std::mutex> lock(executor_->mutex_);
+
+    PAL_INFO(LOG_TAG, "queue %s lane %d: %llu tasks, wait avg %lluus max %lluus, run avg %lluus",
+        name_.c_str(), lane_, (unsigned long long)tasks_,
+        (unsigned long long)(tasks_ ? waitSumNs_ / tasks_ / 1000 : 0),
+        (unsigned long long)(waitMaxNs_ / 1000),
+        (unsigned long long)(tasks_ ? runSumNs_ / tasks_ / 1000 : 0));
+}
+
+PalEventExecutor::PalEventExecutor(int workers) :
+    nextTimerId_(0)
+{
+    for (int i = 0; i < workers; i++)
+        workers_.push_back(std::thread(workerLoop, std::ref(*this)));
+}
+
+/* workers live as long as the process, so the instance is never freed */
+PalEventExecutor *PalEventExecutor::getBlockingInstance()
+{
+    static PalEventExecutor *executor = new PalEventExecutor(PAL_BLOCKING_EXECUTOR_WORKERS);
+
+    return executor;
+}
+
+std::shared_ptr<PalEventQueue> PalEventExecutor::createQueue(const std::string &name,
+    pal_exec_lane_t lane)
+{
+    std::shared_ptr<PalEventQueue> queue(new PalEventQueue(this, name, lane));
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    queues_.erase(std::remove_if(queues_.begin(), queues_.end(),
+        [](const std::weak_ptr<PalEventQueue> &q) { return q.expired(); }),
+        queues_.end());
+    queues_.push_back(queue);
+
+    return queue;
+}
+
+void PalEventExecutor::dumpStats()
+{
+    std::vector<std::shared_ptr<PalEventQueue>> queues;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto &q : queues_) {
+            if (auto queue = q.lock())
+                queues.push_back(queue);
+        }
+    }
+    for (auto &queue : queues)
+        queue->dumpStats();
+}
+
+uint64_t PalEventExecutor::now()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+void PalEventExecutor::enqueueLocked(std::shared_ptr<PalEventQueue> queue,
+    std::function<void()> fn, uint64_t readyNs)
+{
+    queue->pending_.push_back({std::move(fn), readyNs});
+    if (!queue->scheduled_) {
+        queue->scheduled_ = true;
+        ready_[queue->lane_].push_back(queue);
+        cv_.notify_one();
+    }
+}
+
+void PalEventExecutor::fireTimersLocked(uint64_t nowNs, uint64_t *nextNs)
+{
+    *nextNs = UINT64_MAX;
+    for (auto it = timers_.begin(); it != timers_.end();) {
+        if (it->second.deadlineNs > nowNs) {
+            *nextNs = std::min(*nextNs, it->second.deadlineNs);
+            it++;
+            continue;
+        }
+        if (auto queue = it->second.queue.lock()) {
+            if (!queue->closed_)
+                enqueueLocked(queue, std::move(it->second.fn), it->second.deadlineNs);
+        }
+        it = timers_.erase(it);
+    }
+}
+
+void PalEventExecutor::workerLoop(PalEventExecutor &executor)
+{
+    std::unique_lock<std::mutex> lock(executor.mutex_);
+    std::shared_ptr<PalEventQueue> queue;
+    PalEventQueue::task task;
+    uint64_t nextNs = 0;
+    uint64_t nowNs = 0;
+    uint64_t startNs = 0;
+    uint64_t waitNs = 0;
+
+    while (true) {
+        executor.fireTimersLocked(now(), &nextNs);
+
+        queue = nullptr;
+        for (int lane = 0; lane < PAL_EXEC_LANE_MAX && !queue; lane++) {
+            if (!executor.ready_[lane].empty()) {
+                queue = executor.ready_[lane].front();
+                executor.ready_[lane].pop_front();
+            }
+        }
+        if (!queue) {
+            if (nextNs == UINT64_MAX) {
+                executor.cv_.wait(lock);
+            } else {
+                /* a timer may have come due since fireTimersLocked() */
+                nowNs = now();
+                executor.cv_.wait_for(lock,
+                    std::chrono::nanoseconds(nextNs > nowNs ? nextNs - nowNs : 0));
+            }
+            continue;
+        }
+        if (queue->pending_.empty()) {
+            /* cleared while waiting for a worker */
+            queue->scheduled_ = false;
+            continue;
+        }
+
+        task = std::move(queue->pending_.front());
+        queue->pending_.pop_front();
+        queue->running_ = true;
+        queue->runner_ = std::this_thread::get_id();
+        lock.unlock();
+
+        startNs = now();
+        task.fn();
+        task.fn = nullptr;
+        waitNs = startNs > task.readyNs ? startNs - task.readyNs : 0;
+
+        lock.lock();
+        queue->tasks_++;
+        queue->waitSumNs_ += waitNs;
+        queue->waitMaxNs_ = std::max(queue->waitMaxNs_, waitNs);
+        queue->runSumNs_ += now() - startNs;
+        queue->running_ = false;
+        queue->runner_ = std::thread::id();
+        if (!queue->pending_.empty() && !queue->closed_)
+            executor.ready_[queue->lane_].push_back(queue);
+        else
+            queue->scheduled_ = false;
+        queue->idle_cv_.notify_all();
+    }
+}
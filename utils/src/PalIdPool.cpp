@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define LOG_TAG "PAL: PalIdPool"
+
+#include "PalIdPool.h"
+#include "PalCommon.h"
+
+#include <algorithm>
+#include <sstream>
+
+PalIdPool::PalIdPool(const char *name, bool shared) :
+    name(name), shared(shared), inUse(0), peakInUse(0), allocCount(0),
+    failCount(0), badFreeCount(0)
+{
+}
+
+void PalIdPool::setFree(size_t idx, bool free)
+{
+    if (free)
+        freeMask[idx / 64] |= (1ULL << (idx % 64));
+    else
+        freeMask[idx / 64] &= ~(1ULL << (idx % 64));
+}
+
+int PalIdPool::indexOf(int id)
+{
+    auto it = std::lower_bound(ids.begin(), ids.end(), id);
+
+    if (it == ids.end() || *it != id)
+        return -1;
+    return it - ids.begin();
+}
+
+void PalIdPool::add(int id)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = std::lower_bound(ids.begin(), ids.end(), id);
+
+    if (it != ids.end() && *it == id)
+        return;
+
+    ids.insert(it, id);
+    /* ids only grow while parsing the platform xml, rebuild the bitmap */
+    freeMask.assign((ids.size() + 63) / 64, 0);
+    for (size_t i = 0; i < ids.size(); i++)
+        setFree(i, true);
+    inUse = 0;
+}
+
+void PalIdPool::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    ids.clear();
+    freeMask.clear();
+    inUse = 0;
+    peakInUse = 0;
+    allocCount = 0;
+    failCount = 0;
+    badFreeCount = 0;
+}
+
+/* hands out the highest free ids first, same as the old sorted free lists */
+int PalIdPool::alloc(int howMany, std::vector<int> &out)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    int word = 0;
+    int bit = 0;
+    uint64_t mask = 0;
+
+    if (shared) {
+        if ((size_t)howMany > ids.size()) {
+            failCount++;
+            PAL_ERR(LOG_TAG, "%s: requested %d ids, have only %zu",
+                    name.c_str(), howMany, ids.size());
+            return -ENOSPC;
+        }
+        for (int i = 0; i < howMany; i++)
+            out.push_back(ids[ids.size() - 1 - i]);
+        allocCount++;
+        return 0;
+    }
+
+    if ((size_t)howMany > ids.size() - inUse) {
+        failCount++;
+        PAL_ERR(LOG_TAG, "%s: requested %d ids, have only %zu free of %zu",
+                name.c_str(), howMany, ids.size() - inUse, ids.size());
+        return -ENOSPC;
+    }
+
+    word = freeMask.size() - 1;
+    for (int i = 0; i < howMany; i++) {
+        while (!freeMask[word])
+            word--;
+        mask = freeMask[word];
+        bit = 63 - __builtin_clzll(mask);
+        setFree(word * 64 + bit, false);
+        out.push_back(ids[word * 64 + bit]);
+        PAL_INFO(LOG_TAG, "%s: allocated id %d", name.c_str(), out.back());
+    }
+    inUse += howMany;
+    peakInUse = std::max(peakInUse, inUse);
+    allocCount++;
+
+    return 0;
+}
+
+int PalIdPool::release(const std::vector<int> &in)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    int status = 0;
+    int idx = 0;
+
+    if (shared)
+        return 0;
+
+    for (int id : in) {
+        idx = indexOf(id);
+        if (idx < 0 || isFree(idx)) {
+            badFreeCount++;
+            status = -EINVAL;
+            PAL_ERR(LOG_TAG, "%s: id %d %s", name.c_str(), id,
+                    idx < 0 ? "does not belong to pool" : "freed twice");
+            continue;
+        }
+        setFree(idx, true);
+        inUse--;
+    }
+
+    return status;
+}
+
+size_t PalIdPool::size()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    return ids.size();
+}
+
+size_t PalIdPool::available()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    return shared ? ids.size() : ids.size() - inUse;
+}
+
+void PalIdPool::reportLeaks()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (shared || !inUse)
+        return;
+
+    for (size_t i = 0; i < ids.size(); i++) {
+        if (!isFree(i))
+            PAL_ERR(LOG_TAG, "%s: id %d was never freed", name.c_str(), ids[i]);
+    }
+}
+
+std::string PalIdPool::toJson()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::ostringstream out;
+    bool first = true;
+
+    out << "{\"name\":\"" << name << "\",\"size\":" << ids.size()
+        << ",\"in_use\":" << (shared ? 0 : inUse)
+        << ",\"peak\":" << peakInUse << ",\"allocs\":" << allocCount
+        << ",\"failures\":" << failCount << ",\"bad_frees\":" << badFreeCount
+        << ",\"busy\":[";
+    for (size_t i = 0; !shared && i < ids.size(); i++) {
+        if (isFree(i))
+            continue;
+        out << (first ? "" : ",") << ids[i];
+        first = false;
+    }
+    out << "]}";
+
+    return out.str();
+}
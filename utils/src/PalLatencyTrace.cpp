@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define LOG_TAG "PAL: PalLatencyTrace"
+
+#include "PalLatencyTrace.h"
+#include "PalCommon.h"
+
+#include <time.h>
+#include <algorithm>
+#include <sstream>
+
+static const char *phaseNames[PAL_TRACE_PHASE_MAX] = {
+    "stream_open",
+    "stream_start",
+    "stream_stop",
+    "stream_close",
+    "stream_set_device",
+    "fe_alloc",
+    "session_metadata",
+    "pcm_open",
+    "pcm_start",
+    "pcm_stop",
+    "pcm_close",
+    "pcm_pair_open",
+    /* sum of both lanes, what opening them in turn would have taken */
+    "pcm_pair_open_serial",
+    "pcm_pair_setup",
+    "pcm_pair_setup_serial",
+};
+
+PalLatencyHistogram PalLatencyTrace::histograms[PAL_TRACE_PHASE_MAX];
+
+void PalLatencyHistogram::record(uint64_t us)
+{
+    uint32_t bucket = 0;
+    uint64_t prevMax = maxUs.load(std::memory_order_relaxed);
+
+    while ((us >> bucket) > 1 && bucket < PAL_TRACE_HISTOGRAM_BUCKETS - 1)
+        bucket++;
+
+    buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    sumUs.fetch_add(us, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    while (us > prevMax &&
+           !maxUs.compare_exchange_weak(prevMax, us, std::memory_order_relaxed))
+        ;
+}
+
+void PalLatencyHistogram::reset()
+{
+    for (int i = 0; i < PAL_TRACE_HISTOGRAM_BUCKETS; i++)
+        buckets[i].store(0, std::memory_order_relaxed);
+    count.store(0, std::memory_order_relaxed);
+    sumUs.store(0, std::memory_order_relaxed);
+    maxUs.store(0, std::memory_order_relaxed);
+}
+
+/* upper bound of the bucket holding the requested percentile */
+uint64_t PalLatencyHistogram::percentile(uint64_t total, uint32_t pct)
+{
+    uint64_t target = (total * pct + 99) / 100;
+    uint64_t seen = 0;
+
+    for (int i = 0; i < PAL_TRACE_HISTOGRAM_BUCKETS; i++) {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen >= target)
+            return (2ULL << i) - 1;
+    }
+
+    return maxUs.load(std::memory_order_relaxed);
+}
+
+std::string PalLatencyHistogram::toJson()
+{
+    std::ostringstream out;
+    uint64_t total = count.load(std::memory_order_relaxed);
+    uint64_t max = maxUs.load(std::memory_order_relaxed);
+    int last = PAL_TRACE_HISTOGRAM_BUCKETS - 1;
+
+    out << "{\"count\":" << total;
+    if (total) {
+        out << ",\"avg_us\":" << sumUs.load(std::memory_order_relaxed) / total
+            << ",\"max_us\":" << max
+            << ",\"p50_us\":" << std::min(percentile(total, 50), max)
+            << ",\"p90_us\":" << std::min(percentile(total, 90), max)
+            << ",\"p99_us\":" << std::min(percentile(total, 99), max);
+    }
+
+    while (last > 0 && !buckets[last].load(std::memory_order_relaxed))
+        last--;
+    out << ",\"buckets\":[";
+    for (int i = 0; i <= last; i++)
+        out << (i ? "," : "") << buckets[i].load(std::memory_order_relaxed);
+    out << "]}";
+
+    return out.str();
+}
+
+uint64_t PalLatencyTrace::now()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+void PalLatencyTrace::recordDelta(pal_trace_phase_t phase, uint64_t startNs,
+    uint64_t endNs)
+{
+    if (phase >= PAL_TRACE_PHASE_MAX)
+        return;
+
+    histograms[phase].record(endNs > startNs ? (endNs - startNs) / 1000 : 0);
+}
+
+void PalLatencyTrace::record(pal_trace_phase_t phase, uint64_t startNs)
+{
+    recordDelta(phase, startNs, now());
+}
+
+void PalLatencyTrace::reset()
+{
+    PAL_INFO(LOG_TAG, "resetting latency histograms");
+    for (int i = 0; i < PAL_TRACE_PHASE_MAX; i++)
+        histograms[i].reset();
+}
+
+/*
+ * Bucket i counts samples in [2^i, 2^(i+1)) us, bucket 0 also takes 0us.
+ * Percentiles are bucket upper bounds clamped to the observed maximum.
+ */
+std::string PalLatencyTrace::dumpJson()
+{
+    std::ostringstream out;
+
+    out << "{";
+    for (int i = 0; i < PAL_TRACE_PHASE_MAX; i++) {
+        out << (i ? "," : "") << "\"" << phaseNames[i] << "\":"
+            << histograms[i].toJson();
+    }
+    out << "}";
+
+    return out.str();
+}
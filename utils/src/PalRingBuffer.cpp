@@ -31,12 +31,22 @@
 #ifdef LINUX_ENABLED
 #include <algorithm>
 #endif
+#include <chrono>
 #include "PalRingBuffer.h"
 #include "PalCommon.h"
 #define LOG_TAG "PAL: PalRingBuffer"
 
 int32_t PalRingBuffer::removeReader(PalRingBufferReader *reader)
 {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (lockFree_) {
+        for (int i = 0; i < PAL_RING_BUFFER_MAX_READERS; i++) {
+            if (readers_[i].load(std::memory_order_relaxed) == reader)
+                readers_[i].store(nullptr, std::memory_order_release);
+        }
+    }
+
     auto iter = std::find(readOffsets_.begin(), readOffsets_.end(), reader);
     if (iter != readOffsets_.end())
         readOffsets_.erase(iter);
@@ -52,6 +62,8 @@ size_t PalRingBuffer::read(std::shared_ptr<PalRingBufferReader>reader __unused,
 
 size_t PalRingBuffer::getFreeSize()
 {
+    if (lockFree_)
+        return getFreeSizeLockFree(writePos_.load(std::memory_order_relaxed));
 
     size_t freeSize = bufferEnd_;
     std::vector<PalRingBufferReader*>::iterator it;
@@ -63,6 +75,26 @@ size_t PalRingBuffer::getFreeSize()
     return freeSize;
 }
 
+size_t PalRingBuffer::getFreeSizeLockFree(uint64_t writePos)
+{
+    size_t freeSize = bufferEnd_;
+    PalRingBufferReader *reader = nullptr;
+    uint64_t usedSize = 0;
+
+    for (int i = 0; i < PAL_RING_BUFFER_MAX_READERS; i++) {
+        reader = readers_[i].load(std::memory_order_acquire);
+        if (!reader ||
+            reader->state_.load(std::memory_order_acquire) != READER_ENABLED)
+            continue;
+
+        usedSize = writePos - reader->readPos_.load(std::memory_order_acquire);
+        if (usedSize > bufferEnd_)
+            usedSize = bufferEnd_;
+        freeSize = std::min(freeSize, (size_t)(bufferEnd_ - usedSize));
+    }
+    return freeSize;
+}
+
 void PalRingBuffer::updateUnReadSize(size_t writtenSize)
 {
     int32_t i = 0;
@@ -81,8 +113,63 @@ void PalRingBuffer::updateIndices(uint32_t startIndice, uint32_t endIndice)
     PAL_VERBOSE(LOG_TAG, "start index = %u, end index = %u", startIndex, endIndex);
 }
 
+void PalRingBuffer::copyFrom(uint64_t pos, void* dst, size_t size)
+{
+    size_t offset = pos % bufferEnd_;
+    size_t firstSize = std::min(size, bufferEnd_ - offset);
+
+    ar_mem_cpy(dst, firstSize, buffer_ + offset, firstSize);
+    if (size > firstSize)
+        ar_mem_cpy((char *)dst + firstSize, size - firstSize, buffer_,
+                   size - firstSize);
+}
+
+void PalRingBuffer::notifyWaiters()
+{
+    /* order the writePos_ store before the waiters_ check */
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters_.load(std::memory_order_relaxed)) {
+        /* waiters check their predicate under mutex_, so take it to
+         * avoid a lost wakeup between the check and the wait */
+        std::lock_guard<std::mutex> lock(mutex_);
+        cv_.notify_all();
+    }
+}
+
+size_t PalRingBuffer::writeLockFree(void* writeBuffer, size_t writeSize)
+{
+    uint64_t writePos = writePos_.load(std::memory_order_relaxed);
+    size_t sizeToCopy = std::min(writeSize, getFreeSizeLockFree(writePos));
+    size_t offset = writePos % bufferEnd_;
+    size_t firstSize = std::min(sizeToCopy, bufferEnd_ - offset);
+
+    PAL_VERBOSE(LOG_TAG, "freeSize(%zu), writePos(%llu)", sizeToCopy,
+                (unsigned long long)writePos);
+
+    if (!sizeToCopy)
+        return 0;
+
+    /* announce the overwrite before touching the buffer */
+    writeEnd_.store(writePos + sizeToCopy, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    ar_mem_cpy(buffer_ + offset, firstSize, writeBuffer, firstSize);
+    if (sizeToCopy > firstSize)
+        ar_mem_cpy(buffer_, sizeToCopy - firstSize,
+                   (char *)writeBuffer + firstSize, sizeToCopy - firstSize);
+
+    /* publish the data to the readers */
+    writePos_.store(writePos + sizeToCopy, std::memory_order_release);
+    notifyWaiters();
+
+    return sizeToCopy;
+}
+
 size_t PalRingBuffer::write(void* writeBuffer, size_t writeSize)
 {
+    if (lockFree_)
+        return writeLockFree(writeBuffer, writeSize);
+
     /* update the unread size for each reader*/
     mutex_.lock();
     size_t freeSize = getFreeSize();
@@ -120,6 +207,8 @@ size_t PalRingBuffer::write(void* writeBuffer, size_t writeSize)
     writeOffset_ = writeOffset_ % bufferEnd_;
     PAL_DBG(LOG_TAG, "Exit. writeOffset(%zu)", writeOffset_);
     mutex_.unlock();
+    if (writtenSize)
+        cv_.notify_all();
     return writtenSize;
 }
 
@@ -131,11 +220,17 @@ void PalRingBuffer::reset()
     startIndex = 0;
     endIndex = 0;
     writeOffset_ = 0;
+    /*
+     * writePos_ is owned by the lock-free writer and never rewound, a write
+     * racing with reset would publish a cursor from before it. The buffered
+     * data is dropped by moving every reader up to the cursor below.
+     */
     mutex_.unlock();
 
     /* Reset all the associated readers */
     for (it = readOffsets_.begin(); it != readOffsets_.end(); it++)
         (*(it))->reset();
+    cv_.notify_all();
 }
 
 void PalRingBuffer::resizeRingBuffer(size_t bufferSize)
@@ -148,10 +243,81 @@ void PalRingBuffer::resizeRingBuffer(size_t bufferSize)
     bufferEnd_ = bufferSize;
 }
 
+uint64_t PalRingBufferReader::clampReadPos(uint64_t readPos, uint64_t writePos)
+{
+    /* reader was reset against a newer write cursor */
+    if (readPos > writePos)
+        return writePos;
+
+    /* writer lapped the reader, the oldest valid byte is one buffer back */
+    if (writePos - readPos > ringBuffer_->bufferEnd_)
+        return writePos - ringBuffer_->bufferEnd_;
+
+    return readPos;
+}
+
+size_t PalRingBufferReader::unreadSize()
+{
+    uint64_t writePos = 0;
+
+    if (!ringBuffer_->lockFree_)
+        return unreadSize_;
+
+    writePos = ringBuffer_->writePos_.load(std::memory_order_acquire);
+    return writePos - clampReadPos(readPos_.load(std::memory_order_acquire),
+                                   writePos);
+}
+
+int32_t PalRingBufferReader::readLockFree(void* readBuffer, size_t bufferSize)
+{
+    uint64_t readPos = 0;
+    uint64_t writePos = 0;
+    uint64_t writeEnd = 0;
+    uint64_t startPos = 0;
+    size_t readSize = 0;
+
+    do {
+        if (state_.load(std::memory_order_acquire) != READER_ENABLED)
+            return -EINVAL;
+
+        readPos = readPos_.load(std::memory_order_acquire);
+        writePos = ringBuffer_->writePos_.load(std::memory_order_acquire);
+        startPos = clampReadPos(readPos, writePos);
+        readSize = std::min((size_t)(writePos - startPos), bufferSize);
+        if (readSize)
+            ringBuffer_->copyFrom(startPos, readBuffer, readSize);
+
+        /*
+         * The copy is only valid if the writer did not lap startPos while
+         * it was in progress, otherwise retry from the new oldest byte.
+         */
+        std::atomic_thread_fence(std::memory_order_acquire);
+        writeEnd = ringBuffer_->writeEnd_.load(std::memory_order_relaxed);
+        if (writeEnd - startPos > ringBuffer_->bufferEnd_)
+            continue;
+
+        /* fails if reset()/updateState() moved the cursor meanwhile */
+        if (readPos_.compare_exchange_strong(readPos, startPos + readSize,
+                std::memory_order_acq_rel))
+            break;
+    } while (true);
+
+    if (startPos > readPos) {
+        overrunSize_.fetch_add(startPos - readPos, std::memory_order_relaxed);
+        PAL_DBG(LOG_TAG, "reader %pK overrun, dropped %llu bytes", this,
+                (unsigned long long)(startPos - readPos));
+    }
+
+    return readSize;
+}
+
 int32_t PalRingBufferReader::read(void* readBuffer, size_t bufferSize)
 {
     int32_t readSize = 0;
 
+    if (ringBuffer_->lockFree_)
+        return readLockFree(readBuffer, bufferSize);
+
     if (state_ == READER_DISABLED)
         return -EINVAL;
 
@@ -219,10 +385,155 @@ int32_t PalRingBufferReader::read(void* readBuffer, size_t bufferSize)
     return readSize;
 }
 
+int32_t PalRingBufferReader::peek(struct iovec iov[2], size_t readSize)
+{
+    uint64_t readPos = 0;
+    uint64_t writePos = 0;
+    uint64_t startPos = 0;
+    size_t offset = 0;
+    size_t size = 0;
+    size_t firstSize = 0;
+
+    if (!iov)
+        return -EINVAL;
+
+    iov[0].iov_base = iov[1].iov_base = nullptr;
+    iov[0].iov_len = iov[1].iov_len = 0;
+
+    if (ringBuffer_->lockFree_) {
+        readPos = readPos_.load(std::memory_order_acquire);
+        do {
+            if (state_.load(std::memory_order_acquire) != READER_ENABLED)
+                return -EINVAL;
+            writePos = ringBuffer_->writePos_.load(std::memory_order_acquire);
+            startPos = clampReadPos(readPos, writePos);
+            if (startPos == readPos)
+                break;
+            /* drop what the writer already overwrote before exposing */
+        } while (!readPos_.compare_exchange_weak(readPos, startPos,
+                     std::memory_order_acq_rel));
+        if (startPos > readPos)
+            overrunSize_.fetch_add(startPos - readPos, std::memory_order_relaxed);
+        peekPos_ = startPos;
+        size = std::min((size_t)(writePos - startPos), readSize);
+        offset = startPos % ringBuffer_->bufferEnd_;
+    } else {
+        std::lock_guard<std::mutex> lock(ringBuffer_->mutex_);
+
+        if (state_ == READER_DISABLED)
+            return -EINVAL;
+        size = std::min(unreadSize_, readSize);
+        offset = readOffset_;
+    }
+
+    firstSize = std::min(size, ringBuffer_->bufferEnd_ - offset);
+    iov[0].iov_base = ringBuffer_->buffer_ + offset;
+    iov[0].iov_len = firstSize;
+    if (size > firstSize) {
+        iov[1].iov_base = ringBuffer_->buffer_;
+        iov[1].iov_len = size - firstSize;
+    }
+
+    return size;
+}
+
+int32_t PalRingBufferReader::commit(size_t commitSize)
+{
+    uint64_t readPos = 0;
+    uint64_t writePos = 0;
+    uint64_t writeEnd = 0;
+    uint64_t lostSize = 0;
+
+    if (!ringBuffer_->lockFree_) {
+        if (state_ == READER_DISABLED)
+            return -EINVAL;
+        return (advanceReadOffset(commitSize) == commitSize) ? commitSize : -EINVAL;
+    }
+
+    /*
+     * Validate against the cursor peek() exposed, not the current one: a
+     * reset() in between moves readPos_ and the CAS below must then fail.
+     */
+    readPos = peekPos_;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    writeEnd = ringBuffer_->writeEnd_.load(std::memory_order_relaxed);
+    writePos = ringBuffer_->writePos_.load(std::memory_order_relaxed);
+    if (readPos > writePos || writePos - readPos < commitSize) {
+        PAL_ERR(LOG_TAG, "Cannot commit %zu bytes, unread size %llu", commitSize,
+            (unsigned long long)(readPos > writePos ? 0 : writePos - readPos));
+        return -EINVAL;
+    }
+
+    /* regions exposed by peek() were overwritten by a lapping writer */
+    if (writeEnd - readPos > ringBuffer_->bufferEnd_) {
+        PAL_ERR(LOG_TAG, "reader %pK overrun while data was in use", this);
+        lostSize = writeEnd - ringBuffer_->bufferEnd_ - readPos;
+        if (readPos_.compare_exchange_strong(readPos,
+                writeEnd - ringBuffer_->bufferEnd_, std::memory_order_acq_rel))
+            overrunSize_.fetch_add(lostSize, std::memory_order_relaxed);
+        return -EOVERFLOW;
+    }
+
+    /* fails if reset()/updateState() moved the cursor since peek() */
+    if (!readPos_.compare_exchange_strong(readPos, readPos + commitSize,
+            std::memory_order_acq_rel))
+        return -EINVAL;
+
+    return commitSize;
+}
+
+int32_t PalRingBufferReader::waitForData(size_t readSize, uint32_t timeoutMs)
+{
+    bool ready = false;
+    std::unique_lock<std::mutex> lck(ringBuffer_->mutex_);
+
+    if (readSize > ringBuffer_->bufferEnd_) {
+        PAL_ERR(LOG_TAG, "wait size %zu exceeds buffer size %zu",
+            readSize, ringBuffer_->bufferEnd_);
+        return -EINVAL;
+    }
+
+    /* woken by write(), reset() and reader state updates */
+    ringBuffer_->waiters_.fetch_add(1);
+    ready = ringBuffer_->cv_.wait_for(lck, std::chrono::milliseconds(timeoutMs),
+            [&] { return state_ != READER_ENABLED || unreadSize() >= readSize; });
+    ringBuffer_->waiters_.fetch_sub(1);
+    if (!ready)
+        return -ETIMEDOUT;
+
+    return (state_ == READER_ENABLED) ? 0 : -EINVAL;
+}
+
+size_t PalRingBufferReader::advanceReadOffsetLockFree(size_t advanceSize)
+{
+    uint64_t readPos = readPos_.load(std::memory_order_acquire);
+    uint64_t writePos = 0;
+    uint64_t startPos = 0;
+
+    do {
+        writePos = ringBuffer_->writePos_.load(std::memory_order_acquire);
+        startPos = clampReadPos(readPos, writePos);
+        if (writePos - startPos < advanceSize) {
+            PAL_ERR(LOG_TAG, "Cannot advance read offset %zu greater than unread size %llu",
+                advanceSize, (unsigned long long)(writePos - startPos));
+            return 0;
+        }
+    } while (!readPos_.compare_exchange_weak(readPos, startPos + advanceSize,
+                 std::memory_order_acq_rel));
+
+    if (startPos > readPos)
+        overrunSize_.fetch_add(startPos - readPos, std::memory_order_relaxed);
+
+    return advanceSize;
+}
+
 size_t PalRingBufferReader::advanceReadOffset(size_t advanceSize)
 {
     size_t size_advanced = 0;
 
+    if (ringBuffer_->lockFree_)
+        return advanceReadOffsetLockFree(advanceSize);
+
     std::lock_guard<std::mutex> lock(ringBuffer_->mutex_);
 
     /* add code to advance the offset here*/
@@ -248,7 +559,13 @@ void PalRingBufferReader::updateState(pal_ring_buffer_reader_state state)
     PAL_DBG(LOG_TAG, "update reader state to %d", state);
     std::lock_guard<std::mutex> lock(ringBuffer_->mutex_);
 
-    if (state_ == READER_DISABLED && state == READER_ENABLED) {
+    if (ringBuffer_->lockFree_) {
+        /* keep at most one buffer of history, as the locked path does */
+        if (state_ == READER_DISABLED && state == READER_ENABLED)
+            readPos_.store(clampReadPos(readPos_.load(std::memory_order_relaxed),
+                ringBuffer_->writePos_.load(std::memory_order_acquire)),
+                std::memory_order_release);
+    } else if (state_ == READER_DISABLED && state == READER_ENABLED) {
         if (unreadSize_ > ringBuffer_->bufferEnd_)
            unreadSize_ = ringBuffer_->bufferEnd_;
 
@@ -260,6 +577,7 @@ void PalRingBufferReader::updateState(pal_ring_buffer_reader_state state)
         }
     }
     state_ = state;
+    ringBuffer_->cv_.notify_all();
 }
 
 void PalRingBufferReader::getIndices(uint32_t *startIndice, uint32_t *endIndice)
@@ -272,8 +590,10 @@ void PalRingBufferReader::getIndices(uint32_t *startIndice, uint32_t *endIndice)
 
 size_t PalRingBufferReader::getUnreadSize()
 {
-    PAL_VERBOSE(LOG_TAG, "unread size %zu", unreadSize_);
-    return unreadSize_;
+    size_t size = unreadSize();
+
+    PAL_VERBOSE(LOG_TAG, "unread size %zu", size);
+    return size;
 }
 
 void PalRingBufferReader::reset()
@@ -281,14 +601,39 @@ void PalRingBufferReader::reset()
     ringBuffer_->mutex_.lock();
     readOffset_ = 0;
     unreadSize_ = 0;
+    readPos_.store(ringBuffer_->writePos_.load(std::memory_order_acquire),
+                   std::memory_order_release);
+    overrunSize_.store(0, std::memory_order_relaxed);
     state_ = READER_DISABLED;
     ringBuffer_->mutex_.unlock();
+    ringBuffer_->cv_.notify_all();
 }
 
 PalRingBufferReader* PalRingBuffer::newReader()
 {
+    int i = 0;
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (lockFree_) {
+        for (i = 0; i < PAL_RING_BUFFER_MAX_READERS; i++) {
+            if (!readers_[i].load(std::memory_order_relaxed))
+                break;
+        }
+        if (i == PAL_RING_BUFFER_MAX_READERS) {
+            PAL_ERR(LOG_TAG, "No free reader slot, max %d",
+                    PAL_RING_BUFFER_MAX_READERS);
+            return nullptr;
+        }
+    }
+
     PalRingBufferReader* readOffset =
                   new PalRingBufferReader(this);
+    if (lockFree_) {
+        /* new readers start with nothing unread */
+        readOffset->readPos_.store(writePos_.load(std::memory_order_relaxed),
+                                   std::memory_order_relaxed);
+        readers_[i].store(readOffset, std::memory_order_release);
+    }
     readOffsets_.push_back(readOffset);
     return readOffset;
 }
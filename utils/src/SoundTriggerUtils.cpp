@@ -545,3 +545,116 @@ int32_t SoundModelInfo::UpdateConfLevelArray(uint8_t *conf_levels, uint32_t cfl_
     }
     return 0;
 }
+
+std::shared_ptr<MergedSoundModelCache> MergedSoundModelCache::cache_ =
+    nullptr;
+std::mutex MergedSoundModelCache::cache_instance_mutex_;
+
+std::shared_ptr<MergedSoundModelCache> MergedSoundModelCache::GetInstance() {
+    std::lock_guard<std::mutex> lck(cache_instance_mutex_);
+
+    if (!cache_)
+        cache_ = std::make_shared<MergedSoundModelCache>();
+
+    return cache_;
+}
+
+MergedSoundModelCache::MergedSoundModelCache(size_t max_bytes) :
+    max_bytes_(max_bytes),
+    cur_bytes_(0),
+    hits_(0),
+    misses_(0)
+{
+}
+
+MergedSoundModelCache::~MergedSoundModelCache() {
+    Clear();
+}
+
+/* 64 bit FNV-1a, only used to tell sound models apart */
+uint64_t MergedSoundModelCache::HashModel(const uint8_t *data, uint32_t size) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    for (uint32_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 0x100000001b3ULL;
+    }
+    /* mix in the size so that a prefix of a model never collides with it */
+    hash ^= size;
+    hash *= 0x100000001b3ULL;
+
+    return hash;
+}
+
+bool MergedSoundModelCache::Get(std::vector<uint64_t> key,
+                                SoundModelInfo *sm_info) {
+    std::lock_guard<std::mutex> lck(mutex_);
+
+    std::sort(key.begin(), key.end());
+    auto iter = index_.find(key);
+    if (iter == index_.end()) {
+        misses_++;
+        PAL_VERBOSE(LOG_TAG, "miss for %zu models, hits %u misses %u",
+            key.size(), hits_, misses_);
+        return false;
+    }
+
+    lru_.splice(lru_.begin(), lru_, iter->second);
+    *sm_info = *(iter->second->second);
+    hits_++;
+    PAL_DBG(LOG_TAG, "hit for %zu models, size %u, hits %u misses %u",
+        key.size(), sm_info->GetModelSize(), hits_, misses_);
+
+    return true;
+}
+
+void MergedSoundModelCache::Put(std::vector<uint64_t> key,
+                                SoundModelInfo *sm_info) {
+    std::lock_guard<std::mutex> lck(mutex_);
+    std::unique_ptr<SoundModelInfo> copy;
+    size_t size = sm_info->GetModelSize();
+
+    if (!sm_info->GetModelData() || size > max_bytes_) {
+        PAL_DBG(LOG_TAG, "not caching model of size %zu, budget %zu",
+            size, max_bytes_);
+        return;
+    }
+
+    std::sort(key.begin(), key.end());
+    auto iter = index_.find(key);
+    if (iter != index_.end()) {
+        cur_bytes_ -= iter->second->second->GetModelSize();
+        lru_.erase(iter->second);
+        index_.erase(iter);
+    }
+
+    while (!lru_.empty() && cur_bytes_ + size > max_bytes_) {
+        CacheEntry &victim = lru_.back();
+        PAL_DBG(LOG_TAG, "evict model of %zu models, size %u",
+            victim.first.size(), victim.second->GetModelSize());
+        cur_bytes_ -= victim.second->GetModelSize();
+        index_.erase(victim.first);
+        lru_.pop_back();
+    }
+
+    copy.reset(new SoundModelInfo());
+    *copy = *sm_info;
+    if (!copy->GetModelData()) {
+        PAL_ERR(LOG_TAG, "failed to copy model of size %zu", size);
+        return;
+    }
+
+    lru_.emplace_front(key, std::move(copy));
+    index_[key] = lru_.begin();
+    cur_bytes_ += size;
+    PAL_VERBOSE(LOG_TAG, "cached %zu entries, %zu of %zu bytes",
+        lru_.size(), cur_bytes_, max_bytes_);
+}
+
+void MergedSoundModelCache::Clear() {
+    std::lock_guard<std::mutex> lck(mutex_);
+
+    index_.clear();
+    lru_.clear();
+    cur_bytes_ = 0;
+}